@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "audio_mixer.h"
+
+using Format = AudioDecoderBase::Format;
+
+// Mix of 1 BGM and 16 SE as decoded by GenericAudio::Decode
+constexpr int frames = 2048;
+constexpr int num_se = 16;
+
+struct Channel {
+	Format format;
+	int channels;
+	float volume;
+	std::vector<uint8_t> data;
+};
+
+static std::vector<Channel> MakeChannels() {
+	std::vector<Channel> channels;
+	uint32_t x = 1;
+	auto add = [&](Format format, int num_channels, int samplesize, float volume) {
+		Channel chan { format, num_channels, volume, std::vector<uint8_t>(frames * num_channels * samplesize) };
+		for (auto& b: chan.data) {
+			x = x * 1103515245 + 12345;
+			b = static_cast<uint8_t>(x >> 16);
+		}
+		if (format == Format::F32) {
+			auto* f = reinterpret_cast<float*>(chan.data.data());
+			for (int i = 0; i < frames * num_channels; ++i) {
+				f[i] = (i % 200) / 100.0f - 1.0f;
+			}
+		}
+		channels.push_back(std::move(chan));
+	};
+
+	// BGM
+	add(Format::S16, 2, 2, 0.8f);
+	for (int i = 0; i < num_se; ++i) {
+		switch (i % 4) {
+			case 0: add(Format::S16, 2, 2, 0.9f); break;
+			case 1: add(Format::S16, 1, 2, 0.7f); break;
+			case 2: add(Format::U8, 1, 1, 0.5f); break;
+			case 3: add(Format::F32, 2, 4, 1.0f); break;
+		}
+	}
+	return channels;
+}
+
+static void BM_Mix(benchmark::State& state) {
+	auto channels = MakeChannels();
+	std::vector<float> mix(frames * 2);
+	std::vector<float> channel_buffer(frames * 2);
+	std::vector<int16_t> out(frames * 2);
+
+	for (auto _: state) {
+		std::fill(mix.begin(), mix.end(), 0.0f);
+		float total_volume = 0.0f;
+		for (auto& chan: channels) {
+			AudioMixer::ToFloat(chan.data.data(), chan.format, frames * chan.channels, channel_buffer.data());
+			// Fading channels
+			AudioMixer::Accumulate(mix.data(), channel_buffer.data(), chan.channels, frames, chan.volume * 0.95f, chan.volume);
+			total_volume += chan.volume;
+		}
+		AudioMixer::ToS16(mix.data(), frames * 2, total_volume, out.data());
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * frames);
+}
+
+BENCHMARK(BM_Mix);
+
+// The per-sample conversion of GenericAudio::Decode before AudioMixer, for comparison
+static void BM_MixPerSample(benchmark::State& state) {
+	auto channels = MakeChannels();
+	std::vector<float> mix(frames * 2);
+	std::vector<int16_t> out(frames * 2);
+
+	for (auto _: state) {
+		float total_volume = 0.0f;
+		bool channel_active = false;
+		for (auto& chan: channels) {
+			const int nch = chan.channels;
+			const uint8_t* data = chan.data.data();
+			for (int ii = 0; ii < frames; ++ii) {
+				float vall = chan.volume;
+				float valr = vall;
+				const int r = nch > 1 ? 1 : 0;
+				switch (chan.format) {
+					case Format::U8:
+						vall *= (((uint8_t *) data)[ii * nch] / 128.0 - 1.0);
+						valr *= (((uint8_t *) data)[ii * nch + r] / 128.0 - 1.0);
+						break;
+					case Format::S16:
+						vall *= (((int16_t *) data)[ii * nch] / 32768.0);
+						valr *= (((int16_t *) data)[ii * nch + r] / 32768.0);
+						break;
+					case Format::F32:
+						vall *= (((float *) data)[ii * nch]);
+						valr *= (((float *) data)[ii * nch + r]);
+						break;
+					default:
+						break;
+				}
+				if (!channel_active) {
+					mix[ii * 2] = vall;
+					mix[ii * 2 + 1] = valr;
+				} else {
+					mix[ii * 2] += vall;
+					mix[ii * 2 + 1] += valr;
+				}
+			}
+			channel_active = true;
+			total_volume += chan.volume;
+		}
+
+		float threshold = 0.8;
+		for (int i = 0; i < frames * 2; i++) {
+			float sample = mix[i];
+			float sign = (sample < 0) ? -1.0 : 1.0;
+			sample /= sign;
+			if (sample > threshold) {
+				out[i] = sign * 32768.0 * (threshold + (1.0 - threshold) * (sample - threshold) / (total_volume - threshold));
+			} else {
+				out[i] = sign * sample * 32768.0;
+			}
+		}
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * frames);
+}
+
+BENCHMARK(BM_MixPerSample);
+
+BENCHMARK_MAIN();
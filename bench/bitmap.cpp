@@ -1,7 +1,10 @@
 #include <cmath>
+#include <cstring>
+#include <vector>
 #include <benchmark/benchmark.h>
 #include <rect.h>
 #include <bitmap.h>
+#include <bitmap_kernels.h>
 #include <pixel_format.h>
 #include <transform.h>
 
@@ -277,6 +280,126 @@ static void BM_ToneBlit(benchmark::State& state) {
 
 BENCHMARK(BM_ToneBlit);
 
+static std::vector<uint32_t> MakeKernelPixels(int size) {
+	std::vector<uint32_t> pixels(size);
+	uint32_t x = 1;
+	for (auto& px: pixels) {
+		// Random colors, some of them transparent
+		x = x * 1103515245 + 12345;
+		px = x;
+	}
+	return pixels;
+}
+
+static void BM_ToneKernel(benchmark::State& state) {
+	auto level = static_cast<BitmapKernels::Level>(state.range(0));
+	auto prev_level = BitmapKernels::GetLevel();
+	if (!BitmapKernels::SetLevel(level)) {
+		state.SkipWithError("Not supported by the CPU");
+		return;
+	}
+	state.SetLabel(BitmapKernels::GetName(level));
+
+	auto pixels = MakeKernelPixels(320 * 240);
+	BitmapKernels::ToneParams params;
+	params.rs = 24;
+	params.gs = 16;
+	params.bs = 8;
+	params.as = 0;
+	params.apply_saturation = true;
+	params.saturation = 64 * 8;
+	params.apply_tone = true;
+	params.red = 255;
+	params.green = 100;
+	params.blue = 50;
+	params.skip_transparent = true;
+	params.premultiplied = true;
+
+	for (auto _: state) {
+		for (int y = 0; y < 240; ++y) {
+			BitmapKernels::ToneRow(pixels.data() + y * 320, 320, params);
+		}
+		benchmark::DoNotOptimize(pixels.data());
+	}
+	state.SetItemsProcessed(state.iterations() * pixels.size());
+	BitmapKernels::SetLevel(prev_level);
+}
+
+BENCHMARK(BM_ToneKernel)->DenseRange(0, 2);
+
+static void BM_HueKernel(benchmark::State& state) {
+	auto level = static_cast<BitmapKernels::Level>(state.range(0));
+	auto prev_level = BitmapKernels::GetLevel();
+	if (!BitmapKernels::SetLevel(level)) {
+		state.SkipWithError("Not supported by the CPU");
+		return;
+	}
+	state.SetLabel(BitmapKernels::GetName(level));
+
+	auto pixels = MakeKernelPixels(320 * 240);
+
+	for (auto _: state) {
+		BitmapKernels::HueRow(pixels.data(), static_cast<int>(pixels.size()), 0x100);
+		benchmark::DoNotOptimize(pixels.data());
+	}
+	state.SetItemsProcessed(state.iterations() * pixels.size());
+	BitmapKernels::SetLevel(prev_level);
+}
+
+BENCHMARK(BM_HueKernel)->DenseRange(0, 2);
+
+// Arg 0 blits with pixman, 1 with BitmapKernels::BlitRect
+static void BlitSmall(benchmark::State& state, int w, int h, bool fast, Opacity op) {
+	const bool prev = BitmapKernels::IsBlitEnabled();
+	BitmapKernels::SetBlitEnabled(state.range(0) != 0);
+	state.SetLabel(state.range(0) ? "kernel" : "pixman");
+
+	Bitmap::SetFormat(format);
+	auto dest = Bitmap::Create(320, 240);
+	auto src = Bitmap::Create(w, h);
+	auto pixels = MakeKernelPixels(w * h);
+	std::memcpy(src->pixels(), pixels.data(), pixels.size() * sizeof(uint32_t));
+	auto rect = src->GetRect();
+
+	for (auto _: state) {
+		for (int y = 0; y + h <= 240; y += h) {
+			for (int x = 0; x + w <= 320; x += w) {
+				if (fast) {
+					dest->BlitFast(x, y, *src, rect, op);
+				} else {
+					dest->Blit(x, y, *src, rect, op);
+				}
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * (320 / w) * (240 / h));
+	BitmapKernels::SetBlitEnabled(prev);
+}
+
+static void BM_BlitTile(benchmark::State& state) {
+	BlitSmall(state, 16, 16, false, opacity_100);
+}
+
+BENCHMARK(BM_BlitTile)->DenseRange(0, 1);
+
+static void BM_BlitFastTile(benchmark::State& state) {
+	BlitSmall(state, 16, 16, true, opacity_100);
+}
+
+BENCHMARK(BM_BlitFastTile)->DenseRange(0, 1);
+
+static void BM_BlitCharset(benchmark::State& state) {
+	BlitSmall(state, 24, 32, false, opacity_100);
+}
+
+BENCHMARK(BM_BlitCharset)->DenseRange(0, 1);
+
+static void BM_BlitCharsetOpacity(benchmark::State& state) {
+	BlitSmall(state, 24, 32, false, opacity_50);
+}
+
+BENCHMARK(BM_BlitCharsetOpacity)->DenseRange(0, 1);
+
 static void BM_BlendBlit(benchmark::State& state) {
 	Bitmap::SetFormat(format);
 	auto dest = Bitmap::Create(320, 240);
@@ -2,6 +2,8 @@
 #include <font.h>
 #include <rect.h>
 #include <bitmap.h>
+#include <bitmap_kernels.h>
+#include <pixel_format.h>
 #include <sprite.h>
 #include <graphics.h>
 #include <drawable_list.h>
@@ -45,4 +47,71 @@ static void BM_DrawSortLocality(benchmark::State& state) {
 
 BENCHMARK(BM_DrawSortLocality);
 
+// Arg 0 blits with pixman, 1 with BitmapKernels::BlitRect
+static void BM_DrawCharsets(benchmark::State& state) {
+	const bool prev = BitmapKernels::IsBlitEnabled();
+	BitmapKernels::SetBlitEnabled(state.range(0) != 0);
+	state.SetLabel(state.range(0) ? "kernel" : "pixman");
+
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	auto screen = Bitmap::Create(320, 240);
+	auto charset = Bitmap::Create(24 * 12, 32 * 8);
+	charset->Fill(Color(255, 0, 0, 255));
+
+	DrawableList list;
+	DrawableMgr::SetLocalList(&list);
+
+	// A busy map: 200 events with a 24x32 charset frame
+	std::vector<std::unique_ptr<Sprite>> sprites;
+	for (int i = 0; i < 200; ++i) {
+		auto sprite = std::make_unique<Sprite>();
+		sprite->SetBitmap(charset);
+		sprite->SetSrcRect(Rect((i % 12) * 24, (i % 8) * 32, 24, 32));
+		sprite->SetX((i * 37) % 296);
+		sprite->SetY((i * 53) % 208);
+		sprites.push_back(std::move(sprite));
+	}
+
+	for (auto _: state) {
+		list.Draw(*screen);
+	}
+	state.SetItemsProcessed(state.iterations() * sprites.size());
+	BitmapKernels::SetBlitEnabled(prev);
+}
+
+BENCHMARK(BM_DrawCharsets)->DenseRange(0, 1);
+
+// Fading flash on every sprite, the effect bitmap changes every frame
+static void BM_DrawFlashingCharsets(benchmark::State& state) {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	auto screen = Bitmap::Create(320, 240);
+	auto charset = Bitmap::Create(24 * 12, 32 * 8);
+	charset->Fill(Color(255, 0, 0, 255));
+
+	DrawableList list;
+	DrawableMgr::SetLocalList(&list);
+
+	std::vector<std::unique_ptr<Sprite>> sprites;
+	for (int i = 0; i < 50; ++i) {
+		auto sprite = std::make_unique<Sprite>();
+		sprite->SetBitmap(charset);
+		sprite->SetSrcRect(Rect((i % 12) * 24, (i % 8) * 32, 24, 32));
+		sprite->SetX((i * 37) % 296);
+		sprite->SetY((i * 53) % 208);
+		sprites.push_back(std::move(sprite));
+	}
+
+	int alpha = 0;
+	for (auto _: state) {
+		alpha = (alpha + 1) % 256;
+		for (auto& sprite: sprites) {
+			sprite->SetFlashEffect(Color(255, 255, 255, alpha));
+		}
+		list.Draw(*screen);
+	}
+	state.SetItemsProcessed(state.iterations() * sprites.size());
+}
+
+BENCHMARK(BM_DrawFlashingCharsets);
+
 BENCHMARK_MAIN();
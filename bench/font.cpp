@@ -4,6 +4,9 @@
 #include <bitmap.h>
 #include <pixel_format.h>
 #include <cache.h>
+#include <filefinder.h>
+#include <text.h>
+#include <cstdlib>
 
 const std::string text = "Alex landed a critical hit on Slime!";
 char32_t symbol = '\\';
@@ -53,4 +56,42 @@ static void BM_Render(benchmark::State& state) {
 
 BENCHMARK(BM_Render);
 
+// Redraws the same line with a FreeType font every frame like a message window does.
+// The font is loaded from EP_BENCH_FONT, the benchmark is skipped when unset.
+static void BM_RenderTextFreeType(benchmark::State& state) {
+	const char* path = std::getenv("EP_BENCH_FONT");
+	if (!path) {
+		state.SkipWithError("EP_BENCH_FONT not set");
+		return;
+	}
+
+	auto font = Font::CreateFtFont(FileFinder::Root().OpenInputStream(path), 12, false, false);
+	if (!font) {
+		state.SkipWithError("Font loading failed");
+		return;
+	}
+
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	auto surface = Bitmap::Create(width, height);
+	auto system = Cache::SystemOrBlack();
+
+	// The first draw fills the glyph atlas, all further draws must be served from it
+	Text::Draw(*surface, 0, 0, *font, *system, 0, text);
+	const auto loads = Font::GetStats().glyph_loads;
+	const auto renders = Font::GetStats().glyph_renders;
+
+	for (auto _: state) {
+		Text::Draw(*surface, 0, 0, *font, *system, 0, text);
+	}
+	state.SetItemsProcessed(state.iterations() * text.size());
+
+	state.counters["glyph_loads"] = Font::GetStats().glyph_loads - loads;
+	state.counters["glyph_renders"] = Font::GetStats().glyph_renders - renders;
+	if (Font::GetStats().glyph_loads != loads || Font::GetStats().glyph_renders != renders) {
+		state.SkipWithError("Glyphs were loaded from FreeType again");
+	}
+}
+
+BENCHMARK(BM_RenderTextFreeType);
+
 BENCHMARK_MAIN();
@@ -0,0 +1,230 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <benchmark/benchmark.h>
+#include "game_map.h"
+#include "game_commonevent.h"
+#include "game_interpreter_map.h"
+#include "game_player.h"
+#include "game_party.h"
+#include "game_actors.h"
+#include "game_system.h"
+#include "game_switches.h"
+#include "game_variables.h"
+#include "game_screen.h"
+#include "game_pictures.h"
+#include "main_data.h"
+#include "maniac_patch.h"
+#include "map_data.h"
+#include "output.h"
+#include <lcf/data.h>
+
+// Counts the allocations done while the benchmark is running
+static std::atomic<int64_t> num_allocs = {0};
+
+void* operator new(std::size_t size) {
+	++num_allocs;
+	if (void* p = std::malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+constexpr int num_parallel = 200;
+constexpr int script_size = 64;
+constexpr int called_event_id = num_parallel + 1;
+
+using Cmd = lcf::rpg::EventCommand::Code;
+
+static std::vector<lcf::rpg::EventCommand> make_script() {
+	std::vector<lcf::rpg::EventCommand> list;
+	for (int i = 0; i < script_size; ++i) {
+		lcf::rpg::EventCommand cmd;
+		cmd.code = static_cast<int>(i == 0 ? Cmd::Comment : Cmd::Comment_2);
+		cmd.string = lcf::DBString("Parallel process script line");
+		cmd.parameters = lcf::DBArray<int32_t>({ i, 0, 0, 0, 0 });
+		list.push_back(std::move(cmd));
+	}
+	return list;
+}
+
+static void setup() {
+	Output::SetLogLevel(LogLevel::Error);
+
+	lcf::Data::data = {};
+	lcf::Data::terrains.push_back({});
+	lcf::Data::chipsets.push_back({});
+	auto& chipset = lcf::Data::chipsets.back();
+	chipset.passable_data_lower.resize(162, 0xF);
+	chipset.passable_data_upper.resize(162, 0xF);
+	chipset.terrain_data.resize(144, 1);
+
+	lcf::Data::treemap.maps.push_back({});
+	lcf::Data::treemap.maps.back().type = lcf::rpg::TreeMap::MapType_root;
+	lcf::Data::treemap.maps.push_back({});
+	lcf::Data::treemap.maps.back().ID = 1;
+	lcf::Data::treemap.maps.back().type = lcf::rpg::TreeMap::MapType_map;
+
+	// Every parallel common event calls the same common event
+	for (int i = 1; i <= num_parallel; ++i) {
+		lcf::rpg::CommonEvent ce;
+		ce.ID = i;
+		ce.trigger = lcf::rpg::EventPage::Trigger_parallel;
+		lcf::rpg::EventCommand call;
+		call.code = static_cast<int>(Cmd::CallEvent);
+		call.parameters = lcf::DBArray<int32_t>({ 0, called_event_id, 0 });
+		ce.event_commands.push_back(std::move(call));
+		lcf::Data::commonevents.push_back(std::move(ce));
+	}
+	lcf::rpg::CommonEvent called;
+	called.ID = called_event_id;
+	called.trigger = lcf::rpg::EventPage::Trigger_call;
+	called.event_commands = make_script();
+	lcf::Data::commonevents.push_back(std::move(called));
+
+	Main_Data::game_actors = std::make_unique<Game_Actors>();
+	Main_Data::game_party = std::make_unique<Game_Party>();
+	Game_Map::Init();
+	Main_Data::game_system = std::make_unique<Game_System>();
+	Main_Data::game_switches = std::make_unique<Game_Switches>();
+	Main_Data::game_variables = std::make_unique<Game_Variables>(Game_Variables::min_2k3, Game_Variables::max_2k3);
+	Main_Data::game_pictures = std::make_unique<Game_Pictures>();
+	Main_Data::game_screen = std::make_unique<Game_Screen>();
+	Main_Data::game_player = std::make_unique<Game_Player>();
+	Main_Data::game_player->SetMapId(1);
+
+	auto map = std::make_unique<lcf::rpg::Map>();
+	map->width = 20;
+	map->height = 15;
+	map->upper_layer.resize(20 * 15, BLOCK_F);
+	map->lower_layer.resize(20 * 15, BLOCK_E);
+	Game_Map::Setup(std::move(map));
+}
+
+static void teardown() {
+	Main_Data::game_player = {};
+	Main_Data::game_screen = {};
+	Main_Data::game_pictures = {};
+	Main_Data::game_variables = {};
+	Main_Data::game_switches = {};
+	Game_Map::Quit();
+	Main_Data::game_party.reset();
+	lcf::Data::data = {};
+}
+
+// One frame of 200 parallel common events, each calls a shared common event
+static void BM_ParallelCommonEvents(benchmark::State& state) {
+	setup();
+
+	int64_t allocs = num_allocs;
+	for (auto _: state) {
+		for (auto& ce: Game_Map::GetCommonEvents()) {
+			ce.Update(false);
+		}
+	}
+	state.counters["allocs"] = benchmark::Counter(num_allocs - allocs, benchmark::Counter::kAvgIterations);
+	state.SetItemsProcessed(state.iterations() * num_parallel);
+
+	teardown();
+}
+
+BENCHMARK(BM_ParallelCommonEvents);
+
+// Pushing the script of a common event with a shared list (0) or a copy (1)
+static void BM_PushCommandList(benchmark::State& state) {
+	setup();
+
+	const bool copy = state.range(0);
+	auto& called = Game_Map::GetCommonEvents()[called_event_id - 1];
+	std::vector<Game_Interpreter_Map> interpreters(num_parallel);
+
+	int64_t allocs = num_allocs;
+	for (auto _: state) {
+		for (auto& interp: interpreters) {
+			if (copy) {
+				interp.Push(called.GetList(), 0);
+			} else {
+				interp.Push(&called);
+			}
+			interp.Clear();
+		}
+	}
+	state.counters["allocs"] = benchmark::Counter(num_allocs - allocs, benchmark::Counter::kAvgIterations);
+	state.SetItemsProcessed(state.iterations() * num_parallel);
+
+	teardown();
+}
+
+BENCHMARK(BM_PushCommandList)->Arg(0)->Arg(1);
+
+// Infinite loop around a branch that is never taken, the branch body has state.range(0) commands
+static void BM_LoopScript(benchmark::State& state) {
+	setup();
+
+	std::vector<lcf::rpg::EventCommand> list;
+	auto add = [&](Cmd code, int indent, std::initializer_list<int32_t> params) {
+		lcf::rpg::EventCommand cmd;
+		cmd.code = static_cast<int>(code);
+		cmd.indent = indent;
+		cmd.parameters = lcf::DBArray<int32_t>(params);
+		list.push_back(std::move(cmd));
+	};
+	add(Cmd::Loop, 0, {});
+	// Switch 1 is OFF
+	add(Cmd::ConditionalBranch, 1, { 0, 1, 0, 0, 0, 0 });
+	for (int i = 0; i < state.range(0); ++i) {
+		add(Cmd::Comment, 2, {});
+	}
+	add(Cmd::EndBranch, 1, {});
+	add(Cmd::EndLoop, 0, {});
+
+	Game_Interpreter_Map interpreter;
+	interpreter.Push(list, 0);
+
+	for (auto _: state) {
+		interpreter.Update();
+	}
+	state.SetItemsProcessed(state.iterations() * interpreter.GetLoopCount());
+
+	teardown();
+}
+
+BENCHMARK(BM_LoopScript)->RangeMultiplier(10)->Range(1, 1000);
+
+// (V[1] + 3) * V[2] - V[3] % 7 evaluated by parsing every time (0) or compiled once (1)
+static void BM_ManiacExpression(benchmark::State& state) {
+	setup();
+
+	const std::vector<uint32_t> bytes = { 49, 50, 48, 8, 1, 1, 1, 3, 8, 1, 2, 52, 8, 1, 3, 1, 7 };
+	std::vector<int32_t> op_codes((bytes.size() + 3) / 4);
+	for (size_t i = 0; i < bytes.size(); ++i) {
+		op_codes[i / 4] |= static_cast<int32_t>(bytes[i] << ((i % 4) * 8));
+	}
+	Span<const int32_t> span(op_codes.data(), op_codes.size());
+
+	const bool compiled = state.range(0);
+	const auto expr = ManiacPatch::CompileExpression(span);
+	Game_Interpreter_Map interpreter;
+
+	for (auto _: state) {
+		if (compiled) {
+			benchmark::DoNotOptimize(ManiacPatch::EvaluateExpression(expr, interpreter));
+		} else {
+			benchmark::DoNotOptimize(ManiacPatch::ParseExpression(span, interpreter));
+		}
+	}
+
+	teardown();
+}
+
+BENCHMARK(BM_ManiacExpression)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
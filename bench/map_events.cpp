@@ -0,0 +1,128 @@
+#include <benchmark/benchmark.h>
+#include "game_map.h"
+#include "game_event.h"
+#include "game_player.h"
+#include "game_party.h"
+#include "game_actors.h"
+#include "game_system.h"
+#include "game_switches.h"
+#include "game_variables.h"
+#include "game_screen.h"
+#include "game_pictures.h"
+#include "main_data.h"
+#include "map_data.h"
+#include "output.h"
+#include <lcf/data.h>
+
+constexpr int map_size = 128;
+
+static std::unique_ptr<lcf::rpg::Map> make_map(int num_events) {
+	auto map = std::make_unique<lcf::rpg::Map>();
+	map->width = map_size;
+	map->height = map_size;
+	map->upper_layer.resize(map_size * map_size, BLOCK_F);
+	map->lower_layer.resize(map_size * map_size, BLOCK_E);
+
+	uint32_t seed = 1;
+	for (int i = 0; i < num_events; ++i) {
+		seed = seed * 1103515245 + 12345;
+		map->events.push_back({});
+		auto& ev = map->events.back();
+		ev.ID = i + 1;
+		ev.x = (seed >> 8) % map_size;
+		ev.y = (seed >> 20) % map_size;
+		ev.pages.push_back({});
+		ev.pages.back().ID = 1;
+		ev.pages.back().move_type = lcf::rpg::EventPage::MoveType_stationary;
+		ev.pages.back().character_pattern = 1;
+	}
+
+	return map;
+}
+
+static void setup(int num_events) {
+	Output::SetLogLevel(LogLevel::Error);
+
+	lcf::Data::data = {};
+	lcf::Data::terrains.push_back({});
+	lcf::Data::chipsets.push_back({});
+	auto& chipset = lcf::Data::chipsets.back();
+	chipset.passable_data_lower.resize(162, 0xF);
+	chipset.passable_data_upper.resize(162, 0xF);
+	chipset.terrain_data.resize(144, 1);
+
+	lcf::Data::treemap.maps.push_back({});
+	lcf::Data::treemap.maps.back().type = lcf::rpg::TreeMap::MapType_root;
+	lcf::Data::treemap.maps.push_back({});
+	lcf::Data::treemap.maps.back().ID = 1;
+	lcf::Data::treemap.maps.back().type = lcf::rpg::TreeMap::MapType_map;
+
+	Main_Data::game_actors = std::make_unique<Game_Actors>();
+	Main_Data::game_party = std::make_unique<Game_Party>();
+	Game_Map::Init();
+	Main_Data::game_system = std::make_unique<Game_System>();
+	Main_Data::game_switches = std::make_unique<Game_Switches>();
+	Main_Data::game_variables = std::make_unique<Game_Variables>(Game_Variables::min_2k3, Game_Variables::max_2k3);
+	Main_Data::game_pictures = std::make_unique<Game_Pictures>();
+	Main_Data::game_screen = std::make_unique<Game_Screen>();
+	Main_Data::game_player = std::make_unique<Game_Player>();
+	Main_Data::game_player->SetMapId(1);
+
+	Game_Map::Setup(make_map(num_events));
+}
+
+static void teardown() {
+	Main_Data::game_player = {};
+	Main_Data::game_screen = {};
+	Main_Data::game_pictures = {};
+	Main_Data::game_variables = {};
+	Main_Data::game_switches = {};
+	Game_Map::Quit();
+	Main_Data::game_party.reset();
+	lcf::Data::data = {};
+}
+
+// Every event tries one step in a random direction per iteration
+static void BM_MapEventsRandomWalk(benchmark::State& state) {
+	setup(state.range(0));
+
+	uint32_t seed = 1;
+	for (auto _: state) {
+		for (auto& ev: Game_Map::GetEvents()) {
+			seed = seed * 1103515245 + 12345;
+			const int dir = (seed >> 16) % 4;
+			const int x = ev.GetX();
+			const int y = ev.GetY();
+			const int nx = Game_Map::RoundX(x + Game_Character::GetDxFromDirection(dir));
+			const int ny = Game_Map::RoundY(y + Game_Character::GetDyFromDirection(dir));
+			if (Game_Map::MakeWay(ev, x, y, nx, ny)) {
+				ev.SetX(nx);
+				ev.SetY(ny);
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+
+	teardown();
+}
+
+BENCHMARK(BM_MapEventsRandomWalk)->RangeMultiplier(10)->Range(10, 1000);
+
+static void BM_MapGetEventsXY(benchmark::State& state) {
+	setup(state.range(0));
+
+	std::vector<Game_Event*> events;
+	int i = 0;
+	for (auto _: state) {
+		events.clear();
+		Game_Map::GetEventsXY(events, i % map_size, (i / map_size) % map_size);
+		benchmark::DoNotOptimize(events.data());
+		++i;
+	}
+
+	teardown();
+}
+
+BENCHMARK(BM_MapGetEventsXY)->RangeMultiplier(10)->Range(10, 1000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,450 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <set>
+#include <unordered_set>
+#include <utility>
+
+#include "asset_prefetch.h"
+#include "async_handler.h"
+#include "audio_secache.h"
+#include "bitmap.h"
+#include "cache.h"
+#include "filefinder.h"
+#include "game_system.h"
+#include "output.h"
+#include "player.h"
+#include <lcf/data.h>
+#include <lcf/reader_util.h>
+#include <lcf/rpg/commonevent.h>
+#include <lcf/rpg/eventcommand.h>
+#include <lcf/rpg/map.h>
+
+namespace {
+	using Asset = AssetPrefetch::Asset;
+	using Cmd = lcf::rpg::EventCommand::Code;
+
+	constexpr int this_event_id = 10005;
+	// Limits the decoding jobs and downloads to not delay assets requested by the game
+	constexpr int max_jobs_in_flight = 2;
+
+	class Planner {
+	public:
+		Planner(const lcf::rpg::Map& map, const std::vector<lcf::rpg::CommonEvent>& common_events) :
+			map(map), common_events(common_events) {}
+
+		std::vector<Asset> Run();
+
+	private:
+		static bool HasConditions(const lcf::rpg::EventPage& page);
+		static bool IsAutomatic(int trigger);
+
+		template <typename F>
+		void ForEachReachablePage(F&& f) const;
+
+		void Add(Asset::Type type, const char* directory, StringView name, bool transparent = true);
+		void AddAnimation(int animation_id);
+		void WalkPage(const lcf::rpg::Event& event, const lcf::rpg::EventPage& page);
+		void WalkCommonEvent(int common_event_id);
+		void WalkCommands(const std::vector<lcf::rpg::EventCommand>& commands, int event_id);
+
+		const lcf::rpg::Map& map;
+		const std::vector<lcf::rpg::CommonEvent>& common_events;
+
+		std::vector<Asset> assets;
+		std::unordered_set<std::string> seen_assets;
+		std::set<std::pair<int, int>> visited_pages;
+		std::unordered_set<int> visited_common_events;
+	};
+
+	bool Planner::HasConditions(const lcf::rpg::EventPage& page) {
+		const auto& flags = page.condition.flags;
+		return flags.switch_a || flags.switch_b || flags.variable || flags.item
+			|| flags.actor || flags.timer || flags.timer2;
+	}
+
+	bool Planner::IsAutomatic(int trigger) {
+		// Common events share the trigger values of event pages
+		return trigger == lcf::rpg::EventPage::Trigger_auto_start
+			|| trigger == lcf::rpg::EventPage::Trigger_parallel;
+	}
+
+	template <typename F>
+	void Planner::ForEachReachablePage(F&& f) const {
+		for (const auto& event: map.events) {
+			// The active page is the last page with fulfilled conditions
+			for (auto it = event.pages.rbegin(); it != event.pages.rend(); ++it) {
+				f(event, *it);
+				if (!HasConditions(*it)) {
+					break;
+				}
+			}
+		}
+	}
+
+	void Planner::Add(Asset::Type type, const char* directory, StringView name, bool transparent) {
+		if (name.empty() || name == "(OFF)") {
+			return;
+		}
+
+		// Both variants of an image are cached separately
+		std::string key = std::string(directory) + "/" + ToString(name) + (transparent ? "" : "|opaque");
+		if (seen_assets.insert(std::move(key)).second) {
+			assets.push_back({type, directory, ToString(name), transparent});
+		}
+	}
+
+	void Planner::AddAnimation(int animation_id) {
+		const auto* animation = lcf::ReaderUtil::GetElement(lcf::Data::animations, animation_id);
+		if (!animation) {
+			return;
+		}
+
+		Add(Asset::Image, animation->large ? "Battle2" : "Battle", animation->animation_name);
+		for (const auto& timing: animation->timings) {
+			Add(Asset::Sound, "Sound", timing.se.name);
+		}
+	}
+
+	void Planner::WalkPage(const lcf::rpg::Event& event, const lcf::rpg::EventPage& page) {
+		if (!visited_pages.insert({event.ID, page.ID}).second) {
+			return;
+		}
+
+		WalkCommands(page.event_commands, event.ID);
+	}
+
+	void Planner::WalkCommonEvent(int common_event_id) {
+		const auto* ce = lcf::ReaderUtil::GetElement(common_events, common_event_id);
+		if (!ce || !visited_common_events.insert(common_event_id).second) {
+			return;
+		}
+
+		WalkCommands(ce->event_commands, 0);
+	}
+
+	void Planner::WalkCommands(const std::vector<lcf::rpg::EventCommand>& commands, int event_id) {
+		for (const auto& com: commands) {
+			switch (static_cast<Cmd>(com.code)) {
+				case Cmd::ShowPicture:
+					// Game_Pictures requests the image with the transparency of the command
+					Add(Asset::Image, "Picture", com.string, com.parameters.size() <= 7 || com.parameters[7] > 0);
+					break;
+				case Cmd::ChangeSpriteAssociation:
+					Add(Asset::Image, "CharSet", com.string);
+					break;
+				case Cmd::ChangeFaceGraphic:
+					Add(Asset::Image, "FaceSet", com.string);
+					break;
+				case Cmd::PlayBGM:
+					Add(Asset::Music, "Music", com.string);
+					break;
+				case Cmd::PlaySound:
+					Add(Asset::Sound, "Sound", com.string);
+					break;
+				case Cmd::ShowBattleAnimation:
+					if (!com.parameters.empty()) {
+						AddAnimation(com.parameters[0]);
+					}
+					break;
+				case Cmd::CallEvent: {
+					if (com.parameters.size() < 3) {
+						break;
+					}
+					if (com.parameters[0] == 0) {
+						WalkCommonEvent(com.parameters[1]);
+					} else if (com.parameters[0] == 1) {
+						// Indirect calls (2) depend on variables and are not followed
+						int target_id = com.parameters[1] == this_event_id ? event_id : com.parameters[1];
+						auto event = std::find_if(map.events.begin(), map.events.end(), [&](const lcf::rpg::Event& ev) {
+							return ev.ID == target_id;
+						});
+						int page_index = com.parameters[2] - 1;
+						if (event != map.events.end() && page_index >= 0 && page_index < static_cast<int>(event->pages.size())) {
+							WalkPage(*event, event->pages[page_index]);
+						}
+					}
+					break;
+				}
+				default:
+					break;
+			}
+		}
+	}
+
+	std::vector<Asset> Planner::Run() {
+		// Sprites of the events are shown as soon as the map is visible
+		ForEachReachablePage([this](const lcf::rpg::Event&, const lcf::rpg::EventPage& page) {
+			Add(Asset::Image, "CharSet", page.character_name);
+			if (page.move_type == lcf::rpg::EventPage::MoveType_custom) {
+				for (const auto& move_command: page.move_route.move_commands) {
+					using Code = lcf::rpg::MoveCommand::Code;
+					const auto code = static_cast<Code>(move_command.command_id);
+					if (code == Code::change_graphic) {
+						Add(Asset::Image, "CharSet", move_command.parameter_string);
+					} else if (code == Code::play_sound_effect) {
+						Add(Asset::Sound, "Sound", move_command.parameter_string);
+					}
+				}
+			}
+		});
+
+		// Events that start without player interaction
+		ForEachReachablePage([this](const lcf::rpg::Event& event, const lcf::rpg::EventPage& page) {
+			if (IsAutomatic(page.trigger)) {
+				WalkPage(event, page);
+			}
+		});
+		for (const auto& ce: common_events) {
+			if (IsAutomatic(ce.trigger)) {
+				WalkCommonEvent(ce.ID);
+			}
+		}
+
+		ForEachReachablePage([this](const lcf::rpg::Event& event, const lcf::rpg::EventPage& page) {
+			WalkPage(event, page);
+		});
+
+		return std::move(assets);
+	}
+
+	std::vector<Asset> plan;
+	size_t next_asset = 0;
+	size_t budget = 0;
+	int jobs_in_flight = 0;
+	// Incremented on Reset, invalidates callbacks of decoding jobs for the previous map
+	int generation = 0;
+
+	AssetPrefetch::Stats stats;
+	Cache::Stats cache_stats_begin;
+	AudioSeCache::Stats se_stats_begin;
+	// Sound effects decoded by the prefetcher are not counted as misses
+	int prefetch_se_decodes = 0;
+
+	// Keeps the assets alive, unreferenced cache entries are freed after a few seconds
+	std::vector<BitmapRef> loaded_bitmaps;
+	std::vector<AudioSeRef> loaded_sounds;
+
+	void LoadImage(const Asset& asset) {
+		const int gen = generation;
+		auto on_loaded = [gen](BitmapRef bmp) {
+			if (gen != generation) {
+				return;
+			}
+
+			--jobs_in_flight;
+			if (bmp) {
+				++stats.loaded;
+				stats.bytes += bmp->GetSize();
+				loaded_bitmaps.push_back(std::move(bmp));
+			}
+		};
+
+		if (Cache::LoadBitmapAsync(asset.directory, asset.name, asset.transparent, std::move(on_loaded))) {
+			++jobs_in_flight;
+		}
+	}
+
+	/** @return whether the sound is decoded on the main thread */
+	bool LoadSound(const Asset& asset) {
+		if (Player::no_audio_flag || AudioSeCache::GetCachedSe(asset.name)) {
+			return false;
+		}
+
+		Filesystem_Stream::InputStream stream;
+		if (Game_System::IsStopSoundFilename(asset.name, stream) || !stream) {
+			return false;
+		}
+
+		const int gen = generation;
+		auto on_loaded = [gen](AudioSeRef se) {
+			if (gen != generation) {
+				return;
+			}
+
+			--jobs_in_flight;
+			if (se) {
+				++stats.loaded;
+				stats.bytes += se->buffer.size();
+				loaded_sounds.push_back(std::move(se));
+			}
+		};
+
+		// Reopened when it is not decoded in the background
+		if (AudioSeCache::LoadAsync(std::move(stream), asset.name, std::move(on_loaded))) {
+			++jobs_in_flight;
+			return false;
+		}
+
+		if (Game_System::IsStopSoundFilename(asset.name, stream) || !stream) {
+			return false;
+		}
+
+		auto se = AudioSeCache::Create(std::move(stream), asset.name);
+		if (!se) {
+			return false;
+		}
+
+		const int misses = AudioSeCache::GetStats().misses;
+		se->CreateSeDecoder();
+		prefetch_se_decodes += AudioSeCache::GetStats().misses - misses;
+
+		auto se_data = se->GetSeData();
+		++stats.loaded;
+		stats.bytes += se_data->buffer.size();
+		loaded_sounds.push_back(std::move(se_data));
+		return true;
+	}
+
+#ifdef EMSCRIPTEN
+	// Keeps the listeners of the downloads alive
+	std::vector<FileRequestBinding> downloads;
+
+	size_t GetDownloadedSize(const Asset& asset) {
+		Filesystem_Stream::InputStream is;
+		switch (asset.type) {
+			case Asset::Image:
+				is = FileFinder::OpenImage(asset.directory, asset.name);
+				break;
+			case Asset::Sound:
+				is = FileFinder::OpenSound(asset.name);
+				break;
+			case Asset::Music:
+				is = FileFinder::OpenMusic(asset.name);
+				break;
+		}
+		if (!is) {
+			return 0;
+		}
+		is.seekg(0, std::ios_base::end);
+		return static_cast<size_t>(std::max<std::streamoff>(is.tellg(), 0));
+	}
+
+	void Download(const Asset& asset) {
+		auto* request = AsyncHandler::RequestFile(asset.directory, asset.name);
+
+		const int gen = generation;
+		// Invoked immediately when the file was downloaded already
+		downloads.push_back(request->Bind([gen, asset](FileRequestResult* result) {
+			if (gen != generation) {
+				return;
+			}
+
+			--jobs_in_flight;
+			if (result->success) {
+				++stats.loaded;
+				stats.bytes += GetDownloadedSize(asset);
+			}
+		}));
+
+		++jobs_in_flight;
+		request->Start();
+	}
+#endif
+}
+
+std::vector<Asset> AssetPrefetch::Plan(const lcf::rpg::Map& map, const std::vector<lcf::rpg::CommonEvent>& common_events) {
+	return Planner(map, common_events).Run();
+}
+
+void AssetPrefetch::OnMapSetup(const lcf::rpg::Map& map) {
+	Reset();
+
+	budget = static_cast<size_t>(Player::player_config.prefetch_budget.Get()) * 1024 * 1024;
+	if (budget == 0) {
+		return;
+	}
+
+	plan = Plan(map, lcf::Data::commonevents);
+	stats.planned = static_cast<int>(plan.size());
+	cache_stats_begin = Cache::GetStats();
+	se_stats_begin = AudioSeCache::GetStats();
+}
+
+void AssetPrefetch::Update() {
+	while (next_asset < plan.size()) {
+		if (stats.bytes >= budget) {
+			stats.over_budget += static_cast<int>(plan.size() - next_asset);
+			next_asset = plan.size();
+			return;
+		}
+
+		const auto& asset = plan[next_asset];
+
+		if (jobs_in_flight >= max_jobs_in_flight) {
+			return;
+		}
+
+#ifdef EMSCRIPTEN
+		// Only download, the assets are decoded when they are used
+		++next_asset;
+		Download(asset);
+#else
+		switch (asset.type) {
+			case Asset::Image:
+				++next_asset;
+				LoadImage(asset);
+				break;
+			case Asset::Sound:
+				++next_asset;
+				if (LoadSound(asset)) {
+					// Decoded on the main thread: Only one sample per frame
+					return;
+				}
+				break;
+			case Asset::Music:
+				// Streamed while playing, nothing to prepare
+				++next_asset;
+				break;
+		}
+#endif
+	}
+}
+
+void AssetPrefetch::Reset() {
+	if (stats.planned > 0) {
+		auto s = GetStats();
+		Output::Debug("Prefetch: {}/{} assets loaded ({:.2f} MiB, {} over budget), {} cache hits, {} misses",
+				s.loaded, s.planned, s.bytes / 1024.0 / 1024.0, s.over_budget, s.hits, s.misses);
+	}
+
+	++generation;
+	plan.clear();
+	next_asset = 0;
+	jobs_in_flight = 0;
+	prefetch_se_decodes = 0;
+	stats = {};
+	loaded_bitmaps.clear();
+	loaded_sounds.clear();
+#ifdef EMSCRIPTEN
+	downloads.clear();
+#endif
+}
+
+AssetPrefetch::Stats AssetPrefetch::GetStats() {
+	auto s = stats;
+	if (s.planned > 0) {
+		const auto& cache_stats = Cache::GetStats();
+		const auto& se_stats = AudioSeCache::GetStats();
+		s.hits = (cache_stats.hits - cache_stats_begin.hits) + (se_stats.hits - se_stats_begin.hits);
+		s.misses = (cache_stats.misses - cache_stats_begin.misses)
+			+ (se_stats.misses - se_stats_begin.misses - prefetch_se_decodes);
+	}
+	return s;
+}
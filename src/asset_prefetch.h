@@ -0,0 +1,98 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_ASSET_PREFETCH_H
+#define EP_ASSET_PREFETCH_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <lcf/rpg/fwd.h>
+
+/**
+ * AssetPrefetch loads the images and sound effects used by the events of a
+ * map in advance. This prevents stutter when they are used the first time,
+ * e.g. during cutscenes.
+ */
+namespace AssetPrefetch {
+	struct Asset {
+		enum Type {
+			Image,
+			Sound,
+			Music
+		};
+
+		Type type;
+		/** Folder of the asset (e.g. Picture) */
+		std::string directory;
+		std::string name;
+		/** Images: Decoded with a transparent color */
+		bool transparent = true;
+	};
+
+	struct Stats {
+		/** Assets referenced by the events of the map */
+		int planned = 0;
+		/** Assets loaded in advance */
+		int loaded = 0;
+		/** Assets skipped because the memory budget was exhausted */
+		int over_budget = 0;
+		/** Memory used by the loaded assets */
+		size_t bytes = 0;
+		/** Image and sound lookups served by the caches since the map was loaded */
+		int hits = 0;
+		/** Images and sounds decoded on demand since the map was loaded */
+		int misses = 0;
+	};
+
+	/**
+	 * Collects the assets used by a map in the order they are likely needed:
+	 * The graphics of all event pages, then the commands of autostart and
+	 * parallel pages and finally the commands of all other pages.
+	 * Called common events and map event pages are walked where they are called.
+	 * Pages below a page without conditions are skipped as they are never active.
+	 *
+	 * @param map map to scan
+	 * @param common_events common events of the database
+	 * @return assets in load order without duplicates
+	 */
+	std::vector<Asset> Plan(const lcf::rpg::Map& map, const std::vector<lcf::rpg::CommonEvent>& common_events);
+
+	/**
+	 * Plans the assets of a newly loaded map. They are loaded by Update().
+	 *
+	 * @param map the map
+	 */
+	void OnMapSetup(const lcf::rpg::Map& map);
+
+	/**
+	 * Loads the next planned assets until the memory budget is exhausted.
+	 * Images and sound effects are decoded by the WorkerPool, only a few at
+	 * once. Without worker threads sound effects are decoded on the main thread,
+	 * at most one per call. On Emscripten the assets are only downloaded.
+	 * Called once per frame.
+	 */
+	void Update();
+
+	/** Logs the statistics of the current map and releases the loaded assets. */
+	void Reset();
+
+	/** @return statistics of the current map */
+	Stats GetStats();
+}
+
+#endif
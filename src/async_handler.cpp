@@ -27,9 +27,11 @@
 #  include "external/picojson.h"
 #endif
 
+#include "asset_prefetch.h"
 #include "async_handler.h"
 #include "cache.h"
 #include "filefinder.h"
+#include "map_cache.h"
 #include "memory_management.h"
 #include "output.h"
 #include "player.h"
@@ -37,6 +39,7 @@
 #include "utils.h"
 #include "transition.h"
 #include "rand.h"
+#include "worker_pool.h"
 
 // When this option is enabled async requests are randomly delayed.
 // This allows testing some aspects of async file fetching locally.
@@ -162,6 +165,10 @@ void AsyncHandler::CreateRequestMapping(const std::string& file) {
 }
 
 void AsyncHandler::ClearRequests() {
+	// Pending decode jobs reference the requests
+	WorkerPool::Cancel();
+	AssetPrefetch::Reset();
+	MapCache::ResetPrefetch();
 	async_requests.clear();
 }
 
@@ -310,11 +317,29 @@ void FileRequestAsync::Start() {
 #  endif
 
 #  ifndef EP_DEBUG_SIMULATE_ASYNC
+	// Important requests hold the scene until they finish. Finishing them in a later frame
+	// depending on the decoding time would make the game logic non-deterministic.
+	if (graphic && !important && Cache::LoadBitmapAsync(directory, file, [this](BitmapRef) { DownloadDone(true); })) {
+		// Image is decoded in the background, listeners are invoked by WorkerPool::Update
+		return;
+	}
 	DownloadDone(true);
 #  endif
 #endif
 }
 
+void FileRequestAsync::SetImportantFile(bool important) {
+	this->important = important;
+
+#if !defined(EMSCRIPTEN) && !defined(EP_DEBUG_SIMULATE_ASYNC)
+	if (important && state == State_Pending) {
+		// Decoded by LoadBitmapAsync: Waiting for the worker would hold the scene for a
+		// decoding time dependent number of frames. The worker result is not needed.
+		DownloadDone(true);
+	}
+#endif
+}
+
 void FileRequestAsync::UpdateProgress() {
 #ifndef EMSCRIPTEN
 	// Fake download for testing event handlers
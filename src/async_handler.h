@@ -40,7 +40,8 @@ namespace AsyncHandler {
 
 	/**
 	 * Clears all requests. They will hit the server again.
-	 * Called after changing the language to ensure the assets are replaced.
+	 * Called after changing the language to ensure the assets are replaced
+	 * and when switching to another game. Pending decoding jobs are cancelled.
 	 */
 	void ClearRequests();
 
@@ -131,9 +132,10 @@ public:
 
 	/**
 	 * Sets the important flag.
-	 * This flag must be set before Start() is invoked.
 	 * When the important flag is set the Player update loop will block until
 	 * the request is finished.
+	 * A request that is already decoded in the background finishes immediately,
+	 * the listeners load the image on the main thread.
 	 *
 	 * @param important value of important flag.
 	 */
@@ -243,10 +245,6 @@ inline bool FileRequestAsync::IsImportantFile() const {
 	return important;
 }
 
-inline void FileRequestAsync::SetImportantFile(bool important) {
-	this->important = important;
-}
-
 inline bool FileRequestAsync::IsGraphicFile() const {
 	return graphic;
 }
@@ -19,6 +19,7 @@
 #include <cassert>
 #include <cstring>
 #include "audio_decoder_base.h"
+#include "instrumentation.h"
 #include "output.h"
 #include "system.h"
 #include "utils.h"
@@ -32,6 +33,7 @@ float AudioDecoderBase::AdjustVolume(float volume) {
 }
 
 int AudioDecoderBase::Decode(uint8_t* buffer, int length) {
+	EP_INSTRUMENT_SCOPE("AudioDecoder::Decode", length);
 	return Decode(buffer, length, 0);
 }
 
@@ -17,12 +17,14 @@
 
 #include "system.h"
 
+#include <algorithm>
 #include <cstring>
 #include <cassert>
 #include <memory>
 #include "audio_decoder_midi.h"
 #include "audio_generic.h"
 #include "audio_generic_midiout.h"
+#include "audio_mixer.h"
 #include "filefinder.h"
 #include "output.h"
 
@@ -34,6 +36,7 @@ std::vector<int16_t> GenericAudio::sample_buffer = {};
 std::vector<uint8_t> GenericAudio::scrap_buffer = {};
 unsigned GenericAudio::scrap_buffer_size = 0;
 std::vector<float> GenericAudio::mixer_buffer = {};
+std::vector<float> GenericAudio::channel_buffer = {};
 
 std::unique_ptr<GenericAudioMidiOut> GenericAudio::midi_thread;
 
@@ -246,6 +249,7 @@ bool GenericAudio::PlayOnChannel(BgmChannel& chan, Filesystem_Stream::InputStrea
 
 	chan.decoder = AudioDecoder::Create(filestream);
 	chan.midi_out_used = false;
+	chan.mix_volume = -1.0f;
 	if (chan.decoder && chan.decoder->Open(std::move(filestream))) {
 		chan.decoder->SetPitch(pitch);
 		chan.decoder->SetFormat(output_format.frequency, output_format.format, output_format.channels);
@@ -267,6 +271,7 @@ bool GenericAudio::PlayOnChannel(SeChannel& chan, std::unique_ptr<AudioSeCache>
 	chan.stopped = false; // Unstop channel so the audio thread doesn't delete it
 
 	chan.decoder = se->CreateSeDecoder();
+	chan.mix_volume = -1.0f;
 	chan.decoder->SetPitch(pitch);
 	chan.decoder->SetFormat(output_format.frequency, output_format.format, output_format.channels);
 	chan.decoder->SetVolume(volume);
@@ -284,14 +289,16 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 	if (sample_buffer.size() != (size_t)buffer_length) {
 		sample_buffer.resize(buffer_length);
 	}
-	if (mixer_buffer.size() != (size_t)buffer_length) {
-		mixer_buffer.resize(buffer_length);
+	if (mixer_buffer.size() != (size_t)(samples_per_frame * 2)) {
+		mixer_buffer.resize(samples_per_frame * 2);
 	}
 	scrap_buffer_size = samples_per_frame * output_format.channels * sizeof(uint32_t);
 	if (scrap_buffer.size() != scrap_buffer_size) {
 		scrap_buffer.resize(scrap_buffer_size);
+		// One float per byte: Enough for every sample format
+		channel_buffer.resize(scrap_buffer_size);
 	}
-	memset(mixer_buffer.data(), '\0', mixer_buffer.size());
+	std::fill(mixer_buffer.begin(), mixer_buffer.end(), 0.0f);
 
 	for (unsigned i = 0; i < nr_of_bgm_channels + nr_of_se_channels; i++) {
 		int read_bytes = 0;
@@ -300,6 +307,7 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 		int frequency = 0;
 		AudioDecoder::Format sampleformat;
 		float volume;
+		float* mix_volume = nullptr;
 
 		// Mix BGM and SE together;
 		bool is_bgm_channel = i < nr_of_bgm_channels;
@@ -315,11 +323,10 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 				} else {
 					currently_mixed_channel.decoder->Update(std::chrono::microseconds(1000 * 1000 / 60));
 					volume = current_master_volume * (currently_mixed_channel.decoder->GetVolume() / 100.0);
+					mix_volume = &currently_mixed_channel.mix_volume;
 					currently_mixed_channel.decoder->GetFormat(frequency, sampleformat, channels);
 					samplesize = AudioDecoder::GetSamplesizeForFormat(sampleformat);
 
-					total_volume += volume;
-
 					// determine how much data has to be read from this channel (but cap at the bounds of the scrap buffer)
 					unsigned bytes_to_read = (samplesize * channels * samples_per_frame);
 					bytes_to_read = (bytes_to_read < scrap_buffer_size) ? bytes_to_read : scrap_buffer_size;
@@ -348,11 +355,10 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 					currently_mixed_channel.decoder.reset();
 				} else {
 					volume = current_master_volume * (currently_mixed_channel.decoder->GetVolume() / 100.0);
+					mix_volume = &currently_mixed_channel.mix_volume;
 					currently_mixed_channel.decoder->GetFormat(frequency, sampleformat, channels);
 					samplesize = AudioDecoder::GetSamplesizeForFormat(sampleformat);
 
-					total_volume += volume;
-
 					// determine how much data has to be read from this channel (but cap at the bounds of the scrap buffer)
 					unsigned bytes_to_read = (samplesize * channels * samples_per_frame);
 					bytes_to_read = (bytes_to_read < scrap_buffer_size) ? bytes_to_read : scrap_buffer_size;
@@ -381,86 +387,20 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 		//--------------------------------------------------------------------------------------------------------------------//
 
 		if (channel_used) {
-			for (unsigned ii = 0; ii < (unsigned)(read_bytes / (samplesize * channels)); ii++) {
-
-				float vall = volume;
-				float valr = vall;
-
-				// Convert to floating point
-				switch (sampleformat) {
-					case AudioDecoder::Format::S8:
-						vall *= (((int8_t *) scrap_buffer.data())[ii * channels] / 128.0);
-						valr *= (((int8_t *) scrap_buffer.data())[ii * channels + 1] / 128.0);
-						break;
-					case AudioDecoder::Format::U8:
-						vall *= (((uint8_t *) scrap_buffer.data())[ii * channels] / 128.0 - 1.0);
-						valr *= (((uint8_t *) scrap_buffer.data())[ii * channels + 1] / 128.0 - 1.0);
-						break;
-					case AudioDecoder::Format::S16:
-						vall *= (((int16_t *) scrap_buffer.data())[ii * channels] / 32768.0);
-						valr *= (((int16_t *) scrap_buffer.data())[ii * channels + 1] / 32768.0);
-						break;
-					case AudioDecoder::Format::U16:
-						vall *= (((uint16_t *) scrap_buffer.data())[ii * channels] / 32768.0 - 1.0);
-						valr *= (((uint16_t *) scrap_buffer.data())[ii * channels + 1] / 32768.0 - 1.0);
-						break;
-					case AudioDecoder::Format::S32:
-						vall *= (((int32_t *) scrap_buffer.data())[ii * channels] / 2147483648.0);
-						valr *= (((int32_t *) scrap_buffer.data())[ii * channels + 1] / 2147483648.0);
-						break;
-					case AudioDecoder::Format::U32:
-						vall *= (((uint32_t *) scrap_buffer.data())[ii * channels] / 2147483648.0 - 1.0);
-						valr *= (((uint32_t *) scrap_buffer.data())[ii * channels + 1] / 2147483648.0 - 1.0);
-						break;
-					case AudioDecoder::Format::F32:
-						vall *= (((float *) scrap_buffer.data())[ii * channels]);
-						valr *= (((float *) scrap_buffer.data())[ii * channels + 1]);
-						break;
-				}
-
-				if (!channel_active) {
-					// first channel
-					mixer_buffer[ii * output_format.channels] = vall;
-					if (channels > 1) {
-						mixer_buffer[ii * output_format.channels + 1] = valr;
-					} else {
-						mixer_buffer[ii * output_format.channels + 1] = mixer_buffer[ii * output_format.channels];
-					}
-				} else {
-					mixer_buffer[ii * output_format.channels] += vall;
-					if (channels > 1) {
-						mixer_buffer[ii * output_format.channels + 1] += valr;
-					} else {
-						mixer_buffer[ii * output_format.channels + 1] = mixer_buffer[ii * output_format.channels];
-					}
-				}
-
-			}
+			// Ramp from the volume of the last block to prevent clicks
+			float volume_begin = *mix_volume < 0.0f ? volume : *mix_volume;
+			*mix_volume = volume;
+			total_volume += std::max(volume_begin, volume);
+
+			int frames = read_bytes / (samplesize * channels);
+			AudioMixer::ToFloat(scrap_buffer.data(), sampleformat, frames * channels, channel_buffer.data());
+			AudioMixer::Accumulate(mixer_buffer.data(), channel_buffer.data(), channels, frames, volume_begin, volume);
 			channel_active = true;
 		}
 	}
 
 	if (channel_active) {
-		if (total_volume > 1.0) {
-			float threshold = 0.8;
-			for (unsigned i = 0; i < (unsigned)(samples_per_frame * 2); i++) {
-				float sample = mixer_buffer[i];
-				float sign = (sample < 0) ? -1.0 : 1.0;
-				sample /= sign;
-				//dynamic range compression
-				if (sample > threshold) {
-					sample_buffer[i] = sign * 32768.0 * (threshold + (1.0 - threshold) * (sample - threshold) / (total_volume - threshold));
-				} else {
-					sample_buffer[i] = sign * sample * 32768.0;
-				}
-			}
-		} else {
-			//No dynamic range compression necessary
-			for (unsigned i = 0; i < (unsigned)(samples_per_frame * 2); i++) {
-				sample_buffer[i] = mixer_buffer[i] * 32768.0;
-			}
-		}
-
+		AudioMixer::ToS16(mixer_buffer.data(), samples_per_frame * 2, total_volume, sample_buffer.data());
 		memcpy(output_buffer, sample_buffer.data(), buffer_length);
 	} else {
 		memset(output_buffer, '\0', buffer_length);
@@ -72,6 +72,8 @@ private:
 		bool paused;
 		bool stopped;
 		bool midi_out_used = false;
+		/** Volume at the end of the last mixed block, negative when not mixed yet */
+		float mix_volume = -1.0f;
 		void Stop();
 		void SetPaused(bool newPaused);
 		int GetTicks() const;
@@ -85,6 +87,8 @@ private:
 		std::unique_ptr<AudioDecoderBase> decoder;
 		bool paused;
 		bool stopped;
+		/** Volume at the end of the last mixed block, negative when not mixed yet */
+		float mix_volume = -1.0f;
 	};
 	struct Format {
 		int frequency;
@@ -108,6 +112,7 @@ private:
 	static std::vector<uint8_t> scrap_buffer;
 	static unsigned scrap_buffer_size;
 	static std::vector<float> mixer_buffer;
+	static std::vector<float> channel_buffer;
 
 	static std::unique_ptr<GenericAudioMidiOut> midi_thread;
 };
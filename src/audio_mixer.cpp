@@ -0,0 +1,208 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <cstring>
+#include "audio_mixer.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define EP_MIXER_SSE2
+#  include <emmintrin.h>
+#endif
+
+namespace {
+	constexpr float s8_scale = 1.0f / 128.0f;
+	constexpr float s16_scale = 1.0f / 32768.0f;
+	constexpr float s32_scale = 1.0f / 2147483648.0f;
+
+	// Unsigned formats are converted by flipping the sign bit:
+	// (x - 128) / 128 == x / 128 - 1
+
+	void ConvertS8(const uint8_t* src, int samples, float* out, uint8_t flip) {
+		int i = 0;
+#ifdef EP_MIXER_SSE2
+		const __m128i flip_v = _mm_set1_epi8(static_cast<char>(flip));
+		const __m128 scale = _mm_set1_ps(s8_scale);
+		for (; i + 16 <= samples; i += 16) {
+			__m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), flip_v);
+			// Sign extension: Move the byte to the top and shift back
+			__m128i lo = _mm_unpacklo_epi8(v, v);
+			__m128i hi = _mm_unpackhi_epi8(v, v);
+			_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 24)), scale));
+			_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 24)), scale));
+			_mm_storeu_ps(out + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 24)), scale));
+			_mm_storeu_ps(out + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 24)), scale));
+		}
+#endif
+		for (; i < samples; ++i) {
+			out[i] = static_cast<int8_t>(src[i] ^ flip) * s8_scale;
+		}
+	}
+
+	void ConvertS16(const uint16_t* src, int samples, float* out, uint16_t flip) {
+		int i = 0;
+#ifdef EP_MIXER_SSE2
+		const __m128i flip_v = _mm_set1_epi16(static_cast<short>(flip));
+		const __m128 scale = _mm_set1_ps(s16_scale);
+		for (; i + 8 <= samples; i += 8) {
+			__m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), flip_v);
+			__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+			__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+			_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+			_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+		}
+#endif
+		for (; i < samples; ++i) {
+			out[i] = static_cast<int16_t>(src[i] ^ flip) * s16_scale;
+		}
+	}
+
+	void ConvertS32(const uint32_t* src, int samples, float* out, uint32_t flip) {
+		int i = 0;
+#ifdef EP_MIXER_SSE2
+		const __m128i flip_v = _mm_set1_epi32(static_cast<int>(flip));
+		const __m128 scale = _mm_set1_ps(s32_scale);
+		for (; i + 4 <= samples; i += 4) {
+			__m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), flip_v);
+			_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+		}
+#endif
+		for (; i < samples; ++i) {
+			out[i] = static_cast<int32_t>(src[i] ^ flip) * s32_scale;
+		}
+	}
+}
+
+void AudioMixer::ToFloat(const void* src, AudioDecoderBase::Format format, int samples, float* out) {
+	using Format = AudioDecoderBase::Format;
+
+	switch (format) {
+		case Format::S8:
+			ConvertS8(static_cast<const uint8_t*>(src), samples, out, 0);
+			break;
+		case Format::U8:
+			ConvertS8(static_cast<const uint8_t*>(src), samples, out, 0x80);
+			break;
+		case Format::S16:
+			ConvertS16(static_cast<const uint16_t*>(src), samples, out, 0);
+			break;
+		case Format::U16:
+			ConvertS16(static_cast<const uint16_t*>(src), samples, out, 0x8000);
+			break;
+		case Format::S32:
+			ConvertS32(static_cast<const uint32_t*>(src), samples, out, 0);
+			break;
+		case Format::U32:
+			ConvertS32(static_cast<const uint32_t*>(src), samples, out, 0x80000000u);
+			break;
+		case Format::F32:
+			memcpy(out, src, samples * sizeof(float));
+			break;
+	}
+}
+
+void AudioMixer::Accumulate(float* mix, const float* src, int channels, int frames, float volume_begin, float volume_end) {
+	if (frames <= 0) {
+		return;
+	}
+
+	const float step = (volume_end - volume_begin) / frames;
+	int i = 0;
+
+#ifdef EP_MIXER_SSE2
+	// Volume of frame i and i + 1, for both sides
+	__m128 volume = _mm_add_ps(_mm_set1_ps(volume_begin), _mm_set_ps(step, step, 0.0f, 0.0f));
+	if (channels == 2) {
+		const __m128 volume_step = _mm_set1_ps(2.0f * step);
+		for (; i + 2 <= frames; i += 2) {
+			__m128 s = _mm_loadu_ps(src + i * 2);
+			__m128 m = _mm_loadu_ps(mix + i * 2);
+			_mm_storeu_ps(mix + i * 2, _mm_add_ps(m, _mm_mul_ps(s, volume)));
+			volume = _mm_add_ps(volume, volume_step);
+		}
+	} else if (channels == 1) {
+		const __m128 volume_step = _mm_set1_ps(4.0f * step);
+		__m128 volume_hi = _mm_add_ps(volume, _mm_set1_ps(2.0f * step));
+		for (; i + 4 <= frames; i += 4) {
+			__m128 s = _mm_loadu_ps(src + i);
+			__m128 m_lo = _mm_loadu_ps(mix + i * 2);
+			__m128 m_hi = _mm_loadu_ps(mix + i * 2 + 4);
+			_mm_storeu_ps(mix + i * 2, _mm_add_ps(m_lo, _mm_mul_ps(_mm_unpacklo_ps(s, s), volume)));
+			_mm_storeu_ps(mix + i * 2 + 4, _mm_add_ps(m_hi, _mm_mul_ps(_mm_unpackhi_ps(s, s), volume_hi)));
+			volume = _mm_add_ps(volume, volume_step);
+			volume_hi = _mm_add_ps(volume_hi, volume_step);
+		}
+	}
+#endif
+
+	for (; i < frames; ++i) {
+		const float volume = volume_begin + step * i;
+		const float* frame = src + i * channels;
+		mix[i * 2] += frame[0] * volume;
+		mix[i * 2 + 1] += frame[channels > 1 ? 1 : 0] * volume;
+	}
+}
+
+void AudioMixer::ToS16(const float* mix, int samples, float total_volume, int16_t* out) {
+	constexpr float threshold = 0.8f;
+	const bool compress = total_volume > 1.0f;
+	// Maps samples above the threshold from [threshold, total_volume] to [threshold, 1]
+	const float ratio = compress ? (1.0f - threshold) / (total_volume - threshold) : 1.0f;
+
+	int i = 0;
+#ifdef EP_MIXER_SSE2
+	const __m128 sign_mask = _mm_set1_ps(-0.0f);
+	const __m128 threshold_v = _mm_set1_ps(threshold);
+	const __m128 ratio_v = _mm_set1_ps(ratio);
+	const __m128 scale = _mm_set1_ps(32768.0f);
+	const __m128 max = _mm_set1_ps(32767.0f);
+	const __m128 min = _mm_set1_ps(-32768.0f);
+
+	auto convert = [&](__m128 v) {
+		if (compress) {
+			// Dynamic range compression
+			__m128 sign = _mm_and_ps(v, sign_mask);
+			__m128 abs = _mm_andnot_ps(sign_mask, v);
+			__m128 compressed = _mm_add_ps(threshold_v, _mm_mul_ps(_mm_sub_ps(abs, threshold_v), ratio_v));
+			__m128 above = _mm_cmpgt_ps(abs, threshold_v);
+			abs = _mm_or_ps(_mm_and_ps(above, compressed), _mm_andnot_ps(above, abs));
+			v = _mm_or_ps(abs, sign);
+		}
+		v = _mm_min_ps(_mm_max_ps(_mm_mul_ps(v, scale), min), max);
+		return _mm_cvttps_epi32(v);
+	};
+
+	for (; i + 8 <= samples; i += 8) {
+		__m128i lo = convert(_mm_loadu_ps(mix + i));
+		__m128i hi = convert(_mm_loadu_ps(mix + i + 4));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(lo, hi));
+	}
+#endif
+
+	for (; i < samples; ++i) {
+		float sample = mix[i];
+		if (compress) {
+			float abs = sample < 0 ? -sample : sample;
+			if (abs > threshold) {
+				abs = threshold + (abs - threshold) * ratio;
+				sample = sample < 0 ? -abs : abs;
+			}
+		}
+		out[i] = static_cast<int16_t>(std::min(std::max(sample * 32768.0f, -32768.0f), 32767.0f));
+	}
+}
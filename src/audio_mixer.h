@@ -0,0 +1,67 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_AUDIO_MIXER_H
+#define EP_AUDIO_MIXER_H
+
+#include <cstdint>
+#include "audio_decoder_base.h"
+
+/**
+ * Building blocks of the software mixer of GenericAudio.
+ * A block of every channel is converted to float, accumulated into a
+ * stereo float buffer and the mix is converted to S16 once at the end.
+ * Uses SSE2 when available.
+ */
+namespace AudioMixer {
+	/**
+	 * Converts interleaved samples to float in the range [-1, 1].
+	 *
+	 * @param src samples in the given format
+	 * @param format sample format
+	 * @param samples number of samples (frames * channels)
+	 * @param out receives the converted samples
+	 */
+	void ToFloat(const void* src, AudioDecoderBase::Format format, int samples, float* out);
+
+	/**
+	 * Adds a channel to a stereo mix. The volume changes linearly from
+	 * volume_begin to volume_end over the block to prevent clicks on fades.
+	 * Mono channels are added to both sides, further channels are ignored.
+	 *
+	 * @param mix interleaved stereo mix buffer
+	 * @param src interleaved float samples
+	 * @param channels number of channels of src
+	 * @param frames number of frames of src
+	 * @param volume_begin volume of the first frame
+	 * @param volume_end volume after the last frame
+	 */
+	void Accumulate(float* mix, const float* src, int channels, int frames, float volume_begin, float volume_end);
+
+	/**
+	 * Converts the mix to S16 samples. When the summed channel volume is
+	 * above 1 loud samples are compressed to reduce clipping.
+	 *
+	 * @param mix mixed samples
+	 * @param samples number of samples
+	 * @param total_volume sum of the volumes of the mixed channels
+	 * @param out receives the S16 samples
+	 */
+	void ToS16(const float* mix, int samples, float total_volume, int16_t* out);
+}
+
+#endif
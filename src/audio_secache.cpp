@@ -25,7 +25,9 @@
 #include "audio_secache.h"
 #include "game_clock.h"
 #include "filefinder.h"
+#include "instrumentation.h"
 #include "output.h"
+#include "worker_pool.h"
 
 using namespace std::chrono_literals;
 
@@ -37,6 +39,11 @@ namespace {
 	constexpr int cache_limit = 3 * 1024 * 1024;
 	int cache_size = 0;
 
+	AudioSeCache::Stats stats;
+
+	// Incremented by Clear, decoding jobs started before are not cached
+	int clear_count = 0;
+
 	void FreeCacheMemory() {
 		auto cur_time = Game_Clock::GetFrameTime();
 
@@ -138,6 +145,7 @@ std::unique_ptr<AudioDecoderBase> AudioSeCache::CreateSeDecoder() {
 
 	auto it = cache.find(name);
 	if (it != cache.end()) {
+		++stats.hits;
 		se = it->second;
 		se->last_access = Game_Clock::GetFrameTime();
 
@@ -151,6 +159,7 @@ std::unique_ptr<AudioDecoderBase> AudioSeCache::CreateSeDecoder() {
 	}
 
 	// Not cached yet: Decode the sample without any resampling
+	++stats.misses;
 
 	if (!se) {
 		se.reset(new AudioSeData());
@@ -180,6 +189,54 @@ std::unique_ptr<AudioDecoderBase> AudioSeCache::CreateSeDecoder() {
 	return dec;
 }
 
+bool AudioSeCache::LoadAsync(Filesystem_Stream::InputStream stream, StringView name, std::function<void(AudioSeRef)> on_loaded) {
+	if (!WorkerPool::IsEnabled() || !stream || cache.find(ToString(name)) != cache.end()) {
+		return false;
+	}
+
+	// The MIDI synthesizers are shared and not thread-safe
+	char magic[4] = { 0 };
+	if (!stream.ReadIntoObj(magic) || !strncmp(magic, "MThd", 4)) {
+		return false;
+	}
+	stream.seekg(0, std::ios::beg);
+
+	// Opening only parses the header, the decoding happens in the worker
+	std::shared_ptr<AudioDecoderBase> decoder = AudioDecoder::Create(stream, false);
+	if (!decoder || !decoder->Open(std::move(stream))) {
+		return false;
+	}
+
+	auto se = std::make_shared<AudioSeData>();
+	decoder->GetFormat(se->frequency, se->format, se->channels);
+
+	WorkerPool::Submit([decoder, se]() {
+		EP_INSTRUMENT_SCOPE("AudioSeCache::DecodeSe");
+		se->buffer = decoder->DecodeAll();
+	}, [name = ToString(name), se, on_loaded = std::move(on_loaded), generation = clear_count]() {
+		if (generation != clear_count) {
+			on_loaded({});
+			return;
+		}
+
+		auto it = cache.find(name);
+		if (it != cache.end()) {
+			// Decoded meanwhile on the main thread
+			on_loaded(it->second);
+			return;
+		}
+
+		se->last_access = Game_Clock::GetFrameTime();
+		cache.insert(std::make_pair(name, se));
+		cache_size += se->buffer.size();
+		FreeCacheMemory();
+
+		on_loaded(se);
+	});
+
+	return true;
+}
+
 AudioSeRef AudioSeCache::GetSeData() const {
 	auto it = cache.find(name);
 	assert(it != cache.end());
@@ -190,6 +247,13 @@ AudioSeRef AudioSeCache::GetSeData() const {
 void AudioSeCache::Clear() {
 	cache_size = 0;
 	cache.clear();
+	++clear_count;
+}
+
+const AudioSeCache::Stats& AudioSeCache::GetStats() {
+	stats.entries = static_cast<int>(cache.size());
+	stats.bytes = cache_size;
+	return stats;
 }
 
 StringView AudioSeCache::GetName() const {
@@ -20,6 +20,7 @@
 
 // Headers
 #include <cstdio>
+#include <functional>
 #include <string>
 #include <vector>
 #include <memory>
@@ -125,6 +126,18 @@ public:
 	 */
 	std::unique_ptr<AudioDecoderBase> CreateSeDecoder();
 
+	/**
+	 * Decodes a sample on a worker thread and caches it.
+	 *
+	 * @param stream Stream to the audio file
+	 * @param name Name for the cache entry
+	 * @param on_loaded invoked on the main thread with the cached sample, or nullptr
+	 *   when the cache was cleared while decoding
+	 * @return false when nothing was queued: the sample is cached already, invalid, a MIDI
+	 *   file or background decoding is not supported. on_loaded is not invoked.
+	 */
+	static bool LoadAsync(Filesystem_Stream::InputStream stream, StringView name, std::function<void(AudioSeRef)> on_loaded);
+
 	/**
 	 * Returns the SE sample data handled by this SeCache.
 	 *
@@ -138,6 +151,21 @@ public:
 	StringView GetName() const;
 
 	static void Clear();
+
+	/** Lookup statistics of the SE cache */
+	struct Stats {
+		/** Decoders created from cached samples */
+		int hits = 0;
+		/** Samples decoded on the main thread because they were not cached */
+		int misses = 0;
+		/** Number of cached samples */
+		int entries = 0;
+		/** Memory used by the cached samples */
+		size_t bytes = 0;
+	};
+
+	/** @return lookup statistics since startup and the current cache size */
+	static const Stats& GetStats();
 private:
 	std::unique_ptr<AudioDecoderBase> audio_decoder;
 
@@ -26,6 +26,7 @@
 #include <lcf/reader_util.h>
 #include "output.h"
 #include "drawable_mgr.h"
+#include "damage_tracker.h"
 #include "game_screen.h"
 
 Background::Background(const std::string& name) : Drawable(Priority_Background)
@@ -114,7 +115,26 @@ int Background::Scale(int x) {
 	return x > 0 ? x / 64 : -(-x / 64);
 }
 
+bool Background::GetDrawState(const Bitmap& dst, DrawState& state) const {
+	state.bounds = dst.GetRect();
+	state.hash = DrawHash()
+		.Add(bg_bitmap).Add(Scale(bg_x)).Add(Scale(bg_y))
+		.Add(fg_bitmap).Add(Scale(fg_x)).Add(Scale(fg_y))
+		.Add(Main_Data::game_screen->GetShakeOffsetX()).Add(Main_Data::game_screen->GetShakeOffsetY())
+		.Add(tone_effect)
+		.Get();
+	return true;
+}
+
 void Background::Draw(Bitmap& dst) {
+	Background::DrawClipped(dst, dst.GetRect());
+}
+
+bool Background::PrepareDraw(const Bitmap&) {
+	return true;
+}
+
+void Background::DrawClipped(Bitmap& dst, const Rect&) const {
 	Rect dst_rect = dst.GetRect();
 
 	dst_rect.x += Main_Data::game_screen->GetShakeOffsetX();
@@ -31,6 +31,10 @@ public:
 	Background(int terrain_id);
 
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "Background"; }
+	bool GetDrawState(const Bitmap& dst, DrawState& state) const override;
+	bool PrepareDraw(const Bitmap& dst) override;
+	void DrawClipped(Bitmap& dst, const Rect& clip) const override;
 	void Update();
 	Tone GetTone() const;
 	void SetTone(Tone tone);
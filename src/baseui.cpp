@@ -66,6 +66,20 @@ void BaseUi::CleanDisplay() {
 	main_surface->Clear();
 }
 
+void BaseUi::SetDisplayDamage(const Rect& rect) {
+	display_damage = rect;
+	has_display_damage = true;
+}
+
+Rect BaseUi::TakeDisplayDamage() {
+	if (!has_display_damage) {
+		return main_surface->GetRect();
+	}
+
+	has_display_damage = false;
+	return display_damage;
+}
+
 std::string BaseUi::getClipboardText() {
 	return "";
 }
@@ -80,6 +80,15 @@ public:
 	 */
 	virtual void UpdateDisplay() = 0;
 
+	/**
+	 * Sets the area of the display surface that changed since the last
+	 * UpdateDisplay call. Only applies to the next UpdateDisplay call,
+	 * without it the whole surface is considered changed.
+	 *
+	 * @param rect changed area, can be empty
+	 */
+	void SetDisplayDamage(const Rect& rect);
+
 	/**
 	 * Gets a copy of the display surface.
 	 *
@@ -187,6 +196,12 @@ public:
 	/** Toggle whether we should show fps */
 	void ToggleShowFps();
 
+	/** @return true if we should render the frame time graph to the screen */
+	bool RenderFrameStats() const;
+
+	/** Toggle whether we should show the frame time graph */
+	void ToggleShowFrameStats();
+
 	/**
 	 * @return the minimum amount of time each physical frame should take.
 	 * If the UI manages time (i.e.) vsync, will return a 0 duration.
@@ -202,6 +217,14 @@ protected:
 	void SetFrameRateSynchronized(bool value);
 	void SetIsFullscreen(bool value);
 
+	/**
+	 * Returns the area passed to SetDisplayDamage and resets it to the
+	 * whole display surface.
+	 *
+	 * @return changed area of the display surface
+	 */
+	Rect TakeDisplayDamage();
+
 	/**
 	 * Display mode data struct.
 	 */
@@ -223,6 +246,10 @@ protected:
 	/** Surface used for zoom. */
 	BitmapRef main_surface;
 
+	/** Changed area of main_surface, see SetDisplayDamage */
+	Rect display_damage;
+	bool has_display_damage = false;
+
 	/** Mouse position on screen relative to the window. */
 	Point mouse_pos;
 
@@ -256,6 +283,9 @@ protected:
 	/** If we will render fps on the screen even in windowed mode */
 	bool fps_render_window = false;
 
+	/** Whether we will show the frame time graph on the screen */
+	bool show_frame_stats = false;
+
 	/** How to scale the viewport when larger than 320x240 */
 	ScalingMode scaling_mode = ScalingMode::Bilinear;
 };
@@ -323,6 +353,14 @@ inline void BaseUi::ToggleShowFps() {
 	show_fps = !show_fps;
 }
 
+inline bool BaseUi::RenderFrameStats() const {
+	return show_frame_stats;
+}
+
+inline void BaseUi::ToggleShowFrameStats() {
+	show_frame_stats = !show_frame_stats;
+}
+
 inline Game_Clock::duration BaseUi::GetFrameLimit() const {
 	return IsFrameRateSynchronized() ? Game_Clock::duration(0) : frame_limit;
 }
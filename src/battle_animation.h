@@ -34,6 +34,10 @@ struct FileRequestResult;
 
 class BattleAnimation : public Sprite {
 public:
+	/** Drawn by the subclasses, not tracked by the damage tracker and not drawn in bands */
+	bool GetDrawState(const Bitmap&, DrawState&) const override { return false; }
+	bool PrepareDraw(const Bitmap&) override { return false; }
+
 	/** Update the animation to the next animation **/
 	void Update();
 
@@ -109,6 +113,7 @@ class BattleAnimationMap : public BattleAnimation {
 public:
 	BattleAnimationMap(const lcf::rpg::Animation& anim, Game_Character& target, bool global);
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "BattleAnimationMap"; }
 protected:
 	void FlashTargets(int r, int g, int b, int p) override;
 	void ShakeTargets(int str, int spd, int time) override;
@@ -124,6 +129,7 @@ class BattleAnimationBattle : public BattleAnimation {
 public:
 	BattleAnimationBattle(const lcf::rpg::Animation& anim, std::vector<Game_Battler*> battlers, bool only_sound = false, int cutoff_frame = -1, bool set_invert = false);
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "BattleAnimationBattle"; }
 protected:
 	void FlashTargets(int r, int g, int b, int p) override;
 	void ShakeTargets(int str, int spd, int time) override;
@@ -134,6 +140,7 @@ class BattleAnimationBattler : public BattleAnimation {
 public:
 	BattleAnimationBattler(const lcf::rpg::Animation& anim, std::vector<Game_Battler*> battlers, bool only_sound = false, int cutoff_frame = -1, bool set_invert = false);
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "BattleAnimationBattler"; }
 protected:
 	void FlashTargets(int r, int g, int b, int p) override;
 	void ShakeTargets(int str, int spd, int time) override;
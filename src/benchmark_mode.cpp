@@ -0,0 +1,115 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <sstream>
+#include "benchmark_mode.h"
+#include "game_actor.h"
+#include "game_party.h"
+#include "game_player.h"
+#include "game_switches.h"
+#include "game_system.h"
+#include "game_variables.h"
+#include "main_data.h"
+#include "output.h"
+#include "player.h"
+#include "utils.h"
+
+namespace {
+	std::vector<Game_Clock::duration> update_times;
+	std::vector<Game_Clock::duration> draw_times;
+
+	double ToMs(Game_Clock::duration d) {
+		return std::chrono::duration<double, std::milli>(d).count();
+	}
+
+	void PrintStats(const char* name, std::vector<Game_Clock::duration>& samples) {
+		auto stats = BenchmarkMode::CalculateStats(samples);
+		Output::Info("Benchmark: {:6} min {:.3f}ms median {:.3f}ms p99 {:.3f}ms max {:.3f}ms",
+			name, ToMs(stats.min), ToMs(stats.median), ToMs(stats.p99), ToMs(stats.max));
+	}
+}
+
+BenchmarkMode::Stats BenchmarkMode::CalculateStats(std::vector<Game_Clock::duration>& samples) {
+	Stats stats;
+	if (samples.empty()) {
+		return stats;
+	}
+
+	// Nearest rank percentiles
+	auto nth = [&](size_t n) {
+		std::nth_element(samples.begin(), samples.begin() + n, samples.end());
+		return samples[n];
+	};
+	const size_t size = samples.size();
+	stats.min = *std::min_element(samples.begin(), samples.end());
+	stats.max = *std::max_element(samples.begin(), samples.end());
+	stats.median = nth((size - 1) / 2);
+	stats.p99 = nth((size * 99 + 99) / 100 - 1);
+	return stats;
+}
+
+void BenchmarkMode::AddFrame(Game_Clock::duration update, Game_Clock::duration draw) {
+	update_times.push_back(update);
+	draw_times.push_back(draw);
+}
+
+int BenchmarkMode::GetFrameCount() {
+	return static_cast<int>(update_times.size());
+}
+
+uint32_t BenchmarkMode::GetStateHash() {
+	std::stringstream ss;
+	ss << Player::GetFrames() << '\n';
+
+	if (Main_Data::game_system) {
+		ss << Main_Data::game_system->GetFrameCounter() << '\n';
+	}
+	if (Main_Data::game_switches) {
+		for (bool s: Main_Data::game_switches->GetData()) {
+			ss << (s ? '1' : '0');
+		}
+		ss << '\n';
+	}
+	if (Main_Data::game_variables) {
+		for (auto v: Main_Data::game_variables->GetData()) {
+			ss << v << ',';
+		}
+		ss << '\n';
+	}
+	if (Main_Data::game_party) {
+		ss << Main_Data::game_party->GetGold() << '\n';
+		for (auto* actor: Main_Data::game_party->GetActors()) {
+			ss << actor->GetId() << ' ' << actor->GetLevel() << ' ' << actor->GetExp() << ' '
+				<< actor->GetHp() << ' ' << actor->GetSp() << '\n';
+		}
+	}
+	if (Main_Data::game_player) {
+		const auto& player = *Main_Data::game_player;
+		ss << player.GetMapId() << ' ' << player.GetX() << ' ' << player.GetY() << ' ' << player.GetDirection() << '\n';
+	}
+
+	return Utils::CRC32(ss);
+}
+
+void BenchmarkMode::PrintReport() {
+	Output::Info("Benchmark: {} frames", GetFrameCount());
+	PrintStats("update", update_times);
+	PrintStats("draw", draw_times);
+	Output::Info("Benchmark: state hash {:#010x}", GetStateHash());
+}
@@ -0,0 +1,72 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_BENCHMARK_MODE_H
+#define EP_BENCHMARK_MODE_H
+
+// Headers
+#include <cstdint>
+#include <vector>
+#include "game_clock.h"
+
+/**
+ * Headless benchmark mode (--benchmark).
+ *
+ * The Player replays an input log without display and audio output and
+ * records how long the logic update and the drawing of every frame took.
+ */
+namespace BenchmarkMode {
+	/** Summary of the frame timings */
+	struct Stats {
+		Game_Clock::duration min = {};
+		Game_Clock::duration median = {};
+		Game_Clock::duration p99 = {};
+		Game_Clock::duration max = {};
+	};
+
+	/**
+	 * Calculates the summary of timing samples.
+	 *
+	 * @param samples timings, reordered by the function
+	 * @return summary, all zero when there are no samples
+	 */
+	Stats CalculateStats(std::vector<Game_Clock::duration>& samples);
+
+	/**
+	 * Records the timings of one frame.
+	 *
+	 * @param update time spent on the logic updates
+	 * @param draw time spent on drawing
+	 */
+	void AddFrame(Game_Clock::duration update, Game_Clock::duration draw);
+
+	/** @return number of recorded frames */
+	int GetFrameCount();
+
+	/**
+	 * Calculates a hash over the game state (switches, variables, party and
+	 * player position). Identical runs of the same input log have the same hash.
+	 *
+	 * @return CRC32 of the game state
+	 */
+	uint32_t GetStateHash();
+
+	/** Prints the frame timings and the state hash */
+	void PrintReport();
+}
+
+#endif
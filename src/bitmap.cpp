@@ -20,6 +20,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <unordered_map>
 
@@ -37,7 +38,7 @@
 #include "font.h"
 #include "output.h"
 #include "util_macro.h"
-#include "bitmap_hslrgb.h"
+#include "bitmap_kernels.h"
 #include <iostream>
 
 BitmapRef Bitmap::Create(int width, int height, const Color& color) {
@@ -107,14 +108,20 @@ Bitmap::Bitmap(Filesystem_Stream::InputStream stream, bool transparent, uint32_t
 	size_t bytes = stream.read(reinterpret_cast<char*>(data),  4).gcount();
 	stream.seekg(0, std::ios::ios_base::beg);
 
+	// Decode memory backed (e.g. memory mapped) files directly without copying
+	auto buffer = stream.GetBuffer();
+
 	bool img_okay = false;
 
 	if (bytes >= 4 && strncmp((char*)data, "XYZ1", 4) == 0)
-		img_okay = ImageXYZ::ReadXYZ(stream, transparent, w, h, pixels);
+		img_okay = buffer.empty() ? ImageXYZ::ReadXYZ(stream, transparent, w, h, pixels) :
+			ImageXYZ::ReadXYZ(buffer.data(), buffer.size(), transparent, w, h, pixels);
 	else if (bytes > 2 && strncmp((char*)data, "BM", 2) == 0)
-		img_okay = ImageBMP::ReadBMP(stream, transparent, w, h, pixels);
+		img_okay = buffer.empty() ? ImageBMP::ReadBMP(stream, transparent, w, h, pixels) :
+			ImageBMP::ReadBMP(buffer.data(), buffer.size(), transparent, w, h, pixels);
 	else if (bytes >= 4 && strncmp((char*)(data + 1), "PNG", 3) == 0)
-		img_okay = ImagePNG::ReadPNG(stream, transparent, w, h, pixels);
+		img_okay = buffer.empty() ? ImagePNG::ReadPNG(stream, transparent, w, h, pixels) :
+			ImagePNG::ReadPNG(buffer.data(), buffer.size(), transparent, w, h, pixels);
 	else
 		Output::Warning("Unsupported image file {} (Magic: {:02X})", stream.GetName(), *reinterpret_cast<uint32_t*>(data));
 
@@ -147,7 +154,7 @@ Bitmap::Bitmap(const uint8_t* data, unsigned bytes, bool transparent, uint32_t f
 	else if (bytes > 2 && strncmp((char*) data, "BM", 2) == 0)
 		img_okay = ImageBMP::ReadBMP(data, bytes, transparent, w, h, pixels);
 	else if (bytes > 4 && strncmp((char*)(data + 1), "PNG", 3) == 0)
-		img_okay = ImagePNG::ReadPNG((const void*) data, transparent, w, h, pixels);
+		img_okay = ImagePNG::ReadPNG(data, bytes, transparent, w, h, pixels);
 	else
 		Output::Warning("Unsupported image (Magic: {:02X})", bytes >= 4 ? *reinterpret_cast<const uint32_t*>(data) : 0);
 
@@ -300,21 +307,13 @@ void Bitmap::HueChangeBlit(int x, int y, Bitmap const& src, Rect const& src_rect
 		hue -= (hue / 0x600) * 0x600;
 
 	DynamicFormat format(32,8,24,8,16,8,8,8,0,PF::Alpha);
-	std::vector<uint32_t> pixels;
+	// Reused to avoid an allocation per call, per thread because bands are drawn in parallel
+	static thread_local std::vector<uint32_t> pixels;
 	pixels.resize(src_rect.width * src_rect.height);
 	Bitmap bmp(reinterpret_cast<void*>(&pixels.front()), src_rect.width, src_rect.height, src_rect.width * 4, format);
 	bmp.Blit(0, 0, src, src_rect, Opacity::Opaque());
 
-	for (std::vector<uint32_t>::iterator p = pixels.begin(); p != pixels.end(); ++p) {
-		uint32_t pixel = *p;
-		uint8_t r = (pixel>>24) & 0xFF;
-		uint8_t g = (pixel>>16) & 0xFF;
-		uint8_t b = (pixel>> 8) & 0xFF;
-		uint8_t a = pixel & 0xFF;
-		if (a > 0)
-			RGB_adjust_HSL(r, g, b, hue);
-		*p = ((uint32_t) r << 24) | ((uint32_t) g << 16) | ((uint32_t) b << 8) | (uint32_t) a;
-	}
+	BitmapKernels::HueRow(pixels.data(), static_cast<int>(pixels.size()), hue);
 
 	Blit(dst_rect.x, dst_rect.y, bmp, bmp.GetRect(), Opacity::Opaque());
 }
@@ -476,17 +475,17 @@ static void destroy_func(pixman_image_t * /* image */, void *data) {
 	free(data);
 }
 
-static pixman_indexed_t palette;
-static bool palette_initialized = false;
-
-static void initialize_palette() {
-	if (palette_initialized)
-		return;
-	palette.color = false;
-	palette.rgba[0] = 0U;
-	for (int i = 1; i < PIXMAN_MAX_INDEXED; i++)
-		palette.rgba[i] = ~0U;
-	palette_initialized = true;
+// Bitmaps are also created by worker threads, the static initialization is thread-safe
+static pixman_indexed_t* GetPalette() {
+	static pixman_indexed_t palette = []() {
+		pixman_indexed_t p = {};
+		p.color = false;
+		p.rgba[0] = 0U;
+		for (int i = 1; i < PIXMAN_MAX_INDEXED; i++)
+			p.rgba[i] = ~0U;
+		return p;
+	}();
+	return &palette;
 }
 
 void Bitmap::Init(int width, int height, void* data, int pitch, bool destroy) {
@@ -500,12 +499,13 @@ void Bitmap::Init(int width, int height, void* data, int pitch, bool destroy) {
 	}
 
 	if (format.bits == 8) {
-		initialize_palette();
-		pixman_image_set_indexed(bitmap.get(), &palette);
+		pixman_image_set_indexed(bitmap.get(), GetPalette());
 	}
 
 	if (data != NULL && destroy)
 		pixman_image_set_destroy_function(bitmap.get(), destroy_func, data);
+
+	MarkModified();
 }
 
 void Bitmap::ConvertImage(int& width, int& height, void*& pixels, bool transparent) {
@@ -534,6 +534,9 @@ void* Bitmap::pixels() {
 		return nullptr;
 	}
 
+	// The caller can write to the pixels
+	MarkModified();
+
 	return (void*) pixman_image_get_data(bitmap.get());
 }
 void const* Bitmap::pixels() const {
@@ -556,6 +559,45 @@ int Bitmap::pitch() const {
 	return pixman_image_get_stride(bitmap.get());
 }
 
+static std::atomic<uint64_t> next_revision{0};
+
+void Bitmap::MarkModified() {
+	revision = ++next_revision;
+}
+
+void Bitmap::SetClipRects(const std::vector<Rect>& rects) {
+	clip_rects.clear();
+
+	if (rects.empty()) {
+		pixman_image_set_clip_region32(bitmap.get(), nullptr);
+		return;
+	}
+
+	std::vector<pixman_box32_t> boxes;
+	boxes.reserve(rects.size());
+	for (const auto& rect : rects) {
+		boxes.push_back({ rect.x, rect.y, rect.x + rect.width, rect.y + rect.height });
+	}
+
+	pixman_region32_t region;
+	pixman_region32_init_rects(&region, boxes.data(), static_cast<int>(boxes.size()));
+
+	// The region consists of disjoint boxes, in place operations rely on this
+	int num_rects = 0;
+	const auto* region_rects = pixman_region32_rectangles(&region, &num_rects);
+	for (int i = 0; i < num_rects; ++i) {
+		const auto& box = region_rects[i];
+		clip_rects.emplace_back(box.x1, box.y1, box.x2 - box.x1, box.y2 - box.y1);
+	}
+	if (clip_rects.empty()) {
+		// Everything is clipped
+		clip_rects.emplace_back();
+	}
+
+	pixman_image_set_clip_region32(bitmap.get(), &region);
+	pixman_region32_fini(&region);
+}
+
 namespace {
 	PixmanImagePtr CreateMask(Opacity const& opacity, Rect const& src_rect, Transform const* pxform = nullptr) {
 		if (opacity.IsOpaque()) {
@@ -585,10 +627,20 @@ namespace {
 } // anonymous namespace
 
 void Bitmap::Blit(int x, int y, Bitmap const& src, Rect const& src_rect, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
+	MarkModified();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
 
+	if (!opacity.IsSplit() && (blend_mode == BlendMode::Default || blend_mode == BlendMode::Normal)) {
+		const int value = std::min(opacity.Value(), 255);
+		const auto op = value < 255 ? PIXMAN_OP_OVER : src.GetOperator(nullptr, blend_mode);
+		if (BlitKernel(x, y, src, src_rect, op, value)) {
+			return;
+		}
+	}
+
 	auto mask = CreateMask(opacity, src_rect);
 
 	pixman_image_composite32(src.GetOperator(mask.get(), blend_mode),
@@ -600,11 +652,80 @@ void Bitmap::Blit(int x, int y, Bitmap const& src, Rect const& src_rect, Opacity
 							 src_rect.width, src_rect.height);
 }
 
+bool Bitmap::BlitKernel(int x, int y, Bitmap const& src, Rect const& src_rect, pixman_op_t op, int opacity) {
+	using BlitOp = BitmapKernels::BlitOp;
+
+	// Blends of large images are faster with the vectorized pixman code
+	constexpr int max_blend_area = 64 * 64;
+
+	if (!BitmapKernels::IsBlitEnabled() || &src == this || src.pixman_format != pixman_format ||
+			format.bits != 32 || format.a.bits != 8 || (format.a.shift != 0 && format.a.shift != 24)) {
+		return false;
+	}
+
+	// Outside of the source pixman reads transparent pixels
+	if (src_rect.IsEmpty() || src_rect.x < 0 || src_rect.y < 0 ||
+			src_rect.x + src_rect.width > src.width() || src_rect.y + src_rect.height > src.height()) {
+		return false;
+	}
+
+	BlitOp kernel;
+	if (op == PIXMAN_OP_SRC && opacity == 255) {
+		kernel = BlitOp::Copy;
+	} else if (op == PIXMAN_OP_OVER && src_rect.width * src_rect.height <= max_blend_area) {
+		if (opacity < 255) {
+			kernel = BlitOp::OverOpacity;
+		} else if (src.GetImageOpacity() == ImageOpacity::Alpha_1Bit) {
+			kernel = BlitOp::Over1Bit;
+		} else {
+			kernel = BlitOp::Over;
+		}
+	} else {
+		return false;
+	}
+
+	Rect dst_rect(x, y, src_rect.width, src_rect.height);
+	dst_rect.Adjust(GetRect());
+
+	auto* dst_pixels = reinterpret_cast<uint8_t*>(pixman_image_get_data(bitmap.get()));
+	auto* src_pixels = reinterpret_cast<const uint8_t*>(src.pixels());
+	const int dst_pitch = pitch();
+	const int src_pitch = src.pitch();
+
+	auto blit = [&](Rect rect) {
+		rect.Adjust(dst_rect);
+		if (rect.IsEmpty()) {
+			return;
+		}
+		const int sx = src_rect.x + rect.x - x;
+		const int sy = src_rect.y + rect.y - y;
+		BitmapKernels::BlitRect(kernel,
+				reinterpret_cast<uint32_t*>(dst_pixels + rect.y * dst_pitch + rect.x * 4), dst_pitch,
+				reinterpret_cast<const uint32_t*>(src_pixels + sy * src_pitch + sx * 4), src_pitch,
+				rect.width, rect.height, format.a.shift, opacity);
+	};
+
+	if (clip_rects.empty()) {
+		blit(dst_rect);
+	} else {
+		for (const auto& clip: clip_rects) {
+			blit(clip);
+		}
+	}
+	return true;
+}
+
 void Bitmap::BlitFast(int x, int y, Bitmap const & src, Rect const & src_rect, Opacity const & opacity) {
+	MarkModified();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
 
+	if (BlitKernel(x, y, src, src_rect, PIXMAN_OP_SRC, 255)) {
+		return;
+	}
+
 	pixman_image_composite32(PIXMAN_OP_SRC,
 		src.bitmap.get(),
 		nullptr, bitmap.get(),
@@ -616,8 +737,12 @@ void Bitmap::BlitFast(int x, int y, Bitmap const & src, Rect const & src_rect, O
 
 PixmanImagePtr Bitmap::GetSubimage(Bitmap const& src, const Rect& src_rect) {
 	uint8_t* pixels = (uint8_t*) src.pixels() + src_rect.x * src.bpp() + src_rect.y * src.pitch();
-	return PixmanImagePtr{ pixman_image_create_bits(src.pixman_format, src_rect.width, src_rect.height,
+	auto img = PixmanImagePtr{ pixman_image_create_bits(src.pixman_format, src_rect.width, src_rect.height,
 									(uint32_t*) pixels, src.pitch()) };
+	if (src.bpp() == 1) {
+		pixman_image_set_indexed(img.get(), GetPalette());
+	}
+	return img;
 }
 
 void Bitmap::TiledBlit(Rect const& src_rect, Bitmap const& src, Rect const& dst_rect, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
@@ -625,6 +750,8 @@ void Bitmap::TiledBlit(Rect const& src_rect, Bitmap const& src, Rect const& dst_
 }
 
 void Bitmap::TiledBlit(int ox, int oy, Rect const& src_rect, Bitmap const& src, Rect const& dst_rect, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
+	MarkModified();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
@@ -653,6 +780,8 @@ void Bitmap::StretchBlit(Bitmap const&  src, Rect const& src_rect, Opacity const
 }
 
 void Bitmap::StretchBlit(Rect const& dst_rect, Bitmap const& src, Rect const& src_rect, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
+	MarkModified();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
@@ -662,28 +791,31 @@ void Bitmap::StretchBlit(Rect const& dst_rect, Bitmap const& src, Rect const& sr
 
 	Transform xform = Transform::Scale(zoom_x, zoom_y);
 
-	pixman_image_set_transform(src.bitmap.get(), &xform.matrix);
+	// The transform is set on a private view of the pixels: the source may be drawn by several threads
+	auto src_img = GetSubimage(src, src.GetRect());
+	pixman_image_set_transform(src_img.get(), &xform.matrix);
 
 	auto mask = CreateMask(opacity, src_rect, &xform);
 
 	pixman_image_composite32(src.GetOperator(mask.get(), blend_mode),
-							 src.bitmap.get(), mask.get(), bitmap.get(),
+							 src_img.get(), mask.get(), bitmap.get(),
 							 src_rect.x / zoom_x, src_rect.y / zoom_y,
 							 0, 0,
 							 dst_rect.x, dst_rect.y,
 							 dst_rect.width, dst_rect.height);
-
-	pixman_image_set_transform(src.bitmap.get(), nullptr);
 }
 
 void Bitmap::WaverBlit(int x, int y, double zoom_x, double zoom_y, Bitmap const& src, Rect const& src_rect, int depth, double phase, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
+	MarkModified();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
 
 	Transform xform = Transform::Scale(1.0 / zoom_x, 1.0 / zoom_y);
 
-	pixman_image_set_transform(src.bitmap.get(), &xform.matrix);
+	auto src_img = GetSubimage(src, src.GetRect());
+	pixman_image_set_transform(src_img.get(), &xform.matrix);
 
 	auto mask = CreateMask(opacity, src_rect, &xform);
 
@@ -702,14 +834,12 @@ void Bitmap::WaverBlit(int x, int y, double zoom_x, double zoom_y, Bitmap const&
 		const int offset = 2 * zoom_x * depth * std::sin(phase + sy);
 
 		pixman_image_composite32(src.GetOperator(mask.get(), blend_mode),
-								 src.bitmap.get(), mask.get(), bitmap.get(),
+								 src_img.get(), mask.get(), bitmap.get(),
 								 xoff, yoff + i,
 								 0, i,
 								 x + offset, dy,
 								 width, 1);
 	}
-
-	pixman_image_set_transform(src.bitmap.get(), nullptr);
 }
 
 static pixman_color_t PixmanColor(const Color &color) {
@@ -722,6 +852,8 @@ static pixman_color_t PixmanColor(const Color &color) {
 }
 
 void Bitmap::Fill(const Color &color) {
+	MarkModified();
+
 	pixman_color_t pcolor = PixmanColor(color);
 
 	pixman_box32_t box = { 0, 0, width(), height() };
@@ -730,6 +862,8 @@ void Bitmap::Fill(const Color &color) {
 }
 
 void Bitmap::FillRect(Rect const& dst_rect, const Color &color) {
+	MarkModified();
+
 	pixman_color_t pcolor = PixmanColor(color);
 
 	auto timage = PixmanImagePtr{pixman_image_create_solid_fill(&pcolor)};
@@ -748,10 +882,17 @@ void Bitmap::Clear() {
 		return;
 	}
 
+	if (!clip_rects.empty()) {
+		ClearRect(GetRect());
+		return;
+	}
+
 	memset(pixels(), '\0', height() * pitch());
 }
 
 void Bitmap::ClearRect(Rect const& dst_rect) {
+	MarkModified();
+
 	pixman_color_t pcolor = {};
 	pixman_box32_t box = {
 		dst_rect.x,
@@ -763,69 +904,6 @@ void Bitmap::ClearRect(Rect const& dst_rect) {
 	pixman_image_fill_boxes(PIXMAN_OP_CLEAR, bitmap.get(), &pcolor, 1, &box);
 }
 
-// Hard light lookup table mapping source color to destination color
-// FIXME: Replace this with std::array<std::array<uint8_t,256>,256> when we have C++17
-struct HardLightTable {
-	uint8_t table[256][256] = {};
-};
-
-static constexpr HardLightTable make_hard_light_lookup() {
-	HardLightTable hl;
-	for (int i = 0; i < 256; ++i) {
-		for (int j = 0; j < 256; ++j) {
-			int res = 0;
-			if (i <= 128)
-				res = (2 * i * j) / 255;
-			else
-				res = 255 - 2 * (255 - i) * (255 - j) / 255;
-			hl.table[i][j] = res > 255 ? 255 : res < 0 ? 0 : res;
-		}
-	}
-	return hl;
-}
-
-constexpr auto hard_light = make_hard_light_lookup();
-
-
-// Saturation Tone Inline: Changes a pixel saturation
-static inline void saturation_tone(uint32_t &src_pixel, const int saturation, const int rs, const int gs, const int bs, const int as) {
-	// Algorithm from OpenPDN (MIT license)
-	// Transformation in Y'CbCr color space
-	uint8_t r = (src_pixel >> rs) & 0xFF;
-	uint8_t g = (src_pixel >> gs) & 0xFF;
-	uint8_t b = (src_pixel >> bs) & 0xFF;
-	uint8_t a = (src_pixel >> as) & 0xFF;
-
-	// Y' = 0.299 R' + 0.587 G' + 0.114 B'
-	uint8_t lum = (7471 * b + 38470 * g + 19595 * r) >> 16;
-
-	// Scale Cb/Cr by scale factor "sat"
-	int red = ((lum * 1024 + (r - lum) * saturation) >> 10);
-	red = red > 255 ? 255 : red < 0 ? 0 : red;
-	int green = ((lum * 1024 + (g - lum) * saturation) >> 10);
-	green = green > 255 ? 255 : green < 0 ? 0 : green;
-	int blue = ((lum * 1024 + (b - lum) * saturation) >> 10);
-	blue = blue > 255 ? 255 : blue < 0 ? 0 : blue;
-
-	src_pixel = ((uint32_t)red << rs) | ((uint32_t)green << gs) | ((uint32_t)blue << bs) | ((uint32_t)a << as);
-}
-
-// Color Tone Inline: Changes color of a pixel by hard light table
-static inline void color_tone(uint32_t &src_pixel, const Tone& tone, const int rs, const int gs, const int bs, const int as) {
-	src_pixel = ((uint32_t)hard_light.table[tone.red][(src_pixel >> rs) & 0xFF] << rs)
-		| ((uint32_t)hard_light.table[tone.green][(src_pixel >> gs) & 0xFF] << gs)
-		| ((uint32_t)hard_light.table[tone.blue][(src_pixel >> bs) & 0xFF] << bs)
-		| ((uint32_t)((src_pixel >> as) & 0xFF) << as);
-}
-
-static inline void color_tone_alpha(uint32_t &src_pixel, const Tone& tone, const int rs, const int gs, const int bs, const int as) {
-	uint8_t a = (src_pixel >> as) & 0xFF;
-	uint8_t r = ((uint32_t)hard_light.table[tone.red][(src_pixel >> rs) & 0xFF]) * a / 255;
-	uint8_t g = ((uint32_t)hard_light.table[tone.green][(src_pixel >> gs) & 0xFF]) * a / 255;
-	uint8_t b = ((uint32_t)hard_light.table[tone.blue][(src_pixel >> bs) & 0xFF]) * a / 255;
-	src_pixel = ((uint32_t)r << rs) | ((uint32_t)g << gs) | ((uint32_t)b << bs) | ((uint32_t)a << as);
-}
-
 void Bitmap::ToneBlit(int x, int y, Bitmap const& src, Rect const& src_rect, const Tone &tone, Opacity const& opacity) {
 	if (opacity.IsTransparent()) {
 		return;
@@ -864,124 +942,53 @@ void Bitmap::ToneBlit(int x, int y, Bitmap const& src, Rect const& src_rect, con
 		src_rect.width, src_rect.height);
 	}
 
-	const int as = pixel_format.a.shift;
-	const int rs = pixel_format.r.shift;
-	const int gs = pixel_format.g.shift;
-	const int bs = pixel_format.b.shift;
+	BitmapKernels::ToneParams params;
+	params.rs = pixel_format.r.shift;
+	params.gs = pixel_format.g.shift;
+	params.bs = pixel_format.b.shift;
+	params.as = pixel_format.a.shift;
+	params.apply_saturation = tone.gray != 128;
+	params.saturation = tone.gray > 128 ? 1024 + (tone.gray - 128) * 16 : tone.gray * 8;
+	params.apply_tone = (tone.red != 128 || tone.green != 128 || tone.blue != 128);
+	params.red = tone.red;
+	params.green = tone.green;
+	params.blue = tone.blue;
+	params.skip_transparent = src_opacity != ImageOpacity::Opaque;
+	params.premultiplied = src_opacity == ImageOpacity::Alpha_8Bit;
+
 	int next_row = pitch() / sizeof(uint32_t);
 	uint32_t* pixels = (uint32_t*)this->pixels();
-	pixels = pixels + (y - 1) * next_row + x;
 
 	const uint16_t limit_height = std::min<uint16_t>(src_rect.height, height());
 	const uint16_t limit_width = std::min<uint16_t>(src_rect.width, width());
 
-	const bool apply_sat = tone.gray != 128;
-	const bool apply_tone = (tone.red != 128 || tone.green != 128 || tone.blue != 128);
-
-	// If Saturation + Color:
-	if (apply_sat && apply_tone) {
-		int sat = tone.gray > 128 ? 1024 + (tone.gray - 128) * 16 : tone.gray * 8;
-
-		if (src_opacity == ImageOpacity::Opaque) {
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					saturation_tone(pixels[j], sat, rs, gs, bs, as);
-					color_tone(pixels[j], tone, rs, gs, bs, as);
-				}
-			}
-		} else if (src_opacity == ImageOpacity::Alpha_1Bit) {
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					uint8_t a = (uint8_t)((pixels[j] >> as) & 0xFF);
-					if (a == 0)
-						continue;
-
-					saturation_tone(pixels[j], sat, rs, gs, bs, as);
-					color_tone(pixels[j], tone, rs, gs, bs, as);
-				}
-			}
-		} else { // 8 Bit Alpha
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					uint8_t a = (uint8_t)((pixels[j] >> as) & 0xFF);
-					if (a == 0) {
-						continue;
-					}
-
-					saturation_tone(pixels[j], sat, rs, gs, bs, as);
-					color_tone_alpha(pixels[j], tone, rs, gs, bs, as);
-				}
-			}
+	auto tone_rect = [&](const Rect& rect) {
+		uint32_t* row = pixels + rect.y * next_row + rect.x;
+		for (int i = 0; i < rect.height; ++i) {
+			BitmapKernels::ToneRow(row, rect.width, params);
+			row += next_row;
 		}
-	}
-
-	// If Only Saturation:
-	else if (apply_sat) {
-		int sat = tone.gray > 128 ? 1024 + (tone.gray - 128) * 16 : tone.gray * 8;
+	};
 
-		if (src_opacity == ImageOpacity::Opaque) {
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					saturation_tone(pixels[j], sat, rs, gs, bs, as);
-				}
-			}
-		} else { // Any kind of alpha
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					uint8_t a = (uint8_t)((pixels[j] >> as) & 0xFF);
-					if (a == 0)
-						continue;
-
-					saturation_tone(pixels[j], sat, rs, gs, bs, as);
-				}
-			}
-		}
+	const Rect rect(x, y, limit_width, limit_height);
+	if (clip_rects.empty()) {
+		tone_rect(rect);
+		return;
 	}
 
-	// If Only Color:
-	else if (apply_tone) {
-		if (src_opacity == ImageOpacity::Opaque) {
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					color_tone(pixels[j], tone, rs, gs, bs, as);
-				}
-			}
-		} else if (src_opacity == ImageOpacity::Alpha_1Bit) {
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					uint8_t a = (uint8_t)((pixels[j] >> as) & 0xFF);
-					if (a == 0)
-						continue;
-
-					color_tone(pixels[j], tone, rs, gs, bs, as);
-				}
-			}
-		} else { // 8 Bit Alpha
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					uint8_t a = (uint8_t)((pixels[j] >> as) & 0xFF);
-					if (a == 0)
-						continue;
-					else if (a == 255) {
-						color_tone(pixels[j], tone, rs, gs, bs, as);
-					} else {
-						color_tone_alpha(pixels[j], tone, rs, gs, bs, as);
-					}
-				}
-			}
+	// The tone is applied in place, pixels outside of the clip must not be touched
+	for (const auto& clip : clip_rects) {
+		Rect clipped = rect;
+		clipped.Adjust(clip);
+		if (!clipped.IsEmpty()) {
+			tone_rect(clipped);
 		}
 	}
 }
 
 void Bitmap::BlendBlit(int x, int y, Bitmap const& src, Rect const& src_rect, const Color& color, Opacity const& opacity) {
+	MarkModified();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
@@ -1011,7 +1018,41 @@ void Bitmap::BlendBlit(int x, int y, Bitmap const& src, Rect const& src_rect, co
 							 src_rect.width, src_rect.height);
 }
 
+void Bitmap::SpriteEffectBlit(Bitmap const& src, Rect const& src_rect, bool flip_x, bool flip_y, const Tone& tone, const Color& blend) {
+	MarkModified();
+
+	Clear();
+
+	bool applied = false;
+
+	if (tone != Tone()) {
+		ToneBlit(0, 0, src, src_rect, tone, Opacity::Opaque());
+		applied = true;
+	}
+
+	if (blend != Color()) {
+		if (applied) {
+			// Tone blit was applied
+			BlendBlit(0, 0, *this, GetRect(), blend, Opacity::Opaque());
+		} else {
+			BlendBlit(0, 0, src, src_rect, blend, Opacity::Opaque());
+			applied = true;
+		}
+	}
+
+	if (flip_x || flip_y) {
+		if (applied) {
+			// Tone or blend blit was applied
+			Flip(flip_x, flip_y);
+		} else {
+			FlipBlit(src_rect.x, src_rect.y, src, src_rect, flip_x, flip_y, Opacity::Opaque());
+		}
+	}
+}
+
 void Bitmap::FlipBlit(int x, int y, Bitmap const& src, Rect const& src_rect, bool horizontal, bool vertical, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
+	MarkModified();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
@@ -1020,26 +1061,34 @@ void Bitmap::FlipBlit(int x, int y, Bitmap const& src, Rect const& src_rect, boo
 	const auto img_w = src.GetWidth();
 	const auto img_h = src.GetHeight();
 
-	auto rect = src_rect;
-	if (has_xform) {
-		Transform xform = Transform::Scale(horizontal ? -1 : 1, vertical ? -1 : 1);
-		xform *= Transform::Translation(horizontal ? -img_w : 0, vertical ? -img_h : 0);
+	if (!has_xform) {
+		Blit(x, y, src, src_rect, opacity, blend_mode);
+		return;
+	}
 
-		pixman_image_set_transform(src.bitmap.get(), &xform.matrix);
-		const auto src_x = horizontal ? img_w - src_rect.x - src_rect.width : src_rect.x;
-		const auto src_y = vertical ? img_h - src_rect.y - src_rect.height : src_rect.y;
+	Transform xform = Transform::Scale(horizontal ? -1 : 1, vertical ? -1 : 1);
+	xform *= Transform::Translation(horizontal ? -img_w : 0, vertical ? -img_h : 0);
 
-		rect = Rect{ src_x, src_y, src_rect.width, src_rect.height };
-	}
+	auto src_img = GetSubimage(src, src.GetRect());
+	pixman_image_set_transform(src_img.get(), &xform.matrix);
+	const auto src_x = horizontal ? img_w - src_rect.x - src_rect.width : src_rect.x;
+	const auto src_y = vertical ? img_h - src_rect.y - src_rect.height : src_rect.y;
 
-	Blit(x, y, src, rect, opacity, blend_mode);
+	const Rect rect = Rect{ src_x, src_y, src_rect.width, src_rect.height };
+	auto mask = CreateMask(opacity, rect);
 
-	if (has_xform) {
-		pixman_image_set_transform(src.bitmap.get(), nullptr);
-	}
+	pixman_image_composite32(src.GetOperator(mask.get(), blend_mode),
+							 src_img.get(),
+							 mask.get(), bitmap.get(),
+							 rect.x, rect.y,
+							 0, 0,
+							 x, y,
+							 rect.width, rect.height);
 }
 
 void Bitmap::Flip(bool horizontal, bool vertical) {
+	MarkModified();
+
 	if (!horizontal && !vertical) {
 		return;
 	}
@@ -1064,6 +1113,8 @@ void Bitmap::Flip(bool horizontal, bool vertical) {
 }
 
 void Bitmap::MaskedBlit(Rect const& dst_rect, Bitmap const& mask, int mx, int my, Color const& color) {
+	MarkModified();
+
 	pixman_color_t tcolor = {
 		static_cast<uint16_t>(color.red << 8),
 		static_cast<uint16_t>(color.green << 8),
@@ -1081,6 +1132,8 @@ void Bitmap::MaskedBlit(Rect const& dst_rect, Bitmap const& mask, int mx, int my
 }
 
 void Bitmap::MaskedBlit(Rect const& dst_rect, Bitmap const& mask, int mx, int my, Bitmap const& src, int sx, int sy) {
+	MarkModified();
+
 	pixman_image_composite32(PIXMAN_OP_OVER,
 							 src.bitmap.get(), mask.bitmap.get(), bitmap.get(),
 							 sx, sy,
@@ -1090,18 +1143,19 @@ void Bitmap::MaskedBlit(Rect const& dst_rect, Bitmap const& mask, int mx, int my
 }
 
 void Bitmap::Blit2x(Rect const& dst_rect, Bitmap const& src, Rect const& src_rect) {
+	MarkModified();
+
 	Transform xform = Transform::Scale(0.5, 0.5);
 
-	pixman_image_set_transform(src.bitmap.get(), &xform.matrix);
+	auto src_img = GetSubimage(src, src.GetRect());
+	pixman_image_set_transform(src_img.get(), &xform.matrix);
 
 	pixman_image_composite32(PIXMAN_OP_SRC,
-							 src.bitmap.get(), nullptr, bitmap.get(),
+							 src_img.get(), nullptr, bitmap.get(),
 							 src_rect.x, src_rect.y,
 							 0, 0,
 							 dst_rect.x, dst_rect.y,
 							 dst_rect.width, dst_rect.height);
-
-	pixman_image_set_transform(src.bitmap.get(), nullptr);
 }
 
 void Bitmap::EffectsBlit(int x, int y, int ox, int oy,
@@ -1136,12 +1190,12 @@ void Bitmap::RotateZoomOpacityBlit(int x, int y, int ox, int oy,
 		Bitmap const& src, Rect const& src_rect,
 		double angle, double zoom_x, double zoom_y, Opacity const& opacity, Bitmap::BlendMode blend_mode)
 {
+	MarkModified();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
 
-	auto* src_img = src.bitmap.get();
-
 	Transform fwd = Transform::Translation(x, y);
 	fwd *= Transform::Rotation(angle);
 	if (zoom_x != 1.0 || zoom_y != 1.0) {
@@ -1156,26 +1210,19 @@ void Bitmap::RotateZoomOpacityBlit(int x, int y, int ox, int oy,
 
 	auto inv = fwd.Inverse();
 
-	PixmanImagePtr temp;
-	if (src_rect != src.GetRect()) {
-		temp = GetSubimage(src, src_rect);
-		src_img = temp.get();
-	}
-
-	pixman_image_set_transform(src_img, &inv.matrix);
+	auto src_img = GetSubimage(src, src_rect);
+	pixman_image_set_transform(src_img.get(), &inv.matrix);
 
 	auto mask = CreateMask(opacity, src_rect, &inv);
 
 	// OP_SRC draws a black rectangle around the rotated image making this operator unusable here
 	blend_mode = (blend_mode == BlendMode::Default ? BlendMode::Normal : blend_mode);
 	pixman_image_composite32(GetOperator(mask.get(), blend_mode),
-							 src_img, mask.get(), bitmap.get(),
+							 src_img.get(), mask.get(), bitmap.get(),
 							 dst_rect.x, dst_rect.y,
 							 dst_rect.x, dst_rect.y,
 							 dst_rect.x, dst_rect.y,
 							 dst_rect.width, dst_rect.height);
-
-	pixman_image_set_transform(src_img, nullptr);
 }
 
 void Bitmap::ZoomOpacityBlit(int x, int y, int ox, int oy,
@@ -1183,6 +1230,8 @@ void Bitmap::ZoomOpacityBlit(int x, int y, int ox, int oy,
 							 double zoom_x, double zoom_y,
 							 Opacity const& opacity, Bitmap::BlendMode blend_mode)
 {
+	MarkModified();
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
@@ -1241,6 +1290,8 @@ pixman_op_t Bitmap::GetOperator(pixman_image_t* mask, Bitmap::BlendMode blend_mo
 }
 
 void Bitmap::EdgeMirrorBlit(int x, int y, Bitmap const& src, Rect const& src_rect, bool mirror_x, bool mirror_y, Opacity const& opacity) {
+	MarkModified();
+
 	if (opacity.IsTransparent())
 		return;
 
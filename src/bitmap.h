@@ -223,6 +223,28 @@ public:
 	 */
 	StringView GetFilename() const;
 
+	/**
+	 * Gets a number that changes whenever the pixels are modified.
+	 * Numbers are never reused, not even by different bitmaps.
+	 *
+	 * @return revision
+	 */
+	uint64_t GetRevision() const;
+
+	/**
+	 * Restricts all following drawing operations on this bitmap to the
+	 * union of the passed rectangles.
+	 *
+	 * @param rects clip rectangles. An empty list disables clipping.
+	 */
+	void SetClipRects(const std::vector<Rect>& rects);
+
+	/**
+	 * @return disjoint clip rectangles set by SetClipRects.
+	 *         Empty when not clipped, a single empty rectangle when everything is clipped.
+	 */
+	const std::vector<Rect>& GetClipRects() const;
+
 	void CheckPixels(uint32_t flags);
 
 	/**
@@ -489,6 +511,19 @@ public:
 	 */
 	void BlendBlit(int x, int y, Bitmap const& src, Rect const& src_rect, const Color &color, Opacity const& opacity);
 
+	/**
+	 * Clears the bitmap and draws the source rect to the top left corner
+	 * with the sprite effects applied in the order tone, flash and flip.
+	 *
+	 * @param src source bitmap.
+	 * @param src_rect source bitmap rect.
+	 * @param flip_x flip horizontally (mirror).
+	 * @param flip_y flip vertically.
+	 * @param tone tone to apply.
+	 * @param blend flash color to apply.
+	 */
+	void SpriteEffectBlit(Bitmap const& src, Rect const& src_rect, bool flip_x, bool flip_y, const Tone& tone, const Color& blend);
+
 	/**
 	 * Flips the bitmap pixels.
 	 *
@@ -578,6 +613,7 @@ public:
 	int height() const;
 	int bpp() const;
 	int pitch() const;
+	const DynamicFormat& GetFormat() const;
 
 	ImageOpacity ComputeImageOpacity() const;
 	ImageOpacity ComputeImageOpacity(Rect rect) const;
@@ -599,6 +635,15 @@ protected:
 	void ConvertImage(int& width, int& height, void*& pixels, bool transparent);
 
 	static PixmanImagePtr GetSubimage(Bitmap const& src, const Rect& src_rect);
+
+	/**
+	 * Blits with BitmapKernels instead of pixman when the operation is supported.
+	 *
+	 * @param op pixman operator of the blit
+	 * @param opacity global opacity, a solid mask for pixman
+	 * @return whether the blit was done
+	 */
+	bool BlitKernel(int x, int y, Bitmap const& src, Rect const& src_rect, pixman_op_t op, int opacity);
 	static inline void MultiplyAlpha(uint8_t &r, uint8_t &g, uint8_t &b, const uint8_t &a) {
 		r = (uint8_t)((int)r * a / 0xFF);
 		g = (uint8_t)((int)g * a / 0xFF);
@@ -626,6 +671,14 @@ protected:
 	 */
 	pixman_op_t GetOperator(pixman_image_t* mask = nullptr, BlendMode blend_mode = BlendMode::Default) const;
 	bool read_only = false;
+
+	/** Assigns a new revision, called by every operation writing pixels. */
+	void MarkModified();
+
+	uint64_t revision = 0;
+
+	/** Disjoint clip rectangles for operations not done by pixman */
+	std::vector<Rect> clip_rects;
 };
 
 inline ImageOpacity Bitmap::GetImageOpacity() const {
@@ -664,4 +717,16 @@ inline StringView Bitmap::GetFilename() const {
 	return filename;
 }
 
+inline uint64_t Bitmap::GetRevision() const {
+	return revision;
+}
+
+inline const std::vector<Rect>& Bitmap::GetClipRects() const {
+	return clip_rects;
+}
+
+inline const DynamicFormat& Bitmap::GetFormat() const {
+	return format;
+}
+
 #endif
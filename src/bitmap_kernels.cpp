@@ -0,0 +1,439 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "bitmap_kernels.h"
+#include "bitmap_hslrgb.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define EP_KERNELS_SSE2
+#  include <emmintrin.h>
+#  if defined(__GNUC__) || defined(_MSC_VER)
+#    define EP_KERNELS_AVX2
+#    include <immintrin.h>
+#    ifdef _MSC_VER
+#      include <intrin.h>
+#    endif
+#  endif
+#endif
+
+namespace {
+	// Hard light lookup table mapping source color to destination color
+	// FIXME: Replace this with std::array<std::array<uint8_t,256>,256> when we have C++17
+	struct HardLightTable {
+		uint8_t table[256][256] = {};
+	};
+
+	constexpr HardLightTable make_hard_light_lookup() {
+		HardLightTable hl;
+		for (int i = 0; i < 256; ++i) {
+			for (int j = 0; j < 256; ++j) {
+				int res = 0;
+				if (i <= 128)
+					res = (2 * i * j) / 255;
+				else
+					res = 255 - 2 * (255 - i) * (255 - j) / 255;
+				hl.table[i][j] = res > 255 ? 255 : res < 0 ? 0 : res;
+			}
+		}
+		return hl;
+	}
+
+	constexpr auto hard_light = make_hard_light_lookup();
+
+	// Saturation Tone Inline: Changes a pixel saturation
+	inline void saturation_tone(uint32_t &src_pixel, const int saturation, const int rs, const int gs, const int bs, const int as) {
+		// Algorithm from OpenPDN (MIT license)
+		// Transformation in Y'CbCr color space
+		uint8_t r = (src_pixel >> rs) & 0xFF;
+		uint8_t g = (src_pixel >> gs) & 0xFF;
+		uint8_t b = (src_pixel >> bs) & 0xFF;
+		uint8_t a = (src_pixel >> as) & 0xFF;
+
+		// Y' = 0.299 R' + 0.587 G' + 0.114 B'
+		uint8_t lum = (7471 * b + 38470 * g + 19595 * r) >> 16;
+
+		// Scale Cb/Cr by scale factor "sat"
+		int red = ((lum * 1024 + (r - lum) * saturation) >> 10);
+		red = red > 255 ? 255 : red < 0 ? 0 : red;
+		int green = ((lum * 1024 + (g - lum) * saturation) >> 10);
+		green = green > 255 ? 255 : green < 0 ? 0 : green;
+		int blue = ((lum * 1024 + (b - lum) * saturation) >> 10);
+		blue = blue > 255 ? 255 : blue < 0 ? 0 : blue;
+
+		src_pixel = ((uint32_t)red << rs) | ((uint32_t)green << gs) | ((uint32_t)blue << bs) | ((uint32_t)a << as);
+	}
+
+	// Color Tone Inline: Changes color of a pixel by hard light table
+	inline void color_tone(uint32_t &src_pixel, const BitmapKernels::ToneParams& p) {
+		src_pixel = ((uint32_t)hard_light.table[p.red][(src_pixel >> p.rs) & 0xFF] << p.rs)
+			| ((uint32_t)hard_light.table[p.green][(src_pixel >> p.gs) & 0xFF] << p.gs)
+			| ((uint32_t)hard_light.table[p.blue][(src_pixel >> p.bs) & 0xFF] << p.bs)
+			| ((uint32_t)((src_pixel >> p.as) & 0xFF) << p.as);
+	}
+
+	inline void color_tone_alpha(uint32_t &src_pixel, const BitmapKernels::ToneParams& p) {
+		uint8_t a = (src_pixel >> p.as) & 0xFF;
+		uint8_t r = ((uint32_t)hard_light.table[p.red][(src_pixel >> p.rs) & 0xFF]) * a / 255;
+		uint8_t g = ((uint32_t)hard_light.table[p.green][(src_pixel >> p.gs) & 0xFF]) * a / 255;
+		uint8_t b = ((uint32_t)hard_light.table[p.blue][(src_pixel >> p.bs) & 0xFF]) * a / 255;
+		src_pixel = ((uint32_t)r << p.rs) | ((uint32_t)g << p.gs) | ((uint32_t)b << p.bs) | ((uint32_t)a << p.as);
+	}
+
+	void ScalarToneRow(uint32_t* pixels, int width, const BitmapKernels::ToneParams& p) {
+		for (int i = 0; i < width; ++i) {
+			uint32_t& pixel = pixels[i];
+			if (p.skip_transparent && ((pixel >> p.as) & 0xFF) == 0) {
+				continue;
+			}
+
+			if (p.apply_saturation) {
+				saturation_tone(pixel, p.saturation, p.rs, p.gs, p.bs, p.as);
+			}
+			if (p.apply_tone) {
+				if (p.premultiplied) {
+					color_tone_alpha(pixel, p);
+				} else {
+					color_tone(pixel, p);
+				}
+			}
+		}
+	}
+
+	void ScalarHueRow(uint32_t* pixels, int width, int hue) {
+		for (int i = 0; i < width; ++i) {
+			uint32_t pixel = pixels[i];
+			uint8_t r = (pixel>>24) & 0xFF;
+			uint8_t g = (pixel>>16) & 0xFF;
+			uint8_t b = (pixel>> 8) & 0xFF;
+			uint8_t a = pixel & 0xFF;
+			if (a > 0)
+				RGB_adjust_HSL(r, g, b, hue);
+			pixels[i] = ((uint32_t) r << 24) | ((uint32_t) g << 16) | ((uint32_t) b << 8) | (uint32_t) a;
+		}
+	}
+
+#ifdef EP_KERNELS_SSE2
+	/**
+	 * Vector operations used by the kernels in bitmap_kernels_simd.h.
+	 * Porting the kernels to another instruction set (e.g. NEON) only requires
+	 * another struct with the same functions.
+	 */
+	struct Sse2 {
+		using reg = __m128i;
+		static constexpr int lanes = 4;
+
+		static reg load(const uint32_t* p) { return _mm_loadu_si128(reinterpret_cast<const reg*>(p)); }
+		static void store(uint32_t* p, reg v) { _mm_storeu_si128(reinterpret_cast<reg*>(p), v); }
+		static reg set1(int v) { return _mm_set1_epi32(v); }
+
+		static reg add(reg a, reg b) { return _mm_add_epi32(a, b); }
+		static reg sub(reg a, reg b) { return _mm_sub_epi32(a, b); }
+		/** Multiplies the low 16 bits of each lane as signed values, the high bits of b must be 0 */
+		static reg mul16(reg a, reg b) { return _mm_madd_epi16(a, b); }
+		/** Maximum of lanes in the range 0 to 32767 */
+		static reg max(reg a, reg b) { return _mm_max_epi16(a, b); }
+		/** Minimum of lanes in the range 0 to 32767 */
+		static reg min(reg a, reg b) { return _mm_min_epi16(a, b); }
+		static reg clamp255(reg v) {
+			v = _mm_and_si128(v, _mm_cmpgt_epi32(v, _mm_setzero_si128()));
+			return select(_mm_cmpgt_epi32(v, set1(255)), set1(255), v);
+		}
+		/** Signed division rounding towards zero, exact for integer quotients */
+		static reg div_trunc(reg n, reg d) { return _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(n), _mm_cvtepi32_ps(d))); }
+
+		static reg and_(reg a, reg b) { return _mm_and_si128(a, b); }
+		static reg or_(reg a, reg b) { return _mm_or_si128(a, b); }
+		/** ~a & b */
+		static reg andnot(reg a, reg b) { return _mm_andnot_si128(a, b); }
+		static reg cmpeq(reg a, reg b) { return _mm_cmpeq_epi32(a, b); }
+		static reg cmpgt(reg a, reg b) { return _mm_cmpgt_epi32(a, b); }
+		/** mask ? a : b */
+		static reg select(reg mask, reg a, reg b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+
+		static reg srl(reg v, int n) { return _mm_srl_epi32(v, _mm_cvtsi32_si128(n)); }
+		static reg sll(reg v, int n) { return _mm_sll_epi32(v, _mm_cvtsi32_si128(n)); }
+		template <int N> static reg srli(reg v) { return _mm_srli_epi32(v, N); }
+		template <int N> static reg slli(reg v) { return _mm_slli_epi32(v, N); }
+		template <int N> static reg srai(reg v) { return _mm_srai_epi32(v, N); }
+	};
+
+	namespace sse2 {
+		using V = Sse2;
+#  include "bitmap_kernels_simd.h"
+	}
+#endif
+
+#ifdef EP_KERNELS_AVX2
+#  if defined(__clang__)
+#    pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#  elif defined(__GNUC__)
+#    pragma GCC push_options
+#    pragma GCC target("avx2")
+#  endif
+
+	struct Avx2 {
+		using reg = __m256i;
+		static constexpr int lanes = 8;
+
+		static reg load(const uint32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const reg*>(p)); }
+		static void store(uint32_t* p, reg v) { _mm256_storeu_si256(reinterpret_cast<reg*>(p), v); }
+		static reg set1(int v) { return _mm256_set1_epi32(v); }
+
+		static reg add(reg a, reg b) { return _mm256_add_epi32(a, b); }
+		static reg sub(reg a, reg b) { return _mm256_sub_epi32(a, b); }
+		static reg mul16(reg a, reg b) { return _mm256_madd_epi16(a, b); }
+		static reg max(reg a, reg b) { return _mm256_max_epi32(a, b); }
+		static reg min(reg a, reg b) { return _mm256_min_epi32(a, b); }
+		static reg clamp255(reg v) { return _mm256_min_epi32(_mm256_max_epi32(v, _mm256_setzero_si256()), set1(255)); }
+		static reg div_trunc(reg n, reg d) { return _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(n), _mm256_cvtepi32_ps(d))); }
+
+		static reg and_(reg a, reg b) { return _mm256_and_si256(a, b); }
+		static reg or_(reg a, reg b) { return _mm256_or_si256(a, b); }
+		static reg andnot(reg a, reg b) { return _mm256_andnot_si256(a, b); }
+		static reg cmpeq(reg a, reg b) { return _mm256_cmpeq_epi32(a, b); }
+		static reg cmpgt(reg a, reg b) { return _mm256_cmpgt_epi32(a, b); }
+		static reg select(reg mask, reg a, reg b) { return _mm256_blendv_epi8(b, a, mask); }
+
+		static reg srl(reg v, int n) { return _mm256_srl_epi32(v, _mm_cvtsi32_si128(n)); }
+		static reg sll(reg v, int n) { return _mm256_sll_epi32(v, _mm_cvtsi32_si128(n)); }
+		template <int N> static reg srli(reg v) { return _mm256_srli_epi32(v, N); }
+		template <int N> static reg slli(reg v) { return _mm256_slli_epi32(v, N); }
+		template <int N> static reg srai(reg v) { return _mm256_srai_epi32(v, N); }
+	};
+
+	namespace avx2 {
+		using V = Avx2;
+#  include "bitmap_kernels_simd.h"
+	}
+
+#  if defined(__clang__)
+#    pragma clang attribute pop
+#  elif defined(__GNUC__)
+#    pragma GCC pop_options
+#  endif
+
+	bool CpuHasAvx2() {
+#  ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) {
+			return false;
+		}
+		__cpuid(info, 1);
+		// OSXSAVE and AVX, the OS must save the YMM registers
+		const int avx_bits = (1 << 27) | (1 << 28);
+		if ((info[2] & avx_bits) != avx_bits || (_xgetbv(0) & 6) != 6) {
+			return false;
+		}
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#  else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+#  endif
+	}
+#endif
+
+	struct Kernels {
+		void (*tone_row)(uint32_t* pixels, int width, const BitmapKernels::ToneParams& params);
+		void (*hue_row)(uint32_t* pixels, int width, int hue);
+	};
+
+	Kernels GetKernels(BitmapKernels::Level level) {
+		switch (level) {
+#ifdef EP_KERNELS_SSE2
+			case BitmapKernels::Level::SSE2:
+				return { sse2::ToneRow, sse2::HueRow };
+#endif
+#ifdef EP_KERNELS_AVX2
+			case BitmapKernels::Level::AVX2:
+				return { avx2::ToneRow, avx2::HueRow };
+#endif
+			default:
+				return { ScalarToneRow, ScalarHueRow };
+		}
+	}
+
+	BitmapKernels::Level DetectLevel() {
+		using Level = BitmapKernels::Level;
+		if (BitmapKernels::IsSupported(Level::AVX2)) {
+			return Level::AVX2;
+		}
+		if (BitmapKernels::IsSupported(Level::SSE2)) {
+			return Level::SSE2;
+		}
+		return Level::Scalar;
+	}
+
+	BitmapKernels::Level active_level = DetectLevel();
+	Kernels active = GetKernels(active_level);
+
+	bool blit_enabled = true;
+
+	// Channel wise operations on 4 packed 8 bit values, identical to the ones of pixman
+	inline uint32_t MulUn8x4(uint32_t x, uint32_t a) {
+		uint32_t lo = (x & 0xFF00FF) * a + 0x800080;
+		lo = ((lo + ((lo >> 8) & 0xFF00FF)) >> 8) & 0xFF00FF;
+		uint32_t hi = ((x >> 8) & 0xFF00FF) * a + 0x800080;
+		hi = (hi + ((hi >> 8) & 0xFF00FF)) & 0xFF00FF00;
+		return lo | hi;
+	}
+
+	inline uint32_t AddUn8x4(uint32_t x, uint32_t y) {
+		uint32_t lo = (x & 0xFF00FF) + (y & 0xFF00FF);
+		lo = (lo | (0x1000100 - ((lo >> 8) & 0xFF00FF))) & 0xFF00FF;
+		uint32_t hi = ((x >> 8) & 0xFF00FF) + ((y >> 8) & 0xFF00FF);
+		hi = (hi | (0x1000100 - ((hi >> 8) & 0xFF00FF))) & 0xFF00FF;
+		return lo | (hi << 8);
+	}
+
+	template <int AlphaShift>
+	inline uint32_t Over(uint32_t s, uint32_t d) {
+		return AddUn8x4(MulUn8x4(d, 255 - ((s >> AlphaShift) & 0xFF)), s);
+	}
+
+	template <BitmapKernels::BlitOp Op, int AlphaShift>
+	inline void BlitRow(uint32_t* dst, const uint32_t* src, int width, uint32_t opacity) {
+		using BlitOp = BitmapKernels::BlitOp;
+		switch (Op) {
+			case BlitOp::Copy:
+				std::memcpy(dst, src, width * sizeof(uint32_t));
+				break;
+			case BlitOp::Over1Bit:
+				for (int i = 0; i < width; ++i) {
+					const uint32_t s = src[i];
+					const uint32_t a = (s >> AlphaShift) & 0xFF;
+					if (a == 0xFF) {
+						dst[i] = s;
+					} else if (s != 0) {
+						dst[i] = Over<AlphaShift>(s, dst[i]);
+					}
+				}
+				break;
+			case BlitOp::Over:
+				for (int i = 0; i < width; ++i) {
+					dst[i] = Over<AlphaShift>(src[i], dst[i]);
+				}
+				break;
+			case BlitOp::OverOpacity:
+				for (int i = 0; i < width; ++i) {
+					dst[i] = Over<AlphaShift>(MulUn8x4(src[i], opacity), dst[i]);
+				}
+				break;
+		}
+	}
+
+	template <BitmapKernels::BlitOp Op, int AlphaShift>
+	void BlitRectImpl(uint32_t* dst, int dst_pitch, const uint32_t* src, int src_pitch, int width, int height, int opacity) {
+		for (int y = 0; y < height; ++y) {
+			BlitRow<Op, AlphaShift>(dst, src, width, static_cast<uint32_t>(opacity));
+			dst = reinterpret_cast<uint32_t*>(reinterpret_cast<uint8_t*>(dst) + dst_pitch);
+			src = reinterpret_cast<const uint32_t*>(reinterpret_cast<const uint8_t*>(src) + src_pitch);
+		}
+	}
+
+	template <int AlphaShift>
+	void BlitRectShift(BitmapKernels::BlitOp op, uint32_t* dst, int dst_pitch, const uint32_t* src, int src_pitch, int width, int height, int opacity) {
+		using BlitOp = BitmapKernels::BlitOp;
+		switch (op) {
+			case BlitOp::Copy:
+				BlitRectImpl<BlitOp::Copy, AlphaShift>(dst, dst_pitch, src, src_pitch, width, height, opacity);
+				break;
+			case BlitOp::Over1Bit:
+				BlitRectImpl<BlitOp::Over1Bit, AlphaShift>(dst, dst_pitch, src, src_pitch, width, height, opacity);
+				break;
+			case BlitOp::Over:
+				BlitRectImpl<BlitOp::Over, AlphaShift>(dst, dst_pitch, src, src_pitch, width, height, opacity);
+				break;
+			case BlitOp::OverOpacity:
+				BlitRectImpl<BlitOp::OverOpacity, AlphaShift>(dst, dst_pitch, src, src_pitch, width, height, opacity);
+				break;
+		}
+	}
+}
+
+void BitmapKernels::ToneRow(uint32_t* pixels, int width, const ToneParams& params) {
+	active.tone_row(pixels, width, params);
+}
+
+void BitmapKernels::HueRow(uint32_t* pixels, int width, int hue) {
+	active.hue_row(pixels, width, hue);
+}
+
+void BitmapKernels::BlitRect(BlitOp op, uint32_t* dst, int dst_pitch, const uint32_t* src, int src_pitch,
+		int width, int height, int alpha_shift, int opacity) {
+	if (alpha_shift == 24) {
+		BlitRectShift<24>(op, dst, dst_pitch, src, src_pitch, width, height, opacity);
+	} else {
+		BlitRectShift<0>(op, dst, dst_pitch, src, src_pitch, width, height, opacity);
+	}
+}
+
+bool BitmapKernels::IsBlitEnabled() {
+	return blit_enabled;
+}
+
+void BitmapKernels::SetBlitEnabled(bool enabled) {
+	blit_enabled = enabled;
+}
+
+BitmapKernels::Level BitmapKernels::GetLevel() {
+	return active_level;
+}
+
+bool BitmapKernels::SetLevel(Level level) {
+	if (!IsSupported(level)) {
+		return false;
+	}
+
+	active_level = level;
+	active = GetKernels(level);
+	return true;
+}
+
+bool BitmapKernels::IsSupported(Level level) {
+	switch (level) {
+		case Level::Scalar:
+			return true;
+#ifdef EP_KERNELS_SSE2
+		case Level::SSE2:
+			return true;
+#endif
+#ifdef EP_KERNELS_AVX2
+		case Level::AVX2: {
+			static const bool avx2 = CpuHasAvx2();
+			return avx2;
+		}
+#endif
+		default:
+			return false;
+	}
+}
+
+const char* BitmapKernels::GetName(Level level) {
+	switch (level) {
+		case Level::Scalar:
+			return "Scalar";
+		case Level::SSE2:
+			return "SSE2";
+		case Level::AVX2:
+			return "AVX2";
+	}
+	return "";
+}
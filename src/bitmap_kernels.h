@@ -0,0 +1,133 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_BITMAP_KERNELS_H
+#define EP_BITMAP_KERNELS_H
+
+#include <cstdint>
+
+/**
+ * Per-row pixel kernels of the Bitmap effects that pixman can't do.
+ * Every kernel has a scalar implementation and vectorized ones that are
+ * selected at startup depending on the features of the CPU.
+ * All implementations produce identical output.
+ *
+ * Additionally contains blitters for small 32 bit blits which are dominated
+ * by the per call overhead of pixman. Their output is identical to pixman.
+ */
+namespace BitmapKernels {
+	enum class Level {
+		Scalar,
+		SSE2,
+		AVX2
+	};
+
+	struct ToneParams {
+		/** Shifts of the 8 bit channels in the 32 bit pixel */
+		int rs = 0;
+		int gs = 0;
+		int bs = 0;
+		int as = 0;
+		/** Saturation factor, 1024 is unchanged */
+		int saturation = 1024;
+		bool apply_saturation = false;
+		/** Hard light tone per channel, 128 is unchanged */
+		int red = 128;
+		int green = 128;
+		int blue = 128;
+		bool apply_tone = false;
+		/** Pixels with alpha 0 are not modified */
+		bool skip_transparent = false;
+		/** The toned color is multiplied with alpha */
+		bool premultiplied = false;
+	};
+
+	/**
+	 * Applies saturation and tone of ToneBlit to a row.
+	 *
+	 * @param pixels row of 32 bit pixels
+	 * @param width number of pixels
+	 * @param params tone to apply
+	 */
+	void ToneRow(uint32_t* pixels, int width, const ToneParams& params);
+
+	/**
+	 * Rotates the hue of the non transparent pixels of a row.
+	 *
+	 * @param pixels row of pixels in RGBA order (red in the highest byte)
+	 * @param width number of pixels
+	 * @param hue hue rotation in the range 0 to 0x600
+	 */
+	void HueRow(uint32_t* pixels, int width, int hue);
+
+	enum class BlitOp {
+		/** Copies the source (PIXMAN_OP_SRC) */
+		Copy,
+		/** Source over destination, fast when most alpha values are 0 or 255 */
+		Over1Bit,
+		/** Source over destination (PIXMAN_OP_OVER) */
+		Over,
+		/** Source multiplied with an opacity over destination */
+		OverOpacity
+	};
+
+	/**
+	 * Blits a rectangle between two images of the same 32 bit format.
+	 * The rectangle must be inside of both images.
+	 *
+	 * @param op operation
+	 * @param dst first destination pixel
+	 * @param dst_pitch destination bytes per row
+	 * @param src first source pixel
+	 * @param src_pitch source bytes per row
+	 * @param width rectangle width
+	 * @param height rectangle height
+	 * @param alpha_shift shift of the alpha channel, must be 0 or 24
+	 * @param opacity opacity for BlitOp::OverOpacity
+	 */
+	void BlitRect(BlitOp op, uint32_t* dst, int dst_pitch, const uint32_t* src, int src_pitch,
+			int width, int height, int alpha_shift, int opacity = 255);
+
+	/** @return whether Bitmap uses BlitRect instead of pixman when possible */
+	bool IsBlitEnabled();
+
+	/**
+	 * Enables usage of BlitRect by Bitmap. Used by tests and benchmarks to compare with pixman.
+	 *
+	 * @param enabled whether to use BlitRect
+	 */
+	void SetBlitEnabled(bool enabled);
+
+	/** @return the implementation in use */
+	Level GetLevel();
+
+	/**
+	 * Selects the implementation in use. Used by tests and benchmarks.
+	 *
+	 * @param level implementation
+	 * @return false when the CPU doesn't support it
+	 */
+	bool SetLevel(Level level);
+
+	/** @return whether the CPU supports the implementation */
+	bool IsSupported(Level level);
+
+	/** @return name of the implementation */
+	const char* GetName(Level level);
+}
+
+#endif
@@ -0,0 +1,176 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// No include guard: Included by bitmap_kernels.cpp once per instruction set.
+// The including namespace provides "V", a struct with static functions
+// operating on vectors of 32 bit lanes (see Sse2 in bitmap_kernels.cpp),
+// and ScalarToneRow/ScalarHueRow for the remaining pixels of a row.
+// The kernels are plain functions instead of templates because the
+// instruction set is enabled per function by the including file.
+
+/** x / 255 rounded down, exact for x in [0, 65280] */
+static inline V::reg Div255(V::reg x) {
+	return V::srli<8>(V::add(V::add(x, V::set1(1)), V::srli<8>(x)));
+}
+
+/** Hard light of a channel, see make_hard_light_lookup */
+static inline V::reg HardLight(V::reg c, int tone) {
+	if (tone <= 128) {
+		auto res = Div255(V::mul16(c, V::set1(2 * tone)));
+		// 2 * 128 * 255 / 255 is 256
+		return V::clamp255(res);
+	}
+	auto inv = V::sub(V::set1(255), c);
+	return V::sub(V::set1(255), Div255(V::mul16(inv, V::set1(2 * (255 - tone)))));
+}
+
+/** Signed integer division rounding towards zero. d must not be 0, |n| must be below 2^24 */
+static inline V::reg DivTrunc(V::reg n, V::reg d) {
+	// The quotient of two integers is rounded correctly by the float division,
+	// non-integer quotients are further away from the next integer than the error
+	return V::div_trunc(n, d);
+}
+
+/** Replaces the color of the pixels in the hue sector k */
+static inline void SelectSector(V::reg sector, int k, V::reg& r, V::reg& g, V::reg& b, V::reg kr, V::reg kg, V::reg kb) {
+	const auto mask = V::cmpeq(sector, V::set1(k));
+	r = V::select(mask, kr, r);
+	g = V::select(mask, kg, g);
+	b = V::select(mask, kb, b);
+}
+
+static void ToneRow(uint32_t* pixels, int width, const BitmapKernels::ToneParams& p) {
+	const auto ff = V::set1(0xFF);
+	const auto zero = V::set1(0);
+	const auto sat = V::set1(p.saturation);
+
+	int i = 0;
+	for (; i + V::lanes <= width; i += V::lanes) {
+		const auto px = V::load(pixels + i);
+		auto r = V::and_(V::srl(px, p.rs), ff);
+		auto g = V::and_(V::srl(px, p.gs), ff);
+		auto b = V::and_(V::srl(px, p.bs), ff);
+		const auto a = V::and_(V::srl(px, p.as), ff);
+
+		if (p.apply_saturation) {
+			// 38470 doesn't fit in a signed 16 bit multiplier
+			auto lum = V::add(V::mul16(r, V::set1(19595)), V::slli<1>(V::mul16(g, V::set1(19235))));
+			lum = V::srli<16>(V::add(lum, V::mul16(b, V::set1(7471))));
+			const auto lum_scaled = V::slli<10>(lum);
+
+			r = V::clamp255(V::srai<10>(V::add(lum_scaled, V::mul16(V::sub(r, lum), sat))));
+			g = V::clamp255(V::srai<10>(V::add(lum_scaled, V::mul16(V::sub(g, lum), sat))));
+			b = V::clamp255(V::srai<10>(V::add(lum_scaled, V::mul16(V::sub(b, lum), sat))));
+		}
+
+		if (p.apply_tone) {
+			r = HardLight(r, p.red);
+			g = HardLight(g, p.green);
+			b = HardLight(b, p.blue);
+
+			if (p.premultiplied) {
+				r = Div255(V::mul16(r, a));
+				g = Div255(V::mul16(g, a));
+				b = Div255(V::mul16(b, a));
+			}
+		}
+
+		auto res = V::or_(V::or_(V::sll(r, p.rs), V::sll(g, p.gs)), V::or_(V::sll(b, p.bs), V::sll(a, p.as)));
+		if (p.skip_transparent) {
+			res = V::select(V::cmpeq(a, zero), px, res);
+		}
+		V::store(pixels + i, res);
+	}
+
+	ScalarToneRow(pixels + i, width - i, p);
+}
+
+static void HueRow(uint32_t* pixels, int width, int hue) {
+	const auto ff = V::set1(0xFF);
+	const auto zero = V::set1(0);
+	const auto one = V::set1(1);
+
+	int i = 0;
+	for (; i + V::lanes <= width; i += V::lanes) {
+		const auto px = V::load(pixels + i);
+		const auto r = V::srli<24>(px);
+		const auto g = V::and_(V::srli<16>(px), ff);
+		const auto b = V::and_(V::srli<8>(px), ff);
+		const auto a = V::and_(px, ff);
+
+		// RGB to HSL, see RGB_to_HSL
+		const auto max = V::max(r, V::max(g, b));
+		const auto min = V::min(r, V::min(g, b));
+		const auto c = V::sub(max, min);
+		const auto l2 = V::add(max, min);
+
+		// Same case selection as RGB_to_HSL when channels are equal
+		const auto r_gt_g = V::cmpgt(r, g);
+		const auto r_gt_b = V::cmpgt(r, b);
+		const auto r_lt_b = V::cmpgt(b, r);
+		const auto g_gt_b = V::cmpgt(g, b);
+		const auto g_lt_b = V::cmpgt(b, g);
+		const auto red_max = V::and_(r_gt_g, r_gt_b);
+		const auto blue_max = V::or_(V::andnot(r_gt_b, r_gt_g), V::andnot(V::or_(r_gt_g, g_gt_b), r_lt_b));
+
+		const auto n = V::select(red_max, V::sub(g, b), V::select(blue_max, V::sub(r, g), V::sub(b, r)));
+		const auto offset = V::select(red_max, V::and_(g_lt_b, V::set1(0x600)),
+				V::select(blue_max, V::set1(0x400), V::set1(0x200)));
+		const auto c_zero = V::cmpeq(c, zero);
+		auto h = DivTrunc(V::slli<8>(n), V::select(c_zero, one, c));
+		h = V::andnot(c_zero, V::add(h, offset));
+
+		const auto l2_high = V::cmpgt(l2, ff);
+		const auto l2_zero = V::cmpeq(l2, zero);
+		const auto div = V::select(l2_high, V::sub(V::set1(0x1FF), l2), V::select(l2_zero, one, l2));
+		auto s = V::andnot(l2_zero, DivTrunc(V::slli<8>(c), div));
+		const auto l = V::srli<1>(l2);
+
+		// See HSL_adjust
+		h = V::add(h, V::set1(hue));
+		h = V::select(V::cmpgt(h, V::set1(0x5FF)), V::sub(h, V::set1(0x600)), h);
+		s = V::min(s, ff);
+
+		// HSL to RGB, see HSL_to_RGB
+		const auto ll2 = V::slli<1>(l);
+		const auto cc = V::srli<8>(V::mul16(s, V::select(V::cmpgt(ll2, ff), V::sub(V::set1(0x1FF), ll2), ll2)));
+		const auto m = V::srli<1>(V::sub(ll2, cc));
+		const auto h0 = V::and_(h, ff);
+		const auto h1 = V::sub(ff, h0);
+		const auto mc = V::add(m, cc);
+		const auto m0 = V::add(m, V::srli<8>(V::mul16(h0, cc)));
+		const auto m1 = V::add(m, V::srli<8>(V::mul16(h1, cc)));
+		const auto sector = V::srli<8>(h);
+
+		// Other sectors keep the color
+		auto nr = r;
+		auto ng = g;
+		auto nb = b;
+		SelectSector(sector, 0, nr, ng, nb, mc, m0, m);
+		SelectSector(sector, 1, nr, ng, nb, m1, mc, m);
+		SelectSector(sector, 2, nr, ng, nb, m, mc, m0);
+		SelectSector(sector, 3, nr, ng, nb, m, m1, mc);
+		SelectSector(sector, 4, nr, ng, nb, m0, m, mc);
+		SelectSector(sector, 5, nr, ng, nb, mc, m, m1);
+
+		auto res = V::or_(V::or_(V::slli<24>(nr), V::slli<16>(ng)), V::or_(V::slli<8>(nb), a));
+		res = V::select(V::cmpeq(a, zero), px, res);
+		V::store(pixels + i, res);
+	}
+
+	ScalarHueRow(pixels + i, width - i, hue);
+}
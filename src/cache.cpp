@@ -20,6 +20,8 @@
 #  pragma warning(disable: 4003)
 #endif
 
+#include <algorithm>
+#include <cmath>
 #include <map>
 #include <tuple>
 #include <chrono>
@@ -35,6 +37,8 @@
 #include "player.h"
 #include <lcf/data.h>
 #include "game_clock.h"
+#include "worker_pool.h"
+#include "instrumentation.h"
 
 using namespace std::chrono_literals;
 
@@ -84,6 +88,10 @@ namespace {
 	using effect_key_type = std::tuple<BitmapRef, Rect, bool, bool, Tone, Color>;
 	std::map<effect_key_type, std::weak_ptr<Bitmap>> cache_effects;
 
+	// windowskin, right
+	using arrow_key_type = std::tuple<BitmapRef, bool>;
+	std::map<arrow_key_type, std::weak_ptr<Bitmap>> cache_arrows;
+
 	std::string system_name;
 
 	std::string system2_name;
@@ -91,6 +99,13 @@ namespace {
 	constexpr int cache_limit = 10 * 1024 * 1024;
 	size_t cache_size = 0;
 
+	Cache::Stats stats;
+
+	// Keys of images currently decoded by LoadBitmapAsync
+	std::unordered_map<key_type, int> pending_keys;
+	// Incremented by Clear, decoding jobs started before are not cached
+	int clear_count = 0;
+
 	void FreeBitmapMemory() {
 		auto cur_ticks = Game_Clock::GetFrameTime();
 
@@ -234,6 +249,12 @@ namespace {
 		return s.dummy_renderer();
 	}
 
+	uint32_t GetBitmapFlags(Material::Type type) {
+		return Bitmap::Flag_ReadOnly | (
+				type == Material::Chipset ? Bitmap::Flag_Chipset :
+				type == Material::System ? Bitmap::Flag_System : 0);
+	}
+
 	template<Material::Type T>
 	BitmapRef LoadBitmap(StringView filename, bool transparent) {
 		static_assert(Material::REND < T && T < Material::END, "Invalid material.");
@@ -254,6 +275,8 @@ namespace {
 			}
 
 			if (!bmp) {
+				EP_INSTRUMENT_SCOPE("Cache::LoadBitmap");
+				++stats.misses;
 				auto is = FileFinder::OpenImage(s.directory, filename);
 
 				FreeBitmapMemory();
@@ -266,10 +289,7 @@ namespace {
 						bmp = CreateEmpty<T>();
 					}
 				} else {
-					auto flags = Bitmap::Flag_ReadOnly | (
-							T == Material::Chipset ? Bitmap::Flag_Chipset :
-							T == Material::System ? Bitmap::Flag_System : 0);
-					bmp = Bitmap::Create(std::move(is), transparent, flags);
+					bmp = Bitmap::Create(std::move(is), transparent, GetBitmapFlags(T));
 					if (!bmp) {
 						Output::Warning("Invalid image: {}/{}", s.directory, filename);
 					}
@@ -283,6 +303,7 @@ namespace {
 
 			bmp = AddToCache(key, bmp);
 		} else {
+			++stats.hits;
 			it->second.last_access = Game_Clock::GetFrameTime();
 			bmp = it->second.bitmap;
 		}
@@ -321,6 +342,89 @@ namespace {
 
 std::vector<uint8_t> Cache::exfont_custom;
 
+bool Cache::LoadBitmapAsync(StringView folder_name, StringView filename, std::function<void(BitmapRef)> on_loaded) {
+	auto spec_it = std::find_if(std::begin(spec), std::end(spec), [&](const Spec& s) {
+		return folder_name == s.directory;
+	});
+	if (spec_it == std::end(spec)) {
+		return false;
+	}
+
+	return LoadBitmapAsync(folder_name, filename, spec_it->transparent, std::move(on_loaded));
+}
+
+bool Cache::LoadBitmapAsync(StringView folder_name, StringView filename, bool transparent, std::function<void(BitmapRef)> on_loaded) {
+	if (!WorkerPool::IsEnabled() || filename == CACHE_DEFAULT_BITMAP) {
+		return false;
+	}
+
+	auto spec_it = std::find_if(std::begin(spec), std::end(spec), [&](const Spec& s) {
+		return folder_name == s.directory;
+	});
+	if (spec_it == std::end(spec)) {
+		return false;
+	}
+	const Spec& s = *spec_it;
+	const auto type = static_cast<Material::Type>(spec_it - std::begin(spec));
+
+	auto key = MakeHashKey(s.directory, filename, transparent);
+	if (cache.find(key) != cache.end()) {
+		return false;
+	}
+
+	auto on_done = [key, on_loaded = std::move(on_loaded), generation = clear_count]() {
+		auto pending_it = pending_keys.find(key);
+		if (generation == clear_count && pending_it != pending_keys.end() && --pending_it->second == 0) {
+			pending_keys.erase(pending_it);
+		}
+
+		auto it = cache.find(key);
+		on_loaded(it != cache.end() ? it->second.bitmap : BitmapRef());
+	};
+
+	auto pending_it = pending_keys.find(key);
+	if (pending_it != pending_keys.end()) {
+		// Already decoding: Callbacks run in submission order, the image is cached when this one runs
+		++pending_it->second;
+		WorkerPool::Submit([]() {}, std::move(on_done));
+		return true;
+	}
+
+	// The file lookup is not thread-safe, only the decoding happens in the worker
+	auto is = FileFinder::OpenImage(s.directory, filename);
+	if (!is) {
+		// Reported by LoadBitmap when the image is requested
+		return false;
+	}
+
+	auto stream = std::make_shared<Filesystem_Stream::InputStream>(std::move(is));
+	auto bmp = std::make_shared<BitmapRef>();
+	const uint32_t flags = GetBitmapFlags(type);
+
+	pending_keys[key] = 1;
+
+	WorkerPool::Submit([stream, bmp, transparent, flags]() {
+		EP_INSTRUMENT_SCOPE("Cache::DecodeBitmap");
+		*bmp = Bitmap::Create(std::move(*stream), transparent, flags);
+	}, [key, bmp, on_done = std::move(on_done), generation = clear_count]() {
+		// Invalid images are not cached, LoadBitmap reports them.
+		// After a Clear the image can belong to a different game.
+		if (*bmp && generation == clear_count && cache.find(key) == cache.end()) {
+			FreeBitmapMemory();
+			AddToCache(key, std::move(*bmp));
+		}
+		on_done();
+	});
+
+	return true;
+}
+
+const Cache::Stats& Cache::GetStats() {
+	stats.entries = static_cast<int>(cache.size());
+	stats.bytes = cache_size;
+	return stats;
+}
+
 BitmapRef Cache::Backdrop(StringView file) {
 	return LoadBitmap<Material::Backdrop>(file);
 }
@@ -455,47 +559,38 @@ BitmapRef Cache::SpriteEffect(const BitmapRef& src_bitmap, const Rect& rect, boo
 	const auto it = cache_effects.find(key);
 
 	if (it == cache_effects.end() || it->second.expired()) {
-		BitmapRef bitmap_effects;
+		assert((tone != Tone() || blend != Color() || flip_x || flip_y) && "Effect cache used but no effect applied!");
 
-		auto create = [&rect] () -> BitmapRef {
-			return Bitmap::Create(rect.width, rect.height, true);
-		};
+		BitmapRef bitmap_effects = Bitmap::Create(rect.width, rect.height, true);
+		bitmap_effects->SpriteEffectBlit(*src_bitmap, rect, flip_x, flip_y, tone, blend);
 
-		if (tone != Tone()) {
-			bitmap_effects = create();
-			bitmap_effects->ToneBlit(0, 0, *src_bitmap, rect, tone, Opacity::Opaque());
-		}
+		return(cache_effects[key] = bitmap_effects).lock();
+	} else { return it->second.lock(); }
+}
 
-		if (blend != Color()) {
-			if (bitmap_effects) {
-				// Tone blit was applied
-				bitmap_effects->BlendBlit(0, 0, *bitmap_effects, bitmap_effects->GetRect(), blend, Opacity::Opaque());
-			} else {
-				bitmap_effects = create();
-				bitmap_effects->BlendBlit(0, 0, *src_bitmap, rect, blend, Opacity::Opaque());
-			}
-		}
+BitmapRef Cache::WindowArrow(const BitmapRef& windowskin, bool right) {
+	const arrow_key_type key { windowskin, right };
 
-		if (flip_x || flip_y) {
-			if (bitmap_effects) {
-				// Tone or blend blit was applied
-				bitmap_effects->Flip(flip_x, flip_y);
-			} else {
-				bitmap_effects = create();
-				bitmap_effects->FlipBlit(rect.x, rect.y, *src_bitmap, rect, flip_x, flip_y, Opacity::Opaque());
-			}
-		}
+	const auto it = cache_arrows.find(key);
 
-		assert(bitmap_effects && "Effect cache used but no effect applied!");
+	if (it == cache_arrows.end() || it->second.expired()) {
+		// The rotation maps the 16x8 glyph exactly onto a 8x16 rectangle
+		BitmapRef bitmap = Bitmap::Create(8, 16);
+		bitmap->Clear();
+		bitmap->RotateZoomOpacityBlit(0, 0, 16, 0, *windowskin, Rect(40, right ? 16 : 8, 16, 8), -M_PI / 2, 1.0, 1.0, 255);
 
-		return(cache_effects[key] = bitmap_effects).lock();
+		return(cache_arrows[key] = bitmap).lock();
 	} else { return it->second.lock(); }
 }
 
 void Cache::Clear() {
 	cache_effects.clear();
+	cache_arrows.clear();
 	cache.clear();
 	cache_size = 0;
+	// Decoding jobs could have been cancelled, start new ones on the next request
+	pending_keys.clear();
+	++clear_count;
 
 	for (auto& kv : cache_tiles) {
 		auto& key = kv.first;
@@ -19,6 +19,7 @@
 #define EP_CACHE_H
 
 // Headers
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -57,6 +58,58 @@ namespace Cache {
 	BitmapRef Tile(StringView filename, int tile_id);
 	BitmapRef SpriteEffect(const BitmapRef& src_bitmap, const Rect& rect, bool flip_x, bool flip_y, const Tone& tone, const Color& blend);
 
+	/**
+	 * Returns the left or right scroll arrow of a window, which is the up
+	 * or down arrow of the windowskin rotated by 90 degrees.
+	 * The arrows are shared by all windows using the windowskin.
+	 *
+	 * @param windowskin system graphic of the window
+	 * @param right right arrow instead of left arrow
+	 * @return 8x16 arrow bitmap
+	 */
+	BitmapRef WindowArrow(const BitmapRef& windowskin, bool right);
+
+	/**
+	 * Decodes an image on a worker thread and adds it to the cache.
+	 * The image is decoded with the default transparency of the folder.
+	 *
+	 * @param folder_name material folder of the image
+	 * @param filename image to decode
+	 * @param on_loaded invoked on the main thread with the cached image, or nullptr for invalid images
+	 *   and when the cache was cleared while decoding
+	 * @return false when nothing was queued: the image is cached already,
+	 *   not found or background decoding is not supported. on_loaded is not invoked.
+	 */
+	bool LoadBitmapAsync(StringView folder_name, StringView filename, std::function<void(BitmapRef)> on_loaded);
+
+	/**
+	 * Decodes an image on a worker thread and adds it to the cache.
+	 * Like LoadBitmapAsync above but with explicit transparency, e.g. for Pictures
+	 * shown without a transparent color.
+	 *
+	 * @param folder_name material folder of the image
+	 * @param filename image to decode
+	 * @param transparent whether the image uses a transparent color
+	 * @param on_loaded see above
+	 * @return see above
+	 */
+	bool LoadBitmapAsync(StringView folder_name, StringView filename, bool transparent, std::function<void(BitmapRef)> on_loaded);
+
+	/** Lookup statistics of the bitmap cache */
+	struct Stats {
+		/** Bitmaps returned from the cache */
+		int hits = 0;
+		/** Bitmaps decoded on the main thread because they were not cached */
+		int misses = 0;
+		/** Number of cached bitmaps */
+		int entries = 0;
+		/** Memory used by the cached bitmaps */
+		size_t bytes = 0;
+	};
+
+	/** @return lookup statistics since startup and the current cache size */
+	const Stats& GetStats();
+
 	void Clear();
 	void ClearAll();
 
@@ -0,0 +1,230 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include "damage_tracker.h"
+#include "bitmap.h"
+
+namespace {
+	// More rects than this are merged into their bounding rect
+	constexpr size_t max_unmerged_rects = 64;
+
+	uint64_t Mix(uint64_t x) {
+		// splitmix64 finalizer
+		x += 0x9E3779B97F4A7C15ULL;
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+		return x ^ (x >> 31);
+	}
+
+	int64_t Area(const Rect& rect) {
+		return rect.IsEmpty() ? 0 : static_cast<int64_t>(rect.width) * rect.height;
+	}
+
+	Rect Union(const Rect& l, const Rect& r) {
+		const int x1 = std::min(l.x, r.x);
+		const int y1 = std::min(l.y, r.y);
+		const int x2 = std::max(l.x + l.width, r.x + r.width);
+		const int y2 = std::max(l.y + l.height, r.y + r.height);
+		return Rect(x1, y1, x2 - x1, y2 - y1);
+	}
+}
+
+constexpr size_t DamageTracker::max_rects;
+
+DrawHash& DrawHash::Add(uint64_t value) {
+	hash = Mix(hash ^ value);
+	return *this;
+}
+
+DrawHash& DrawHash::Add(int value) {
+	return Add(static_cast<uint64_t>(static_cast<uint32_t>(value)));
+}
+
+DrawHash& DrawHash::Add(double value) {
+	uint64_t bits;
+	static_assert(sizeof(bits) == sizeof(value), "Unexpected double size");
+	std::memcpy(&bits, &value, sizeof(bits));
+	return Add(bits);
+}
+
+DrawHash& DrawHash::Add(const Rect& rect) {
+	return Add(rect.x).Add(rect.y).Add(rect.width).Add(rect.height);
+}
+
+DrawHash& DrawHash::Add(const Color& color) {
+	return Add(static_cast<int>(color.red)).Add(static_cast<int>(color.green))
+		.Add(static_cast<int>(color.blue)).Add(static_cast<int>(color.alpha));
+}
+
+DrawHash& DrawHash::Add(const Tone& tone) {
+	return Add(tone.red).Add(tone.green).Add(tone.blue).Add(tone.gray);
+}
+
+DrawHash& DrawHash::Add(const BitmapRef& bitmap) {
+	Add(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(bitmap.get())));
+	return Add(bitmap ? bitmap->GetRevision() : 0);
+}
+
+const std::vector<Rect>& DamageTracker::Update(uint64_t key, const Rect& screen, const std::vector<Entry>& entries) {
+	const bool full = invalid || key != frame_key || screen != screen_rect;
+	invalid = false;
+	frame_key = key;
+	screen_rect = screen;
+
+	damage.clear();
+	current.clear();
+	for (const auto& entry : entries) {
+		current[entry.id] = entry;
+	}
+
+	if (full) {
+		AddDamage(screen);
+	} else {
+		for (const auto& entry : entries) {
+			auto it = previous.find(entry.id);
+			if (it == previous.end()) {
+				AddDamage(entry.bounds);
+				continue;
+			}
+
+			const auto& prev = it->second;
+			if (prev.hash != entry.hash || prev.bounds != entry.bounds) {
+				AddDamage(prev.bounds);
+				AddDamage(entry.bounds);
+			}
+		}
+
+		for (const auto& prev : previous) {
+			if (current.find(prev.first) == current.end()) {
+				AddDamage(prev.second.bounds);
+			}
+		}
+
+		MergeDamage();
+	}
+
+	std::swap(previous, current);
+
+	// Averaged over roughly one second
+	const double ratio = screen.IsEmpty() ? 0.0 : static_cast<double>(GetArea(damage)) / Area(screen);
+	redraw_ratio += (ratio - redraw_ratio) / 60.0;
+
+	return damage;
+}
+
+Rect DamageTracker::GetDamageBounds() const {
+	if (damage.empty()) {
+		return {};
+	}
+
+	Rect bounds = damage.front();
+	for (const auto& rect : damage) {
+		bounds = Union(bounds, rect);
+	}
+	return bounds;
+}
+
+void DamageTracker::AddDamage(Rect rect) {
+	rect.Adjust(screen_rect);
+	if (!rect.IsEmpty()) {
+		damage.push_back(rect);
+	}
+}
+
+void DamageTracker::MergeDamage() {
+	if (damage.size() > max_unmerged_rects) {
+		damage = { GetDamageBounds() };
+		return;
+	}
+
+	// Merge when the union covers no more pixels than both rects
+	bool merged = true;
+	while (merged) {
+		merged = false;
+		for (size_t i = 0; i < damage.size() && !merged; ++i) {
+			for (size_t j = i + 1; j < damage.size(); ++j) {
+				const Rect rect = Union(damage[i], damage[j]);
+				if (Area(rect) <= Area(damage[i]) + Area(damage[j])) {
+					damage[i] = rect;
+					damage.erase(damage.begin() + j);
+					merged = true;
+					break;
+				}
+			}
+		}
+	}
+
+	// Merge the pairs adding the fewest pixels until the limit is reached
+	while (damage.size() > max_rects) {
+		size_t best_i = 0;
+		size_t best_j = 1;
+		int64_t best_cost = INT64_MAX;
+		for (size_t i = 0; i < damage.size(); ++i) {
+			for (size_t j = i + 1; j < damage.size(); ++j) {
+				const int64_t cost = Area(Union(damage[i], damage[j])) - Area(damage[i]) - Area(damage[j]);
+				if (cost < best_cost) {
+					best_cost = cost;
+					best_i = i;
+					best_j = j;
+				}
+			}
+		}
+		damage[best_i] = Union(damage[best_i], damage[best_j]);
+		damage.erase(damage.begin() + best_j);
+	}
+}
+
+int64_t DamageTracker::GetArea(const std::vector<Rect>& rects) {
+	// Sweep over the x edges and sum up the covered y spans between them
+	std::vector<int> xs;
+	for (const auto& rect : rects) {
+		if (!rect.IsEmpty()) {
+			xs.push_back(rect.x);
+			xs.push_back(rect.x + rect.width);
+		}
+	}
+	std::sort(xs.begin(), xs.end());
+	xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+
+	int64_t area = 0;
+	std::vector<std::pair<int, int>> spans;
+	for (size_t i = 0; i + 1 < xs.size(); ++i) {
+		spans.clear();
+		for (const auto& rect : rects) {
+			if (!rect.IsEmpty() && rect.x <= xs[i] && rect.x + rect.width >= xs[i + 1]) {
+				spans.emplace_back(rect.y, rect.y + rect.height);
+			}
+		}
+		std::sort(spans.begin(), spans.end());
+
+		int64_t covered = 0;
+		int end = INT_MIN;
+		for (const auto& span : spans) {
+			if (span.second <= end) {
+				continue;
+			}
+			covered += span.second - std::max(span.first, end);
+			end = span.second;
+		}
+		area += covered * (xs[i + 1] - xs[i]);
+	}
+	return area;
+}
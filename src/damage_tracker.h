@@ -0,0 +1,134 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_DAMAGE_TRACKER_H
+#define EP_DAMAGE_TRACKER_H
+
+// Headers
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "color.h"
+#include "memory_management.h"
+#include "rect.h"
+#include "tone.h"
+
+/**
+ * Builds the hash of a Drawable::DrawState.
+ * Every value influencing the drawn pixels must be added.
+ */
+class DrawHash {
+public:
+	DrawHash() = default;
+	explicit DrawHash(uint64_t seed);
+
+	DrawHash& Add(uint64_t value);
+	DrawHash& Add(int value);
+	DrawHash& Add(double value);
+	DrawHash& Add(const Rect& rect);
+	DrawHash& Add(const Color& color);
+	DrawHash& Add(const Tone& tone);
+	/** Adds the identity and the revision of the bitmap */
+	DrawHash& Add(const BitmapRef& bitmap);
+
+	uint64_t Get() const;
+
+private:
+	uint64_t hash = 0;
+};
+
+/**
+ * Compares the drawables of consecutive frames and calculates the parts of
+ * the screen that must be redrawn.
+ */
+class DamageTracker {
+public:
+	struct Entry {
+		/** Identity of the drawable */
+		const void* id = nullptr;
+		/** Screen area touched by the drawable */
+		Rect bounds;
+		/** Hash of everything influencing the drawn pixels */
+		uint64_t hash = 0;
+	};
+
+	/** Damages the whole screen in the next Update. */
+	void Invalidate();
+
+	/**
+	 * Compares the entries against the entries of the previous call.
+	 * Changed entries damage their old and new bounds, added and removed
+	 * entries damage their bounds.
+	 *
+	 * @param key hash of everything else influencing the frame, a change damages the whole screen
+	 * @param screen screen rect
+	 * @param entries all visible drawables of the frame
+	 * @return damaged rects, can overlap. Empty when nothing changed.
+	 */
+	const std::vector<Rect>& Update(uint64_t key, const Rect& screen, const std::vector<Entry>& entries);
+
+	/** @return damaged rects of the last Update */
+	const std::vector<Rect>& GetDamage() const;
+
+	/** @return bounding rect of the damaged rects of the last Update */
+	Rect GetDamageBounds() const;
+
+	/** @return average part of the screen that was redrawn, from 0.0 to 1.0 */
+	double GetRedrawRatio() const;
+
+	/**
+	 * @param rects rectangles
+	 * @return amount of pixels covered by the rectangles, overlaps are counted once
+	 */
+	static int64_t GetArea(const std::vector<Rect>& rects);
+
+	/** More damaged rects than this are merged */
+	static constexpr size_t max_rects = 8;
+
+private:
+	void AddDamage(Rect rect);
+	void MergeDamage();
+
+	std::unordered_map<const void*, Entry> previous;
+	std::unordered_map<const void*, Entry> current;
+	std::vector<Rect> damage;
+	Rect screen_rect;
+	uint64_t frame_key = 0;
+	bool invalid = true;
+	double redraw_ratio = 1.0;
+};
+
+inline DrawHash::DrawHash(uint64_t seed) : hash(seed) {
+}
+
+inline uint64_t DrawHash::Get() const {
+	return hash;
+}
+
+inline const std::vector<Rect>& DamageTracker::GetDamage() const {
+	return damage;
+}
+
+inline double DamageTracker::GetRedrawRatio() const {
+	return redraw_ratio;
+}
+
+inline void DamageTracker::Invalidate() {
+	invalid = true;
+}
+
+#endif
@@ -20,6 +20,7 @@
 
 #include <cstdint>
 #include <memory>
+#include "rect.h"
 
 class Bitmap;
 class Drawable;
@@ -57,6 +58,48 @@ public:
 
 	virtual void Draw(Bitmap& dst) = 0;
 
+	/** @return name of the drawable type shown in traces */
+	virtual const char* GetTypeName() const { return "Drawable"; }
+
+	/** Describes the output of Draw, used to only redraw the changed parts of the screen */
+	struct DrawState {
+		/** Area of the screen touched by Draw */
+		Rect bounds;
+		/** Hash of everything influencing the drawn pixels, see DrawHash */
+		uint64_t hash = 0;
+	};
+
+	/**
+	 * Reports what the next Draw call will render.
+	 * The default returns false which redraws the whole screen every frame.
+	 * Subclasses overriding Draw must override this as well.
+	 *
+	 * @param dst bitmap Draw will render to
+	 * @param state receives bounds and hash
+	 * @return whether the state is known
+	 */
+	virtual bool GetDrawState(const Bitmap& dst, DrawState& state) const;
+
+	/**
+	 * Performs all lazy updates of the next Draw call on the main thread,
+	 * afterwards DrawClipped renders the drawable band by band in parallel.
+	 * The default returns false which renders with Draw on the main thread.
+	 * Subclasses overriding Draw must override this as well.
+	 *
+	 * @param dst bitmap the drawable will be rendered to
+	 * @return whether DrawClipped is supported
+	 */
+	virtual bool PrepareDraw(const Bitmap& dst);
+
+	/**
+	 * Renders the state captured by PrepareDraw.
+	 * Invoked concurrently for different bands and must not modify the drawable.
+	 *
+	 * @param dst bitmap clipped to the band
+	 * @param clip bounds of the band, only used for culling
+	 */
+	virtual void DrawClipped(Bitmap& dst, const Rect& clip) const;
+
 	Z_t GetZ() const;
 
 	void SetZ(Z_t z);
@@ -117,6 +160,17 @@ inline Drawable::Drawable(Z_t z, Flags flags)
 {
 }
 
+inline bool Drawable::GetDrawState(const Bitmap&, DrawState&) const {
+	return false;
+}
+
+inline bool Drawable::PrepareDraw(const Bitmap&) {
+	return false;
+}
+
+inline void Drawable::DrawClipped(Bitmap&, const Rect&) const {
+}
+
 inline Drawable::Z_t Drawable::GetZ() const {
 	return _z;
 }
@@ -18,6 +18,8 @@
 // Headers
 #include "drawable_list.h"
 #include "drawable_mgr.h"
+#include "instrumentation.h"
+#include "worker_pool.h"
 #include <algorithm>
 #include <cassert>
 
@@ -106,8 +108,53 @@ void DrawableList::Draw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z) {
 			break;
 		}
 		if (drawable->IsVisible()) {
+			EP_INSTRUMENT_SCOPE(Instrumentation::IsTracing() ? drawable->GetTypeName() : nullptr);
 			drawable->Draw(dst);
 		}
 	}
 }
 
+void DrawableList::Draw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z, const std::vector<Band>& bands) {
+	if (IsDirty()) {
+		Sort();
+	} else {
+		assert(IsSorted());
+	}
+
+	// Consecutive drawables supporting bands are drawn with one parallel pass
+	std::vector<Drawable*> batch;
+	auto flush = [&]() {
+		if (batch.empty()) {
+			return;
+		}
+		EP_INSTRUMENT_SCOPE("DrawableList::DrawBands");
+		WorkerPool::Parallel(static_cast<int>(bands.size()), [&](int i) {
+			for (auto* drawable : batch) {
+				drawable->DrawClipped(*bands[i].bitmap, bands[i].rect);
+			}
+		});
+		batch.clear();
+	};
+
+	for (auto* drawable : _list) {
+		auto z = drawable->GetZ();
+		if (z < min_z) {
+			continue;
+		}
+		if (z > max_z) {
+			break;
+		}
+		if (!drawable->IsVisible()) {
+			continue;
+		}
+		if (drawable->PrepareDraw(dst)) {
+			batch.push_back(drawable);
+		} else {
+			flush();
+			EP_INSTRUMENT_SCOPE(Instrumentation::IsTracing() ? drawable->GetTypeName() : nullptr);
+			drawable->Draw(dst);
+		}
+	}
+	flush();
+}
+
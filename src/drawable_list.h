@@ -19,6 +19,7 @@
 #define EP_DRAWABLE_LIST_H
 
 #include "drawable.h"
+#include "memory_management.h"
 #include <memory>
 #include <vector>
 #include <limits>
@@ -131,6 +132,26 @@ class DrawableList {
 		 */
 		void Draw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z);
 
+		/** A horizontal stripe of the screen drawn by one thread */
+		struct Band {
+			/** Shares the pixels of the screen, clipped to the band */
+			BitmapRef bitmap;
+			/** Bounds of the band */
+			Rect rect;
+		};
+
+		/**
+		 * Like Draw but drawables supporting PrepareDraw are rendered into
+		 * all bands in parallel. Other drawables are drawn onto dst on the
+		 * main thread, the Z order is preserved.
+		 *
+		 * @param dst The bitmap to draw onto
+		 * @param min_z Skip any drawables with z < min_z
+		 * @param max_z Skip any drawables with z > max_z
+		 * @param bands The bands of dst
+		 */
+		void Draw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z, const std::vector<Band>& bands);
+
 	private:
 		std::vector<Drawable*> _list;
 		bool _dirty = false;
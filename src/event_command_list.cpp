@@ -0,0 +1,148 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include "event_command_list.h"
+
+const EventCommandList::JumpTable& EventCommandList::GetJumpTable() const {
+	if (jump_table) {
+		return *jump_table;
+	}
+
+	jump_table.reset(new JumpTable());
+	auto& table = *jump_table;
+	const int n = size();
+	table.block_end.resize(n, n);
+	table.loop_start.resize(n, -1);
+	table.next_end_loop.resize(n, n);
+
+	// Next command with a lower indentation and the next EndLoop
+	std::vector<int> lower;
+	int next_end_loop = n;
+	for (int i = n - 1; i >= 0; --i) {
+		const auto& com = commands[i];
+		while (!lower.empty() && commands[lower.back()].indent >= com.indent) {
+			lower.pop_back();
+		}
+		table.block_end[i] = lower.empty() ? n : lower.back();
+		lower.push_back(i);
+
+		table.next_end_loop[i] = next_end_loop;
+		if (static_cast<Cmd>(com.code) == Cmd::EndLoop) {
+			next_end_loop = i;
+		}
+	}
+
+	// Last Loop command per indentation that is reachable backwards
+	// without passing a command with a lower indentation
+	std::vector<std::pair<int, int>> loops;
+	int min_indent = 0;
+	for (int i = 0; i < n; ++i) {
+		const auto& com = commands[i];
+		const int indent = com.indent;
+
+		while (!loops.empty() && loops.back().first > indent) {
+			loops.pop_back();
+		}
+
+		switch (static_cast<Cmd>(com.code)) {
+			case Cmd::Loop:
+				if (!loops.empty() && loops.back().first == indent) {
+					loops.back().second = i;
+				} else {
+					loops.emplace_back(indent, i);
+				}
+				break;
+			case Cmd::EndLoop:
+				if (!loops.empty() && loops.back().first == indent) {
+					table.loop_start[i] = loops.back().second;
+				} else if (i == 0 || min_indent >= indent) {
+					// Nothing found before the start of the list
+					table.loop_start[i] = i;
+				}
+				break;
+			case Cmd::Label:
+				if (!com.parameters.empty()) {
+					table.labels.emplace_back(com.parameters[0], i);
+				}
+				break;
+			default:
+				break;
+		}
+		min_indent = i == 0 ? indent : std::min(min_indent, indent);
+	}
+
+	// Keep the first label for every id
+	std::stable_sort(table.labels.begin(), table.labels.end(), [](const auto& a, const auto& b) {
+		return a.first < b.first;
+	});
+	table.labels.erase(std::unique(table.labels.begin(), table.labels.end(), [](const auto& a, const auto& b) {
+		return a.first == b.first;
+	}), table.labels.end());
+
+	return table;
+}
+
+int EventCommandList::FindNext(int index, std::initializer_list<Cmd> codes, int indent) const {
+	const auto& table = GetJumpTable();
+	const int n = size();
+
+	for (++index; index < n;) {
+		const auto& com = commands[index];
+		if (com.indent > indent) {
+			// Skip the whole nested block
+			index = table.block_end[index];
+			continue;
+		}
+		if (std::find(codes.begin(), codes.end(), static_cast<Cmd>(com.code)) != codes.end()) {
+			break;
+		}
+		++index;
+	}
+	return std::min(index, n);
+}
+
+int EventCommandList::FindLoopStart(int index) const {
+	return GetJumpTable().loop_start[index];
+}
+
+int EventCommandList::FindNextEndLoop(int index) const {
+	return GetJumpTable().next_end_loop[index];
+}
+
+int EventCommandList::FindLabel(int label_id) const {
+	const auto& labels = GetJumpTable().labels;
+	auto it = std::lower_bound(labels.begin(), labels.end(), label_id, [](const auto& label, int id) {
+		return label.first < id;
+	});
+	if (it == labels.end() || it->first != label_id) {
+		return -1;
+	}
+	return it->second;
+}
+
+const ManiacPatch::Expression& EventCommandList::GetExpression(int index, int size_param) const {
+	const auto key = std::make_pair(index, size_param);
+	auto it = expressions.find(key);
+	if (it == expressions.end()) {
+		const auto& params = commands[index].parameters;
+		auto op_codes = MakeSpan(params).subspan(size_param + 1, params[size_param]);
+		it = expressions.emplace(key, ManiacPatch::CompileExpression(op_codes)).first;
+	}
+	return it->second;
+}
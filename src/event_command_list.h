@@ -0,0 +1,149 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_EVENT_COMMAND_LIST_H
+#define EP_EVENT_COMMAND_LIST_H
+
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <lcf/rpg/eventcommand.h>
+#include "event_profiler.h"
+#include "maniac_patch.h"
+
+/**
+ * Immutable list of event commands executed by the interpreter.
+ *
+ * The jump targets of branches, loops and labels are resolved once when
+ * the interpreter needs them for the first time, afterwards jumps don't
+ * scan the command list anymore. Maniac Patch expressions are compiled
+ * on first use as well.
+ */
+class EventCommandList {
+public:
+	using Cmd = lcf::rpg::EventCommand::Code;
+
+	EventCommandList() = default;
+	explicit EventCommandList(std::vector<lcf::rpg::EventCommand> commands, EventProfiler::Source source = {});
+
+	/** @return the event commands */
+	const std::vector<lcf::rpg::EventCommand>& GetCommands() const;
+
+	/** @return event the commands belong to */
+	const EventProfiler::Source& GetSource() const;
+
+	/** @return number of event commands */
+	int size() const;
+
+	/** @return true when there are no event commands */
+	bool empty() const;
+
+	const lcf::rpg::EventCommand& operator[](int index) const;
+
+	/**
+	 * Finds the first command after index with an indentation of at most
+	 * indent whose code is in codes.
+	 *
+	 * @param index index to search from (exclusive)
+	 * @param codes command codes to search for
+	 * @param indent maximum indentation
+	 * @return index of the command or size() when not found
+	 */
+	int FindNext(int index, std::initializer_list<Cmd> codes, int indent) const;
+
+	/**
+	 * Finds the Loop command belonging to an EndLoop command.
+	 *
+	 * @param index index of the EndLoop command
+	 * @return index of the Loop command, index when there is no Loop before
+	 *         the command or -1 when an outer block ends before a Loop is found
+	 */
+	int FindLoopStart(int index) const;
+
+	/**
+	 * Finds the first EndLoop command after index regardless of the indentation.
+	 *
+	 * @param index index to search from (exclusive)
+	 * @return index of the EndLoop command or size() when not found
+	 */
+	int FindNextEndLoop(int index) const;
+
+	/**
+	 * Finds the first Label command with the given label id.
+	 *
+	 * @param label_id label id
+	 * @return index of the Label command or -1 when not found
+	 */
+	int FindLabel(int label_id) const;
+
+	/**
+	 * Returns the compiled Maniac Patch expression of a command.
+	 *
+	 * @param index index of the command
+	 * @param size_param parameter holding the op code count, the op codes follow it
+	 * @return compiled expression
+	 */
+	const ManiacPatch::Expression& GetExpression(int index, int size_param) const;
+
+private:
+	struct JumpTable {
+		/** Index of the first following command with a lower indentation */
+		std::vector<int> block_end;
+		/** Index of the Loop command of EndLoop commands */
+		std::vector<int> loop_start;
+		/** Index of the next EndLoop command */
+		std::vector<int> next_end_loop;
+		/** Label id -> index of the first Label command, sorted by label id */
+		std::vector<std::pair<int, int>> labels;
+	};
+
+	const JumpTable& GetJumpTable() const;
+
+	std::vector<lcf::rpg::EventCommand> commands;
+	EventProfiler::Source source;
+	mutable std::unique_ptr<JumpTable> jump_table;
+	/** (command index, size parameter) -> compiled expression */
+	mutable std::map<std::pair<int, int>, ManiacPatch::Expression> expressions;
+};
+
+inline EventCommandList::EventCommandList(std::vector<lcf::rpg::EventCommand> commands, EventProfiler::Source source)
+	: commands(std::move(commands)), source(source) {
+}
+
+inline const EventProfiler::Source& EventCommandList::GetSource() const {
+	return source;
+}
+
+inline const std::vector<lcf::rpg::EventCommand>& EventCommandList::GetCommands() const {
+	return commands;
+}
+
+inline int EventCommandList::size() const {
+	return static_cast<int>(commands.size());
+}
+
+inline bool EventCommandList::empty() const {
+	return commands.empty();
+}
+
+inline const lcf::rpg::EventCommand& EventCommandList::operator[](int index) const {
+	return commands[index];
+}
+
+#endif
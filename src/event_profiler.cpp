@@ -0,0 +1,152 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <functional>
+#include <ostream>
+#include <tuple>
+#include <unordered_map>
+#include "event_profiler.h"
+#include "filefinder.h"
+#include "output.h"
+
+namespace {
+	struct Key {
+		int map_id;
+		int event_id;
+		int page_id;
+		int code;
+
+		bool operator==(const Key& o) const {
+			return map_id == o.map_id && event_id == o.event_id && page_id == o.page_id && code == o.code;
+		}
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key& k) const {
+			size_t h = std::hash<int>()(k.map_id);
+			for (int v: { k.event_id, k.page_id, k.code }) {
+				h = h * 31 + std::hash<int>()(v);
+			}
+			return h;
+		}
+	};
+
+	bool enabled = false;
+	std::unordered_map<Key, EventProfiler::Entry, KeyHash> entries;
+
+	EventProfiler::Entry& GetEntry(const EventProfiler::Source& source, int code) {
+		auto& entry = entries[{ source.map_id, source.event_id, source.page_id, code }];
+		entry.source = source;
+		entry.code = code;
+		return entry;
+	}
+}
+
+bool EventProfiler::IsEnabled() {
+	return enabled;
+}
+
+void EventProfiler::SetEnabled(bool enabled) {
+	::enabled = enabled;
+}
+
+void EventProfiler::Reset() {
+	entries.clear();
+}
+
+void EventProfiler::AddCommand(const Source& source, int code, Game_Clock::duration time) {
+	auto& entry = GetEntry(source, code);
+	++entry.count;
+	entry.time += time;
+}
+
+void EventProfiler::AddUpdate(const Source& source, Game_Clock::duration time) {
+	AddCommand(source, update_code, time);
+}
+
+void EventProfiler::AddLoopLimit(const Source& source, int code) {
+	++GetEntry(source, code).loop_limit_hits;
+}
+
+int EventProfiler::GetEntryCount() {
+	return static_cast<int>(entries.size());
+}
+
+std::vector<EventProfiler::Entry> EventProfiler::GetEntries() {
+	std::vector<Entry> result;
+	result.reserve(entries.size());
+	for (const auto& e: entries) {
+		result.push_back(e.second);
+	}
+
+	// Ties are ordered by source for a stable output
+	std::sort(result.begin(), result.end(), [](const Entry& a, const Entry& b) {
+		if (a.time != b.time) {
+			return a.time > b.time;
+		}
+		return std::make_tuple(a.source.map_id, a.source.event_id, a.source.page_id, a.code)
+			< std::make_tuple(b.source.map_id, b.source.event_id, b.source.page_id, b.code);
+	});
+	return result;
+}
+
+std::string EventProfiler::GetLabel(const Entry& entry) {
+	const auto& src = entry.source;
+	std::string label;
+	if (src.map_id > 0) {
+		label = fmt::format("M{}:E{}/{}", src.map_id, src.event_id, src.page_id);
+	} else if (src.event_id > 0) {
+		label = fmt::format("CE{}", src.event_id);
+	} else {
+		label = "Other";
+	}
+
+	if (entry.code == update_code) {
+		return label + " Update";
+	}
+	return fmt::format("{} #{}", label, entry.code);
+}
+
+void EventProfiler::WriteCsv(std::ostream& os) {
+	os << "map,event,page,command,count,time_us,loop_limit_hits\n";
+	for (const auto& entry: GetEntries()) {
+		const auto& src = entry.source;
+		os << fmt::format("{},{},{},{},{},{:.3f},{}\n",
+			src.map_id, src.event_id, src.page_id, entry.code, entry.count,
+			std::chrono::duration<double, std::micro>(entry.time).count(), entry.loop_limit_hits);
+	}
+}
+
+std::string EventProfiler::Dump() {
+	int index = 0;
+	std::string file;
+	do {
+		file = "profile_" + std::to_string(index++) + ".csv";
+	} while (FileFinder::Save().Exists(file));
+
+	auto os = FileFinder::Save().OpenOutputStream(file, std::ios_base::out | std::ios_base::trunc);
+	if (!os) {
+		Output::Warning("EventProfiler: Could not create {}", file);
+		return {};
+	}
+
+	WriteCsv(os);
+	Output::Info("Event profile written to {}", file);
+	return file;
+}
@@ -0,0 +1,128 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_EVENT_PROFILER_H
+#define EP_EVENT_PROFILER_H
+
+// Headers
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "game_clock.h"
+
+/**
+ * Execution profiler for event scripts.
+ *
+ * When enabled the interpreter accumulates the time, the number of
+ * executions and the loop limit hits of every command per event page.
+ * The map additionally records the whole update of every event, this
+ * includes the movement and the parallel interpreter of the event.
+ */
+namespace EventProfiler {
+	/** Identifies the event script a command belongs to */
+	struct Source {
+		/** Map of a map event, 0 for common events and other scripts */
+		int map_id = 0;
+		/** Map event id or common event id, 0 when unknown */
+		int event_id = 0;
+		/** Page of a map event, 0 for common events */
+		int page_id = 0;
+	};
+
+	/** Command code of the entries recording the whole update of an event */
+	constexpr int update_code = 0;
+
+	/** Accumulated data of one command of an event page */
+	struct Entry {
+		Source source;
+		/** Command code or update_code */
+		int code = 0;
+		/** Number of executions */
+		int64_t count = 0;
+		/** Total execution time */
+		Game_Clock::duration time = {};
+		/** How often the interpreter loop limit was reached on this command */
+		int64_t loop_limit_hits = 0;
+	};
+
+	/** @return whether data is recorded */
+	bool IsEnabled();
+
+	/**
+	 * Enables or disables the recording, the data is kept when disabled.
+	 *
+	 * @param enabled whether to record
+	 */
+	void SetEnabled(bool enabled);
+
+	/** Discards the recorded data */
+	void Reset();
+
+	/**
+	 * Records one execution of a command.
+	 *
+	 * @param source event of the command
+	 * @param code command code
+	 * @param time execution time
+	 */
+	void AddCommand(const Source& source, int code, Game_Clock::duration time);
+
+	/**
+	 * Records one update of an event.
+	 *
+	 * @param source event
+	 * @param time update time
+	 */
+	void AddUpdate(const Source& source, Game_Clock::duration time);
+
+	/**
+	 * Records that the interpreter loop limit was reached.
+	 *
+	 * @param source event the interpreter stopped in
+	 * @param code code of the command the interpreter stopped at
+	 */
+	void AddLoopLimit(const Source& source, int code);
+
+	/** @return number of recorded entries */
+	int GetEntryCount();
+
+	/** @return recorded entries, most expensive first */
+	std::vector<Entry> GetEntries();
+
+	/**
+	 * @param entry entry
+	 * @return short description of the event and the command of an entry
+	 */
+	std::string GetLabel(const Entry& entry);
+
+	/**
+	 * Writes the recorded entries as CSV, most expensive first.
+	 *
+	 * @param os output stream
+	 */
+	void WriteCsv(std::ostream& os);
+
+	/**
+	 * Writes the recorded entries to profile_N.csv in the save directory.
+	 *
+	 * @return name of the file or an empty string on failure
+	 */
+	std::string Dump();
+}
+
+#endif
@@ -152,6 +152,10 @@ bool Filesystem::MakeDirectory(StringView, bool) const {
 	return false;
 }
 
+bool Filesystem::Rename(StringView, StringView) const {
+	return false;
+}
+
 bool Filesystem::IsValid() const {
 	// FIXME: better way to do this?
 	return Exists("");
@@ -335,6 +339,11 @@ bool FilesystemView::MakeDirectory(StringView dir, bool follow_symlinks) const {
 	return fs->MakeDirectory(MakePath(dir), follow_symlinks);
 }
 
+bool FilesystemView::Rename(StringView from, StringView to) const {
+	assert(fs);
+	return fs->Rename(MakePath(from), MakePath(to));
+}
+
 bool FilesystemView::IsFeatureSupported(Filesystem::Feature f) const {
 	assert(fs);
 	return fs->IsFeatureSupported(f);
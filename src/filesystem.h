@@ -45,7 +45,9 @@ public:
 	/** Features provided by the filesystem */
 	enum class Feature {
 		/** Filesystem supports Write operations */
-		Write = 1
+		Write = 1,
+		/** Filesystem supports replacing files with Rename */
+		Rename = 2
 	};
 
 	virtual ~Filesystem() = default;
@@ -208,6 +210,7 @@ public:
 	virtual bool Exists(StringView path) const = 0;
 	virtual int64_t GetFilesize(StringView path) const = 0;
 	virtual bool MakeDirectory(StringView dir, bool follow_symlinks) const;
+	virtual bool Rename(StringView from, StringView to) const;
 	virtual bool IsFeatureSupported(Feature f) const;
 	virtual std::string Describe() const = 0;
 	/** @} */
@@ -438,6 +441,18 @@ public:
 	 */
 	bool MakeDirectory(StringView dir, bool follow_symlinks) const;
 
+	/**
+	 * Renames a file, an existing file at the target is replaced.
+	 * Only supported when the filesystem has Feature::Rename.
+	 * The directory cache is not updated, call ClearCache afterwards.
+	 * This allows the use from a background thread.
+	 *
+	 * @param from File to rename.
+	 * @param to New name of the file.
+	 * @return true when the file was renamed
+	 */
+	bool Rename(StringView from, StringView to) const;
+
 	/**
 	 * @param f Filesystem feature to check
 	 * @return true when the feature is supported.
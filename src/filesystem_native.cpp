@@ -16,10 +16,12 @@
  */
 
 #include "filesystem_native.h"
+#include "filesystem_stream.h"
 #include <cerrno>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 #include <fmt/core.h>
@@ -47,7 +49,24 @@ int64_t NativeFilesystem::GetFilesize(StringView path) const {
 	return Platform::File(ToString(path)).GetSize();
 }
 
+class MappedStreamBuf : public Filesystem_Stream::InputMemoryStreamBufView {
+public:
+	explicit MappedStreamBuf(std::unique_ptr<Platform::MappedFile> file) :
+		Filesystem_Stream::InputMemoryStreamBufView(Span<uint8_t>(const_cast<uint8_t*>(file->GetData().data()), file->GetData().size())),
+		file(std::move(file)) {
+	}
+
+private:
+	std::unique_ptr<Platform::MappedFile> file;
+};
+
 std::streambuf* NativeFilesystem::CreateInputStreambuffer(StringView path, std::ios_base::openmode mode) const {
+	// Read-only access goes through a memory mapping when possible to avoid copies
+	auto mapped_file = std::make_unique<Platform::MappedFile>(ToString(path));
+	if (*mapped_file) {
+		return new MappedStreamBuf(std::move(mapped_file));
+	}
+
 	auto* buf = new std::filebuf();
 	buf->open(
 #ifdef _MSC_VER
@@ -119,8 +138,12 @@ bool NativeFilesystem::MakeDirectory(StringView path, bool follow_symlinks) cons
 	return Platform::File(ToString(path)).MakeDirectory(follow_symlinks);
 }
 
+bool NativeFilesystem::Rename(StringView from, StringView to) const {
+	return Platform::File(ToString(from)).Rename(ToString(to));
+}
+
 bool NativeFilesystem::IsFeatureSupported(Feature f) const {
-	return f == Filesystem::Feature::Write;
+	return f == Filesystem::Feature::Write || f == Filesystem::Feature::Rename;
 }
 
 std::string NativeFilesystem::Describe() const {
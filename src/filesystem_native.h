@@ -43,6 +43,7 @@ protected:
 	std::streambuf* CreateOutputStreambuffer(StringView path, std::ios_base::openmode mode) const override;
 	bool GetDirectoryContent(StringView path, std::vector<DirectoryTree::Entry>& entries) const override;
 	bool MakeDirectory(StringView path, bool follow_symlinks) const override;
+	bool Rename(StringView from, StringView to) const override;
 	bool IsFeatureSupported(Feature f) const override;
 	std::string Describe() const override;
 	/** @} */
@@ -16,8 +16,29 @@
  */
 
 #include "filesystem_stream.h"
+#include "system.h"
 
+#include <unordered_set>
 #include <utility>
+#ifdef SUPPORT_THREADS
+#  include <mutex>
+#endif
+
+namespace {
+	// Registry of all InputMemoryStreamBufView instances, used instead of dynamic_cast
+	std::unordered_set<const std::streambuf*> memory_streambufs;
+
+#ifdef SUPPORT_THREADS
+	// Streams are destroyed by the worker pool threads
+	std::mutex memory_streambufs_mutex;
+	using RegistryLock = std::lock_guard<std::mutex>;
+#else
+	struct RegistryLock {
+		explicit RegistryLock(int) {}
+	};
+	constexpr int memory_streambufs_mutex = 0;
+#endif
+}
 
 Filesystem_Stream::InputStream::InputStream(std::streambuf* sb, std::string name) :
 	std::istream(sb), name(std::move(name)) {}
@@ -50,6 +71,14 @@ void Filesystem_Stream::InputStream::Close() {
 	set_rdbuf(nullptr);
 }
 
+Span<const uint8_t> Filesystem_Stream::InputStream::GetBuffer() const {
+	auto* buf = InputMemoryStreamBufView::FromStreambuf(rdbuf());
+	if (!buf) {
+		return {};
+	}
+	return buf->GetBuffer();
+}
+
 Filesystem_Stream::OutputStream::OutputStream(std::streambuf* sb, FilesystemView fs, std::string name) :
 	std::ostream(sb), fs(std::move(fs)), name(std::move(name)) {};
 
@@ -88,6 +117,30 @@ Filesystem_Stream::InputMemoryStreamBufView::InputMemoryStreamBufView(Span<uint8
 		: std::streambuf(), buffer_view(buffer_view) {
 	char* cbuffer = reinterpret_cast<char*>(buffer_view.data());
 	setg(cbuffer, cbuffer, cbuffer + buffer_view.size());
+
+	RegistryLock lock(memory_streambufs_mutex);
+	memory_streambufs.insert(this);
+}
+
+Filesystem_Stream::InputMemoryStreamBufView::~InputMemoryStreamBufView() {
+	RegistryLock lock(memory_streambufs_mutex);
+	memory_streambufs.erase(this);
+}
+
+Span<const uint8_t> Filesystem_Stream::InputMemoryStreamBufView::GetBuffer() const {
+	return buffer_view;
+}
+
+const Filesystem_Stream::InputMemoryStreamBufView* Filesystem_Stream::InputMemoryStreamBufView::FromStreambuf(const std::streambuf* buf) {
+	if (!buf) {
+		return nullptr;
+	}
+
+	RegistryLock lock(memory_streambufs_mutex);
+	if (memory_streambufs.find(buf) == memory_streambufs.end()) {
+		return nullptr;
+	}
+	return static_cast<const InputMemoryStreamBufView*>(buf);
 }
 
 std::streambuf::pos_type Filesystem_Stream::InputMemoryStreamBufView::seekoff(std::streambuf::off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode mode) {
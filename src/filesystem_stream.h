@@ -39,6 +39,15 @@ namespace Filesystem_Stream {
 		StringView GetName() const;
 		void Close();
 
+		/**
+		 * Provides direct access to the content of memory backed streams
+		 * (memory mapped files, uncompressed archive entries, ...).
+		 * The view is valid as long as the stream is open.
+		 *
+		 * @return view on the whole content or an empty span when the stream is not memory backed
+		 */
+		Span<const uint8_t> GetBuffer() const;
+
 		template <typename T>
 		bool ReadIntoObj(T& obj);
 
@@ -71,9 +80,22 @@ namespace Filesystem_Stream {
 	class InputMemoryStreamBufView : public std::streambuf {
 	public:
 		explicit InputMemoryStreamBufView(Span<uint8_t> buffer_view);
+		~InputMemoryStreamBufView() override;
 		InputMemoryStreamBufView(InputMemoryStreamBufView const& other) = delete;
 		InputMemoryStreamBufView const& operator=(InputMemoryStreamBufView const& other) = delete;
 
+		/** @return view on the whole buffer */
+		Span<const uint8_t> GetBuffer() const;
+
+		/**
+		 * Looks up whether the streambuf is a memory streambuf.
+		 * Works without RTTI which is unavailable on some platforms.
+		 *
+		 * @param buf streambuf to check
+		 * @return buf as memory streambuf or nullptr when it is a different streambuf
+		 */
+		static const InputMemoryStreamBufView* FromStreambuf(const std::streambuf* buf);
+
 	protected:
 		std::streambuf::pos_type seekoff(std::streambuf::off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode mode) override;
 		std::streambuf::pos_type seekpos(std::streambuf::pos_type pos, std::ios_base::openmode mode) override;
@@ -22,20 +22,308 @@
 
 #include <zlib.h>
 #include <lcf/reader_util.h>
-#include <lcf/scope_guard.h>
 #include <iostream>
 #include <sstream>
 #include <cassert>
 #include <algorithm>
+#include <array>
 #include <fmt/core.h>
 
 constexpr uint32_t end_of_central_directory = 0x06054b50;
 constexpr int32_t end_of_central_directory_size = 22;
 
+constexpr uint32_t zip64_end_of_central_directory = 0x06064b50;
+constexpr uint32_t zip64_end_of_central_directory_locator = 0x07064b50;
+constexpr int32_t zip64_end_of_central_directory_locator_size = 20;
+
 constexpr uint32_t central_directory_entry = 0x02014b50;
 constexpr uint32_t local_header = 0x04034b50;
 constexpr uint32_t local_header_size = 30;
 
+constexpr uint16_t zip64_extra_field = 0x0001;
+constexpr uint32_t zip64_marker = 0xFFFFFFFF;
+
+namespace {
+	/** Streambuf for a memory backed archive or a stored entry inside it. Keeps the archive alive. */
+	class ZipMappedStreamBuf : public Filesystem_Stream::InputMemoryStreamBufView {
+	public:
+		ZipMappedStreamBuf(std::shared_ptr<Filesystem_Stream::InputStream> archive, Span<const uint8_t> buffer) :
+			Filesystem_Stream::InputMemoryStreamBufView(Span<uint8_t>(const_cast<uint8_t*>(buffer.data()), buffer.size())),
+			archive(std::move(archive)) {
+		}
+
+	private:
+		std::shared_ptr<Filesystem_Stream::InputStream> archive;
+	};
+
+	/** Streambuf for stored entries. Reads the entry in small windows directly from the archive. */
+	class ZipStoredStreamBuf : public std::streambuf {
+	public:
+		ZipStoredStreamBuf(Filesystem_Stream::InputStream zip_file, uint64_t data_offset, uint64_t size) :
+			std::streambuf(), zip_file(std::move(zip_file)), data_offset(data_offset), size(size) {
+			setg(buffer.data(), buffer.data(), buffer.data());
+		}
+
+	protected:
+		int underflow() override {
+			window_start += egptr() - eback();
+
+			const auto len = std::min<uint64_t>(buffer.size(), size - window_start);
+			std::streamsize read = 0;
+			if (len > 0) {
+				zip_file.clear();
+				zip_file.seekg(data_offset + window_start);
+				zip_file.read(buffer.data(), len);
+				read = zip_file.gcount();
+			}
+
+			setg(buffer.data(), buffer.data(), buffer.data() + read);
+			if (read <= 0) {
+				return traits_type::eof();
+			}
+			return traits_type::to_int_type(*gptr());
+		}
+
+		std::streambuf::pos_type seekoff(std::streambuf::off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode mode) override {
+			std::streambuf::off_type off;
+			if (dir == std::ios_base::beg) {
+				off = offset;
+			} else if (dir == std::ios_base::cur) {
+				off = window_start + (gptr() - eback()) + offset;
+			} else {
+				off = size + offset;
+			}
+			return seekpos(off, mode);
+		}
+
+		std::streambuf::pos_type seekpos(std::streambuf::pos_type pos, std::ios_base::openmode) override {
+			const uint64_t target = Utils::Clamp<int64_t>(pos, 0, size);
+			if (target >= window_start && target <= window_start + (egptr() - eback())) {
+				setg(eback(), eback() + (target - window_start), egptr());
+			} else {
+				window_start = target;
+				setg(buffer.data(), buffer.data(), buffer.data());
+			}
+			return target;
+		}
+
+	private:
+		Filesystem_Stream::InputStream zip_file;
+		uint64_t data_offset = 0;
+		uint64_t size = 0;
+		/** Position in the entry of the start of the buffer */
+		uint64_t window_start = 0;
+		std::array<char, 16 * 1024> buffer;
+	};
+
+	/**
+	 * Streambuf for deflated entries. Inflates the entry on demand in fixed size windows.
+	 * While inflating restart points are recorded at deflate block boundaries, seeking
+	 * backwards resumes inflating from the nearest restart point.
+	 */
+	class ZipInflateStreamBuf : public std::streambuf {
+	public:
+		ZipInflateStreamBuf(Filesystem_Stream::InputStream zip_file, uint64_t data_offset,
+				uint64_t compressed_size, uint64_t uncompressed_size, std::string name) :
+				std::streambuf(), zip_file(std::move(zip_file)), data_offset(data_offset),
+				compressed_size(compressed_size), uncompressed_size(uncompressed_size), name(std::move(name)) {
+			inflateInit2(&zlib_stream, -MAX_WBITS);
+			checkpoints.push_back({});
+			this->zip_file.seekg(data_offset);
+			setg(out_buffer.data(), out_buffer.data(), out_buffer.data());
+		}
+
+		~ZipInflateStreamBuf() override {
+			inflateEnd(&zlib_stream);
+		}
+
+		ZipInflateStreamBuf(const ZipInflateStreamBuf&) = delete;
+		ZipInflateStreamBuf& operator=(const ZipInflateStreamBuf&) = delete;
+
+	protected:
+		int underflow() override {
+			if (!Fill()) {
+				return traits_type::eof();
+			}
+			return traits_type::to_int_type(*gptr());
+		}
+
+		std::streambuf::pos_type seekoff(std::streambuf::off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode mode) override {
+			std::streambuf::off_type off;
+			if (dir == std::ios_base::beg) {
+				off = offset;
+			} else if (dir == std::ios_base::cur) {
+				off = window_start + (gptr() - eback()) + offset;
+			} else {
+				off = uncompressed_size + offset;
+			}
+			return seekpos(off, mode);
+		}
+
+		std::streambuf::pos_type seekpos(std::streambuf::pos_type pos, std::ios_base::openmode) override {
+			const uint64_t target = Utils::Clamp<int64_t>(pos, 0, uncompressed_size);
+			if (!SeekTo(target)) {
+				return std::streambuf::pos_type(std::streambuf::off_type(-1));
+			}
+			return target;
+		}
+
+	private:
+		struct Checkpoint {
+			/** Position in the uncompressed data */
+			uint64_t out_pos = 0;
+			/** Position in the compressed data */
+			uint64_t in_pos = 0;
+			/** Amount of bits of the byte before in_pos that belong to the next block */
+			int bits = 0;
+			/** Last 32 KiB of uncompressed data */
+			std::vector<uint8_t> dictionary;
+		};
+
+		bool Fill();
+		bool SeekTo(uint64_t target);
+		void Restart(const Checkpoint& checkpoint);
+		void AddCheckpoint();
+
+		static constexpr size_t window_size = 64 * 1024;
+		static constexpr uint64_t checkpoint_interval = 1024 * 1024;
+
+		Filesystem_Stream::InputStream zip_file;
+		uint64_t data_offset = 0;
+		uint64_t compressed_size = 0;
+		uint64_t uncompressed_size = 0;
+		std::string name;
+
+		z_stream zlib_stream = {};
+		bool stream_end = false;
+		/** Amount of compressed bytes read from the archive */
+		uint64_t in_pos = 0;
+		/** Position in the entry of the start of the output window */
+		uint64_t window_start = 0;
+		std::array<char, 16 * 1024> in_buffer;
+		std::array<char, window_size> out_buffer;
+		std::vector<Checkpoint> checkpoints;
+	};
+
+	constexpr size_t ZipInflateStreamBuf::window_size;
+	constexpr uint64_t ZipInflateStreamBuf::checkpoint_interval;
+
+	bool ZipInflateStreamBuf::Fill() {
+		window_start += egptr() - eback();
+		setg(out_buffer.data(), out_buffer.data(), out_buffer.data());
+
+		if (stream_end) {
+			return false;
+		}
+
+		zlib_stream.next_out = reinterpret_cast<Bytef*>(out_buffer.data());
+		zlib_stream.avail_out = static_cast<uInt>(out_buffer.size());
+
+		while (zlib_stream.avail_out > 0) {
+			if (zlib_stream.avail_in == 0 && in_pos < compressed_size) {
+				const auto len = std::min<uint64_t>(in_buffer.size(), compressed_size - in_pos);
+				zip_file.read(in_buffer.data(), len);
+				const auto read = zip_file.gcount();
+				in_pos += read;
+				zlib_stream.next_in = reinterpret_cast<Bytef*>(in_buffer.data());
+				zlib_stream.avail_in = static_cast<uInt>(read);
+			}
+
+			// Z_BLOCK stops at every deflate block boundary, required for the checkpoints
+			int zlib_error = inflate(&zlib_stream, Z_BLOCK);
+			if (zlib_error == Z_STREAM_END) {
+				stream_end = true;
+				break;
+			} else if (zlib_error == Z_BUF_ERROR) {
+				Output::Warning("ZipFS: zlib failed for {}: Unexpected end of data (Archive corrupted?)", name);
+				stream_end = true;
+				break;
+			} else if (zlib_error != Z_OK) {
+				Output::Warning("ZipFS: zlib failed for {}: {} ({})", name, zlib_error, zlib_stream.msg ? zlib_stream.msg : "No error message");
+				stream_end = true;
+				break;
+			}
+
+			AddCheckpoint();
+		}
+
+		const auto produced = out_buffer.size() - zlib_stream.avail_out;
+		setg(out_buffer.data(), out_buffer.data(), out_buffer.data() + produced);
+		return produced > 0;
+	}
+
+	bool ZipInflateStreamBuf::SeekTo(uint64_t target) {
+		if (target >= window_start && target <= window_start + (egptr() - eback())) {
+			setg(eback(), eback() + (target - window_start), egptr());
+			return true;
+		}
+
+		// Resume from the closest checkpoint when seeking backwards or when it skips inflating data
+		auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(), target, [](uint64_t pos, const Checkpoint& cp) {
+			return pos < cp.out_pos;
+		});
+		assert(it != checkpoints.begin());
+		--it;
+
+		if (target < window_start || it->out_pos > window_start + (egptr() - eback())) {
+			Restart(*it);
+		}
+
+		while (target > window_start + (egptr() - eback())) {
+			if (!Fill()) {
+				return false;
+			}
+		}
+
+		setg(eback(), eback() + (target - window_start), egptr());
+		return true;
+	}
+
+	void ZipInflateStreamBuf::Restart(const Checkpoint& checkpoint) {
+		inflateReset(&zlib_stream);
+		zlib_stream.avail_in = 0;
+		stream_end = false;
+
+		in_pos = checkpoint.in_pos;
+		zip_file.clear();
+		zip_file.seekg(data_offset + in_pos - (checkpoint.bits ? 1 : 0));
+		if (checkpoint.bits) {
+			int c = zip_file.get();
+			inflatePrime(&zlib_stream, checkpoint.bits, c >> (8 - checkpoint.bits));
+		}
+		if (!checkpoint.dictionary.empty()) {
+			inflateSetDictionary(&zlib_stream, checkpoint.dictionary.data(), static_cast<uInt>(checkpoint.dictionary.size()));
+		}
+
+		window_start = checkpoint.out_pos;
+		setg(out_buffer.data(), out_buffer.data(), out_buffer.data());
+	}
+
+	void ZipInflateStreamBuf::AddCheckpoint() {
+#if ZLIB_VERNUM >= 0x1280
+		// Bit 7: At a block boundary, Bit 6: Last block
+		if ((zlib_stream.data_type & 128) == 0 || (zlib_stream.data_type & 64) != 0) {
+			return;
+		}
+
+		const uint64_t out_pos = window_start + (out_buffer.size() - zlib_stream.avail_out);
+		if (out_pos < checkpoints.back().out_pos + checkpoint_interval) {
+			return;
+		}
+
+		Checkpoint checkpoint;
+		checkpoint.out_pos = out_pos;
+		checkpoint.in_pos = in_pos - zlib_stream.avail_in;
+		checkpoint.bits = zlib_stream.data_type & 7;
+		checkpoint.dictionary.resize(32 * 1024);
+		uInt dictionary_size = static_cast<uInt>(checkpoint.dictionary.size());
+		inflateGetDictionary(&zlib_stream, checkpoint.dictionary.data(), &dictionary_size);
+		checkpoint.dictionary.resize(dictionary_size);
+		checkpoints.push_back(std::move(checkpoint));
+#endif
+	}
+} // anonymous namespace
+
 static std::string normalize_path(StringView path) {
 	if (path == "." || path == "/" || path == "") {
 		return "";
@@ -58,9 +346,9 @@ ZipFilesystem::ZipFilesystem(std::string base_path, FilesystemView parent_fs, St
 		return;
 	}
 
-	uint16_t central_directory_entries = 0;
-	uint32_t central_directory_size = 0;
-	uint32_t central_directory_offset = 0;
+	uint64_t central_directory_entries = 0;
+	uint64_t central_directory_size = 0;
+	uint64_t central_directory_offset = 0;
 
 	ZipEntry entry = {};
 	entry.is_directory = false;
@@ -179,12 +467,24 @@ ZipFilesystem::ZipFilesystem(std::string base_path, FilesystemView parent_fs, St
 		std::sort(zip_entries_cp437.begin(), zip_entries_cp437.end(), [](auto& a, auto& b) {
 			return a.first < b.first;
 		});
+
+		if (!zipfile.GetBuffer().empty()) {
+			zipfile.clear();
+			mapped_archive = std::make_shared<Filesystem_Stream::InputStream>(std::move(zipfile));
+		}
 	} else {
 		Output::Warning("ZipFS: {} is not a valid archive", GetPath());
 	}
 }
 
-bool ZipFilesystem::FindCentralDirectory(std::istream& zipfile, uint32_t& offset, uint32_t& size, uint16_t& num_entries) const {
+Filesystem_Stream::InputStream ZipFilesystem::OpenArchive() const {
+	if (mapped_archive) {
+		return Filesystem_Stream::InputStream(new ZipMappedStreamBuf(mapped_archive, mapped_archive->GetBuffer()), GetPath());
+	}
+	return GetParent().OpenInputStream(GetPath());
+}
+
+bool ZipFilesystem::FindCentralDirectory(std::istream& zipfile, uint64_t& offset, uint64_t& size, uint64_t& num_entries) const {
 	uint32_t magic = 0;
 	bool found = false;
 
@@ -206,13 +506,48 @@ bool ZipFilesystem::FindCentralDirectory(std::istream& zipfile, uint32_t& offset
 	}
 
 	if (found) {
+		const std::streamoff end_of_central_directory_pos = static_cast<std::streamoff>(zipfile.tellg()) - sizeof(magic);
+		uint16_t num_entries16;
+		uint32_t size32;
+		uint32_t offset32;
+
 		zipfile.seekg(6, std::ios_base::cur); // Jump over multiarchive related fields
-		zipfile.read(reinterpret_cast<char*>(&num_entries), sizeof(uint16_t));
-		Utils::SwapByteOrder(num_entries);
-		zipfile.read(reinterpret_cast<char*>(&size), sizeof(uint32_t));
-		Utils::SwapByteOrder(size);
-		zipfile.read(reinterpret_cast<char*>(&offset), sizeof(uint32_t));
-		Utils::SwapByteOrder(offset);
+		zipfile.read(reinterpret_cast<char*>(&num_entries16), sizeof(uint16_t));
+		Utils::SwapByteOrder(num_entries16);
+		zipfile.read(reinterpret_cast<char*>(&size32), sizeof(uint32_t));
+		Utils::SwapByteOrder(size32);
+		zipfile.read(reinterpret_cast<char*>(&offset32), sizeof(uint32_t));
+		Utils::SwapByteOrder(offset32);
+		num_entries = num_entries16;
+		size = size32;
+		offset = offset32;
+
+		if ((num_entries16 == UINT16_MAX || size32 == zip64_marker || offset32 == zip64_marker) &&
+				end_of_central_directory_pos >= zip64_end_of_central_directory_locator_size) {
+			// Zip64: The real values are in the Zip64 end of central directory record
+			zipfile.seekg(end_of_central_directory_pos - zip64_end_of_central_directory_locator_size);
+			zipfile.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+			Utils::SwapByteOrder(magic);
+			if (magic == zip64_end_of_central_directory_locator) {
+				uint64_t zip64_offset;
+				zipfile.seekg(4, std::ios_base::cur); // Jump over disk number
+				zipfile.read(reinterpret_cast<char*>(&zip64_offset), sizeof(uint64_t));
+				Utils::SwapByteOrder(zip64_offset);
+
+				zipfile.seekg(zip64_offset);
+				zipfile.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+				Utils::SwapByteOrder(magic);
+				if (magic == zip64_end_of_central_directory) {
+					zipfile.seekg(28, std::ios_base::cur); // Jump over record size, versions and multiarchive related fields
+					zipfile.read(reinterpret_cast<char*>(&num_entries), sizeof(uint64_t));
+					Utils::SwapByteOrder(num_entries);
+					zipfile.read(reinterpret_cast<char*>(&size), sizeof(uint64_t));
+					Utils::SwapByteOrder(size);
+					zipfile.read(reinterpret_cast<char*>(&offset), sizeof(uint64_t));
+					Utils::SwapByteOrder(offset);
+				}
+			}
+		}
 		return true;
 	}
 	else {
@@ -226,6 +561,9 @@ bool ZipFilesystem::ReadCentralDirectoryEntry(std::istream& zipfile, std::string
 	uint16_t filepath_length;
 	uint16_t extra_field_length;
 	uint16_t comment_length;
+	uint32_t compressed_size;
+	uint32_t uncompressed_size;
+	uint32_t fileoffset;
 
 	zipfile.read(reinterpret_cast<char*>(&magic), sizeof(magic));
 	Utils::SwapByteOrder(magic); // Take care of big endian systems
@@ -235,10 +573,10 @@ bool ZipFilesystem::ReadCentralDirectoryEntry(std::istream& zipfile, std::string
 	Utils::SwapByteOrder(flags);
 	is_utf8 = (flags & 0x800) == 0x800;
 	zipfile.seekg(10, std::ios_base::cur); // Jump over currently not needed entries
-	zipfile.read(reinterpret_cast<char*>(&entry.compressed_size), sizeof(uint32_t));
-	Utils::SwapByteOrder(entry.compressed_size);
-	zipfile.read(reinterpret_cast<char*>(&entry.uncompressed_size), sizeof(uint32_t));
-	Utils::SwapByteOrder(entry.uncompressed_size);
+	zipfile.read(reinterpret_cast<char*>(&compressed_size), sizeof(uint32_t));
+	Utils::SwapByteOrder(compressed_size);
+	zipfile.read(reinterpret_cast<char*>(&uncompressed_size), sizeof(uint32_t));
+	Utils::SwapByteOrder(uncompressed_size);
 	zipfile.read(reinterpret_cast<char*>(&filepath_length), sizeof(uint16_t));
 	Utils::SwapByteOrder(filepath_length);
 	zipfile.read(reinterpret_cast<char*>(&extra_field_length), sizeof(uint16_t));
@@ -246,13 +584,20 @@ bool ZipFilesystem::ReadCentralDirectoryEntry(std::istream& zipfile, std::string
 	zipfile.read(reinterpret_cast<char*>(&comment_length), sizeof(uint16_t));
 	Utils::SwapByteOrder(comment_length);
 	zipfile.seekg(8, std::ios_base::cur); // Jump over currently not needed entries
-	zipfile.read(reinterpret_cast<char*>(&entry.fileoffset), sizeof(uint32_t));
-	Utils::SwapByteOrder(entry.fileoffset);
+	zipfile.read(reinterpret_cast<char*>(&fileoffset), sizeof(uint32_t));
+	Utils::SwapByteOrder(fileoffset);
+	entry.compressed_size = compressed_size;
+	entry.uncompressed_size = uncompressed_size;
+	entry.fileoffset = fileoffset;
 	if (filename_buffer.capacity() < filepath_length + 1) {
 		filename_buffer.resize(filepath_length + 1);
 	}
 	zipfile.read(reinterpret_cast<char*>(filename_buffer.data()), filepath_length);
 	filename = std::string(filename_buffer.data(), filepath_length);
+	if (compressed_size == zip64_marker || uncompressed_size == zip64_marker || fileoffset == zip64_marker) {
+		ReadZip64ExtraField(zipfile, extra_field_length, entry, true);
+		extra_field_length = 0;
+	}
 	// Jump over currently not needed entries
 	zipfile.seekg(comment_length + extra_field_length, std::ios_base::cur);
 	// Workaround ZIP archives containing invalid "\" paths created by .net or Powershell
@@ -266,6 +611,8 @@ bool ZipFilesystem::ReadLocalHeader(std::istream& zipfile, StorageMethod& method
 	uint16_t extra_field_length;
 	uint16_t flags;
 	uint16_t compression;
+	uint32_t compressed_size;
+	uint32_t uncompressed_size;
 
 	zipfile.read(reinterpret_cast<char*>(&magic), sizeof(magic));
 	Utils::SwapByteOrder(magic); // Take care of big endian systems
@@ -276,14 +623,20 @@ bool ZipFilesystem::ReadLocalHeader(std::istream& zipfile, StorageMethod& method
 	zipfile.read(reinterpret_cast<char*>(&compression), sizeof(uint16_t));
 	Utils::SwapByteOrder(compression);
 	zipfile.seekg(8, std::ios_base::cur); // Jump over currently not needed entries
-	zipfile.read(reinterpret_cast<char*>(&entry.compressed_size), sizeof(uint32_t));
-	Utils::SwapByteOrder(entry.compressed_size);
-	zipfile.read(reinterpret_cast<char*>(&entry.uncompressed_size), sizeof(uint32_t));
-	Utils::SwapByteOrder(entry.uncompressed_size);
+	zipfile.read(reinterpret_cast<char*>(&compressed_size), sizeof(uint32_t));
+	Utils::SwapByteOrder(compressed_size);
+	zipfile.read(reinterpret_cast<char*>(&uncompressed_size), sizeof(uint32_t));
+	Utils::SwapByteOrder(uncompressed_size);
 	zipfile.read(reinterpret_cast<char*>(&filepath_length), sizeof(uint16_t));
 	Utils::SwapByteOrder(filepath_length);
 	zipfile.read(reinterpret_cast<char*>(&extra_field_length), sizeof(uint16_t));
 	Utils::SwapByteOrder(extra_field_length);
+	entry.compressed_size = compressed_size;
+	entry.uncompressed_size = uncompressed_size;
+	if (compressed_size == zip64_marker || uncompressed_size == zip64_marker) {
+		zipfile.seekg(filepath_length, std::ios_base::cur);
+		ReadZip64ExtraField(zipfile, extra_field_length, entry, false);
+	}
 
 	switch (compression) {
 	case 0:
@@ -300,6 +653,46 @@ bool ZipFilesystem::ReadLocalHeader(std::istream& zipfile, StorageMethod& method
 	return true;
 }
 
+void ZipFilesystem::ReadZip64ExtraField(std::istream& zipfile, uint16_t extra_field_length, ZipEntry& entry, bool has_offset) const {
+	const auto extra_field_end = zipfile.tellg() + static_cast<std::streamoff>(extra_field_length);
+
+	uint16_t remaining = extra_field_length;
+	while (remaining >= 4) {
+		uint16_t id;
+		uint16_t size;
+		zipfile.read(reinterpret_cast<char*>(&id), sizeof(uint16_t));
+		Utils::SwapByteOrder(id);
+		zipfile.read(reinterpret_cast<char*>(&size), sizeof(uint16_t));
+		Utils::SwapByteOrder(size);
+		remaining -= 4;
+		if (size > remaining) {
+			break;
+		}
+
+		if (id == zip64_extra_field) {
+			// Only contains the values that are marked with 0xFFFFFFFF in the header, in this order
+			auto read_field = [&](uint64_t& field) {
+				if (field == zip64_marker && size >= sizeof(uint64_t)) {
+					zipfile.read(reinterpret_cast<char*>(&field), sizeof(uint64_t));
+					Utils::SwapByteOrder(field);
+					size -= sizeof(uint64_t);
+				}
+			};
+			read_field(entry.uncompressed_size);
+			read_field(entry.compressed_size);
+			if (has_offset) {
+				read_field(entry.fileoffset);
+			}
+			break;
+		}
+
+		zipfile.seekg(size, std::ios_base::cur);
+		remaining -= size;
+	}
+
+	zipfile.seekg(extra_field_end);
+}
+
 bool ZipFilesystem::IsFile(StringView path) const {
 	std::string path_normalized = normalize_path(path);
 	auto entry = Find(path);
@@ -337,7 +730,7 @@ std::streambuf* ZipFilesystem::CreateInputStreambuffer(StringView path, std::ios
 	std::string path_normalized = normalize_path(path);
 	auto central_entry = Find(path);
 	if (central_entry && !central_entry->is_directory) {
-		auto zip_file = GetParent().OpenInputStream(GetPath());
+		auto zip_file = OpenArchive();
 		zip_file.seekg(central_entry->fileoffset);
 		StorageMethod method;
 		uint32_t local_offset = 0;
@@ -361,41 +754,21 @@ std::streambuf* ZipFilesystem::CreateInputStreambuffer(StringView path, std::ios
 				}
 			}
 
-			if (local_entry.compressed_size == 0xffffffff || local_entry.uncompressed_size == 0xffffffff) {
-				Output::Warning("ZipFS: Zip64 is not supported {}", path_normalized);
-				return nullptr;
-			}
-
-			zip_file.seekg(central_entry->fileoffset + local_entry.fileoffset);
+			const uint64_t data_offset = central_entry->fileoffset + local_entry.fileoffset;
+			zip_file.seekg(data_offset);
 			if (method == StorageMethod::Plain) {
-				auto data = std::vector<uint8_t>(local_entry.uncompressed_size);
-				zip_file.read(reinterpret_cast<char*>(data.data()), data.size());
-				return new Filesystem_Stream::InputMemoryStreamBuf(std::move(data));
-			} else if (method == StorageMethod::Deflate) {
-				std::vector<uint8_t> comp_buf;
-				comp_buf.resize(local_entry.compressed_size);
-				zip_file.read(reinterpret_cast<char*>(comp_buf.data()), comp_buf.size());
-				auto dec_buf = std::vector<uint8_t>(local_entry.uncompressed_size);
-				z_stream zlib_stream = {};
-				zlib_stream.next_in = reinterpret_cast<Bytef*>(comp_buf.data());
-				zlib_stream.avail_in = static_cast<uInt>(comp_buf.size());
-				zlib_stream.next_out = reinterpret_cast<Bytef*>(dec_buf.data());
-				zlib_stream.avail_out = static_cast<uInt>(dec_buf.size());
-				inflateInit2(&zlib_stream, -MAX_WBITS);
-				auto inflate_sg = lcf::makeScopeGuard([&]() {
-					inflateEnd(&zlib_stream);
-				});
-
-				int zlib_error = inflate(&zlib_stream, Z_NO_FLUSH);
-				if (zlib_error == Z_OK) {
-					Output::Warning("ZipFS: zlib failed for {}: More data available (Archive corrupted?)", path_normalized);
-					return nullptr;
-				}
-				else if (zlib_error != Z_STREAM_END) {
-					Output::Warning("ZipFS: zlib failed for {}: {} ({})", path_normalized, zlib_error, zlib_stream.msg ? zlib_stream.msg : "No error message");
-					return nullptr;
+				if (mapped_archive) {
+					auto buffer = mapped_archive->GetBuffer();
+					if (data_offset > buffer.size() || local_entry.uncompressed_size > buffer.size() - data_offset) {
+						Output::Warning("ZipFS: {} exceeds the archive size (Archive corrupted?)", path_normalized);
+						return nullptr;
+					}
+					return new ZipMappedStreamBuf(mapped_archive, buffer.subspan(data_offset, local_entry.uncompressed_size));
 				}
-				return new Filesystem_Stream::InputMemoryStreamBuf(std::move(dec_buf));
+				return new ZipStoredStreamBuf(std::move(zip_file), data_offset, local_entry.uncompressed_size);
+			} else if (method == StorageMethod::Deflate) {
+				return new ZipInflateStreamBuf(std::move(zip_file), data_offset,
+						local_entry.compressed_size, local_entry.uncompressed_size, path_normalized);
 			} else {
 				Output::Warning("ZipFS: {} has unsupported compression format. Only Deflate is supported", path_normalized);
 				return nullptr;
@@ -56,21 +56,25 @@ protected:
 private:
 	enum class StorageMethod {Unknown, Plain, Deflate};
 	struct ZipEntry {
-		uint32_t compressed_size;
-		uint32_t uncompressed_size;
-		uint32_t fileoffset;
+		uint64_t compressed_size;
+		uint64_t uncompressed_size;
+		uint64_t fileoffset;
 		bool is_directory;
 	};
 
-	bool FindCentralDirectory(std::istream& stream, uint32_t& offset, uint32_t& size, uint16_t& num_entries) const;
+	bool FindCentralDirectory(std::istream& stream, uint64_t& offset, uint64_t& size, uint64_t& num_entries) const;
 	bool ReadCentralDirectoryEntry(std::istream& zipfile, std::string& filepath, ZipEntry& entry, bool& is_utf8) const;
 	bool ReadLocalHeader(std::istream& zipfile, StorageMethod& method, ZipEntry& entry) const;
+	void ReadZip64ExtraField(std::istream& zipfile, uint16_t extra_field_length, ZipEntry& entry, bool has_offset) const;
 	const ZipEntry* Find(StringView what) const;
+	Filesystem_Stream::InputStream OpenArchive() const;
 
 	std::vector<std::pair<std::string, ZipEntry>> zip_entries;
 	std::vector<std::pair<std::string, ZipEntry>> zip_entries_cp437;
 	std::string encoding;
 	mutable std::vector<char> filename_buffer;
+	/** Archive stream when it is memory backed, entries are then read without copying */
+	std::shared_ptr<Filesystem_Stream::InputStream> mapped_archive;
 };
 
 #endif
@@ -17,6 +17,7 @@
 
 // Headers
 #include <map>
+#include <unordered_map>
 #include <type_traits>
 #include <vector>
 #include <iterator>
@@ -129,9 +130,63 @@ namespace {
 		BitmapRef glyph_bm;
 	}; // class BitmapFont
 
+	Font::Stats stats;
+
 #ifdef HAVE_FREETYPE
 	FT_Library library = nullptr;
 
+	/**
+	 * LRU cache of rendered glyphs of one FreeType face and size.
+	 * The glyphs are packed into shelves of shared atlas pages. When all pages
+	 * are full the least recently used page is emptied and reused.
+	 */
+	class GlyphAtlas {
+	public:
+		struct Entry {
+			int page = 0;
+			Rect rect;
+			Point advance;
+			Point offset;
+			bool has_color = false;
+		};
+
+		/** @return cached glyph or nullptr on a cache miss */
+		const Entry* Find(char32_t code);
+
+		/**
+		 * Reserves space for a glyph of the given size.
+		 *
+		 * @return entry to fill or nullptr when the glyph does not fit into a page
+		 */
+		Entry* Insert(char32_t code, int width, int height);
+
+		/** @return atlas page bitmap */
+		const BitmapRef& GetPage(int page) const;
+
+		static constexpr int page_size = 512;
+		static constexpr int max_pages = 4;
+
+	private:
+		struct Shelf {
+			int y = 0;
+			int height = 0;
+			int x = 0;
+		};
+
+		struct Page {
+			BitmapRef bitmap;
+			std::vector<Shelf> shelves;
+			uint32_t last_used = 0;
+		};
+
+		bool Allocate(Page& page, int width, int height, Rect& rect);
+		int EvictPage();
+
+		std::unordered_map<char32_t, Entry> entries;
+		std::vector<Page> pages;
+		uint32_t clock = 0;
+	};
+
 	struct FTFont final : public Font  {
 		FTFont(Filesystem_Stream::InputStream is, int size, bool bold, bool italic);
 		~FTFont() override;
@@ -149,6 +204,10 @@ namespace {
 		int baseline_offset = 0;
 		/** Workaround for bad kerning in RM2000 and RMG2000 fonts */
 		bool rm2000_workaround = false;
+		/** Lookups update the LRU order, this happens in GetSize as well */
+		mutable GlyphAtlas atlas;
+		/** Used for glyphs larger than an atlas page */
+		BitmapRef large_glyph_bm;
 	}; // class FTFont
 #endif
 
@@ -216,7 +275,7 @@ Font::GlyphRet BitmapFont::Glyph(char32_t code) {
 		glyph_bm = Bitmap::Create(nullptr, FULL_WIDTH, HEIGHT, 0, DynamicFormat(8,8,0,8,0,8,0,8,0,PF::Alpha));
 	}
 	if (EP_UNLIKELY(Utils::IsControlCharacter(code))) {
-		return { glyph_bm, {0, 0}, {0, 0} };
+		return { glyph_bm, glyph_bm->GetRect(), {0, 0}, {0, 0} };
 	}
 	auto glyph = func(code);
 	auto width = glyph->is_full? FULL_WIDTH : HALF_WIDTH;
@@ -228,7 +287,7 @@ Font::GlyphRet BitmapFont::Glyph(char32_t code) {
 		for(size_t x_ = 0; x_ < width; ++x_)
 			data[y_*pitch+x_] = (glyph->data[y_] & (0x1 << x_)) ? 255 : 0;
 
-	return { glyph_bm, {width, 0}, {0, 0} };
+	return { glyph_bm, glyph_bm->GetRect(), {width, 0}, {0, 0} };
 }
 
 #ifdef HAVE_FREETYPE
@@ -294,6 +353,10 @@ Rect FTFont::GetSize(StringView txt) const {
 }
 
 Rect FTFont::GetSize(char32_t code) const {
+	if (auto* entry = atlas.Find(code)) {
+		return {0, 0, entry->advance.x, entry->advance.y};
+	}
+
 	auto glyph_index = FT_Get_Char_Index(face, code);
 
 	if (glyph_index == 0 && code != 0 && fallback_font) {
@@ -301,6 +364,7 @@ Rect FTFont::GetSize(char32_t code) const {
 	}
 
 	auto load_glyph = [&](auto flags) {
+		++stats.glyph_loads;
 		if (FT_Load_Glyph(face, glyph_index, flags) != FT_Err_Ok) {
 			Output::Error("Couldn't load FreeType character {:#x}", uint32_t(code));
 		}
@@ -332,17 +396,24 @@ Rect FTFont::GetSize(char32_t code) const {
 }
 
 Font::GlyphRet FTFont::Glyph(char32_t code) {
-    auto glyph_index = FT_Get_Char_Index(face, code);
+	if (auto* entry = atlas.Find(code)) {
+		return { atlas.GetPage(entry->page), entry->rect, entry->advance, entry->offset, entry->has_color };
+	}
+
+	auto glyph_index = FT_Get_Char_Index(face, code);
 
 	if (glyph_index == 0 && code != 0 && fallback_font) {
 		return fallback_font->Glyph(code);
 	}
 
 	auto render_glyph = [&](auto flags, auto mode) {
+		++stats.glyph_loads;
 		if (FT_Load_Glyph(face, glyph_index, flags) != FT_Err_Ok) {
 			Output::Error("Couldn't load FreeType character {:#x}", uint32_t(code));
 		}
 
+		++stats.glyph_renders;
+
 		if (FT_Render_Glyph(face->glyph, mode) != FT_Err_Ok) {
 			Output::Error("Couldn't render FreeType character {:#x}", uint32_t(code));
 		}
@@ -353,7 +424,7 @@ Font::GlyphRet FTFont::Glyph(char32_t code) {
 
 		// When it is a color font check if the glyph is a color glyph
 		// If it is not then rerender the glyph monochrome
-		// FIXME: This is inefficient
+		// This is inefficient but only happens once per glyph due to the atlas
 		if (face->glyph->bitmap.pixel_mode != FT_PIXEL_MODE_BGRA) {
 			render_glyph(FT_LOAD_MONOCHROME | FT_LOAD_TARGET_MONO, FT_RENDER_MODE_MONO);
 		}
@@ -370,39 +441,159 @@ Font::GlyphRet FTFont::Glyph(char32_t code) {
 	const int width = ft_bitmap->width;
 	const int height = ft_bitmap->rows;
 
+	const bool has_color = (ft_bitmap->pixel_mode == FT_PIXEL_MODE_BGRA);
+
+	Point advance;
+	Point offset;
+
+	advance.x = slot->advance.x / 64;
+	advance.y = slot->advance.y / 64;
+	offset.x = slot->bitmap_left;
+	offset.y = slot->bitmap_top - baseline_offset;
+
+	if (EP_UNLIKELY(rm2000_workaround)) {
+		advance.x = 6;
+	}
+
 	BitmapRef bm;
-	bool has_color = false;
+	Rect rect;
+
+	auto* entry = atlas.Insert(code, width, height);
+	if (entry) {
+		bm = atlas.GetPage(entry->page);
+		rect = entry->rect;
+		entry->advance = advance;
+		entry->offset = offset;
+		entry->has_color = has_color;
+	} else {
+		// Does not fit into the atlas, use a temporary bitmap
+		if (!large_glyph_bm || large_glyph_bm->width() < width || large_glyph_bm->height() < height) {
+			large_glyph_bm = Bitmap::Create(width, height);
+		}
+		bm = large_glyph_bm;
+		rect = Rect(0, 0, width, height);
+	}
 
-	if (ft_bitmap->pixel_mode == FT_PIXEL_MODE_BGRA) {
-		bm = Bitmap::Create(ft_bitmap->buffer, width, height, 0, format_B8G8R8A8_a().format());
-		has_color = true;
+	if (has_color) {
+		auto color_bm = Bitmap::Create(ft_bitmap->buffer, width, height, 0, format_B8G8R8A8_a().format());
+		bm->BlitFast(rect.x, rect.y, *color_bm, color_bm->GetRect(), Opacity::Opaque());
 	} else {
-		bm = Bitmap::Create(width, height);
 		auto* data = reinterpret_cast<uint32_t*>(bm->pixels());
+		const int bm_pitch = bm->pitch() / 4;
 
 		for (int row = 0; row < height; ++row) {
 			for (int col = 0; col < width; ++col) {
 				unsigned c = ft_bitmap->buffer[pitch * row + (col / 8)];
 				unsigned bit = 7 - (col % 8);
 				c = c & (0x01 << bit) ? 255 : 0;
-				data[row * width + col] = (c << 24) + (c << 16) + (c << 8) + c;
+				data[(rect.y + row) * bm_pitch + rect.x + col] = (c << 24) + (c << 16) + (c << 8) + c;
 			}
 		}
 	}
 
-	Point advance;
-	Point offset;
+	return { bm, rect, advance, offset, has_color };
+}
 
-	advance.x = slot->advance.x / 64;
-	advance.y = slot->advance.y / 64;
-	offset.x = slot->bitmap_left;
-	offset.y = slot->bitmap_top - baseline_offset;
+constexpr int GlyphAtlas::page_size;
+constexpr int GlyphAtlas::max_pages;
 
-	if (EP_UNLIKELY(rm2000_workaround)) {
-		advance.x = 6;
+const GlyphAtlas::Entry* GlyphAtlas::Find(char32_t code) {
+	auto it = entries.find(code);
+	if (it == entries.end()) {
+		return nullptr;
 	}
 
-	return { bm, advance, offset, has_color };
+	pages[it->second.page].last_used = ++clock;
+	return &it->second;
+}
+
+const BitmapRef& GlyphAtlas::GetPage(int page) const {
+	return pages[page].bitmap;
+}
+
+GlyphAtlas::Entry* GlyphAtlas::Insert(char32_t code, int width, int height) {
+	if (width > page_size || height > page_size) {
+		return nullptr;
+	}
+
+	Rect rect;
+	int page_index = -1;
+
+	for (int i = 0; i < static_cast<int>(pages.size()); ++i) {
+		if (Allocate(pages[i], width, height, rect)) {
+			page_index = i;
+			break;
+		}
+	}
+
+	if (page_index < 0) {
+		if (static_cast<int>(pages.size()) < max_pages) {
+			pages.emplace_back();
+			pages.back().bitmap = Bitmap::Create(page_size, page_size, true);
+			page_index = static_cast<int>(pages.size()) - 1;
+		} else {
+			page_index = EvictPage();
+		}
+
+		if (!Allocate(pages[page_index], width, height, rect)) {
+			return nullptr;
+		}
+	}
+
+	auto& page = pages[page_index];
+	page.last_used = ++clock;
+
+	auto& entry = entries[code];
+	entry.page = page_index;
+	entry.rect = rect;
+	return &entry;
+}
+
+bool GlyphAtlas::Allocate(Page& page, int width, int height, Rect& rect) {
+	// Use the shelf wasting the least amount of height
+	Shelf* best = nullptr;
+	for (auto& shelf: page.shelves) {
+		if (shelf.height >= height && shelf.x + width <= page_size) {
+			if (!best || shelf.height < best->height) {
+				best = &shelf;
+			}
+		}
+	}
+
+	if (!best) {
+		const int y = page.shelves.empty() ? 0 : page.shelves.back().y + page.shelves.back().height;
+		if (y + height > page_size) {
+			return false;
+		}
+		page.shelves.push_back({ y, height, 0 });
+		best = &page.shelves.back();
+	}
+
+	rect = Rect(best->x, best->y, width, height);
+	best->x += width;
+	return true;
+}
+
+int GlyphAtlas::EvictPage() {
+	int page_index = 0;
+	for (int i = 1; i < static_cast<int>(pages.size()); ++i) {
+		if (pages[i].last_used < pages[page_index].last_used) {
+			page_index = i;
+		}
+	}
+
+	for (auto it = entries.begin(); it != entries.end();) {
+		if (it->second.page == page_index) {
+			it = entries.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	auto& page = pages[page_index];
+	page.shelves.clear();
+	page.bitmap->Clear();
+	return page_index;
 }
 #endif
 
@@ -471,6 +662,10 @@ void Font::Dispose() {
 #endif
 }
 
+const Font::Stats& Font::GetStats() {
+	return stats;
+}
+
 // Constructor.
 Font::Font(StringView name, int size, bool bold, bool italic)
 	: name(ToString(name))
@@ -483,7 +678,7 @@ Font::Font(StringView name, int size, bool bold, bool italic)
 Point Font::Render(Bitmap& dest, int const x, int const y, const Bitmap& sys, int color, char32_t code) {
 	auto gret = Glyph(code);
 
-	auto rect = Rect(x, y, gret.bitmap->width(), gret.bitmap->height());
+	auto rect = Rect(x, y, gret.rect.width, gret.rect.height);
 	if (EP_UNLIKELY(rect.width == 0)) {
 		return {};
 	}
@@ -497,7 +692,7 @@ Point Font::Render(Bitmap& dest, int const x, int const y, const Bitmap& sys, in
 	if (color != ColorShadow) {
 		if (!gret.has_color) {
 			auto shadow_rect = Rect(rect.x + 1, rect.y + 1, rect.width, rect.height);
-			dest.MaskedBlit(shadow_rect, *gret.bitmap, 0, 0, sys, 16, 32);
+			dest.MaskedBlit(shadow_rect, *gret.bitmap, gret.rect.x, gret.rect.y, sys, 16, 32);
 		}
 
 		src_x = color % 10 * 16 + 2;
@@ -505,7 +700,7 @@ Point Font::Render(Bitmap& dest, int const x, int const y, const Bitmap& sys, in
 
 		// When the glyph is large the system graphic color mask will be outside the rectangle
 		// Move the mask slightly up to avoid this
-		int offset = gret.bitmap->height() - gret.offset.y;
+		int offset = gret.rect.height - gret.offset.y;
 		if (offset > 12) {
 			src_y -= offset - 12;
 		}
@@ -515,9 +710,9 @@ Point Font::Render(Bitmap& dest, int const x, int const y, const Bitmap& sys, in
 	}
 
 	if (!gret.has_color) {
-		dest.MaskedBlit(rect, *gret.bitmap, 0, 0, sys, src_x, src_y);
+		dest.MaskedBlit(rect, *gret.bitmap, gret.rect.x, gret.rect.y, sys, src_x, src_y);
 	} else {
-		dest.Blit(rect.x, rect.y, *gret.bitmap, gret.bitmap->GetRect(), Opacity::Opaque());
+		dest.Blit(rect.x, rect.y, *gret.bitmap, gret.rect, Opacity::Opaque());
 	}
 
 	return gret.advance;
@@ -526,8 +721,8 @@ Point Font::Render(Bitmap& dest, int const x, int const y, const Bitmap& sys, in
 Point Font::Render(Bitmap& dest, int x, int y, Color const& color, char32_t code) {
 	auto gret = Glyph(code);
 
-	auto rect = Rect(x, y, gret.bitmap->width(), gret.bitmap->height());
-	dest.MaskedBlit(rect, *gret.bitmap, 0, 0, color);
+	auto rect = Rect(x, y, gret.rect.width, gret.rect.height);
+	dest.MaskedBlit(rect, *gret.bitmap, gret.rect.x, gret.rect.y, color);
 
 	return gret.advance;
 }
@@ -561,7 +756,7 @@ Font::GlyphRet ExFont::Glyph(char32_t code) {
 		}
 	}
 
-	return { bm, {WIDTH, 0}, {0, 0}, has_color };
+	return { bm, bm->GetRect(), {WIDTH, 0}, {0, 0}, has_color };
 }
 
 Rect ExFont::GetSize(StringView) const {
@@ -55,6 +55,8 @@ class Font {
 	struct GlyphRet {
 		/** bitmap which the glyph pixels are located within */
 		BitmapRef bitmap;
+		/** rect inside bitmap containing the glyph pixels */
+		Rect rect;
 		/**
 		 * How far to advance the x/y offset after drawing for the next glyph.
 		 * y value is only relevant for vertical layouts.
@@ -68,7 +70,8 @@ class Font {
 
 	/* Returns a bitmap and rect containing the pixels of the glyph.
 	 * The bitmap may be larger than the size of the glyph, and so the
-	 * rect must be used to get the pixels out of the bitmap
+	 * rect must be used to get the pixels out of the bitmap.
+	 * The bitmap is only valid until the next call of Glyph.
 	 *
 	 * @param code which utf32 glyph to return.
 	 * @return @refer GlyphRet
@@ -119,6 +122,17 @@ class Font {
 	static void ResetDefault();
 	static void Dispose();
 
+	/** FreeType calls of all fonts */
+	struct Stats {
+		/** Glyphs loaded from a face, this includes measuring uncached glyphs */
+		int glyph_loads = 0;
+		/** Glyphs rasterized into a bitmap */
+		int glyph_renders = 0;
+	};
+
+	/** @return FreeType calls since startup */
+	static const Stats& GetStats();
+
 	static FontRef exfont;
 
 	enum SystemColor {
@@ -15,6 +15,7 @@
  * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <sstream>
 
 #include "fps_overlay.h"
@@ -24,10 +25,33 @@
 #include "input.h"
 #include "font.h"
 #include "drawable_mgr.h"
+#include "frame_stats.h"
+#include "cache.h"
+#include "audio_secache.h"
+#include "damage_tracker.h"
+#include "graphics.h"
 
 using namespace std::chrono_literals;
 
 static constexpr auto refresh_frequency = 1s;
+static constexpr auto stats_refresh_frequency = 200ms;
+
+// One column per frame, the height is two target frame times
+static constexpr int stats_width = 216;
+static constexpr int graph_height = 40;
+static constexpr int text_lines = 4;
+
+static const Color phase_colors[FrameStats::ePhaseCount] = {
+	Color(160, 160, 160, 255), // Input
+	Color(80, 140, 255, 255), // Logic
+	Color(80, 220, 80, 255), // Draw
+	Color(240, 200, 40, 255), // Present
+	Color(70, 70, 70, 255) // Sleep
+};
+
+static double ToMs(Game_Clock::duration d) {
+	return std::chrono::duration<double, std::milli>(d).count();
+}
 
 FpsOverlay::FpsOverlay() :
 	Drawable(Priority_Overlay + 100, Drawable::Flags::Global)
@@ -51,6 +75,11 @@ bool FpsOverlay::Update() {
 	}
 
 	auto now = Game_Clock::GetFrameTime();
+	if (draw_frame_stats && now - last_stats_refresh_time >= stats_refresh_frequency) {
+		last_stats_refresh_time = now;
+		stats_dirty = true;
+	}
+
 	auto dt = now - last_refresh_time;
 	if (dt < refresh_frequency) {
 		return false;
@@ -62,7 +91,92 @@ bool FpsOverlay::Update() {
 	return true;
 }
 
+void FpsOverlay::RefreshFrameStats() {
+	auto& font = *Font::DefaultBitmapFont();
+	const int line_height = font.GetSize("0").height;
+
+	if (!stats_bitmap) {
+		stats_bitmap = Bitmap::Create(stats_width, graph_height + text_lines * line_height + 2, true);
+	}
+	stats_bitmap->Clear();
+	stats_bitmap->Fill(Color(0, 0, 0, 160));
+
+	// Stacked bars, newest frame on the right
+	const double px_per_ms = graph_height / (2 * ToMs(Game_Clock::GetTargetGameTimeStep()));
+	const int num_frames = std::min(FrameStats::GetFrameCount(), stats_width);
+	for (int age = 0; age < num_frames; ++age) {
+		const auto& frame = FrameStats::GetFrame(age);
+		const int x = stats_width - 1 - age;
+		int y = graph_height;
+		for (int p = 0; p < FrameStats::ePhaseCount && y > 0; ++p) {
+			const int h = std::min(Utils::RoundTo<int>(ToMs(frame.phases[p]) * px_per_ms), y);
+			if (h > 0) {
+				y -= h;
+				stats_bitmap->FillRect(Rect(x, y, 1, h), phase_colors[p]);
+			}
+		}
+	}
+	// Target frame time
+	stats_bitmap->FillRect(Rect(0, graph_height / 2, stats_width, 1), Color(255, 80, 80, 160));
+
+	const auto summary = FrameStats::GetSummary();
+	const Color white(255, 255, 255, 255);
+	int y = graph_height + 1;
+
+	Text::Draw(*stats_bitmap, 1, y, font, white, fmt::format("p50 {:.1f} p95 {:.1f} p99 {:.1f} max {:.1f}ms",
+		ToMs(summary.p50), ToMs(summary.p95), ToMs(summary.p99), ToMs(summary.max)));
+	y += line_height;
+
+	const char* names[FrameStats::ePhaseCount] = { "in", "lg", "dr", "pr", "sl" };
+	int x = 1;
+	for (int p = 0; p < FrameStats::ePhaseCount; ++p) {
+		auto text = fmt::format("{} {:.1f}", names[p], ToMs(summary.average.phases[p]));
+		if (p == FrameStats::eLogic) {
+			text += fmt::format("x{}", summary.average.logic_steps);
+		}
+		x += Text::Draw(*stats_bitmap, x, y, font, p == FrameStats::eSleep ? white : phase_colors[p], text + " ").x;
+	}
+	y += line_height;
+
+	const auto& bitmaps = Cache::GetStats();
+	const auto& se = AudioSeCache::GetStats();
+	Text::Draw(*stats_bitmap, 1, y, font, white, fmt::format("Img {} {:.1f}MB SE {} {:.1f}MB",
+		bitmaps.entries, bitmaps.bytes / (1024.0 * 1024.0), se.entries, se.bytes / (1024.0 * 1024.0)));
+	y += line_height;
+
+	Text::Draw(*stats_bitmap, 1, y, font, white, fmt::format("Redraw {:.0f}%",
+		Graphics::GetDamageTracker().GetRedrawRatio() * 100.0));
+
+	stats_dirty = false;
+}
+
+bool FpsOverlay::GetDrawState(const Bitmap& dst, DrawState& state) const {
+	int height = 0;
+	if (draw_fps || last_speed_mod > 1) {
+		height = 16;
+	}
+	if (draw_frame_stats) {
+		height = stats_bitmap ? 16 + stats_bitmap->GetHeight() : dst.GetHeight();
+	}
+
+	state.bounds = Rect(0, 0, dst.GetWidth(), height);
+	state.hash = DrawHash()
+		.Add(draw_fps).Add(fps_dirty).Add(fps_bitmap).Add(fps_rect)
+		.Add(last_speed_mod).Add(speedup_dirty).Add(speedup_bitmap)
+		.Add(draw_frame_stats).Add(stats_dirty).Add(stats_bitmap)
+		.Get();
+	return true;
+}
+
 void FpsOverlay::Draw(Bitmap& dst) {
+	if (draw_frame_stats) {
+		if (stats_dirty || !stats_bitmap) {
+			RefreshFrameStats();
+		}
+		// Below the fps counter
+		dst.Blit(1, 16, *stats_bitmap, stats_bitmap->GetRect(), 255);
+	}
+
 	if (draw_fps) {
 		if (fps_dirty) {
 			std::string text = GetFpsString();
@@ -28,12 +28,17 @@
 /**
  * FpsOverlay class.
  * Shows current FPS and the speedup indicator.
+ * The extended mode adds a graph of the frame times split into the
+ * FrameStats phases, the frame time percentiles, the cache sizes and the
+ * part of the screen redrawn per frame.
  */
 class FpsOverlay : public Drawable {
 public:
 	FpsOverlay();
 
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "FpsOverlay"; }
+	bool GetDrawState(const Bitmap& dst, DrawState& state) const override;
 
 	/**
 	 * Update the fps overlay.
@@ -56,12 +61,22 @@ public:
 	 */
 	void SetDrawFps(bool value);
 
+	/**
+	 * Set whether we will render the frame time graph.
+	 *
+	 * @param value true if we want to draw to screen
+	 */
+	void SetDrawFrameStats(bool value);
+
 private:
 	void UpdateText();
+	void RefreshFrameStats();
 
 	BitmapRef fps_bitmap;
 	BitmapRef speedup_bitmap;
+	BitmapRef stats_bitmap;
 	Game_Clock::time_point last_refresh_time;
+	Game_Clock::time_point last_stats_refresh_time;
 
 	/** Rect to draw on screen */
 	Rect fps_rect;
@@ -73,6 +88,8 @@ private:
 	bool speedup_dirty = true;
 	bool fps_dirty = true;
 	bool draw_fps = true;
+	bool stats_dirty = true;
+	bool draw_frame_stats = false;
 };
 
 inline std::string FpsOverlay::GetFpsString() const {
@@ -83,4 +100,8 @@ inline void FpsOverlay::SetDrawFps(bool value) {
 	draw_fps = value;
 }
 
+inline void FpsOverlay::SetDrawFrameStats(bool value) {
+	draw_frame_stats = value;
+}
+
 #endif
@@ -23,6 +23,7 @@
 #include "main_data.h"
 #include "frame.h"
 #include "drawable_mgr.h"
+#include "damage_tracker.h"
 
 Frame::Frame() :
 	Drawable(Priority_Frame)
@@ -41,6 +42,12 @@ void Frame::Update() {
 	// no-op
 }
 
+bool Frame::GetDrawState(const Bitmap&, DrawState& state) const {
+	state.bounds = frame_bitmap ? frame_bitmap->GetRect() : Rect();
+	state.hash = DrawHash().Add(frame_bitmap).Get();
+	return true;
+}
+
 void Frame::Draw(Bitmap& dst) {
 	if (frame_bitmap) {
 		dst.Blit(0, 0, *frame_bitmap, frame_bitmap->GetRect(), 255);
@@ -32,6 +32,8 @@ public:
 	Frame();
 
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "Frame"; }
+	bool GetDrawState(const Bitmap& dst, DrawState& state) const override;
 	void Update();
 
 private:
@@ -0,0 +1,101 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include "frame_stats.h"
+
+namespace {
+	std::array<FrameStats::Frame, FrameStats::history_size> history;
+	/** Index of the next history entry to write */
+	int head = 0;
+	int count = 0;
+	FrameStats::Frame current;
+}
+
+Game_Clock::duration FrameStats::Frame::GetTotal() const {
+	Game_Clock::duration total = {};
+	for (auto& t: phases) {
+		total += t;
+	}
+	return total;
+}
+
+void FrameStats::AddTime(Phase phase, Game_Clock::duration time) {
+	current.phases[phase] += time;
+}
+
+void FrameStats::AddLogicStep() {
+	++current.logic_steps;
+}
+
+void FrameStats::EndFrame() {
+	history[head] = current;
+	head = (head + 1) % history_size;
+	count = std::min(count + 1, history_size);
+	current = {};
+}
+
+void FrameStats::Reset() {
+	head = 0;
+	count = 0;
+	current = {};
+}
+
+int FrameStats::GetFrameCount() {
+	return count;
+}
+
+const FrameStats::Frame& FrameStats::GetFrame(int age) {
+	return history[(head - 1 - age + history_size) % history_size];
+}
+
+FrameStats::Summary FrameStats::GetSummary() {
+	Summary summary;
+	if (count == 0) {
+		return summary;
+	}
+
+	std::array<Game_Clock::duration, history_size> totals;
+	int steps = 0;
+	for (int i = 0; i < count; ++i) {
+		const auto& frame = GetFrame(i);
+		totals[i] = frame.GetTotal();
+		for (int p = 0; p < ePhaseCount; ++p) {
+			summary.average.phases[p] += frame.phases[p];
+		}
+		steps += frame.logic_steps;
+	}
+	for (auto& t: summary.average.phases) {
+		t /= count;
+	}
+	summary.average.logic_steps = steps / count;
+
+	// Nearest rank percentiles
+	auto begin = totals.begin();
+	auto end = totals.begin() + count;
+	auto nth = [&](int n) {
+		std::nth_element(begin, begin + n, end);
+		return begin[n];
+	};
+	summary.p50 = nth((count - 1) / 2);
+	summary.p95 = nth((count * 95 + 99) / 100 - 1);
+	summary.p99 = nth((count * 99 + 99) / 100 - 1);
+	summary.max = *std::max_element(begin, end);
+
+	return summary;
+}
@@ -0,0 +1,121 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_FRAME_STATS_H
+#define EP_FRAME_STATS_H
+
+// Headers
+#include <array>
+#include "game_clock.h"
+
+/**
+ * Timing history of the main loop.
+ *
+ * Every frame is split into phases. The history has a fixed size and
+ * recording does not allocate, so it is always enabled.
+ */
+namespace FrameStats {
+	enum Phase {
+		/** Input and system key handling */
+		eInput,
+		/** All logic steps (Game_Clock::NextGameTimeStep iterations) */
+		eLogic,
+		/** Drawing into the display surface */
+		eDraw,
+		/** BaseUi::UpdateDisplay */
+		ePresent,
+		/** Waiting for the next frame */
+		eSleep,
+		ePhaseCount
+	};
+
+	/** Timings of one frame */
+	struct Frame {
+		std::array<Game_Clock::duration, ePhaseCount> phases = {};
+		/** Number of logic steps */
+		int logic_steps = 0;
+
+		/** @return time of all phases */
+		Game_Clock::duration GetTotal() const;
+	};
+
+	/** Summary of the frames in the history */
+	struct Summary {
+		Game_Clock::duration p50 = {};
+		Game_Clock::duration p95 = {};
+		Game_Clock::duration p99 = {};
+		Game_Clock::duration max = {};
+		/** Average time of every phase */
+		Frame average;
+	};
+
+	/** Number of frames kept in the history */
+	constexpr int history_size = 256;
+
+	/**
+	 * Adds time to a phase of the current frame.
+	 *
+	 * @param phase phase
+	 * @param time time spent
+	 */
+	void AddTime(Phase phase, Game_Clock::duration time);
+
+	/** Counts a logic step of the current frame */
+	void AddLogicStep();
+
+	/** Moves the current frame into the history and starts a new one */
+	void EndFrame();
+
+	/** Discards the history */
+	void Reset();
+
+	/** @return number of frames in the history */
+	int GetFrameCount();
+
+	/**
+	 * @param age 0 for the last completed frame, must be less than GetFrameCount()
+	 * @return frame from the history
+	 */
+	const Frame& GetFrame(int age);
+
+	/** @return percentiles of the frame times and the phase averages */
+	Summary GetSummary();
+
+	/** Adds the lifetime of the scope to a phase */
+	class PhaseScope {
+	public:
+		explicit PhaseScope(Phase phase);
+		~PhaseScope();
+
+		PhaseScope(const PhaseScope&) = delete;
+		PhaseScope& operator=(const PhaseScope&) = delete;
+
+	private:
+		Phase phase;
+		Game_Clock::time_point start;
+	};
+}
+
+inline FrameStats::PhaseScope::PhaseScope(Phase phase)
+	: phase(phase), start(Game_Clock::now()) {
+}
+
+inline FrameStats::PhaseScope::~PhaseScope() {
+	AddTime(phase, Game_Clock::now() - start);
+}
+
+#endif
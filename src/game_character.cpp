@@ -18,6 +18,7 @@
 // Headers
 #include "audio.h"
 #include "game_character.h"
+#include "game_event.h"
 #include "game_map.h"
 #include "game_player.h"
 #include "game_switches.h"
@@ -54,6 +55,10 @@ void Game_Character::SanitizeMoveRoute(StringView name, const lcf::rpg::MoveRout
 	}
 }
 
+void Game_Character::OnEventPositionChanged() {
+	Game_Map::UpdateEventPosition(static_cast<const Game_Event&>(*this));
+}
+
 void Game_Character::MoveTo(int map_id, int x, int y) {
 	data()->map_id = map_id;
 	// RPG_RT does not round the position for this function.
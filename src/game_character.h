@@ -880,6 +880,8 @@ protected:
 	void IncAnimFrame();
 	void UpdateFlash();
 	bool BeginMoveRouteJump(int32_t& current_index, const lcf::rpg::MoveRoute& current_route);
+	/** Keeps the event position index of Game_Map in sync, only called for events */
+	void OnEventPositionChanged();
 
 	lcf::rpg::SaveMapEventBase* data();
 	const lcf::rpg::SaveMapEventBase* data() const;
@@ -937,6 +939,9 @@ inline int Game_Character::GetX() const {
 
 inline void Game_Character::SetX(int new_x) {
 	data()->position_x = new_x;
+	if (_type == Event) {
+		OnEventPositionChanged();
+	}
 }
 
 inline int Game_Character::GetY() const {
@@ -945,6 +950,9 @@ inline int Game_Character::GetY() const {
 
 inline void Game_Character::SetY(int new_y) {
 	data()->position_y = new_y;
+	if (_type == Event) {
+		OnEventPositionChanged();
+	}
 }
 
 inline int Game_Character::GetMapId() const {
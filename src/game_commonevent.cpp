@@ -89,6 +89,13 @@ std::vector<lcf::rpg::EventCommand>& Game_CommonEvent::GetList() {
 	return lcf::ReaderUtil::GetElement(lcf::Data::commonevents, common_event_id)->event_commands;
 }
 
+Game_Interpreter::CommandList Game_CommonEvent::GetCommandList() {
+	if (!commands) {
+		commands = std::make_shared<const EventCommandList>(GetList(), EventProfiler::Source{ 0, common_event_id, 0 });
+	}
+	return commands;
+}
+
 lcf::rpg::SaveEventExecState Game_CommonEvent::GetSaveData() {
 	lcf::rpg::SaveEventExecState state;
 	if (interpreter) {
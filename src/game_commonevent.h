@@ -96,6 +96,14 @@ public:
 	 */
 	std::vector<lcf::rpg::EventCommand>& GetList();
 
+	/**
+	 * Gets event commands list shared by all interpreter frames
+	 * running this common event.
+	 *
+	 * @return event commands list.
+	 */
+	Game_Interpreter::CommandList GetCommandList();
+
 	lcf::rpg::SaveEventExecState GetSaveData();
 
 	/** @return true if waiting for foreground execution */
@@ -112,6 +120,9 @@ private:
 
 	/** Interpreter for parallel common events. */
 	std::unique_ptr<Game_Interpreter_Map> interpreter;
+
+	/** Lazily created by GetCommandList */
+	Game_Interpreter::CommandList commands;
 };
 
 #endif
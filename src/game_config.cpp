@@ -130,6 +130,24 @@ void Game_Config::LoadFromArgs(CmdlineParser& cp) {
 			}
 			continue;
 		}
+		if (cp.ParseNext(arg, 1, "--prefetch-budget")) {
+			if (arg.ParseValue(0, li_value)) {
+				player.prefetch_budget.Set(li_value);
+			}
+			continue;
+		}
+		if (cp.ParseNext(arg, 1, "--map-cache-budget")) {
+			if (arg.ParseValue(0, li_value)) {
+				player.map_cache_budget.Set(li_value);
+			}
+			continue;
+		}
+		if (cp.ParseNext(arg, 1, "--render-threads")) {
+			if (arg.ParseValue(0, li_value)) {
+				player.render_threads.Set(li_value);
+			}
+			continue;
+		}
 
 		cp.SkipNext();
 	}
@@ -159,6 +177,15 @@ void Game_Config::LoadFromConfig(const std::string& path) {
 	if (ini.HasValue("player", "enemyai-algo")) {
 		player.enemyai_algo.Set(ini.GetString("player", "enemyai-algo", ""));
 	}
+	if (ini.HasValue("player", "prefetch-budget")) {
+		player.prefetch_budget.Set(ini.GetInteger("player", "prefetch-budget", 0));
+	}
+	if (ini.HasValue("player", "map-cache-budget")) {
+		player.map_cache_budget.Set(ini.GetInteger("player", "map-cache-budget", 0));
+	}
+	if (ini.HasValue("player", "render-threads")) {
+		player.render_threads.Set(ini.GetInteger("player", "render-threads", 0));
+	}
 
 	/** VIDEO SECTION */
 
@@ -201,6 +228,15 @@ void Game_Config::WriteToConfig(const std::string& path) const {
 	of << "[player]\n";
 	of << "autobattle-algo=" << player.autobattle_algo.Get() << "\n";
 	of << "enemyai-algo=" << player.enemyai_algo.Get() << "\n";
+	if (player.prefetch_budget.Enabled()) {
+		of << "prefetch-budget=" << player.prefetch_budget.Get() << "\n";
+	}
+	if (player.map_cache_budget.Enabled()) {
+		of << "map-cache-budget=" << player.map_cache_budget.Get() << "\n";
+	}
+	if (player.render_threads.Enabled()) {
+		of << "render-threads=" << player.render_threads.Get() << "\n";
+	}
 	of << "\n";
 
 	/** VIDEO SECTION */
@@ -35,6 +35,12 @@ enum class ScalingMode {
 struct Game_ConfigPlayer {
 	StringConfigParam autobattle_algo{ "" };
 	StringConfigParam enemyai_algo{ "" };
+	/** Memory in MiB used for assets prefetched when a map is loaded */
+	RangeConfigParam<int> prefetch_budget{ 8, 0, 1024 };
+	/** Memory in MiB used for parsed maps kept for later transfers */
+	RangeConfigParam<int> map_cache_budget{ 16, 0, 1024 };
+	/** Amount of screen bands drawn in parallel, 1 draws on the main thread only */
+	RangeConfigParam<int> render_threads{ 1, 1, 16 };
 };
 
 struct Game_ConfigVideo {
@@ -364,6 +364,25 @@ const std::vector<lcf::rpg::EventCommand>& Game_Event::GetList() const {
 	return page ? page->event_commands : _empty_list;
 }
 
+Game_Interpreter::CommandList Game_Event::GetCommandList(const lcf::rpg::EventPage* page) {
+	if (!page) {
+		return nullptr;
+	}
+
+	const EventProfiler::Source source = { Game_Map::GetMapId(), GetId(), page->ID };
+	const auto idx = page - event->pages.data();
+	if (idx < 0 || idx >= static_cast<std::ptrdiff_t>(event->pages.size())) {
+		return std::make_shared<const EventCommandList>(page->event_commands, source);
+	}
+
+	page_commands.resize(event->pages.size());
+	auto& list = page_commands[idx];
+	if (!list) {
+		list = std::make_shared<const EventCommandList>(page->event_commands, source);
+	}
+	return list;
+}
+
 void Game_Event::OnFinishForegroundEvent() {
 	UpdateFacing();
 	SetPaused(false);
@@ -102,6 +102,15 @@ public:
 	 */
 	const std::vector<lcf::rpg::EventCommand>& GetList() const;
 
+	/**
+	 * Gets the event commands of a page as a list shared by all
+	 * interpreter frames running this page.
+	 *
+	 * @param page page of this event
+	 * @return event commands list or nullptr when page is nullptr
+	 */
+	Game_Interpreter::CommandList GetCommandList(const lcf::rpg::EventPage* page);
+
 	/**
 	 * Event returns to its original direction before talking to the hero.
 	 */
@@ -212,6 +221,8 @@ private:
 	const lcf::rpg::Event* event = nullptr;
 	const lcf::rpg::EventPage* page = nullptr;
 	std::unique_ptr<Game_Interpreter_Map> interpreter;
+	/** Lazily created command lists of every page */
+	std::vector<Game_Interpreter::CommandList> page_commands;
 };
 
 inline int Game_Event::GetNumPages() const {
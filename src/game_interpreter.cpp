@@ -40,12 +40,15 @@
 #include "game_message.h"
 #include "game_pictures.h"
 #include "game_screen.h"
+#include "event_profiler.h"
 #include "game_interpreter_control_variables.h"
 #include "maniac_patch.h"
 #include "spriteset_map.h"
 #include "sprite_character.h"
 #include "scene_gameover.h"
 #include "scene_map.h"
+#include "save_header.h"
+#include "save_writer.h"
 #include "scene_save.h"
 #include "scene.h"
 #include "game_clock.h"
@@ -64,6 +67,7 @@
 #include "baseui.h"
 #include "algo.h"
 #include "rand.h"
+#include "instrumentation.h"
 
 #include "sliding_puzzle.h"
 
@@ -87,6 +91,7 @@ Game_Interpreter::~Game_Interpreter() {
 // Clear.
 void Game_Interpreter::Clear() {
 	_state = {};
+	_frame_commands.clear();
 	_keyinput = {};
 	_async_op = {};
 }
@@ -106,13 +111,24 @@ void Game_Interpreter::Push(
 		return;
 	}
 
+	Push(std::make_shared<const EventCommandList>(_list), event_id, started_by_decision_key);
+}
+
+void Game_Interpreter::Push(
+	CommandList _list,
+	int event_id,
+	bool started_by_decision_key
+) {
+	if (!_list || _list->empty()) {
+		return;
+	}
+
 	if ((int)_state.stack.size() > call_stack_limit) {
 		Output::Error("Call Event limit ({}) has been exceeded", call_stack_limit);
 	}
 
 	lcf::rpg::SaveEventExecFrame frame;
 	frame.ID = _state.stack.size() + 1;
-	frame.commands = _list;
 	frame.current_command = 0;
 	frame.triggered_by_decision_key = started_by_decision_key;
 	frame.event_id = event_id;
@@ -124,6 +140,7 @@ void Game_Interpreter::Push(
 	}
 
 	_state.stack.push_back(std::move(frame));
+	_frame_commands.push_back(std::move(_list));
 }
 
 
@@ -274,6 +291,9 @@ void Game_Interpreter::KeyInputState::toSave(lcf::rpg::SaveEventExecState& save)
 
 lcf::rpg::SaveEventExecState Game_Interpreter::GetState() const {
 	auto save = _state;
+	for (size_t i = 0; i < save.stack.size(); ++i) {
+		save.stack[i].commands = _frame_commands[i]->GetCommands();
+	}
 	_keyinput.toSave(save);
 	return save;
 }
@@ -288,6 +308,16 @@ void Game_Interpreter::SetupWait(int duration) {
 	}
 }
 
+EventProfiler::Source Game_Interpreter::GetProfilerSource() const {
+	auto source = GetFrameCommands().GetSource();
+	if (source.event_id == 0 && GetCurrentEventId() > 0) {
+		// Map event frames restored from a savegame
+		source.map_id = Game_Map::GetMapId();
+		source.event_id = GetCurrentEventId();
+	}
+	return source;
+}
+
 bool Game_Interpreter::ReachedLoopLimit() const {
 	return loop_count >= loop_limit;
 }
@@ -460,7 +490,7 @@ void Game_Interpreter::Update(bool reset_loop_count) {
 		}
 
 		// Pop any completed stack frames
-		if (frame->current_command >= (int)frame->commands.size()) {
+		if (frame->current_command >= (int)GetFrameCommands().size()) {
 			if (!OnFinishStackFrame()) {
 				break;
 			}
@@ -471,7 +501,22 @@ void Game_Interpreter::Update(bool reset_loop_count) {
 		int current_frame_idx = _state.stack.size() - 1;
 
 		const int index_before_exec = frame->current_command;
-		if (!ExecuteCommand()) {
+		const int code = GetFrameCommands()[index_before_exec].code;
+		bool executed;
+		if (EventProfiler::IsEnabled()) {
+			// The command can change the stack, the source is fetched before
+			const auto source = GetProfilerSource();
+			const auto start = Game_Clock::now();
+			{
+				EP_INSTRUMENT_SCOPE("Interpreter::ExecuteCommand", code);
+				executed = ExecuteCommand();
+			}
+			EventProfiler::AddCommand(source, code, Game_Clock::now() - start);
+		} else {
+			EP_INSTRUMENT_SCOPE("Interpreter::ExecuteCommand", code);
+			executed = ExecuteCommand();
+		}
+		if (!executed) {
 			break;
 		}
 
@@ -501,6 +546,12 @@ void Game_Interpreter::Update(bool reset_loop_count) {
 		int event_id = frame ? frame->event_id : 0;
 		// Executed Events Count exceeded (10000)
 		Output::Debug("Event {} exceeded execution limit", event_id);
+
+		if (frame && EventProfiler::IsEnabled()) {
+			const auto& list = GetFrameCommands();
+			const int index = Utils::Clamp(frame->current_command - 1, 0, list.size() - 1);
+			EventProfiler::AddLoopLimit(GetProfilerSource(), list[index].code);
+		}
 	}
 
 	if (Game_Map::GetNeedRefresh()) {
@@ -510,15 +561,15 @@ void Game_Interpreter::Update(bool reset_loop_count) {
 
 // Setup Starting Event
 void Game_Interpreter::Push(Game_Event* ev) {
-	Push(ev->GetList(), ev->GetId(), ev->WasStartedByDecisionKey());
+	Push(ev->GetCommandList(ev->GetActivePage()), ev->GetId(), ev->WasStartedByDecisionKey());
 }
 
 void Game_Interpreter::Push(Game_Event* ev, const lcf::rpg::EventPage* page, bool triggered_by_decision_key) {
-	Push(page->event_commands, ev->GetId(), triggered_by_decision_key);
+	Push(ev->GetCommandList(page), ev->GetId(), triggered_by_decision_key);
 }
 
 void Game_Interpreter::Push(Game_CommonEvent* ev) {
-	Push(ev->GetList(), 0, false);
+	Push(ev->GetCommandList(), 0, false);
 }
 
 bool Game_Interpreter::CheckGameOver() {
@@ -534,22 +585,14 @@ bool Game_Interpreter::CheckGameOver() {
 
 void Game_Interpreter::SkipToNextConditional(std::initializer_list<Cmd> codes, int indent) {
 	auto& frame = GetFrame();
-	const auto& list = frame.commands;
+	const auto& list = GetFrameCommands();
 	auto& index = frame.current_command;
 
-	if (index >= static_cast<int>(list.size())) {
+	if (index >= list.size()) {
 		return;
 	}
 
-	for (++index; index < static_cast<int>(list.size()); ++index) {
-		const auto& com = list[index];
-		if (com.indent > indent) {
-			continue;
-		}
-		if (std::find(codes.begin(), codes.end(), static_cast<Cmd>(com.code)) != codes.end()) {
-			break;
-		}
-	}
+	index = list.FindNext(index, codes, indent);
 }
 
 int Game_Interpreter::DecodeInt(lcf::DBArray<int32_t>::const_iterator& it) {
@@ -605,7 +648,7 @@ lcf::rpg::MoveCommand Game_Interpreter::DecodeMove(lcf::DBArray<int32_t>::const_
 // Execute Command.
 bool Game_Interpreter::ExecuteCommand() {
 	auto& frame = GetFrame();
-	const auto& com = frame.commands[frame.current_command];
+	const auto& com = GetFrameCommands()[frame.current_command];
 
 	switch (static_cast<Cmd>(com.code)) {
 		case Cmd::ShowMessage:
@@ -840,6 +883,7 @@ bool Game_Interpreter::OnFinishStackFrame() {
 	} else {
 		// If a called frame, or base frame of foreground interpreter, pop the stack.
 		_state.stack.pop_back();
+		_frame_commands.pop_back();
 	}
 
 	return !is_base_frame;
@@ -847,7 +891,7 @@ bool Game_Interpreter::OnFinishStackFrame() {
 
 std::vector<std::string> Game_Interpreter::GetChoices(int max_num_choices) {
 	const auto& frame = GetFrame();
-	const auto& list = frame.commands;
+	const auto& list = GetFrameCommands();
 	auto& index = frame.current_command;
 
 	// Let's find the choices
@@ -924,7 +968,7 @@ bool isCommand(std::string cmd) {
 
 bool Game_Interpreter::CommandShowMessage(lcf::rpg::EventCommand const& com) { // code 10110
 	auto& frame = GetFrame();
-	const auto& list = frame.commands;
+	const auto& list = GetFrameCommands();
 	auto& index = frame.current_command;
 
 	if (!Game_Message::CanShowMessage(main_flag)) {
@@ -1268,7 +1312,7 @@ bool Game_Interpreter::CommandControlVariables(lcf::rpg::EventCommand const& com
 		}
 		case 21:
 			// Expression (Maniac)
-			value = ManiacPatch::ParseExpression(MakeSpan(com.parameters).subspan(6, com.parameters[5]), *this);
+			value = EvaluateExpression(com, 5);
 			break;
 		default:
 			Output::Warning("ControlVariables: Unsupported operand {}", operand);
@@ -1298,8 +1342,7 @@ bool Game_Interpreter::CommandControlVariables(lcf::rpg::EventCommand const& com
 			end = Main_Data::game_variables->Get(com.parameters[2]);
 		} else if (target == 4 && Player::IsPatchManiac()) {
 			// Expression (Maniac)
-			int idx = com.parameters[1];
-			start = ManiacPatch::ParseExpression(MakeSpan(com.parameters).subspan(idx + 1, com.parameters[idx]), *this);
+			start = EvaluateExpression(com, com.parameters[1]);
 			end = start;
 		} else {
 			return true;
@@ -1780,6 +1823,17 @@ int Game_Interpreter::ValueOrVariable(int mode, int val) {
 	return -1;
 }
 
+int Game_Interpreter::EvaluateExpression(const lcf::rpg::EventCommand& com, int size_param) const {
+	if (!_state.stack.empty()) {
+		const auto& list = GetFrameCommands();
+		const int index = GetFrame().current_command;
+		if (index < list.size() && &list[index] == &com) {
+			return ManiacPatch::EvaluateExpression(list.GetExpression(index, size_param), *this);
+		}
+	}
+	return ManiacPatch::ParseExpression(MakeSpan(com.parameters).subspan(size_param + 1, com.parameters[size_param]), *this);
+}
+
 bool Game_Interpreter::CommandChangeParameters(lcf::rpg::EventCommand const& com) { // Code 10430
 	int value = OperateValue(
 		com.parameters[2],
@@ -2071,12 +2125,12 @@ bool Game_Interpreter::CommandComment(const lcf::rpg::EventCommand &com) {
 		}
 
 		auto& frame = GetFrame();
-		const auto& list = frame.commands;
+		const auto& list = GetFrameCommands();
 		auto& index = frame.current_command;
 
 		std::string command = ToString(com.string);
 		// Concat everything that is not another command or a new comment block
-		for (size_t i = index + 1; i < list.size(); ++i) {
+		for (int i = index + 1; i < list.size(); ++i) {
 			const auto& cmd = list[i];
 			if (cmd.code == static_cast<uint32_t>(Cmd::Comment_2) &&
 					!cmd.string.empty() && cmd.string[0] != '@') {
@@ -2093,7 +2147,7 @@ bool Game_Interpreter::CommandComment(const lcf::rpg::EventCommand &com) {
 
 void Game_Interpreter::EndEventProcessing() {
 	auto& frame = GetFrame();
-	const auto& list = frame.commands;
+	const auto& list = GetFrameCommands();
 	auto& index = frame.current_command;
 
 	index = static_cast<int>(list.size());
@@ -3593,18 +3647,14 @@ bool Game_Interpreter::CommandEndBranch(lcf::rpg::EventCommand const& /* com */)
 
 bool Game_Interpreter::CommandJumpToLabel(lcf::rpg::EventCommand const& com) { // code 12120
 	auto& frame = GetFrame();
-	const auto& list = frame.commands;
+	const auto& list = GetFrameCommands();
 	auto& index = frame.current_command;
 
 	int label_id = com.parameters[0];
 
-	for (int idx = 0; (size_t)idx < list.size(); idx++) {
-		if (static_cast<Cmd>(list[idx].code) != Cmd::Label)
-			continue;
-		if (list[idx].parameters[0] != label_id)
-			continue;
+	int idx = list.FindLabel(label_id);
+	if (idx >= 0) {
 		index = idx;
-		break;
 	}
 
 	return true;
@@ -3674,7 +3724,7 @@ bool Game_Interpreter::CommandLoop(lcf::rpg::EventCommand const& com) { // code
 
 bool Game_Interpreter::CommandBreakLoop(lcf::rpg::EventCommand const& /* com */) { // code 12220
 	auto& frame = GetFrame();
-	const auto& list = frame.commands;
+	const auto& list = GetFrameCommands();
 	auto& index = frame.current_command;
 
 	// BreakLoop will jump to the end of the event if there is no loop.
@@ -3688,24 +3738,16 @@ bool Game_Interpreter::CommandBreakLoop(lcf::rpg::EventCommand const& /* com */)
 
 	// This emulates an RPG_RT bug where break loop ignores scopes and
 	// unconditionally jumps to the next EndLoop command.
-	auto pcode = static_cast<Cmd>(list[index].code);
-	for (++index; index < (int)list.size(); ++index) {
-		if (pcode == Cmd::EndLoop) {
-			break;
-		}
-		pcode = static_cast<Cmd>(list[index].code);
-	}
+	index = std::min(list.FindNextEndLoop(index) + 1, list.size());
 
 	return true;
 }
 
 bool Game_Interpreter::CommandEndLoop(lcf::rpg::EventCommand const& com) { // code 22210
 	auto& frame = GetFrame();
-	const auto& list = frame.commands;
+	const auto& list = GetFrameCommands();
 	auto& index = frame.current_command;
 
-	int indent = com.indent;
-
 	if (Player::IsPatchManiac() && com.parameters.size() >= 5 && com.parameters[0] != 0) {
 		int type = com.parameters[0];
 		int offset = com.indent * 2;
@@ -3758,19 +3800,14 @@ bool Game_Interpreter::CommandEndLoop(lcf::rpg::EventCommand const& com) { // co
 	}
 
 	// Restart the loop
-	for (int idx = index; idx >= 0; idx--) {
-		if (list[idx].indent > indent)
-			continue;
-		if (list[idx].indent < indent)
-			return false;
-		if (static_cast<Cmd>(list[idx].code) != Cmd::Loop)
-			continue;
-		index = idx;
-		break;
+	int loop_start = list.FindLoopStart(index);
+	if (loop_start < 0) {
+		return false;
 	}
+	index = loop_start;
 
 	// Jump past the Cmd::Loop to the first command.
-	if (index < (int)frame.commands.size()) {
+	if (index < list.size()) {
 		++index;
 	}
 
@@ -3846,7 +3883,7 @@ bool Game_Interpreter::CommandCallEvent(lcf::rpg::EventCommand const& com) { //
 		return false;
 	}
 
-	Push(page->event_commands, event->GetId(), false);
+	Push(event, page, false);
 
 	return true;
 }
@@ -3940,27 +3977,34 @@ bool Game_Interpreter::CommandManiacGetSaveInfo(lcf::rpg::EventCommand const& co
 		return true;
 	}
 
+	SaveWriter::Flush();
 	auto savefs = FileFinder::Save();
 	std::string save_name = Scene_Save::GetSaveFilename(savefs, save_number);
 	auto save_stream = FileFinder::Save().OpenInputStream(save_name);
-	auto save = lcf::LSD_Reader::Load(save_stream, Player::encoding);
+	lcf::rpg::SaveTitle title;
 
-	if (!save) {
-		Output::Debug("ManiacGetSaveInfo: Save not found {}", save_number);
-		return true;
+	if (!save_stream || !SaveHeader::Read(save_stream, Player::encoding, title)) {
+		save_stream = FileFinder::Save().OpenInputStream(save_name);
+		auto save = lcf::LSD_Reader::Load(save_stream, Player::encoding);
+
+		if (!save) {
+			Output::Debug("ManiacGetSaveInfo: Save not found {}", save_number);
+			return true;
+		}
+		title = std::move(save->title);
 	}
 
-	std::time_t t = lcf::LSD_Reader::ToUnixTimestamp(save->title.timestamp);
+	std::time_t t = lcf::LSD_Reader::ToUnixTimestamp(title.timestamp);
 	std::tm* tm = std::gmtime(&t);
 
 	Main_Data::game_variables->Set(com.parameters[2], atoi(Utils::FormatDate(tm, Utils::DateFormat_YYMMDD).c_str()));
 	Main_Data::game_variables->Set(com.parameters[3], atoi(Utils::FormatDate(tm, Utils::DateFormat_HHMMSS).c_str()));
-	Main_Data::game_variables->Set(com.parameters[4], save->title.hero_level);
-	Main_Data::game_variables->Set(com.parameters[5], save->title.hero_hp);
+	Main_Data::game_variables->Set(com.parameters[4], title.hero_level);
+	Main_Data::game_variables->Set(com.parameters[5], title.hero_hp);
 	Game_Map::SetNeedRefresh(true);
 
-	auto face_ids = Utils::MakeArray(save->title.face1_id, save->title.face2_id, save->title.face3_id, save->title.face4_id);
-	auto face_names = Utils::MakeArray(save->title.face1_name, save->title.face2_name, save->title.face3_name, save->title.face4_name);
+	auto face_ids = Utils::MakeArray(title.face1_id, title.face2_id, title.face3_id, title.face4_id);
+	auto face_names = Utils::MakeArray(title.face1_name, title.face2_name, title.face3_name, title.face4_name);
 
 	for (int i = 0; i <= 3; ++i) {
 		const int param = 8 + i;
@@ -4032,6 +4076,7 @@ bool Game_Interpreter::CommandManiacLoad(lcf::rpg::EventCommand const& com) {
 	// Not implemented (kinda useless feature):
 	// When com.parameters[2] is 1 the check whether the file exists is skipped
 	// When skipped and missing RPG_RT will crash
+	SaveWriter::Flush();
 	auto savefs = FileFinder::Save();
 	std::string save_name = Scene_Save::GetSaveFilename(savefs, slot);
 	auto save_stream = FileFinder::Save().OpenInputStream(save_name);
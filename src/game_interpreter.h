@@ -20,6 +20,7 @@
 
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include "async_handler.h"
@@ -32,6 +33,7 @@
 #include <lcf/rpg/saveeventexecstate.h>
 #include <lcf/flag_set.h>
 #include "async_op.h"
+#include "event_command_list.h"
 
 class Game_Event;
 class Game_CommonEvent;
@@ -45,6 +47,12 @@ class Game_Interpreter
 public:
 	using Cmd = lcf::rpg::EventCommand::Code;
 
+	/**
+	 * Event commands of a stack frame. The list is shared between all
+	 * frames that run the same event code and is never modified.
+	 */
+	using CommandList = std::shared_ptr<const EventCommandList>;
+
 	static Game_Interpreter& GetForegroundInterpreter();
 
 	Game_Interpreter(bool _main_flag = false);
@@ -68,6 +76,11 @@ public:
 			int _event_id,
 			bool started_by_decision_key = false
 	);
+	void Push(
+			CommandList _list,
+			int _event_id,
+			bool started_by_decision_key = false
+	);
 	void Push(Game_Event* ev);
 	void Push(Game_Event* ev, const lcf::rpg::EventPage* page, bool triggered_by_decision_key);
 	void Push(Game_CommonEvent* ev);
@@ -116,6 +129,12 @@ protected:
 	const lcf::rpg::SaveEventExecFrame* GetFramePtr() const;
 	lcf::rpg::SaveEventExecFrame* GetFramePtr();
 
+	/** @return event commands of the current frame */
+	const EventCommandList& GetFrameCommands() const;
+
+	/** @return event of the current frame for the EventProfiler */
+	EventProfiler::Source GetProfilerSource() const;
+
 	bool main_flag;
 
 	int loop_count = 0;
@@ -164,6 +183,16 @@ protected:
 	static std::vector<Game_Actor*> GetActors(int mode, int id);
 	static int ValueOrVariable(int mode, int val);
 
+	/**
+	 * Evaluates the Maniac Patch expression stored in a command.
+	 * The compiled expression is cached when the command belongs to the current frame.
+	 *
+	 * @param com event command
+	 * @param size_param parameter holding the op code count, the op codes follow it
+	 * @return result of the expression
+	 */
+	int EvaluateExpression(const lcf::rpg::EventCommand& com, int size_param) const;
+
 	/**
 	 * When current frame finishes executing we pop the stack
 	 */
@@ -324,6 +353,11 @@ protected:
 	bool ManiacCheckContinueLoop(int val, int val2, int type, int op) const;
 
 	lcf::rpg::SaveEventExecState _state;
+	/**
+	 * Event commands of every frame in _state.stack.
+	 * The commands of the frames are only filled in GetState.
+	 */
+	std::vector<CommandList> _frame_commands;
 	KeyInputState _keyinput;
 	AsyncOp _async_op = {};
 };
@@ -348,6 +382,10 @@ inline lcf::rpg::SaveEventExecFrame& Game_Interpreter::GetFrame() {
 	return *frame;
 }
 
+inline const EventCommandList& Game_Interpreter::GetFrameCommands() const {
+	assert(!_frame_commands.empty());
+	return *_frame_commands.back();
+}
 
 inline int Game_Interpreter::GetCurrentEventId() const {
 	return !_state.stack.empty() ? _state.stack.back().event_id : 0;
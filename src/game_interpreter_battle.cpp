@@ -156,7 +156,7 @@ int Game_Interpreter_Battle::ScheduleNextPage(lcf::rpg::TroopPageCondition::Flag
 // Execute Command.
 bool Game_Interpreter_Battle::ExecuteCommand() {
 	auto& frame = GetFrame();
-	const auto& com = frame.commands[frame.current_command];
+	const auto& com = GetFrameCommands()[frame.current_command];
 
 	switch (static_cast<Cmd>(com.code)) {
 		case Cmd::CallCommonEvent:
@@ -73,6 +73,11 @@ enum InnSubcommand {
 void Game_Interpreter_Map::SetState(const lcf::rpg::SaveEventExecState& save) {
 	Clear();
 	_state = save;
+	_frame_commands.reserve(_state.stack.size());
+	for (auto& frame: _state.stack) {
+		_frame_commands.push_back(std::make_shared<const EventCommandList>(std::move(frame.commands)));
+		frame.commands.clear();
+	}
 	_keyinput.fromSave(save);
 }
 
@@ -88,7 +93,7 @@ void Game_Interpreter_Map::OnMapChange() {
  */
 bool Game_Interpreter_Map::ExecuteCommand() {
 	auto& frame = GetFrame();
-	const auto& com = frame.commands[frame.current_command];
+	const auto& com = GetFrameCommands()[frame.current_command];
 
 	switch (static_cast<Cmd>(com.code)) {
 		case Cmd::RecallToLocation:
@@ -21,7 +21,10 @@
 #include <sstream>
 #include <algorithm>
 #include <climits>
+#include <functional>
+#include <map>
 
+#include "asset_prefetch.h"
 #include "async_handler.h"
 #include "system.h"
 #include "game_battle.h"
@@ -29,6 +32,7 @@
 #include "game_map.h"
 #include "game_interpreter_map.h"
 #include "game_switches.h"
+#include "game_variables.h"
 #include "game_player.h"
 #include "game_party.h"
 #include "game_message.h"
@@ -38,6 +42,7 @@
 #include "scene_map.h"
 #include <lcf/lmu/reader.h>
 #include <lcf/reader_lcf.h>
+#include "map_cache.h"
 #include "map_data.h"
 #include "main_data.h"
 #include "output.h"
@@ -52,6 +57,8 @@
 #include <lcf/rpg/save.h>
 #include "scene_gameover.h"
 #include "feature.h"
+#include "instrumentation.h"
+#include "event_profiler.h"
 
 namespace {
 	lcf::rpg::SaveMapInfo map_info;
@@ -66,6 +73,40 @@ namespace {
 	std::vector<Game_Event> events;
 	std::vector<Game_CommonEvent> common_events;
 
+	// Tile index of the events: The events on a tile are a linked list
+	// ordered by their position in the events vector.
+	// Tile -> index of the first event on the tile or -1
+	std::vector<int> event_grid;
+	// Event index -> index of the next event on the same tile or -1
+	std::vector<int> event_grid_next;
+	// Event index -> tile the event is registered on or -1
+	std::vector<int> event_grid_tile;
+
+	// A value read by the page conditions of map events, see Game_Map::Refresh
+	struct RefreshDependency {
+		enum Type {
+			eSwitch,
+			eVariable,
+			eItem,
+			eActor,
+			eTimer1,
+			eTimer2
+		};
+
+		Type type;
+		int id;
+		// Value during the last refresh
+		int value;
+		// Indices of the events with pages reading this value
+		std::vector<int> events;
+	};
+	std::vector<RefreshDependency> refresh_dependencies;
+	// Per event: Needs a page refresh in the current Refresh call
+	std::vector<uint8_t> refresh_pending;
+	// When false the next refresh refreshes all events
+	bool refresh_dependencies_valid = false;
+	int refreshed_event_count = 0;
+
 	std::unique_ptr<lcf::rpg::Map> map;
 
 	std::unique_ptr<Game_Interpreter_Map> interpreter;
@@ -85,6 +126,178 @@ namespace Game_Map {
 void SetupCommon();
 }
 
+static int GetEventGridTile(const Game_Event& ev) {
+	// Events outside of the map are not indexed, they are found by
+	// the fallback path of ForEachEventAt
+	if (!Game_Map::IsValid(ev.GetX(), ev.GetY())) {
+		return -1;
+	}
+	return ev.GetX() + ev.GetY() * Game_Map::GetWidth();
+}
+
+static void EventGridRemove(int index) {
+	int tile = event_grid_tile[index];
+	if (tile < 0) {
+		return;
+	}
+
+	int* link = &event_grid[tile];
+	while (*link != index) {
+		link = &event_grid_next[*link];
+	}
+	*link = event_grid_next[index];
+
+	event_grid_next[index] = -1;
+	event_grid_tile[index] = -1;
+}
+
+static void EventGridInsert(int index, int tile) {
+	if (tile < 0) {
+		return;
+	}
+
+	int* link = &event_grid[tile];
+	while (*link >= 0 && *link < index) {
+		link = &event_grid_next[*link];
+	}
+	event_grid_next[index] = *link;
+	*link = index;
+
+	event_grid_tile[index] = tile;
+}
+
+static void RebuildEventGrid() {
+	event_grid.assign(Game_Map::GetWidth() * Game_Map::GetHeight(), -1);
+	event_grid_next.assign(events.size(), -1);
+	event_grid_tile.assign(events.size(), -1);
+
+	// Reverse order: Every insert ends at the head of the list
+	for (int i = static_cast<int>(events.size()) - 1; i >= 0; --i) {
+		EventGridInsert(i, GetEventGridTile(events[i]));
+	}
+}
+
+/**
+ * Calls fn for every event at (x, y) in the order of the events vector.
+ * The next event is looked up after fn returns, so fn is allowed to move events.
+ *
+ * @param fn callback taking a Game_Event&, return true to stop the iteration
+ */
+template <typename F>
+static void ForEachEventAt(int x, int y, F&& fn) {
+	if (!Game_Map::IsValid(x, y) || event_grid.empty()) {
+		for (auto& ev: events) {
+			if (ev.IsInPosition(x, y) && fn(ev)) {
+				return;
+			}
+		}
+		return;
+	}
+
+	const int tile = x + y * Game_Map::GetWidth();
+	int last = -1;
+	while (true) {
+		int i = event_grid[tile];
+		while (i >= 0 && i <= last) {
+			i = event_grid_next[i];
+		}
+		if (i < 0 || fn(events[i])) {
+			return;
+		}
+		last = i;
+	}
+}
+
+void Game_Map::UpdateEventPosition(const Game_Event& ev) {
+	// Events which are not (yet) part of the index, e.g. during construction
+	if (event_grid_tile.empty()
+			|| std::less<const Game_Event*>()(&ev, &events.front())
+			|| std::less<const Game_Event*>()(&events.back(), &ev)) {
+		return;
+	}
+
+	const int index = static_cast<int>(&ev - events.data());
+	if (index >= static_cast<int>(event_grid_tile.size())) {
+		return;
+	}
+
+	const int tile = GetEventGridTile(ev);
+	if (tile == event_grid_tile[index]) {
+		return;
+	}
+
+	EventGridRemove(index);
+	EventGridInsert(index, tile);
+}
+
+static void BuildRefreshDependencies() {
+	using Dep = RefreshDependency;
+
+	refresh_dependencies.clear();
+	refresh_pending.assign(events.size(), 0);
+	refresh_dependencies_valid = false;
+
+	std::map<std::pair<int, int>, int> lookup;
+	auto add = [&](Dep::Type type, int id, int event_index) {
+		auto it = lookup.emplace(std::make_pair(static_cast<int>(type), id), static_cast<int>(refresh_dependencies.size())).first;
+		if (it->second == static_cast<int>(refresh_dependencies.size())) {
+			refresh_dependencies.push_back({ type, id, 0, {} });
+		}
+		auto& dep_events = refresh_dependencies[it->second].events;
+		if (dep_events.empty() || dep_events.back() != event_index) {
+			dep_events.push_back(event_index);
+		}
+	};
+
+	// The events vector is created from the map events in the same order
+	for (int i = 0; i < static_cast<int>(map->events.size()); ++i) {
+		for (const auto& page: map->events[i].pages) {
+			const auto& cond = page.condition;
+			if (cond.flags.switch_a) {
+				add(Dep::eSwitch, cond.switch_a_id, i);
+			}
+			if (cond.flags.switch_b) {
+				add(Dep::eSwitch, cond.switch_b_id, i);
+			}
+			if (cond.flags.variable) {
+				add(Dep::eVariable, cond.variable_id, i);
+			}
+			if (cond.flags.item) {
+				add(Dep::eItem, cond.item_id, i);
+			}
+			if (cond.flags.actor) {
+				add(Dep::eActor, cond.actor_id, i);
+			}
+			if (cond.flags.timer) {
+				add(Dep::eTimer1, 0, i);
+			}
+			if (cond.flags.timer2) {
+				add(Dep::eTimer2, 0, i);
+			}
+		}
+	}
+}
+
+static int GetRefreshDependencyValue(const RefreshDependency& dep) {
+	using Dep = RefreshDependency;
+
+	switch (dep.type) {
+		case Dep::eSwitch:
+			return Main_Data::game_switches->GetInt(dep.id);
+		case Dep::eVariable:
+			return Main_Data::game_variables->Get(dep.id);
+		case Dep::eItem:
+			return Main_Data::game_party->GetItemCount(dep.id) + Main_Data::game_party->GetEquippedItemCount(dep.id);
+		case Dep::eActor:
+			return Main_Data::game_party->IsActorInParty(dep.id) ? 1 : 0;
+		case Dep::eTimer1:
+			return Main_Data::game_party->GetTimerSeconds(Main_Data::game_party->Timer1);
+		case Dep::eTimer2:
+			return Main_Data::game_party->GetTimerSeconds(Main_Data::game_party->Timer2);
+	}
+	return 0;
+}
+
 void Game_Map::OnContinueFromBattle() {
 	Main_Data::game_system->BgmPlay(Main_Data::game_system->GetBeforeBattleMusic());
 }
@@ -113,7 +326,14 @@ void Game_Map::Init() {
 }
 
 void Game_Map::Dispose() {
+	AssetPrefetch::Reset();
 	events.clear();
+	event_grid.clear();
+	event_grid_next.clear();
+	event_grid_tile.clear();
+	refresh_dependencies.clear();
+	refresh_pending.clear();
+	refresh_dependencies_valid = false;
 	map.reset();
 	map_info = {};
 	panorama = {};
@@ -229,6 +449,10 @@ void Game_Map::SetupFromSave(
 			auto& ev = events[i];
 			ev.SetSaveData(map_info.events[i]);
 		}
+		// Positions were restored without SetX/SetY
+		RebuildEventGrid();
+		// Pages are restored on the next full refresh
+		refresh_dependencies_valid = false;
 	}
 	map_info.events.clear();
 	interpreter->Clear();
@@ -265,51 +489,51 @@ void Game_Map::SetupFromSave(
 }
 
 std::unique_ptr<lcf::rpg::Map> Game_Map::loadMapFile(int map_id) {
-	std::unique_ptr<lcf::rpg::Map> map;
+	auto map_file = MapCache::Get(map_id);
 
-	// Try loading EasyRPG map files first, then fallback to normal RPG Maker
-	// FIXME: Assert map was cached for async platforms
-	std::string map_name = Game_Map::ConstructMapName(map_id, true);
-	std::string map_file = FileFinder::Game().FindFile(map_name);
-	if (map_file.empty()) {
-		map_name = Game_Map::ConstructMapName(map_id, false);
-		map_file = FileFinder::Game().FindFile(map_name);
-
-		if (map_file.empty()) {
-			Output::Error("Loading of Map {} failed.\nThe map was not found.", map_name);
-			return nullptr;
+	if (map_file.map) {
+		Output::Debug("Loaded Map {} from cache", map_id);
+	} else {
+		// Try loading EasyRPG map files first, then fallback to normal RPG Maker
+		// FIXME: Assert map was cached for async platforms
+		std::string map_name = Game_Map::ConstructMapName(map_id, true);
+		std::string map_path = FileFinder::Game().FindFile(map_name);
+		const bool lmu = map_path.empty();
+		if (lmu) {
+			map_name = Game_Map::ConstructMapName(map_id, false);
+			map_path = FileFinder::Game().FindFile(map_name);
+
+			if (map_path.empty()) {
+				Output::Error("Loading of Map {} failed.\nThe map was not found.", map_name);
+				return nullptr;
+			}
 		}
 
-		auto map_stream = FileFinder::Game().OpenInputStream(map_file);
+		auto map_stream = FileFinder::Game().OpenInputStream(map_path);
 		if (!map_stream) {
 			Output::Error("Loading of Map {} failed.\nMap not readable.", map_name);
 			return nullptr;
 		}
 
-		map = lcf::LMU_Reader::Load(map_stream, Player::encoding);
+		map_file = MapCache::Parse(map_stream, lmu, Player::encoding);
 
-		if (Input::IsRecording()) {
-			map_stream.clear();
-			map_stream.seekg(0);
-			Input::AddRecordingData(Input::RecordingData::Hash,
-						   fmt::format("map{:04} {:#08x}", map_id, Utils::CRC32(map_stream)));
-		}
-	} else {
-		auto map_stream = FileFinder::Game().OpenInputStream(map_file);
-		if (!map_stream) {
-			Output::Error("Loading of Map {} failed.\nMap not readable.", map_name);
+		Output::Debug("Loaded Map {}", map_name);
+
+		if (!map_file.map) {
+			Output::ErrorStr(lcf::LcfReader::GetError());
 			return nullptr;
 		}
-		map = lcf::LMU_Reader::LoadXml(map_stream);
-	}
 
-	Output::Debug("Loaded Map {}", map_name);
+		MapCache::Add(map_id, map_file);
+	}
 
-	if (map.get() == NULL) {
-		Output::ErrorStr(lcf::LcfReader::GetError());
+	if (map_file.lmu && Input::IsRecording()) {
+		Input::AddRecordingData(Input::RecordingData::Hash,
+					   fmt::format("map{:04} {:#08x}", map_id, map_file.crc));
 	}
 
-	return map;
+	// The cached map must stay unmodified, e.g. translations rewrite the messages
+	return std::make_unique<lcf::rpg::Map>(*map_file.map);
 }
 
 void Game_Map::SetupCommon() {
@@ -352,6 +576,12 @@ void Game_Map::SetupCommon() {
 	for (const auto& ev : map->events) {
 		events.emplace_back(GetMapId(), &ev);
 	}
+
+	RebuildEventGrid();
+	BuildRefreshDependencies();
+
+	AssetPrefetch::OnMapSetup(*map);
+	MapCache::OnMapSetup(*map, GetMapId());
 }
 
 void Game_Map::PrepareSave(lcf::rpg::Save& save) {
@@ -413,15 +643,49 @@ const std::vector<uint8_t>& Game_Map::GetTilesLayer(int layer) {
 }
 
 void Game_Map::Refresh() {
+	refreshed_event_count = 0;
+
 	if (GetMapId() > 0) {
-		for (Game_Event& ev : events) {
-			ev.RefreshPage();
+		if (!refresh_dependencies_valid) {
+			for (Game_Event& ev : events) {
+				ev.RefreshPage();
+			}
+			refreshed_event_count = static_cast<int>(events.size());
+			for (auto& dep: refresh_dependencies) {
+				dep.value = GetRefreshDependencyValue(dep);
+			}
+			refresh_dependencies_valid = true;
+		} else {
+			// Only events with a page condition reading a changed value can change their page.
+			for (auto& dep: refresh_dependencies) {
+				const int value = GetRefreshDependencyValue(dep);
+				if (value != dep.value) {
+					dep.value = value;
+					for (int i: dep.events) {
+						refresh_pending[i] = 1;
+					}
+				}
+			}
+
+			for (size_t i = 0; i < events.size(); ++i) {
+				// Events without a page are always refreshed because RefreshPage
+				// resets their state even when no page is found.
+				if (refresh_pending[i] || events[i].GetActivePage() == nullptr) {
+					refresh_pending[i] = 0;
+					events[i].RefreshPage();
+					++refreshed_event_count;
+				}
+			}
 		}
 	}
 
 	need_refresh = false;
 }
 
+int Game_Map::GetRefreshedEventCount() {
+	return refreshed_event_count;
+}
+
 Game_Interpreter_Map& Game_Map::GetInterpreter() {
 	assert(interpreter);
 	return *interpreter;
@@ -607,10 +871,13 @@ bool Game_Map::MakeWay(const Game_Character& self,
 
 	if (vehicle_type != Game_Vehicle::Airship) {
 		// Check for collision with events on the target tile.
-		for (auto& other: GetEvents()) {
-			if (MakeWayCollideEvent(to_x, to_y, self, other, self_conflict)) {
-				return false;
-			}
+		bool collision = false;
+		ForEachEventAt(to_x, to_y, [&](Game_Event& other) {
+			collision = MakeWayCollideEvent(to_x, to_y, self, other, self_conflict);
+			return collision;
+		});
+		if (collision) {
+			return false;
 		}
 		auto& player = Main_Data::game_player;
 		if (player->GetVehicleType() == Game_Vehicle::None) {
@@ -654,12 +921,13 @@ bool Game_Map::CanLandAirship(int x, int y) {
 		return false;
 	}
 
-	for (auto& ev: events) {
-		if (ev.IsInPosition(x, y)
-				&& ev.IsActive()
-				&& ev.GetActivePage() != nullptr) {
-			return false;
-		}
+	bool blocked = false;
+	ForEachEventAt(x, y, [&](Game_Event& ev) {
+		blocked = ev.IsActive() && ev.GetActivePage() != nullptr;
+		return blocked;
+	});
+	if (blocked) {
+		return false;
 	}
 	for (auto vid: { Game_Vehicle::Boat, Game_Vehicle::Ship }) {
 		auto& vehicle = vehicles[vid - 1];
@@ -692,13 +960,15 @@ bool Game_Map::CanDisembarkShip(Game_Player& player, int x, int y) {
 		return false;
 	}
 
-	for (auto& ev: GetEvents()) {
-		if (ev.IsInPosition(x, y)
-			&& ev.GetLayer() == lcf::rpg::EventPage::Layers_same
+	bool blocked = false;
+	ForEachEventAt(x, y, [&](Game_Event& ev) {
+		blocked = ev.GetLayer() == lcf::rpg::EventPage::Layers_same
 			&& ev.IsActive()
-			&& ev.GetActivePage() != nullptr) {
-			return false;
-		}
+			&& ev.GetActivePage() != nullptr;
+		return blocked;
+	});
+	if (blocked) {
+		return false;
 	}
 
 	int bit = GetPassableMask(x, y, player.GetX(), player.GetY());
@@ -759,20 +1029,21 @@ bool Game_Map::IsPassableTile(const Game_Character* self, int bit, int x, int y)
 
 	// Highest ID event with layer=below, not through, and a tile graphic wins.
 	int event_tile_id = 0;
-	for (auto& ev: events) {
+	ForEachEventAt(x, y, [&](Game_Event& ev) {
 		if (self == &ev) {
-			continue;
+			return false;
 		}
 		if (!ev.IsActive() || ev.GetActivePage() == nullptr || ev.GetThrough()) {
-			continue;
+			return false;
 		}
-		if (ev.IsInPosition(x, y) && ev.GetLayer() == lcf::rpg::EventPage::Layers_below) {
+		if (ev.GetLayer() == lcf::rpg::EventPage::Layers_below) {
 			int tile_id = ev.GetTileId();
 			if (tile_id > 0) {
 				event_tile_id = tile_id;
 			}
 		}
-	}
+		return false;
+	});
 
 	// If there was a below tile event, and the tile is not above
 	// Override the chipset with event tile behavior.
@@ -869,22 +1140,24 @@ int Game_Map::GetTerrainTag(int x, int y) {
 }
 
 void Game_Map::GetEventsXY(std::vector<Game_Event*>& events, int x, int y) {
-	for (Game_Event& ev : GetEvents()) {
-		if (ev.IsInPosition(x, y) && ev.IsActive()) {
+	ForEachEventAt(x, y, [&](Game_Event& ev) {
+		if (ev.IsActive()) {
 			events.push_back(&ev);
 		}
-	}
+		return false;
+	});
 }
 
 Game_Event* Game_Map::GetEventAt(int x, int y, bool require_active) {
-	auto& events = GetEvents();
-	for (auto iter = events.rbegin(); iter != events.rend(); ++iter) {
-		auto& ev = *iter;
-		if (ev.IsInPosition(x, y) && (!require_active || ev.IsActive())) {
-			return &ev;
+	// The last matching event wins
+	Game_Event* result = nullptr;
+	ForEachEventAt(x, y, [&](Game_Event& ev) {
+		if (!require_active || ev.IsActive()) {
+			result = &ev;
 		}
-	}
-	return nullptr;
+		return false;
+	});
+	return result;
 }
 
 bool Game_Map::LoopHorizontal() {
@@ -947,6 +1220,7 @@ int Game_Map::CheckEvent(int x, int y) {
 
 void Game_Map::Update(MapUpdateAsyncContext& actx, bool is_preupdate) {
 	if (GetNeedRefresh()) {
+		EP_INSTRUMENT_SCOPE("Game_Map::Refresh");
 		Refresh();
 	}
 
@@ -956,6 +1230,7 @@ void Game_Map::Update(MapUpdateAsyncContext& actx, bool is_preupdate) {
 	}
 
 	if (!actx.IsActive() || actx.IsParallelCommonEvent()) {
+		EP_INSTRUMENT_SCOPE("Game_Map::UpdateCommonEvents");
 		if (!UpdateCommonEvents(actx)) {
 			// Suspend due to common event async op ...
 			return;
@@ -963,6 +1238,7 @@ void Game_Map::Update(MapUpdateAsyncContext& actx, bool is_preupdate) {
 	}
 
 	if (!actx.IsActive() || actx.IsParallelMapEvent()) {
+		EP_INSTRUMENT_SCOPE("Game_Map::UpdateMapEvents");
 		if (!UpdateMapEvents(actx)) {
 			// Suspend due to map event async op ...
 			return;
@@ -975,6 +1251,7 @@ void Game_Map::Update(MapUpdateAsyncContext& actx, bool is_preupdate) {
 
 	if (!actx.IsActive()) {
 		//If not resuming from async op ...
+		EP_INSTRUMENT_SCOPE("Game_Map::UpdatePlayer");
 		Main_Data::game_player->Update();
 
 		for (auto& vehicle: vehicles) {
@@ -985,6 +1262,7 @@ void Game_Map::Update(MapUpdateAsyncContext& actx, bool is_preupdate) {
 	}
 
 	if (!actx.IsActive() || actx.IsMessage()) {
+		EP_INSTRUMENT_SCOPE("Game_Map::UpdateMessage");
 		if (!UpdateMessage(actx)) {
 			// Suspend due to message async op ...
 			return;
@@ -992,12 +1270,14 @@ void Game_Map::Update(MapUpdateAsyncContext& actx, bool is_preupdate) {
 	}
 
 	if (!actx.IsActive()) {
+		EP_INSTRUMENT_SCOPE("Game_Map::UpdateScreen");
 		Main_Data::game_party->UpdateTimers();
 		Main_Data::game_screen->Update();
 		Main_Data::game_pictures->Update(false);
 	}
 
 	if (!actx.IsActive() || actx.IsForegroundEvent()) {
+		EP_INSTRUMENT_SCOPE("Game_Map::UpdateForegroundEvents");
 		if (!UpdateForegroundEvents(actx)) {
 			// Suspend due to foreground event async op ...
 			return;
@@ -1039,7 +1319,14 @@ bool Game_Map::UpdateCommonEvents(MapUpdateAsyncContext& actx) {
 			}
 		}
 
-		auto aop = ev.Update(resume_async);
+		AsyncOp aop;
+		if (EventProfiler::IsEnabled()) {
+			const auto start = Game_Clock::now();
+			aop = ev.Update(resume_async);
+			EventProfiler::AddUpdate({ 0, ev.GetIndex(), 0 }, Game_Clock::now() - start);
+		} else {
+			aop = ev.Update(resume_async);
+		}
 		if (aop.IsActive()) {
 			// Suspend due to this event ..
 			actx = MapUpdateAsyncContext::FromCommonEvent(ev.GetIndex(), aop);
@@ -1066,7 +1353,17 @@ bool Game_Map::UpdateMapEvents(MapUpdateAsyncContext& actx) {
 			}
 		}
 
-		auto aop = ev.Update(resume_async);
+		AsyncOp aop;
+		if (EventProfiler::IsEnabled()) {
+			// The update can change the active page
+			const auto* page = ev.GetActivePage();
+			const EventProfiler::Source source = { GetMapId(), ev.GetId(), page ? page->ID : 0 };
+			const auto start = Game_Clock::now();
+			aop = ev.Update(resume_async);
+			EventProfiler::AddUpdate(source, Game_Clock::now() - start);
+		} else {
+			aop = ev.Update(resume_async);
+		}
 		if (aop.IsActive()) {
 			// Suspend due to this event ..
 			actx = MapUpdateAsyncContext::FromMapEvent(ev.GetId(), aop);
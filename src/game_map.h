@@ -90,7 +90,7 @@ namespace Game_Map {
 	void Dispose();
 
 	/**
-	 * Loads the map from disk
+	 * Loads the map from disk or the MapCache
 	 *
 	 * @param map_id the id of the map to load
 	 * @return the map, or nullptr if it couldn't be loaded
@@ -140,9 +140,14 @@ namespace Game_Map {
 
 	/**
 	 * Refreshes the map.
+	 * Only events with a page condition reading a changed switch, variable,
+	 * item, actor or timer and events without an active page are refreshed.
 	 */
 	void Refresh();
 
+	/** @return amount of events whose page was refreshed by the last Refresh */
+	int GetRefreshedEventCount();
+
 	/** Actions to perform after finishing a battle */
 	void OnContinueFromBattle();
 
@@ -495,6 +500,15 @@ namespace Game_Map {
 
 	void GetEventsXY(std::vector<Game_Event*>& events, int x, int y);
 
+	/**
+	 * Updates the tile index used by the event position queries
+	 * after the position of the event changed.
+	 * Called by Game_Character::SetX and SetY.
+	 *
+	 * @param ev the event that moved
+	 */
+	void UpdateEventPosition(const Game_Event& ev);
+
 	/**
 	 * @param x x position on the map
 	 * @param y y position on the map
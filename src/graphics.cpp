@@ -30,11 +30,14 @@
 #include "drawable_mgr.h"
 #include "baseui.h"
 #include "game_clock.h"
+#include "damage_tracker.h"
+#include "worker_pool.h"
 
 using namespace std::chrono_literals;
 
 namespace Graphics {
 	void UpdateTitle();
+	const std::vector<Rect>& UpdateDamage(const Bitmap& dst);
 
 	std::shared_ptr<Scene> current_scene;
 
@@ -42,6 +45,11 @@ namespace Graphics {
 	std::unique_ptr<FpsOverlay> fps_overlay;
 
 	std::string window_title_key;
+
+	DamageTracker damage_tracker;
+	std::vector<DamageTracker::Entry> damage_entries;
+	/** Revision of the screen after the last Draw */
+	uint64_t drawn_revision = 0;
 }
 
 void Graphics::Init() {
@@ -64,6 +72,7 @@ void Graphics::Quit() {
 
 void Graphics::Update() {
 	fps_overlay->SetDrawFps(DisplayUi->RenderFps());
+	fps_overlay->SetDrawFrameStats(DisplayUi->RenderFrameStats());
 
 	//Update Graphics:
 	if (fps_overlay->Update()) {
@@ -114,9 +123,66 @@ void Graphics::Draw(Bitmap& dst) {
 		min_z = transition.GetZ();
 	} else if (transition.IsErasedNotActive()) {
 		min_z = transition.GetZ() + 1;
+	}
+
+	// Transitions and changes to the screen done elsewhere require a full redraw
+	if (min_z != std::numeric_limits<Drawable::Z_t>::min() || dst.GetRevision() != drawn_revision) {
+		damage_tracker.Invalidate();
+	}
+
+	const auto& damage = UpdateDamage(dst);
+	if (damage.empty()) {
+		return;
+	}
+
+	if (transition.IsErasedNotActive()) {
 		dst.Clear();
 	}
+
+	const bool partial = damage.size() > 1 || damage.front() != dst.GetRect();
+	if (partial) {
+		dst.SetClipRects(damage);
+	}
 	LocalDraw(dst, min_z, max_z);
+	if (partial) {
+		dst.SetClipRects({});
+	}
+
+	drawn_revision = dst.GetRevision();
+}
+
+const std::vector<Rect>& Graphics::UpdateDamage(const Bitmap& dst) {
+	auto& drawable_list = DrawableMgr::GetLocalList();
+
+	DrawHash key;
+	key.Add(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(&dst)));
+	key.Add(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(current_scene.get())));
+	key.Add(drawable_list.empty());
+
+	uint64_t background = 0;
+	if (!drawable_list.empty() && !current_scene->GetBackgroundHash(background)) {
+		damage_tracker.Invalidate();
+	}
+	key.Add(background);
+
+	damage_entries.clear();
+	for (auto* drawable : drawable_list) {
+		if (!drawable->IsVisible()) {
+			continue;
+		}
+
+		Drawable::DrawState state;
+		if (drawable->GetDrawState(dst, state)) {
+			state.hash = DrawHash(state.hash).Add(drawable->GetZ()).Get();
+		} else {
+			// Unknown output, removing it later must redraw everything
+			state.bounds = dst.GetRect();
+			damage_tracker.Invalidate();
+		}
+		damage_entries.push_back({ drawable, state.bounds, state.hash });
+	}
+
+	return damage_tracker.Update(key.Get(), dst.GetRect(), damage_entries);
 }
 
 void Graphics::LocalDraw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z) {
@@ -126,7 +192,49 @@ void Graphics::LocalDraw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z)
 		current_scene->DrawBackground(dst);
 	}
 
-	drawable_list.Draw(dst, min_z, max_z);
+	const int threads = Player::player_config.render_threads.Get();
+	if (threads > 1 && WorkerPool::IsEnabled()) {
+		drawable_list.Draw(dst, min_z, max_z, CreateBands(dst, threads));
+	} else {
+		drawable_list.Draw(dst, min_z, max_z);
+	}
+}
+
+std::vector<DrawableList::Band> Graphics::CreateBands(Bitmap& dst, int count) {
+	std::vector<DrawableList::Band> bands;
+
+	const auto& dst_clip = dst.GetClipRects();
+	const int width = dst.GetWidth();
+	const int height = dst.GetHeight();
+	// The bands write to the pixels of dst, this also assigns a new revision to dst
+	void* pixels = dst.pixels();
+
+	for (int i = 0; i < count; ++i) {
+		const int top = height * i / count;
+		const Rect rect(0, top, width, height * (i + 1) / count - top);
+
+		// Bands only draw the damaged parts of the screen as well
+		std::vector<Rect> clip;
+		if (dst_clip.empty()) {
+			clip.push_back(rect);
+		} else {
+			for (auto r : dst_clip) {
+				r.Adjust(rect);
+				if (!r.IsEmpty()) {
+					clip.push_back(r);
+				}
+			}
+		}
+		if (clip.empty()) {
+			continue;
+		}
+
+		auto bitmap = Bitmap::Create(pixels, width, height, dst.pitch(), dst.GetFormat());
+		bitmap->SetClipRects(clip);
+		bands.push_back({ std::move(bitmap), rect });
+	}
+
+	return bands;
 }
 
 std::shared_ptr<Scene> Graphics::UpdateSceneCallback() {
@@ -150,3 +258,7 @@ MessageOverlay& Graphics::GetMessageOverlay() {
 	return *message_overlay;
 }
 
+const DamageTracker& Graphics::GetDamageTracker() {
+	return damage_tracker;
+}
+
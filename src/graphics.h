@@ -25,6 +25,7 @@
 #include "drawable_list.h"
 #include "game_clock.h"
 
+class DamageTracker;
 class MessageOverlay;
 class Scene;
 
@@ -48,10 +49,26 @@ namespace Graphics {
 	 */
 	void Update();
 
+	/**
+	 * Draws the scene. Only the parts of dst that changed since the
+	 * previous call are redrawn, the rest of dst must be left untouched.
+	 *
+	 * @param dst screen surface
+	 */
 	void Draw(Bitmap& dst);
 
 	void LocalDraw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z);
 
+	/**
+	 * Splits dst into horizontal bands for a parallel DrawableList::Draw.
+	 * The bands share the pixels of dst and are clipped to its clip rects.
+	 *
+	 * @param dst screen surface
+	 * @param count number of bands
+	 * @return bands that contain parts of the clip rects
+	 */
+	std::vector<DrawableList::Band> CreateBands(Bitmap& dst, int count);
+
 	std::shared_ptr<Scene> UpdateSceneCallback();
 
 	/**
@@ -61,6 +78,9 @@ namespace Graphics {
 	 * @return message overlay
 	 */
 	MessageOverlay& GetMessageOverlay();
+
+	/** @return tracker of the screen parts redrawn by Draw */
+	const DamageTracker& GetDamageTracker();
 }
 
 #endif
@@ -21,7 +21,7 @@
 #include "filesystem_stream.h"
 
 namespace ImagePNG {
-	bool ReadPNG(const void* buffer, bool transparent, int& width, int& height, void*& pixels);
+	bool ReadPNG(const uint8_t* data, unsigned len, bool transparent, int& width, int& height, void*& pixels);
 	bool ReadPNG(Filesystem_Stream::InputStream& is, bool transparent, int& width, int& height, void*& pixels);
 	bool WritePNG(Filesystem_Stream::OutputStream& os, uint32_t width, uint32_t height, uint32_t* data);
 }
@@ -70,6 +70,7 @@ namespace Input {
 		TOGGLE_FPS,
 		TAKE_SCREENSHOT,
 		SHOW_LOG,
+		TOGGLE_TRACE,
 		RESET,
 		PAGE_UP,
 		PAGE_DOWN,
@@ -126,6 +127,7 @@ namespace Input {
 		"TOGGLE_FPS",
 		"TAKE_SCREENSHOT",
 		"SHOW_LOG",
+		"TOGGLE_TRACE",
 		"RESET",
 		"PAGE_UP",
 		"PAGE_DOWN",
@@ -168,6 +170,7 @@ namespace Input {
 		"Toggle the FPS display",
 		"Take a screenshot",
 		"Show the console log on the screen",
+		"Start or stop recording a performance trace",
 		"Reset to the title screen",
 		"Page up key",
 		"Page down key",
@@ -189,6 +192,7 @@ namespace Input {
 			case TOGGLE_FPS:
 			case TAKE_SCREENSHOT:
 			case SHOW_LOG:
+			case TOGGLE_TRACE:
 			case TOGGLE_ZOOM:
 			case FAST_FORWARD:
 			case FAST_FORWARD_PLUS:
@@ -93,6 +93,7 @@ Input::ButtonMappingArray Input::GetDefaultButtonMappings() {
 		{TAKE_SCREENSHOT, Keys::F7},
 		{TOGGLE_FPS, Keys::F2},
 		{SHOW_LOG, Keys::F3},
+		{TOGGLE_TRACE, Keys::F6},
 		{TOGGLE_FULLSCREEN, Keys::F4},
 		{TOGGLE_ZOOM, Keys::F5},
 		{PAGE_UP, Keys::PGUP},
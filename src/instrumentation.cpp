@@ -15,13 +15,76 @@
  * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
 #include "instrumentation.h"
+#include "filefinder.h"
+#include "game_clock.h"
+#include "output.h"
 #include "utils.h"
 
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 __itt_domain* Instrumentation::domain = nullptr;
 #endif
 
+std::atomic<bool> Instrumentation::tracing = { false };
+
+namespace {
+	struct TraceRecord {
+		const char* name;
+		int32_t arg;
+		int64_t start;
+		int64_t end;
+	};
+
+	constexpr uint32_t trace_capacity = 1 << 16;
+
+	/**
+	 * Written only by the owning thread while tracing. The reader takes the
+	 * records before head after all writers stopped, the oldest ones are
+	 * overwritten when the buffer is full.
+	 */
+	struct TraceBuffer {
+		std::array<TraceRecord, trace_capacity> records;
+		std::atomic<uint32_t> head = { 0 };
+		/** Set while the owning thread writes a record */
+		std::atomic<bool> writing = { false };
+		int thread_id = 0;
+	};
+
+	// Buffers stay registered after their thread exits so their records can be written
+	std::mutex buffers_mutex;
+	std::vector<std::shared_ptr<TraceBuffer>> buffers;
+	std::atomic<int64_t> trace_start = { 0 };
+
+	TraceBuffer& GetThreadBuffer() {
+		thread_local std::shared_ptr<TraceBuffer> buffer;
+		if (!buffer) {
+			buffer = std::make_shared<TraceBuffer>();
+			std::lock_guard<std::mutex> lock(buffers_mutex);
+			buffer->thread_id = static_cast<int>(buffers.size()) + 1;
+			buffers.push_back(buffer);
+		}
+		return *buffer;
+	}
+
+	void WriteJsonString(std::ostream& os, const char* str) {
+		os << '"';
+		for (; *str; ++str) {
+			if (*str == '"' || *str == '\\') {
+				os << '\\';
+			}
+			os << *str;
+		}
+		os << '"';
+	}
+}
+
 void Instrumentation::Init(const char* name) {
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 	assert(!domain);
@@ -34,3 +97,104 @@ void Instrumentation::Init(const char* name) {
 	(void)name;
 #endif
 }
+
+int64_t Instrumentation::Now() noexcept {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(Game_Clock::now().time_since_epoch()).count();
+}
+
+void Instrumentation::Record(const char* name, int32_t arg, int64_t start, int64_t end) noexcept {
+	auto& buffer = GetThreadBuffer();
+
+	// Pairs with StopTrace: Either the trace is still running and StopTrace
+	// waits for this record or the record is dropped.
+	buffer.writing.store(true);
+	if (!tracing.load()) {
+		buffer.writing.store(false, std::memory_order_release);
+		return;
+	}
+
+	const uint32_t head = buffer.head.load(std::memory_order_relaxed);
+	buffer.records[head % trace_capacity] = { name, arg, start, end };
+	buffer.head.store(head + 1, std::memory_order_relaxed);
+	buffer.writing.store(false, std::memory_order_release);
+}
+
+void Instrumentation::StartTrace() {
+	// Records that started before are filtered out when writing
+	trace_start.store(Now(), std::memory_order_relaxed);
+	tracing.store(true, std::memory_order_release);
+}
+
+void Instrumentation::StopTrace(std::ostream& os) {
+	tracing.store(false);
+	const int64_t start_time = trace_start.load(std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(buffers_mutex);
+
+	// Wait for records that are written right now, afterwards no thread
+	// touches the buffers until the next trace starts
+	for (const auto& buffer: buffers) {
+		while (buffer->writing.load(std::memory_order_acquire)) {
+			std::this_thread::yield();
+		}
+	}
+
+	os << "{\"traceEvents\":[";
+	bool first = true;
+	auto separator = [&]() {
+		os << (first ? "\n" : ",\n");
+		first = false;
+	};
+
+	for (const auto& buffer: buffers) {
+		separator();
+		os << fmt::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"Thread {}"}}}})",
+			buffer->thread_id, buffer->thread_id);
+
+		const uint32_t head = buffer->head.load(std::memory_order_acquire);
+		const uint32_t count = std::min(head, trace_capacity);
+		for (uint32_t i = head - count; i != head; ++i) {
+			const auto& rec = buffer->records[i % trace_capacity];
+			if (rec.start < start_time) {
+				continue;
+			}
+
+			separator();
+			os << "{\"name\":";
+			WriteJsonString(os, rec.name);
+			// Timestamps are in microseconds
+			os << fmt::format(R"(,"ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f})",
+				buffer->thread_id, (rec.start - start_time) / 1000.0, (rec.end - rec.start) / 1000.0);
+			if (rec.arg != Scope::no_arg) {
+				os << fmt::format(R"(,"args":{{"value":{}}})", rec.arg);
+			}
+			os << "}";
+		}
+	}
+
+	os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void Instrumentation::ToggleTrace() {
+	if (!IsTracing()) {
+		StartTrace();
+		Output::Info("Tracing started");
+		return;
+	}
+
+	int index = 0;
+	std::string file;
+	do {
+		file = "trace_" + std::to_string(index++) + ".json";
+	} while (FileFinder::Save().Exists(file));
+
+	auto os = FileFinder::Save().OpenOutputStream(file, std::ios_base::out | std::ios_base::trunc);
+	if (!os) {
+		tracing = false;
+		Output::Warning("Tracing stopped: Could not create {}", file);
+		return;
+	}
+
+	StopTrace(os);
+	Output::Info("Trace written to {}", file);
+}
@@ -25,7 +25,20 @@
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 #include <ittnotify.h>
 #endif
+#include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+
+/**
+ * Records the enclosing scope as a named zone while tracing is enabled.
+ * The name must be a string literal, an optional integer argument is shown
+ * in the trace viewer.
+ */
+#define EP_INSTRUMENT_SCOPE(...) Instrumentation::Scope EP_INSTRUMENT_CONCAT(instrument_scope_, __LINE__)(__VA_ARGS__)
+#define EP_INSTRUMENT_CONCAT(a, b) EP_INSTRUMENT_CONCAT_IMPL(a, b)
+#define EP_INSTRUMENT_CONCAT_IMPL(a, b) a##b
 
 class Instrumentation {
 public:
@@ -73,7 +86,57 @@ public:
 		bool begun = false;
 	};
 
+	/** @return whether scopes are recorded */
+	static bool IsTracing();
+
+	/**
+	 * Starts recording scopes into the per thread ring buffers.
+	 * Records of a previous trace are discarded.
+	 */
+	static void StartTrace();
+
+	/**
+	 * Stops recording and writes the recorded scopes as Chrome trace JSON,
+	 * which can be opened in chrome://tracing or Perfetto.
+	 *
+	 * @param os stream to write the trace to
+	 */
+	static void StopTrace(std::ostream& os);
+
+	/** Starts a trace or stops it and writes trace_N.json into the save directory */
+	static void ToggleTrace();
+
+	/** RAII timer for a named zone, use EP_INSTRUMENT_SCOPE */
+	class Scope {
+	public:
+		static constexpr int32_t no_arg = std::numeric_limits<int32_t>::min();
+
+		/**
+		 * Starts the zone when tracing is enabled.
+		 *
+		 * @param name zone name, must outlive the trace, nullptr disables the scope
+		 * @param arg optional argument of the zone
+		 */
+		explicit Scope(const char* name, int32_t arg = no_arg) noexcept;
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+		/** Records the zone */
+		~Scope();
+	private:
+		const char* name = nullptr;
+		int32_t arg = no_arg;
+		int64_t start = 0;
+	};
+
 private:
+	/** @return timestamp in nanoseconds */
+	static int64_t Now() noexcept;
+	static void Record(const char* name, int32_t arg, int64_t start, int64_t end) noexcept;
+
+	static std::atomic<bool> tracing;
+
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 	static __itt_domain* domain;
 #endif
@@ -137,4 +200,22 @@ inline void Instrumentation::FrameScope::Dismiss() noexcept {
 	begun = false;
 }
 
+inline bool Instrumentation::IsTracing() {
+	return tracing.load(std::memory_order_relaxed);
+}
+
+inline Instrumentation::Scope::Scope(const char* name, int32_t arg) noexcept {
+	if (name && IsTracing()) {
+		this->name = name;
+		this->arg = arg;
+		start = Now();
+	}
+}
+
+inline Instrumentation::Scope::~Scope() {
+	if (name) {
+		Record(name, arg, start, Now());
+	}
+}
+
 #endif
@@ -23,7 +23,10 @@
 #include "game_variables.h"
 #include "output.h"
 #include "input.h"
+#include "utils.h"
 
+#include <algorithm>
+#include <limits>
 #include <vector>
 
 /*
@@ -35,6 +38,12 @@ They could be implemented but are not very useful
 All Inplace functions:
 Inplace assigns to variables while the ControlVariables event command is executed.
 This violates how the command is supposed to work because more variables than the target variables can be set.
+
+Expressions are compiled once into a flat list of register instructions.
+Warnings about unsupported operations are emitted during compilation.
+The arguments of functions are evaluated in the order they are stored and passed
+in reverse order, e.g. pow(a, b) is stored as b, a. This matches the previous
+tree walking evaluator.
 */
 
 namespace {
@@ -110,315 +119,503 @@ namespace {
 		Divmul,
 		Between
 	};
-}
 
-int process(std::vector<int32_t>::iterator& it, std::vector<int32_t>::iterator end, const Game_Interpreter& ip) {
-	int value = 0;
-	int imm = 0;
-	int imm2 = 0;
-	int imm3 = 0;
+	// Instructions of the compiled expression
+	enum class Code : uint8_t {
+		Var,
+		Switch,
+		VarIndirect,
+		SwitchIndirect,
+		Negate,
+		Not,
+		Flip,
+		Add,
+		Sub,
+		Mul,
+		Div,
+		Mod,
+		BitOr,
+		BitAnd,
+		BitXor,
+		BitShiftLeft,
+		BitShiftRight,
+		Equal,
+		GreaterEqual,
+		LessEqual,
+		Greater,
+		Less,
+		NotEqual,
+		Or,
+		And,
+		Ternary,
+		Rand,
+		Item,
+		Event,
+		Actor,
+		Party,
+		Enemy,
+		Misc,
+		Pow,
+		Sqrt,
+		Sin,
+		Cos,
+		Atan2,
+		Min,
+		Max,
+		Abs,
+		Clamp,
+		Muldiv,
+		Divmul,
+		Between
+	};
+
+	class Compiler {
+	public:
+		explicit Compiler(Span<const int32_t> op_codes) {
+			// Every op code holds 4 bytes of the expression
+			ops.reserve(op_codes.size() * 4);
+			for (auto& o: op_codes) {
+				auto uo = static_cast<uint32_t>(o);
+				ops.push_back(static_cast<int32_t>(uo & 0x000000FF));
+				ops.push_back(static_cast<int32_t>((uo & 0x0000FF00) >> 8));
+				ops.push_back(static_cast<int32_t>((uo & 0x00FF0000) >> 16));
+				ops.push_back(static_cast<int32_t>((uo & 0xFF000000) >> 24));
+			}
+		}
 
-	if (it == end) {
-		return 0;
+		ManiacPatch::Expression Compile() {
+			int32_t result = Process();
+
+			// Constants are stored before the computed registers
+			const auto num_constants = static_cast<int32_t>(expr.constants.size());
+			auto reg = [&](int32_t r) {
+				return r < 0 ? ~r : r + num_constants;
+			};
+			for (auto& ins: expr.code) {
+				ins.dst = reg(ins.dst);
+				ins.a = reg(ins.a);
+				ins.b = reg(ins.b);
+				ins.c = reg(ins.c);
+			}
+			expr.result = reg(result);
+			expr.num_registers = num_constants + num_computed;
+			return std::move(expr);
+		}
+
+	private:
+		bool AtEnd() const {
+			return pos >= ops.size();
+		}
+
+		// Reading past the end yields 0
+		int32_t Next() {
+			return AtEnd() ? 0 : ops[pos++];
+		}
+
+		// Constants use negative ids until the register layout is known
+		int32_t Const(int32_t value) {
+			auto it = std::find(expr.constants.begin(), expr.constants.end(), value);
+			if (it != expr.constants.end()) {
+				return ~static_cast<int32_t>(it - expr.constants.begin());
+			}
+			expr.constants.push_back(value);
+			return ~static_cast<int32_t>(expr.constants.size() - 1);
+		}
+
+		int32_t Emit(Code code, int32_t a = ~0, int32_t b = ~0, int32_t c = ~0) {
+			if (expr.constants.empty()) {
+				// Unused operands read the first constant
+				Const(0);
+			}
+			int32_t dst = num_computed++;
+			expr.code.push_back({ static_cast<uint8_t>(code), dst, a, b, c });
+			return dst;
+		}
+
+		int32_t Unary(Code code) {
+			int32_t a = Process();
+			return Emit(code, a);
+		}
+
+		int32_t Binary(Code code) {
+			int32_t a = Process();
+			int32_t b = Process();
+			return Emit(code, a, b);
+		}
+
+		int32_t Ternary(Code code) {
+			int32_t a = Process();
+			int32_t b = Process();
+			int32_t c = Process();
+			return Emit(code, a, b, c);
+		}
+
+		// The arguments of functions are stored in reverse order
+		int32_t Call(Code code, int args) {
+			int32_t r[3] = { ~0, ~0, ~0 };
+			for (int i = args - 1; i >= 0; --i) {
+				r[i] = Process();
+			}
+			return Emit(code, r[0], r[1], r[2]);
+		}
+
+		int32_t Function();
+		int32_t Process();
+
+		std::vector<int32_t> ops;
+		size_t pos = 0;
+		ManiacPatch::Expression expr;
+		int32_t num_computed = 0;
+	};
+}
+
+int32_t Compiler::Process() {
+	if (AtEnd()) {
+		return Const(0);
 	}
 
-	auto op = static_cast<Op>(*it);
-	++it;
+	auto op = static_cast<Op>(Next());
+	int32_t imm, imm2, imm3, value;
 
-	// When entering the switch it is on the first argument
 	switch (op) {
 		case Op::Null:
-			*it++;
-			return 0;
+			Next();
+			return Const(0);
 		case Op::U8:
 		case Op::UX8:
-			value = *it++;
-			return value;
+			return Const(Next());
 		case Op::U16:
 		case Op::UX16:
-			imm = *it++;
-			if (it == end) {
-				return 0;
+			imm = Next();
+			if (AtEnd()) {
+				return Const(0);
 			}
-			imm2 = *it++;
-			value = (imm2 << 8) + imm;
-			return value;
+			imm2 = Next();
+			return Const((imm2 << 8) + imm);
 		case Op::S32:
 		case Op::SX32:
-			imm = *it++;
-			if (it == end) {
-				return 0;
+			imm = Next();
+			if (AtEnd()) {
+				return Const(0);
 			}
-			imm2 = *it++;
-			if (it == end) {
-				return 0;
+			imm2 = Next();
+			if (AtEnd()) {
+				return Const(0);
 			}
-			imm3 = *it++;
-			if (it == end) {
-				return 0;
+			imm3 = Next();
+			if (AtEnd()) {
+				return Const(0);
 			}
-			value = *it++;
-			value = (value << 24) + (imm3 << 16) + (imm2 << 8) + imm;
-			return value;
+			value = Next();
+			return Const(static_cast<int32_t>((static_cast<uint32_t>(value) << 24) + (imm3 << 16) + (imm2 << 8) + imm));
 		case Op::Var:
-			imm = process(it, end, ip);
-			return Main_Data::game_variables->Get(imm);
+			return Unary(Code::Var);
 		case Op::Switch:
-			imm = process(it, end, ip);
-			return Main_Data::game_switches->GetInt(imm);
+			return Unary(Code::Switch);
 		case Op::VarIndirect:
-			imm = process(it, end, ip);
-			return Main_Data::game_variables->GetIndirect(imm);
+			return Unary(Code::VarIndirect);
 		case Op::SwitchIndirect:
-			imm = process(it, end, ip);
-			return Main_Data::game_switches->GetInt(Main_Data::game_variables->Get(imm));
+			return Unary(Code::SwitchIndirect);
 		case Op::Negate:
-			imm = process(it, end, ip);
-			return -imm;
+			return Unary(Code::Negate);
 		case Op::Not:
-			imm = process(it, end, ip);
-			return !imm ? 0 : 1;
+			return Unary(Code::Not);
 		case Op::Flip:
-			imm = process(it, end, ip);
-			return ~imm;
+			return Unary(Code::Flip);
 		case Op::Add:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			return static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(imm) + imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
+			return Binary(Code::Add);
 		case Op::Sub:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			return static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(imm) - imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
+			return Binary(Code::Sub);
 		case Op::Mul:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			return static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(imm) * imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
+			return Binary(Code::Mul);
 		case Op::Div:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			if (imm2 == 0) {
-				return imm;
-			}
-			return imm / imm2;
+			return Binary(Code::Div);
 		case Op::Mod:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			if (imm2 == 0) {
-				return imm;
-			}
-			return imm % imm2;
+			return Binary(Code::Mod);
 		case Op::BitOr:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			return imm | imm2;
+			return Binary(Code::BitOr);
 		case Op::BitAnd:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			return imm & imm2;
+			return Binary(Code::BitAnd);
 		case Op::BitXor:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			return imm ^ imm2;
+			return Binary(Code::BitXor);
 		case Op::BitShiftLeft:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			return imm << imm2;
+			return Binary(Code::BitShiftLeft);
 		case Op::BitShiftRight:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			return imm >> imm2;
+			return Binary(Code::BitShiftRight);
 		case Op::Equal:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			return imm == imm2 ? 1 : 0;
+			return Binary(Code::Equal);
 		case Op::GreaterEqual:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			return imm >= imm2 ? 1 : 0;
+			return Binary(Code::GreaterEqual);
 		case Op::LessEqual:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			return imm <= imm2 ? 1 : 0;
+			return Binary(Code::LessEqual);
 		case Op::Greater:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			return imm > imm2 ? 1 : 0;
+			return Binary(Code::Greater);
 		case Op::Less:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			return imm < imm2 ? 1 : 0;
+			return Binary(Code::Less);
 		case Op::NotEqual:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			return imm != imm2 ? 1 : 0;
+			return Binary(Code::NotEqual);
 		case Op::Or:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			return !!imm || !!imm2 ? 1 : 0;
+			return Binary(Code::Or);
 		case Op::And:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			return !!imm && !!imm2 ? 1 : 0;
+			return Binary(Code::And);
 		case Op::Ternary:
-			imm = process(it, end, ip);
-			imm2 = process(it, end, ip);
-			imm3 = process(it, end, ip);
-			return imm != 0 ? imm2 : imm3;
+			return Ternary(Code::Ternary);
 		case Op::Function:
-			imm = *it++; // function
-			imm2 = *it++; // arguments
+			return Function();
+		default:
+			Output::Warning("Maniac: Expression contains unsupported operation {}", static_cast<int>(op));
+			return Const(0);
+	}
+}
 
-			if ((imm2 & 0x80) != 0) {
-				// Argument count is 4 bytes, that mode is not supported
-				Output::Warning("Maniac: Expression func long args unsupported");
-				return 0;
-			}
+int32_t Compiler::Function() {
+	int32_t fn = Next();
+	int32_t args = Next();
+
+	if ((args & 0x80) != 0) {
+		// Argument count is 4 bytes, that mode is not supported
+		Output::Warning("Maniac: Expression func long args unsupported");
+		return Const(0);
+	}
 
-			switch (static_cast<Fn>(imm)) {
-				case Fn::Rand:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression rnd args {} != 2", imm2);
-						return 0;
-					}
-					imm3 = process(it, end, ip);
-					return ControlVariables::Random(process(it, end, ip), imm3);
-				case Fn::Item:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression item args {} != 2", imm2);
-						return 0;
-					}
-					imm3 = process(it, end, ip);
-					return ControlVariables::Item(process(it, end, ip), imm3);
-				case Fn::Event:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression event args {} != 2", imm2);
-						return 0;
-					}
-					imm3 = process(it, end, ip);
-					return ControlVariables::Event(process(it, end, ip), imm3, ip);
-				case Fn::Actor:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression actor args {} != 2", imm2);
-						return 0;
-					}
-					return ControlVariables::Actor(process(it, end, ip), imm3);
-				case Fn::Party:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression member args {} != 2", imm2);
-						return 0;
-					}
-					imm3 = process(it, end, ip);
-					return ControlVariables::Party(process(it, end, ip), imm3);
-				case Fn::Enemy:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression enemy args {} != 2", imm2);
-						return 0;
-					}
-					imm3 = process(it, end, ip);
-					return ControlVariables::Enemy(process(it, end, ip), imm3);
-					break;
-				case Fn::Misc:
-					if (imm2 != 1) {
-						Output::Warning("Maniac: Expression misc args {} != 1", imm2);
-						return 0;
-					}
-					return ControlVariables::Other(process(it, end, ip));
-				case Fn::Pow:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression pow args {} != 2", imm2);
-						return 0;
-					}
-					return ControlVariables::Pow(process(it, end, ip), process(it, end, ip));
-				case Fn::Sqrt:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression sqrt args {} != 2", imm2);
-						return 0;
-					}
-					return ControlVariables::Sqrt(process(it, end, ip), process(it, end, ip));
-				case Fn::Sin:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression sin args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Sin(process(it, end, ip), process(it, end, ip), process(it, end, ip));
-				case Fn::Cos:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression cos args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Cos(process(it, end, ip), process(it, end, ip), process(it, end, ip));
-				case Fn::Atan2:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression atan2 args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Atan2(process(it, end, ip), process(it, end, ip), process(it, end, ip));
-				case Fn::Min:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression min args {} != 2", imm2);
-						return 0;
-					}
-					return ControlVariables::Min(process(it, end, ip), process(it, end, ip));
-				case Fn::Max:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression max args {} != 2", imm2);
-						return 0;
-					}
-					return ControlVariables::Max(process(it, end, ip), process(it, end, ip));
-				case Fn::Abs:
-					if (imm2 != 1) {
-						Output::Warning("Maniac: Expression abs args {} != 1", imm2);
-						return 0;
-					}
-					return ControlVariables::Abs(process(it, end, ip));
-				case Fn::Clamp:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression clamp args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Clamp(process(it, end, ip), process(it, end, ip), process(it, end, ip));
-				case Fn::Muldiv:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression muldiv args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Muldiv(process(it, end, ip), process(it, end, ip), process(it, end, ip));
-				case Fn::Divmul:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression divmul args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Divmul(process(it, end, ip), process(it, end, ip), process(it, end, ip));
-				case Fn::Between:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression between args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Between(process(it, end, ip), process(it, end, ip), process(it, end, ip));
-				default:
-					Output::Warning("Maniac: Expression Unknown Func {}", imm);
-					for (int i = 0; i < imm2; ++i) {
-						process(it, end, ip);
-					}
-					return 0;
+	auto check_args = [&](const char* name, int32_t expected) {
+		if (args != expected) {
+			Output::Warning("Maniac: Expression {} args {} != {}", name, args, expected);
+			return false;
+		}
+		return true;
+	};
+
+	switch (static_cast<Fn>(fn)) {
+		case Fn::Rand:
+			return check_args("rnd", 2) ? Call(Code::Rand, 2) : Const(0);
+		case Fn::Item:
+			return check_args("item", 2) ? Call(Code::Item, 2) : Const(0);
+		case Fn::Event:
+			return check_args("event", 2) ? Call(Code::Event, 2) : Const(0);
+		case Fn::Actor:
+			if (!check_args("actor", 2)) {
+				return Const(0);
+			} else {
+				// FIXME: Only the first argument is read, the actor id is always 0
+				int32_t a = Process();
+				return Emit(Code::Actor, a, Const(0));
 			}
+		case Fn::Party:
+			return check_args("member", 2) ? Call(Code::Party, 2) : Const(0);
+		case Fn::Enemy:
+			return check_args("enemy", 2) ? Call(Code::Enemy, 2) : Const(0);
+		case Fn::Misc:
+			return check_args("misc", 1) ? Call(Code::Misc, 1) : Const(0);
+		case Fn::Pow:
+			return check_args("pow", 2) ? Call(Code::Pow, 2) : Const(0);
+		case Fn::Sqrt:
+			return check_args("sqrt", 2) ? Call(Code::Sqrt, 2) : Const(0);
+		case Fn::Sin:
+			return check_args("sin", 3) ? Call(Code::Sin, 3) : Const(0);
+		case Fn::Cos:
+			return check_args("cos", 3) ? Call(Code::Cos, 3) : Const(0);
+		case Fn::Atan2:
+			return check_args("atan2", 3) ? Call(Code::Atan2, 3) : Const(0);
+		case Fn::Min:
+			return check_args("min", 2) ? Call(Code::Min, 2) : Const(0);
+		case Fn::Max:
+			return check_args("max", 2) ? Call(Code::Max, 2) : Const(0);
+		case Fn::Abs:
+			return check_args("abs", 1) ? Call(Code::Abs, 1) : Const(0);
+		case Fn::Clamp:
+			return check_args("clamp", 3) ? Call(Code::Clamp, 3) : Const(0);
+		case Fn::Muldiv:
+			return check_args("muldiv", 3) ? Call(Code::Muldiv, 3) : Const(0);
+		case Fn::Divmul:
+			return check_args("divmul", 3) ? Call(Code::Divmul, 3) : Const(0);
+		case Fn::Between:
+			return check_args("between", 3) ? Call(Code::Between, 3) : Const(0);
 		default:
-			Output::Warning("Maniac: Expression contains unsupported operation {}", static_cast<int>(op));
-			return 0;
+			Output::Warning("Maniac: Expression Unknown Func {}", fn);
+			// The arguments are still evaluated
+			for (int i = 0; i < args; ++i) {
+				Process();
+			}
+			return Const(0);
 	}
 }
 
-int32_t ManiacPatch::ParseExpression(Span<const int32_t> op_codes, const Game_Interpreter& interpreter) {
-	std::vector<int32_t> ops;
-	for (auto &o: op_codes) {
-		auto uo = static_cast<uint32_t>(o);
-		ops.push_back(static_cast<int32_t>(uo & 0x000000FF));
-		ops.push_back(static_cast<int32_t>((uo & 0x0000FF00) >> 8));
-		ops.push_back(static_cast<int32_t>((uo & 0x00FF0000) >> 16));
-		ops.push_back(static_cast<int32_t>((uo & 0xFF000000) >> 24));
+ManiacPatch::Expression ManiacPatch::CompileExpression(Span<const int32_t> op_codes) {
+	return Compiler(op_codes).Compile();
+}
+
+int32_t ManiacPatch::EvaluateExpression(const Expression& expr, const Game_Interpreter& ip) {
+	if (expr.num_registers == 0) {
+		return 0;
 	}
-	auto beg = ops.begin();
-	return process(beg, ops.end(), interpreter);
+
+	// Most expressions fit into the stack buffer
+	constexpr int32_t num_stack_regs = 64;
+	int32_t stack_regs[num_stack_regs];
+	std::vector<int32_t> heap_regs;
+	int32_t* r = stack_regs;
+	if (expr.num_registers > num_stack_regs) {
+		heap_regs.resize(expr.num_registers);
+		r = heap_regs.data();
+	}
+	std::copy(expr.constants.begin(), expr.constants.end(), r);
+
+	auto saturate = [](int64_t v) {
+		return static_cast<int32_t>(Utils::Clamp<int64_t>(v, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
+	};
+
+	for (const auto& ins: expr.code) {
+		const int32_t a = r[ins.a];
+		const int32_t b = r[ins.b];
+		const int32_t c = r[ins.c];
+		int32_t& dst = r[ins.dst];
+
+		switch (static_cast<Code>(ins.code)) {
+			case Code::Var:
+				dst = Main_Data::game_variables->Get(a);
+				break;
+			case Code::Switch:
+				dst = Main_Data::game_switches->GetInt(a);
+				break;
+			case Code::VarIndirect:
+				dst = Main_Data::game_variables->GetIndirect(a);
+				break;
+			case Code::SwitchIndirect:
+				dst = Main_Data::game_switches->GetInt(Main_Data::game_variables->Get(a));
+				break;
+			case Code::Negate:
+				dst = -a;
+				break;
+			case Code::Not:
+				dst = !a ? 0 : 1;
+				break;
+			case Code::Flip:
+				dst = ~a;
+				break;
+			case Code::Add:
+				dst = saturate(static_cast<int64_t>(a) + b);
+				break;
+			case Code::Sub:
+				dst = saturate(static_cast<int64_t>(a) - b);
+				break;
+			case Code::Mul:
+				dst = saturate(static_cast<int64_t>(a) * b);
+				break;
+			case Code::Div:
+				// INT_MIN / -1 overflows
+				dst = b == 0 ? a : b == -1 ? saturate(-static_cast<int64_t>(a)) : a / b;
+				break;
+			case Code::Mod:
+				dst = b == 0 ? a : b == -1 ? 0 : a % b;
+				break;
+			case Code::BitOr:
+				dst = a | b;
+				break;
+			case Code::BitAnd:
+				dst = a & b;
+				break;
+			case Code::BitXor:
+				dst = a ^ b;
+				break;
+			case Code::BitShiftLeft:
+				dst = a << b;
+				break;
+			case Code::BitShiftRight:
+				dst = a >> b;
+				break;
+			case Code::Equal:
+				dst = a == b ? 1 : 0;
+				break;
+			case Code::GreaterEqual:
+				dst = a >= b ? 1 : 0;
+				break;
+			case Code::LessEqual:
+				dst = a <= b ? 1 : 0;
+				break;
+			case Code::Greater:
+				dst = a > b ? 1 : 0;
+				break;
+			case Code::Less:
+				dst = a < b ? 1 : 0;
+				break;
+			case Code::NotEqual:
+				dst = a != b ? 1 : 0;
+				break;
+			case Code::Or:
+				dst = !!a || !!b ? 1 : 0;
+				break;
+			case Code::And:
+				dst = !!a && !!b ? 1 : 0;
+				break;
+			case Code::Ternary:
+				dst = a != 0 ? b : c;
+				break;
+			case Code::Rand:
+				dst = ControlVariables::Random(a, b);
+				break;
+			case Code::Item:
+				dst = ControlVariables::Item(a, b);
+				break;
+			case Code::Event:
+				dst = ControlVariables::Event(a, b, ip);
+				break;
+			case Code::Actor:
+				dst = ControlVariables::Actor(a, b);
+				break;
+			case Code::Party:
+				dst = ControlVariables::Party(a, b);
+				break;
+			case Code::Enemy:
+				dst = ControlVariables::Enemy(a, b);
+				break;
+			case Code::Misc:
+				dst = ControlVariables::Other(a);
+				break;
+			case Code::Pow:
+				dst = ControlVariables::Pow(a, b);
+				break;
+			case Code::Sqrt:
+				dst = ControlVariables::Sqrt(a, b);
+				break;
+			case Code::Sin:
+				dst = ControlVariables::Sin(a, b, c);
+				break;
+			case Code::Cos:
+				dst = ControlVariables::Cos(a, b, c);
+				break;
+			case Code::Atan2:
+				dst = ControlVariables::Atan2(a, b, c);
+				break;
+			case Code::Min:
+				dst = ControlVariables::Min(a, b);
+				break;
+			case Code::Max:
+				dst = ControlVariables::Max(a, b);
+				break;
+			case Code::Abs:
+				dst = ControlVariables::Abs(a);
+				break;
+			case Code::Clamp:
+				dst = ControlVariables::Clamp(a, b, c);
+				break;
+			case Code::Muldiv:
+				dst = ControlVariables::Muldiv(a, b, c);
+				break;
+			case Code::Divmul:
+				dst = ControlVariables::Divmul(a, b, c);
+				break;
+			case Code::Between:
+				dst = ControlVariables::Between(a, b, c);
+				break;
+		}
+	}
+
+	return r[expr.result];
+}
+
+int32_t ManiacPatch::ParseExpression(Span<const int32_t> op_codes, const Game_Interpreter& interpreter) {
+	return EvaluateExpression(CompileExpression(op_codes), interpreter);
 }
 
 std::array<bool, 50> ManiacPatch::GetKeyRange() {
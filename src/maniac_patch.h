@@ -20,11 +20,53 @@
 #define EP_MANIAC_PATCH
 
 #include <array>
+#include <cstdint>
+#include <vector>
 #include "span.h"
 
 class Game_Interpreter;
 
 namespace ManiacPatch {
+	/**
+	 * A Maniac Patch expression compiled to register based bytecode.
+	 * Every instruction writes one register, the first registers hold the
+	 * constants of the expression.
+	 */
+	struct Expression {
+		struct Instruction {
+			uint8_t code;
+			int32_t dst;
+			int32_t a;
+			int32_t b;
+			int32_t c;
+		};
+
+		std::vector<int32_t> constants;
+		std::vector<Instruction> code;
+		int32_t num_registers = 0;
+		/** Register of the result */
+		int32_t result = 0;
+	};
+
+	/**
+	 * Compiles the op codes of an expression.
+	 * Unsupported operations evaluate to 0.
+	 *
+	 * @param op_codes expression op codes of the event command
+	 * @return compiled expression
+	 */
+	Expression CompileExpression(Span<const int32_t> op_codes);
+
+	/**
+	 * Runs a compiled expression.
+	 *
+	 * @param expr compiled expression
+	 * @param interpreter interpreter used to resolve "This Event"
+	 * @return result of the expression
+	 */
+	int32_t EvaluateExpression(const Expression& expr, const Game_Interpreter& interpreter);
+
+	/** Compiles and runs an expression once */
 	int32_t ParseExpression(Span<const int32_t> op_codes, const Game_Interpreter& interpreter);
 
 	std::array<bool, 50> GetKeyRange();
@@ -0,0 +1,267 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "map_cache.h"
+#include "filefinder.h"
+#include "game_map.h"
+#include "game_targets.h"
+#include "main_data.h"
+#include "output.h"
+#include "player.h"
+#include "utils.h"
+#include "worker_pool.h"
+#include <lcf/lmu/reader.h>
+#include <lcf/rpg/eventcommand.h>
+#include <lcf/rpg/map.h>
+#include <lcf/rpg/savetarget.h>
+
+namespace {
+	using Cmd = lcf::rpg::EventCommand::Code;
+
+	// Hub maps can reference dozens of maps, only the first ones are parsed in advance
+	constexpr size_t max_prefetch_maps = 8;
+
+	struct Entry {
+		int map_id;
+		MapCache::MapFile file;
+	};
+
+	// Most recently used map first
+	std::list<Entry> entries;
+	std::unordered_map<int, std::list<Entry>::iterator> entry_index;
+	size_t cache_size = 0;
+	MapCache::Stats stats;
+
+	std::vector<int> plan;
+	size_t next_map = 0;
+	bool map_in_flight = false;
+	// Incremented on reset, invalidates callbacks of parsing jobs
+	int generation = 0;
+
+	size_t GetBudget() {
+		return static_cast<size_t>(Player::player_config.map_cache_budget.Get()) * 1024 * 1024;
+	}
+
+	void Evict(size_t budget) {
+		while (cache_size > budget && !entries.empty()) {
+			auto& entry = entries.back();
+			cache_size -= entry.file.bytes;
+			entry_index.erase(entry.map_id);
+			entries.pop_back();
+		}
+	}
+
+	std::string FindMapFile(int map_id, bool& lmu) {
+		// Same lookup order as Game_Map::loadMapFile
+		std::string map_file = FileFinder::Game().FindFile(Game_Map::ConstructMapName(map_id, true));
+		lmu = map_file.empty();
+		if (lmu) {
+			map_file = FileFinder::Game().FindFile(Game_Map::ConstructMapName(map_id, false));
+		}
+		return map_file;
+	}
+}
+
+MapCache::MapFile MapCache::Parse(std::istream& stream, bool lmu, const std::string& encoding) {
+	MapFile file;
+	file.lmu = lmu;
+
+	std::unique_ptr<lcf::rpg::Map> map;
+	if (lmu) {
+		map = lcf::LMU_Reader::Load(stream, encoding);
+		if (map) {
+			// Needed for input recordings
+			stream.clear();
+			stream.seekg(0);
+			file.crc = Utils::CRC32(stream);
+		}
+	} else {
+		map = lcf::LMU_Reader::LoadXml(stream);
+	}
+
+	if (map) {
+		file.bytes = EstimateSize(*map);
+		file.map = std::move(map);
+	}
+
+	return file;
+}
+
+MapCache::MapFile MapCache::Get(int map_id) {
+	auto it = entry_index.find(map_id);
+	if (it == entry_index.end()) {
+		++stats.misses;
+		return {};
+	}
+
+	++stats.hits;
+	entries.splice(entries.begin(), entries, it->second);
+	return it->second->file;
+}
+
+void MapCache::Add(int map_id, MapFile file) {
+	const auto budget = GetBudget();
+	if (!file.map || file.bytes > budget) {
+		return;
+	}
+
+	auto it = entry_index.find(map_id);
+	if (it != entry_index.end()) {
+		cache_size -= it->second->file.bytes;
+		entries.erase(it->second);
+	}
+
+	cache_size += file.bytes;
+	entries.push_front({map_id, std::move(file)});
+	entry_index[map_id] = entries.begin();
+
+	Evict(budget);
+}
+
+size_t MapCache::EstimateSize(const lcf::rpg::Map& map) {
+	size_t bytes = sizeof(map);
+	bytes += (map.lower_layer.size() + map.upper_layer.size()) * sizeof(int16_t);
+
+	for (const auto& event: map.events) {
+		bytes += sizeof(event) + event.name.size();
+		for (const auto& page: event.pages) {
+			bytes += sizeof(page) + page.character_name.size();
+			bytes += page.move_route.move_commands.size() * sizeof(lcf::rpg::MoveCommand);
+			for (const auto& cmd: page.event_commands) {
+				bytes += sizeof(cmd) + cmd.string.size() + cmd.parameters.size() * sizeof(int32_t);
+			}
+		}
+	}
+
+	return bytes;
+}
+
+std::vector<int> MapCache::PlanPrefetch(const lcf::rpg::Map& map, int map_id, const std::vector<lcf::rpg::SaveTarget>& targets) {
+	std::vector<int> map_ids;
+	std::unordered_set<int> seen = { map_id };
+
+	auto add = [&](int target_id) {
+		if (target_id > 0 && seen.insert(target_id).second) {
+			map_ids.push_back(target_id);
+		}
+	};
+
+	for (const auto& event: map.events) {
+		for (const auto& page: event.pages) {
+			for (const auto& cmd: page.event_commands) {
+				if (static_cast<Cmd>(cmd.code) == Cmd::Teleport && cmd.parameters.size() > 0) {
+					add(cmd.parameters[0]);
+				}
+			}
+		}
+	}
+
+	for (const auto& target: targets) {
+		add(target.map_id);
+	}
+
+	return map_ids;
+}
+
+void MapCache::OnMapSetup(const lcf::rpg::Map& map, int map_id) {
+	plan.clear();
+	next_map = 0;
+
+	if (GetBudget() == 0 || !WorkerPool::IsEnabled()) {
+		return;
+	}
+
+	plan = PlanPrefetch(map, map_id, Main_Data::game_targets->GetTeleportTargets());
+	if (plan.size() > max_prefetch_maps) {
+		plan.resize(max_prefetch_maps);
+	}
+}
+
+void MapCache::Update() {
+	// One map at a time: Parsing takes longer than decoding an image and the
+	// callbacks of images requested by the game must wait for it
+	while (!map_in_flight && next_map < plan.size()) {
+		const int map_id = plan[next_map++];
+		if (entry_index.find(map_id) != entry_index.end()) {
+			continue;
+		}
+
+		bool lmu;
+		auto map_file = FindMapFile(map_id, lmu);
+		if (map_file.empty()) {
+			continue;
+		}
+
+		// The file lookup is not thread-safe, only the parsing happens in the worker
+		auto is = FileFinder::Game().OpenInputStream(map_file);
+		if (!is) {
+			continue;
+		}
+
+		auto stream = std::make_shared<Filesystem_Stream::InputStream>(std::move(is));
+		auto result = std::make_shared<MapFile>();
+		auto encoding = Player::encoding;
+		const int gen = generation;
+
+		map_in_flight = true;
+		WorkerPool::Submit([stream, result, lmu, encoding]() {
+			*result = Parse(*stream, lmu, encoding);
+		}, [result, map_id, gen]() {
+			if (gen != generation) {
+				return;
+			}
+
+			map_in_flight = false;
+			if (result->map) {
+				++stats.prefetched;
+				Add(map_id, std::move(*result));
+			}
+		});
+	}
+}
+
+void MapCache::ResetPrefetch() {
+	++generation;
+	plan.clear();
+	next_map = 0;
+	map_in_flight = false;
+}
+
+void MapCache::Clear() {
+	if (stats.hits > 0 || stats.misses > 0) {
+		Output::Debug("MapCache: {} hits, {} misses, {} prefetched", stats.hits, stats.misses, stats.prefetched);
+	}
+
+	ResetPrefetch();
+	entries.clear();
+	entry_index.clear();
+	cache_size = 0;
+	stats = {};
+}
+
+MapCache::Stats MapCache::GetStats() {
+	auto s = stats;
+	s.entries = static_cast<int>(entries.size());
+	s.bytes = cache_size;
+	return s;
+}
@@ -0,0 +1,117 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_MAP_CACHE_H
+#define EP_MAP_CACHE_H
+
+// Headers
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <lcf/rpg/fwd.h>
+
+/**
+ * MapCache keeps recently used maps in parsed form so transfers between
+ * them do not read and parse the map file again. Maps reachable by the
+ * Teleport commands of the current map and the teleport targets are parsed
+ * in advance by the WorkerPool.
+ * The cached maps are never modified, Game_Map works on a copy.
+ */
+namespace MapCache {
+	struct MapFile {
+		std::shared_ptr<const lcf::rpg::Map> map;
+		/** Whether the map was loaded from a LMU file, false for EasyRPG XML maps */
+		bool lmu = false;
+		/** CRC32 of the LMU file */
+		uint32_t crc = 0;
+		/** Estimated memory usage of the parsed map */
+		size_t bytes = 0;
+	};
+
+	struct Stats {
+		int entries = 0;
+		size_t bytes = 0;
+		int hits = 0;
+		int misses = 0;
+		/** Maps parsed in advance */
+		int prefetched = 0;
+	};
+
+	/**
+	 * Parses a map file. Thread-safe.
+	 *
+	 * @param stream map file
+	 * @param lmu whether the stream is a LMU file or an EasyRPG XML map
+	 * @param encoding encoding of the LMU file
+	 * @return parsed map, the map is empty on error
+	 */
+	MapFile Parse(std::istream& stream, bool lmu, const std::string& encoding);
+
+	/**
+	 * @param map_id map id
+	 * @return the cached map or an empty MapFile when not cached
+	 */
+	MapFile Get(int map_id);
+
+	/**
+	 * Adds a map to the cache. The least recently used maps are removed
+	 * when the memory budget is exceeded.
+	 *
+	 * @param map_id map id
+	 * @param file parsed map
+	 */
+	void Add(int map_id, MapFile file);
+
+	/** @return approximate memory used by a parsed map */
+	size_t EstimateSize(const lcf::rpg::Map& map);
+
+	/**
+	 * Collects the maps that are likely visited next: The targets of the
+	 * Teleport commands of all events, followed by the teleport targets.
+	 *
+	 * @param map current map
+	 * @param map_id id of the current map, not part of the result
+	 * @param targets teleport targets (Teleport skill)
+	 * @return map ids without duplicates
+	 */
+	std::vector<int> PlanPrefetch(const lcf::rpg::Map& map, int map_id, const std::vector<lcf::rpg::SaveTarget>& targets);
+
+	/**
+	 * Plans the prefetch for a newly loaded map. The maps are parsed by Update().
+	 *
+	 * @param map the map
+	 * @param map_id id of the map
+	 */
+	void OnMapSetup(const lcf::rpg::Map& map, int map_id);
+
+	/** Parses the next planned map in the WorkerPool. Called once per frame. */
+	void Update();
+
+	/** Stops prefetching. Must be called when the WorkerPool jobs were cancelled. */
+	void ResetPrefetch();
+
+	/** Removes all maps, e.g. when a different game is started. */
+	void Clear();
+
+	/** @return cache statistics */
+	Stats GetStats();
+}
+
+#endif
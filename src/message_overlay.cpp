@@ -22,6 +22,7 @@
 #include "bitmap.h"
 #include "game_message.h"
 #include "drawable_mgr.h"
+#include "damage_tracker.h"
 #include "baseui.h"
 
 MessageOverlay::MessageOverlay() : Drawable(Priority_Overlay, Drawable::Flags::Global)
@@ -29,6 +30,18 @@ MessageOverlay::MessageOverlay() : Drawable(Priority_Overlay, Drawable::Flags::G
 	// Graphics::RegisterDrawable is in the Update function
 }
 
+bool MessageOverlay::GetDrawState(const Bitmap&, DrawState& state) const {
+	if (!IsAnyMessageVisible() && !show_all) {
+		state = {};
+		return true;
+	}
+
+	// Draw refreshes the bitmap after blitting it, the new revision damages the next frame
+	state.bounds = Rect(ox, oy, bitmap->GetWidth(), bitmap->GetHeight());
+	state.hash = DrawHash().Add(bitmap).Add(dirty).Get();
+	return true;
+}
+
 void MessageOverlay::Draw(Bitmap& dst) {
 	if (!IsAnyMessageVisible() && !show_all) {
 		// Don't render overlay when no message visible
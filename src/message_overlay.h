@@ -44,6 +44,8 @@ public:
 	MessageOverlay();
 
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "MessageOverlay"; }
+	bool GetDrawState(const Bitmap& dst, DrawState& state) const override;
 
 	void Update();
 
@@ -0,0 +1,59 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "nullui.h"
+#include "bitmap.h"
+
+NullUi::NullUi(long width, long height, const Game_ConfigVideo& cfg) : BaseUi(cfg)
+{
+	current_display_mode.width = width;
+	current_display_mode.height = height;
+	current_display_mode.bpp = 32;
+
+	// Nothing to wait for, frames are drawn as fast as possible
+	SetFrameRateSynchronized(true);
+
+	const DynamicFormat format(
+		32,
+		0x00FF0000,
+		0x0000FF00,
+		0x000000FF,
+		0xFF000000,
+		PF::NoAlpha);
+
+	Bitmap::SetFormat(Bitmap::ChooseFormat(format));
+	main_surface = Bitmap::Create(current_display_mode.width,
+		current_display_mode.height,
+		false,
+		current_display_mode.bpp
+	);
+}
+
+void NullUi::ProcessEvents() {
+	// No events, input comes from the input log
+}
+
+void NullUi::UpdateDisplay() {
+	// The frame is rendered into main_surface but never presented
+}
+
+#ifdef SUPPORT_AUDIO
+AudioInterface& NullUi::GetAudio() {
+	return audio_;
+}
+#endif
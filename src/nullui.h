@@ -0,0 +1,56 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_NULLUI_H
+#define EP_NULLUI_H
+
+// Headers
+#include "audio.h"
+#include "baseui.h"
+
+/**
+ * NullUi class.
+ * Headless display without a window, input or audio output.
+ * Used by the benchmark mode.
+ */
+class NullUi final : public BaseUi {
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param width display client width.
+	 * @param height display client height.
+	 * @param cfg video config options
+	 */
+	NullUi(long width, long height, const Game_ConfigVideo& cfg);
+
+	/**
+	 * Inherited from BaseUi.
+	 */
+	/** @{ */
+	void ProcessEvents() override;
+	void UpdateDisplay() override;
+#ifdef SUPPORT_AUDIO
+	AudioInterface& GetAudio() override;
+#endif
+	/** @} */
+
+private:
+	EmptyAudio audio_;
+};
+
+#endif
@@ -24,6 +24,8 @@
 #include <fstream>
 #include <thread>
 #include <chrono>
+#include <mutex>
+#include <vector>
 #ifdef __ANDROID__
 #  include <android/log.h>
 #elif defined(EMSCRIPTEN)
@@ -43,6 +45,7 @@
 #include "message_overlay.h"
 #include "font.h"
 #include "baseui.h"
+#include "system.h"
 
 using namespace std::chrono_literals;
 
@@ -92,6 +95,18 @@ namespace {
 		std::string msg;
 		LogLevel lvl = {};
 	} last_message;
+
+#ifdef SUPPORT_THREADS
+	struct DeferredMessage {
+		LogLevel lvl;
+		std::string msg;
+		Color color;
+	};
+
+	thread_local bool defer_messages = false;
+	std::mutex deferred_mutex;
+	std::vector<DeferredMessage> deferred_messages;
+#endif
 }
 
 LogLevel Output::GetLogLevel() {
@@ -111,6 +126,14 @@ void Output::IgnorePause(bool const val) {
 }
 
 static void WriteLog(LogLevel lvl, std::string const& msg, Color const& c = Color()) {
+#ifdef SUPPORT_THREADS
+	if (defer_messages) {
+		std::lock_guard<std::mutex> lock(deferred_mutex);
+		deferred_messages.push_back({lvl, msg, c});
+		return;
+	}
+#endif
+
 #ifdef EMSCRIPTEN
 
 // Allow pretty log output and filtering in browser console
@@ -297,7 +320,40 @@ void Output::ToggleLog() {
 	show_log = !show_log;
 }
 
+void Output::DeferThreadMessages() {
+#ifdef SUPPORT_THREADS
+	defer_messages = true;
+#endif
+}
+
+void Output::Update() {
+#ifdef SUPPORT_THREADS
+	std::vector<DeferredMessage> messages;
+	{
+		std::lock_guard<std::mutex> lock(deferred_mutex);
+		messages.swap(deferred_messages);
+	}
+
+	for (auto& m: messages) {
+		if (m.lvl == LogLevel::Error) {
+			ErrorStr(m.msg);
+		}
+		WriteLog(m.lvl, m.msg, m.color);
+	}
+#endif
+}
+
 void Output::ErrorStr(std::string const& err) {
+#ifdef SUPPORT_THREADS
+	if (defer_messages) {
+		// The main thread shows the error and terminates the Player
+		WriteLog(LogLevel::Error, err);
+		for (;;) {
+			Game_Clock::SleepFor(1s);
+		}
+	}
+#endif
+
 	WriteLog(LogLevel::Error, err);
 	static bool recursive_call = false;
 	if (!recursive_call && DisplayUi) {
@@ -66,6 +66,19 @@ namespace Output {
 	 */
 	void Quit();
 
+	/**
+	 * Marks the calling thread as a background thread.
+	 * Messages of this thread are queued and written by Update().
+	 * An Error stops the thread and is raised by Update().
+	 */
+	void DeferThreadMessages();
+
+	/**
+	 * Writes the messages queued by background threads.
+	 * Must be called from the main thread.
+	 */
+	void Update();
+
 	/**
 	 * Takes screenshot and save it in the save directory.
 	 *
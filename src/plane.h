@@ -32,6 +32,7 @@ public:
 	Plane();
 
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "Plane"; }
 
 	BitmapRef const& GetBitmap() const;
 	void SetBitmap(BitmapRef const& bitmap);
@@ -20,7 +20,18 @@
 #include "filefinder.h"
 #include "utils.h"
 #include <cassert>
+#include <cstdio>
 #include <utility>
+#ifdef __vita__
+#  include <psp2/io/fcntl.h>
+#endif
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__APPLE__)) && \
+	!defined(__vita__) && !defined(__3DS__) && !defined(GEKKO) && !defined(__SWITCH__) && !defined(EMSCRIPTEN)
+#  define HAVE_MMAP
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#endif
 
 #ifndef DT_UNKNOWN
 #define DT_UNKNOWN 0
@@ -178,6 +189,72 @@ bool Platform::File::MakeDirectory(bool follow_symlinks) const {
 	return true;
 }
 
+bool Platform::File::Rename(const std::string& target) const {
+#ifdef _WIN32
+	return MoveFileExW(filename.c_str(), Utils::ToWideString(target).c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#elif defined(__vita__)
+	// Fails when the target exists
+	::sceIoRemove(target.c_str());
+	return ::sceIoRename(filename.c_str(), target.c_str()) >= 0;
+#else
+	return std::rename(filename.c_str(), target.c_str()) == 0;
+#endif
+}
+
+Platform::MappedFile::MappedFile(const std::string& name) {
+#if defined(_WIN32)
+	HANDLE file = ::CreateFileW(Utils::ToWideString(name).c_str(), GENERIC_READ, FILE_SHARE_READ,
+			nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return;
+	}
+
+	LARGE_INTEGER file_size;
+	if (::GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0 &&
+			static_cast<uint64_t>(file_size.QuadPart) <= SIZE_MAX) {
+		HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping) {
+			data = static_cast<const uint8_t*>(::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			if (data) {
+				size = static_cast<size_t>(file_size.QuadPart);
+			}
+			::CloseHandle(mapping);
+		}
+	}
+	::CloseHandle(file);
+#elif defined(HAVE_MMAP)
+	int fd = ::open(name.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return;
+	}
+
+	struct stat sb = {};
+	if (::fstat(fd, &sb) == 0 && S_ISREG(sb.st_mode) && sb.st_size > 0 &&
+			static_cast<uint64_t>(sb.st_size) <= SIZE_MAX) {
+		void* addr = ::mmap(nullptr, static_cast<size_t>(sb.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr != MAP_FAILED) {
+			data = static_cast<const uint8_t*>(addr);
+			size = static_cast<size_t>(sb.st_size);
+		}
+	}
+	::close(fd);
+#else
+	(void)name;
+#endif
+}
+
+Platform::MappedFile::~MappedFile() {
+	if (!data) {
+		return;
+	}
+
+#if defined(_WIN32)
+	::UnmapViewOfFile(data);
+#elif defined(HAVE_MMAP)
+	::munmap(const_cast<uint8_t*>(data), size);
+#endif
+}
+
 Platform::Directory::Directory(const std::string& name) {
 #if defined(_WIN32)
 	dir_handle = ::_wopendir(Utils::ToWideString(name.empty() ? "." : name).c_str());
@@ -20,6 +20,8 @@
 
 // Headers
 #include "system.h"
+#include "span.h"
+#include <cstdint>
 #include <string>
 #ifdef _WIN32
 #  include <windows.h>
@@ -102,6 +104,15 @@ namespace Platform {
 		 */
 		bool MakeDirectory(bool follow_symlinks) const;
 
+		/**
+		 * Renames the file. An existing file at the target is replaced.
+		 * The replacement is atomic on platforms supporting this.
+		 *
+		 * @param target New name of the file
+		 * @return true when the file was renamed
+		 */
+		bool Rename(const std::string& target) const;
+
 	private:
 #ifdef _WIN32
 		const std::wstring filename;
@@ -110,6 +121,33 @@ namespace Platform {
 #endif
 	};
 
+	/** Read-only memory mapping of a whole file */
+	class MappedFile {
+	public:
+		explicit MappedFile() = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(const MappedFile&) = delete;
+
+		/**
+		 * Maps a file into memory.
+		 * Fails for empty files and on platforms without memory mapping support.
+		 *
+		 * @param name File to map
+		 */
+		explicit MappedFile(const std::string& name);
+		~MappedFile();
+
+		/** @return mapped content of the file, empty on failure */
+		Span<const uint8_t> GetData() const;
+
+		/** @return true if mapping the file was successful */
+		explicit operator bool() const noexcept;
+
+	private:
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+	};
+
 	/** Wrapper around directory reading */
 	class Directory {
 	public:
@@ -159,6 +197,14 @@ namespace Platform {
 		bool valid_entry = false;
 	};
 
+	inline Span<const uint8_t> MappedFile::GetData() const {
+		return Span<const uint8_t>(data, size);
+	}
+
+	inline MappedFile::operator bool() const noexcept {
+		return data != nullptr;
+	}
+
 	inline Directory::operator bool() const noexcept {
 #ifdef __vita__
 		return dir_handle >= 0;
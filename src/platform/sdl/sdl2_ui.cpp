@@ -350,6 +350,7 @@ bool Sdl2Ui::RefreshDisplayMode() {
 			Output::Debug("SDL_CreateTexture failed : {}", SDL_GetError());
 			return false;
 		}
+		texture_needs_upload = true;
 
 		renderer_sg.Dismiss();
 		window_sg.Dismiss();
@@ -456,8 +457,20 @@ void Sdl2Ui::ProcessEvents() {
 }
 
 void Sdl2Ui::UpdateDisplay() {
-	// SDL_UpdateTexture was found to be faster than SDL_LockTexture / SDL_UnlockTexture.
-	SDL_UpdateTexture(sdl_texture_game, nullptr, main_surface->pixels(), main_surface->pitch());
+	Rect damage = TakeDisplayDamage();
+	if (texture_needs_upload) {
+		damage = main_surface->GetRect();
+		texture_needs_upload = false;
+	}
+
+	if (!damage.IsEmpty()) {
+		// Only the changed rows are uploaded.
+		// SDL_UpdateTexture was found to be faster than SDL_LockTexture / SDL_UnlockTexture.
+		const Bitmap& surface = *main_surface;
+		SDL_Rect rows = { 0, damage.y, surface.width(), damage.height };
+		const auto* pixels = static_cast<const uint8_t*>(surface.pixels()) + damage.y * surface.pitch();
+		SDL_UpdateTexture(sdl_texture_game, &rows, pixels, surface.pitch());
+	}
 
 	if (window.size_changed && window.width > 0 && window.height > 0) {
 		// Based on SDL2 function UpdateLogicalSize
@@ -615,6 +628,12 @@ void Sdl2Ui::ProcessEvent(SDL_Event &evnt) {
 		case SDL_FINGERMOTION:
 			ProcessFingerEvent(evnt);
 			return;
+
+		case SDL_RENDER_TARGETS_RESET:
+		case SDL_RENDER_DEVICE_RESET:
+			// Texture content was lost
+			texture_needs_upload = true;
+			return;
 	}
 }
 
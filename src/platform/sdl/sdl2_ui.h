@@ -137,6 +137,9 @@ private:
 
 	uint32_t texture_format = SDL_PIXELFORMAT_UNKNOWN;
 
+	/** The game texture content is undefined, upload the whole surface */
+	bool texture_needs_upload = true;
+
 	std::unique_ptr<AudioInterface> audio_;
 };
 
@@ -33,8 +33,10 @@
 #  include <emscripten.h>
 #endif
 
+#include "asset_prefetch.h"
 #include "async_handler.h"
 #include "audio.h"
+#include "benchmark_mode.h"
 #include "cache.h"
 #include "rand.h"
 #include "cmdline_parser.h"
@@ -57,16 +59,19 @@
 #include "game_variables.h"
 #include "game_targets.h"
 #include "graphics.h"
+#include "damage_tracker.h"
 #include <lcf/inireader.h>
 #include "input.h"
 #include <lcf/ldb/reader.h>
 #include <lcf/lmt/reader.h>
 #include <lcf/lsd/reader.h>
 #include "main_data.h"
+#include "map_cache.h"
 #include "output.h"
 #include "player.h"
 #include <lcf/reader_lcf.h>
 #include <lcf/reader_util.h>
+#include "save_writer.h"
 #include "scene_battle.h"
 #include "scene_logo.h"
 #include "scene_map.h"
@@ -74,10 +79,13 @@
 #include "version.h"
 #include "game_quit.h"
 #include "scene_title.h"
+#include "frame_stats.h"
 #include "instrumentation.h"
 #include "transition.h"
 #include <lcf/scope_guard.h>
 #include "baseui.h"
+#include "nullui.h"
+#include "worker_pool.h"
 #include "game_clock.h"
 
 #include "sliding_puzzle.h"
@@ -106,6 +114,7 @@ namespace Player {
 	bool no_rtp_flag;
 	std::string rtp_path;
 	bool no_audio_flag;
+	bool benchmark_flag;
 	bool is_easyrpg_project;
 	bool mouse_flag;
 	bool touch_flag;
@@ -165,6 +174,11 @@ void Player::Init(std::vector<std::string> arguments) {
 	// First parse command line arguments
 	auto cfg = ParseCommandLine(std::move(arguments));
 
+	// Benchmark runs must not depend on when background jobs finish
+	if (!benchmark_flag) {
+		WorkerPool::Init();
+	}
+
 	// Display a nice version string
 	auto header = GetFullVersionString() + " started";
 	Output::Debug("{}", header);
@@ -179,12 +193,20 @@ void Player::Init(std::vector<std::string> arguments) {
 	Output::Debug("CLI: {}", command_line);
 
 	Game_Clock::logClockInfo();
-	Rand::SeedRandomNumberGenerator(time(NULL));
+	if (!benchmark_flag) {
+		Rand::SeedRandomNumberGenerator(time(NULL));
+	}
 
 	Main_Data::Init();
 
 	DisplayUi.reset();
 
+	if (benchmark_flag) {
+		// Errors must not wait for a key press that never comes
+		Output::IgnorePause(true);
+		DisplayUi = std::make_shared<NullUi>(SCREEN_TARGET_WIDTH, SCREEN_TARGET_HEIGHT, cfg.video);
+	}
+
 	if(! DisplayUi) {
 		DisplayUi = BaseUi::CreateUi(SCREEN_TARGET_WIDTH, SCREEN_TARGET_HEIGHT, cfg.video);
 	}
@@ -219,17 +241,37 @@ void Player::Run() {
 void Player::MainLoop() {
 	Instrumentation::FrameScope iframe;
 
-	const auto frame_time = Game_Clock::now();
+	// The sleep at the end of the previous frame is part of that frame
+	FrameStats::EndFrame();
+
+	// The benchmark advances the game clock by exactly one logical frame per
+	// frame, the amount of updates does not depend on the machine speed then.
+	const auto frame_time = benchmark_flag
+		? Game_Clock::GetFrameTime() + Game_Clock::GetTargetGameTimeStep()
+		: Game_Clock::now();
 	Game_Clock::OnNextFrame(frame_time);
 
-	Player::UpdateInput();
+	const auto update_start = Game_Clock::now();
+
+	{
+		FrameStats::PhaseScope phase(FrameStats::eInput);
+		Player::UpdateInput();
+		Output::Update();
+	}
 
 	int num_updates = 0;
 	while (Game_Clock::NextGameTimeStep()) {
 		if (num_updates > 0) {
+			FrameStats::PhaseScope phase(FrameStats::eInput);
 			Player::UpdateInput();
 		}
 
+		FrameStats::PhaseScope phase(FrameStats::eLogic);
+		FrameStats::AddLogicStep();
+
+		// Publish background decoded images before the logic runs
+		WorkerPool::Update();
+
 		Scene::old_instances.clear();
 		Scene::instance->MainFunction();
 
@@ -237,11 +279,25 @@ void Player::MainLoop() {
 	}
 	if (num_updates == 0) {
 		// If no logical frames ran, we need to update the system keys only.
+		FrameStats::PhaseScope phase(FrameStats::eInput);
 		Input::UpdateSystem();
 	}
 
+	{
+		FrameStats::PhaseScope phase(FrameStats::eLogic);
+		AssetPrefetch::Update();
+		MapCache::Update();
+		SaveWriter::Update();
+	}
+
+	const auto draw_start = Game_Clock::now();
+
 	Player::Draw();
 
+	if (benchmark_flag) {
+		BenchmarkMode::AddFrame(draw_start - update_start, Game_Clock::now() - draw_start);
+	}
+
 	Scene::old_instances.clear();
 
 	if (!Transition::instance().IsActive() && Scene::instance->type == Scene::Null) {
@@ -250,6 +306,7 @@ void Player::MainLoop() {
 	}
 
 	auto frame_limit = DisplayUi->GetFrameLimit();
+	FrameStats::PhaseScope phase(FrameStats::eSleep);
 	if (frame_limit == Game_Clock::duration()) {
 #ifdef EMSCRIPTEN
 		emscripten_sleep(0);
@@ -294,7 +351,11 @@ void Player::UpdateInput() {
 	}
 
 	if (Input::IsSystemTriggered(Input::TOGGLE_FPS)) {
-		DisplayUi->ToggleShowFps();
+		if (Input::IsRawKeyPressed(Input::Keys::LSHIFT) || Input::IsRawKeyPressed(Input::Keys::RSHIFT)) {
+			DisplayUi->ToggleShowFrameStats();
+		} else {
+			DisplayUi->ToggleShowFps();
+		}
 	}
 	if (Input::IsSystemTriggered(Input::TAKE_SCREENSHOT)) {
 		Output::TakeScreenshot();
@@ -302,6 +363,9 @@ void Player::UpdateInput() {
 	if (Input::IsSystemTriggered(Input::SHOW_LOG)) {
 		Output::ToggleLog();
 	}
+	if (Input::IsSystemTriggered(Input::TOGGLE_TRACE)) {
+		Instrumentation::ToggleTrace();
+	}
 	if (Input::IsSystemTriggered(Input::TOGGLE_ZOOM)) {
 		DisplayUi->ToggleZoom();
 	}
@@ -369,13 +433,20 @@ void Player::Update(bool update_scene) {
 			Main_Data::game_ineluki->Update();
 		}
 
+		EP_INSTRUMENT_SCOPE("Scene::Update", Scene::instance->type);
 		Scene::instance->Update();
 	}
 }
 
 void Player::Draw() {
-	Graphics::Update();
-	Graphics::Draw(*DisplayUi->GetDisplaySurface());
+	EP_INSTRUMENT_SCOPE("Player::Draw");
+	{
+		FrameStats::PhaseScope phase(FrameStats::eDraw);
+		Graphics::Update();
+		Graphics::Draw(*DisplayUi->GetDisplaySurface());
+		DisplayUi->SetDisplayDamage(Graphics::GetDamageTracker().GetDamageBounds());
+	}
+	FrameStats::PhaseScope phase(FrameStats::ePresent);
 	DisplayUi->UpdateDisplay();
 }
 
@@ -391,6 +462,10 @@ int Player::GetFrames() {
 }
 
 void Player::Exit() {
+	if (benchmark_flag) {
+		BenchmarkMode::PrintReport();
+	}
+
 	Graphics::UpdateSceneCallback();
 #ifdef EMSCRIPTEN
 	BitmapRef surface = DisplayUi->GetDisplaySurface();
@@ -401,6 +476,8 @@ void Player::Exit() {
 	auto ret = FileFinder::Root().OpenOutputStream("/tmp/message.png", std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
 	if (ret) Output::TakeScreenshot(ret);
 #endif
+	SaveWriter::Quit();
+	WorkerPool::Quit();
 	Player::ResetGameObjects();
 	Font::Dispose();
 	DynRpg::Reset();
@@ -424,6 +501,7 @@ Game_Config Player::ParseCommandLine(std::vector<std::string> arguments) {
 	start_map_id = -1;
 	no_rtp_flag = false;
 	no_audio_flag = false;
+	benchmark_flag = false;
 	is_easyrpg_project = false;
 	mouse_flag = false;
 	touch_flag = false;
@@ -646,6 +724,14 @@ Game_Config Player::ParseCommandLine(std::vector<std::string> arguments) {
 			}
 			continue;
 		}
+		if (cp.ParseNext(arg, 1, "--benchmark")) {
+			if (arg.NumValues() > 0) {
+				benchmark_flag = true;
+				no_audio_flag = true;
+				replay_input_path = arg.Value(0);
+			}
+			continue;
+		}
 		if (cp.ParseNext(arg, 1, "--encoding")) {
 			if (arg.NumValues() > 0) {
 				forced_encoding = arg.Value(0);
@@ -1094,6 +1180,8 @@ static void OnMapSaveFileReady(FileRequestResult*, lcf::rpg::Save save) {
 void Player::LoadSavegame(const std::string& save_name, int save_id) {
 	Output::Debug("Loading Save {}", save_name);
 
+	SaveWriter::Flush();
+
 	bool load_on_map = Scene::instance->type == Scene::Map;
 
 	if (!load_on_map) {
@@ -1360,6 +1448,10 @@ void Player::PrintUsage() {
 R"(EasyRPG Player - An open source interpreter for RPG Maker 2000/2003 games.
 Options:
       --battle-test N      Start a battle test with monster party N.
+      --benchmark PATH     Replays the input log at PATH without window and
+                           audio as fast as possible. Prints the update and
+                           draw time of the frames and a hash of the final
+                           game state. Use --seed for games using random numbers.
       --disable-audio      Disable audio (in case you prefer your own music).
       --disable-rtp        Disable support for the Runtime Package (RTP).
       --encoding N         Instead of auto detecting the encoding or using
@@ -1410,11 +1502,19 @@ Options:
                            Possible options:
                             RPG_RT     - The default RPG_RT compatible algo, including RPG_RT bugs
                             RPG_RT+    - The default RPG_RT compatible algo, with bug fixes
+      --map-cache-budget N Memory in MiB for parsed maps that are kept for later
+                           transfers and prefetched from teleport commands.
+                           The default is 16 MiB. Set to 0 to disable the cache.
       --patch PATCH...     Force emulation of engine patches, disabling auto-detection.
                            Possible options:
                             none       - Disable all patches
                             dynrpg     - DynRPG patch by Cherry
                             maniac     - Maniac Patch by BingShan
+      --prefetch-budget N  Memory in MiB for assets used by the events of a map
+                           that are loaded in advance. The default is 8 MiB.
+                           Set to 0 to disable prefetching.
+      --render-threads N   Split the screen into N bands that are drawn in
+                           parallel. The default is 1 (no parallel drawing).
       --start-position X Y Overwrite the party start position and move the
                            party to position (X, Y).
                            Incompatible with --load-game-id.
@@ -324,6 +324,9 @@ namespace Player {
 	/** Mutes audio playback */
 	extern bool no_audio_flag;
 
+	/** Headless benchmark mode, replays an input log as fast as possible */
+	extern bool benchmark_flag;
+
 	/** Is this project using EasyRPG files, or the RPG_RT format? */
 	extern bool is_easyrpg_project;
 
@@ -0,0 +1,160 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "save_header.h"
+#include <lcf/reader_lcf.h>
+
+namespace {
+	// Chunk IDs of lcf::rpg::Save and lcf::rpg::SaveTitle
+	constexpr int chunk_end_of_block = 0x00;
+	constexpr int chunk_save_title = 0x64;
+
+	enum ChunkSaveTitle {
+		timestamp = 0x01,
+		hero_name = 0x0B,
+		hero_level = 0x0C,
+		hero_hp = 0x0D,
+		face1_name = 0x15,
+		face1_id = 0x16,
+		face2_name = 0x17,
+		face2_id = 0x18,
+		face3_name = 0x19,
+		face3_id = 0x1A,
+		face4_name = 0x1B,
+		face4_id = 0x1C
+	};
+}
+
+bool SaveHeader::Read(std::istream& is, const std::string& encoding, lcf::rpg::SaveTitle& title) {
+	// The file size is needed to validate the chunk layout
+	const std::streamoff begin = is.tellg();
+	if (begin < 0) {
+		return false;
+	}
+	is.seekg(0, std::ios_base::end);
+	const std::streamoff file_end = is.tellg();
+	is.seekg(begin);
+	if (!is || file_end < 0) {
+		return false;
+	}
+
+	lcf::LcfReader reader(is, encoding);
+
+	std::string header;
+	reader.ReadString(header, reader.ReadInt());
+	if (!reader.IsOk() || header != "LcfSaveData") {
+		return false;
+	}
+
+	lcf::LcfReader::Chunk chunk;
+	chunk.ID = reader.ReadInt();
+	chunk.length = reader.ReadInt();
+	if (!reader.IsOk() || chunk.ID != chunk_save_title) {
+		return false;
+	}
+
+	const auto end = reader.Tell() + chunk.length;
+	lcf::rpg::SaveTitle result;
+
+	for (;;) {
+		chunk.ID = reader.ReadInt();
+		if (!reader.IsOk() || reader.Tell() > end) {
+			return false;
+		}
+		if (chunk.ID == chunk_end_of_block) {
+			break;
+		}
+		chunk.length = reader.ReadInt();
+
+		switch (chunk.ID) {
+			case timestamp:
+				reader.Read(result.timestamp);
+				break;
+			case hero_name:
+				reader.ReadString(result.hero_name, chunk.length);
+				break;
+			case hero_level:
+				result.hero_level = reader.ReadInt();
+				break;
+			case hero_hp:
+				result.hero_hp = reader.ReadInt();
+				break;
+			case face1_name:
+				reader.ReadString(result.face1_name, chunk.length);
+				break;
+			case face1_id:
+				result.face1_id = reader.ReadInt();
+				break;
+			case face2_name:
+				reader.ReadString(result.face2_name, chunk.length);
+				break;
+			case face2_id:
+				result.face2_id = reader.ReadInt();
+				break;
+			case face3_name:
+				reader.ReadString(result.face3_name, chunk.length);
+				break;
+			case face3_id:
+				result.face3_id = reader.ReadInt();
+				break;
+			case face4_name:
+				reader.ReadString(result.face4_name, chunk.length);
+				break;
+			case face4_id:
+				result.face4_id = reader.ReadInt();
+				break;
+			default:
+				reader.Skip(chunk, "SaveHeader");
+		}
+
+		if (!reader.IsOk() || reader.Tell() > end) {
+			return false;
+		}
+	}
+
+	if (reader.Tell() != end) {
+		return false;
+	}
+
+	// The other chunks are skipped without parsing, but they must fill the
+	// file up to the end of block marker. Otherwise the savegame is
+	// truncated or corrupted and only the full parse can decide about it.
+	for (;;) {
+		chunk.ID = reader.ReadInt();
+		if (!reader.IsOk()) {
+			return false;
+		}
+		if (chunk.ID == chunk_end_of_block) {
+			break;
+		}
+		chunk.length = reader.ReadInt();
+
+		const std::streamoff length = chunk.length;
+		if (!reader.IsOk() || length < 0 || reader.Tell() + length > file_end) {
+			return false;
+		}
+		is.seekg(length, std::ios_base::cur);
+	}
+
+	if (static_cast<std::streamoff>(reader.Tell()) != file_end) {
+		return false;
+	}
+
+	title = std::move(result);
+	return true;
+}
@@ -0,0 +1,45 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_SAVE_HEADER_H
+#define EP_SAVE_HEADER_H
+
+// Headers
+#include <istream>
+#include <string>
+#include <lcf/rpg/savetitle.h>
+
+/**
+ * Fast access to the title of a savegame (faces, hero and timestamp).
+ * RPG_RT and Player write the title as the first chunk of the LSD file,
+ * so it can be read without parsing the whole savegame.
+ */
+namespace SaveHeader {
+	/**
+	 * Reads the title chunk of a savegame.
+	 * The title is validated and the chunk layout of the remaining file is
+	 * checked without parsing it, use LSD_Reader::Load when this fails.
+	 *
+	 * @param is stream positioned at the start of the LSD file
+	 * @param encoding encoding of the strings
+	 * @param title receives the title
+	 * @return true when the title was read
+	 */
+	bool Read(std::istream& is, const std::string& encoding, lcf::rpg::SaveTitle& title);
+}
+
+#endif
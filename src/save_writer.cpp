@@ -0,0 +1,197 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "save_writer.h"
+#include "output.h"
+#include "system.h"
+
+#ifdef SUPPORT_THREADS
+#  include <condition_variable>
+#  include <deque>
+#  include <memory>
+#  include <mutex>
+#  include <thread>
+#  include <vector>
+
+namespace {
+	struct Job {
+		std::function<void()> work;
+		std::function<void()> done;
+		bool finished = false;
+	};
+
+	struct Writer {
+		std::thread thread;
+		std::mutex mutex;
+		/** Signaled when a job is queued or the thread shuts down */
+		std::condition_variable work_cv;
+		/** Signaled when a job finished */
+		std::condition_variable finished_cv;
+		/** All jobs whose done callback wasn't invoked yet, in submission order */
+		std::deque<std::shared_ptr<Job>> jobs;
+		/** Index in jobs of the next job to execute */
+		size_t next_job = 0;
+		bool quit = false;
+	};
+
+	// Heap allocated: Output::Error calls exit() and joinable threads must not be destructed
+	Writer* writer = nullptr;
+
+	void WriterMain() {
+		Output::DeferThreadMessages();
+
+		std::unique_lock<std::mutex> lock(writer->mutex);
+		for (;;) {
+			writer->work_cv.wait(lock, [] { return writer->quit || writer->next_job < writer->jobs.size(); });
+			if (writer->next_job >= writer->jobs.size()) {
+				// Quit is only requested after all jobs finished
+				return;
+			}
+
+			auto job = writer->jobs[writer->next_job];
+
+			lock.unlock();
+			job->work();
+			lock.lock();
+
+			job->finished = true;
+			++writer->next_job;
+			writer->finished_cv.notify_all();
+		}
+	}
+
+	/** Must be called with the lock held */
+	std::vector<std::shared_ptr<Job>> TakeFinished() {
+		std::vector<std::shared_ptr<Job>> finished;
+		auto& jobs = writer->jobs;
+		while (!jobs.empty() && jobs.front()->finished) {
+			finished.push_back(std::move(jobs.front()));
+			jobs.pop_front();
+			--writer->next_job;
+		}
+		return finished;
+	}
+
+	void InvokeDone(std::vector<std::shared_ptr<Job>> finished) {
+		// Invoked without the lock, callbacks are allowed to submit new jobs.
+		// The jobs are destroyed here, resources captured by them are
+		// released on the main thread.
+		for (auto& job: finished) {
+			job->done();
+		}
+	}
+}
+
+void SaveWriter::Submit(std::function<void()> work, std::function<void()> done) {
+	if (!writer) {
+		writer = new Writer();
+		writer->thread = std::thread(WriterMain);
+	}
+
+	auto job = std::make_shared<Job>();
+	job->work = std::move(work);
+	job->done = std::move(done);
+
+	{
+		std::lock_guard<std::mutex> lock(writer->mutex);
+		writer->jobs.push_back(std::move(job));
+	}
+	writer->work_cv.notify_one();
+}
+
+void SaveWriter::Update() {
+	if (!writer) {
+		return;
+	}
+
+	std::vector<std::shared_ptr<Job>> finished;
+	{
+		std::lock_guard<std::mutex> lock(writer->mutex);
+		finished = TakeFinished();
+	}
+	InvokeDone(std::move(finished));
+}
+
+bool SaveWriter::IsPending() {
+	if (!writer) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(writer->mutex);
+	return !writer->jobs.empty();
+}
+
+void SaveWriter::Flush() {
+	if (!writer) {
+		return;
+	}
+
+	// Done callbacks can submit further jobs
+	for (;;) {
+		std::vector<std::shared_ptr<Job>> finished;
+		{
+			std::unique_lock<std::mutex> lock(writer->mutex);
+			if (writer->jobs.empty()) {
+				return;
+			}
+			writer->finished_cv.wait(lock, [] { return writer->next_job >= writer->jobs.size(); });
+			finished = TakeFinished();
+		}
+		InvokeDone(std::move(finished));
+	}
+}
+
+void SaveWriter::Quit() {
+	if (!writer) {
+		return;
+	}
+
+	Flush();
+
+	{
+		std::lock_guard<std::mutex> lock(writer->mutex);
+		writer->quit = true;
+	}
+	writer->work_cv.notify_all();
+	writer->thread.join();
+
+	delete writer;
+	writer = nullptr;
+}
+
+#else
+
+void SaveWriter::Submit(std::function<void()> work, std::function<void()> done) {
+	work();
+	done();
+}
+
+void SaveWriter::Update() {
+}
+
+bool SaveWriter::IsPending() {
+	return false;
+}
+
+void SaveWriter::Flush() {
+}
+
+void SaveWriter::Quit() {
+}
+
+#endif
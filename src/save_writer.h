@@ -0,0 +1,58 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_SAVE_WRITER_H
+#define EP_SAVE_WRITER_H
+
+#include <functional>
+
+/**
+ * SaveWriter runs savegame writes on a background thread.
+ * Unlike WorkerPool the jobs are executed one after another in submission
+ * order and are never discarded, so writes to the same file can't overlap.
+ * The completion callbacks are invoked on the main thread by Update().
+ */
+namespace SaveWriter {
+	/**
+	 * Queues a job.
+	 * Without thread support both functions are invoked immediately.
+	 *
+	 * @param work executed on the background thread, must not touch main thread state
+	 * @param done executed on the main thread after work finished
+	 */
+	void Submit(std::function<void()> work, std::function<void()> done);
+
+	/**
+	 * Invokes the done callbacks of all finished jobs.
+	 * Must be called from the main thread.
+	 */
+	void Update();
+
+	/** @return whether a job or its done callback is pending */
+	bool IsPending();
+
+	/**
+	 * Waits for all jobs and invokes their done callbacks.
+	 * Must be called from the main thread.
+	 */
+	void Flush();
+
+	/** Flushes and stops the background thread */
+	void Quit();
+}
+
+#endif
@@ -18,6 +18,7 @@
 // Headers
 #include <cassert>
 #include "async_handler.h"
+#include "damage_tracker.h"
 #include "scene.h"
 #include "graphics.h"
 #include "input.h"
@@ -302,6 +303,11 @@ void Scene::DrawBackground(Bitmap& dst) {
 	dst.Fill(Main_Data::game_system->GetBackgroundColor());
 }
 
+bool Scene::GetBackgroundHash(uint64_t& hash) const {
+	hash = DrawHash().Add(Main_Data::game_system->GetBackgroundColor()).Get();
+	return true;
+}
+
 bool Scene::CheckSceneExit(AsyncOp aop) {
 	if (aop.GetType() == AsyncOp::eExitGame) {
 		if (Scene::Find(Scene::GameBrowser)) {
@@ -199,6 +199,15 @@ public:
 	 */
 	virtual void DrawBackground(Bitmap& dst);
 
+	/**
+	 * Provides a hash of everything influencing DrawBackground.
+	 * Used to only redraw the changed parts of the screen.
+	 *
+	 * @param hash receives the hash
+	 * @return false when the background cannot be tracked and must be redrawn every frame
+	 */
+	virtual bool GetBackgroundHash(uint64_t& hash) const;
+
 	DrawableList& GetDrawableList();
 
 	/** @return true if the Scene has been initialized */
@@ -89,6 +89,7 @@ public:
 	void TransitionIn(SceneType prev_scene) override;
 	void TransitionOut(SceneType next_scene) override;
 	void DrawBackground(Bitmap& dst) override;
+	bool GetBackgroundHash(uint64_t& hash) const override { hash = 0; return true; }
 
 	enum State {
 		/** Battle has started (Display encounter message) */
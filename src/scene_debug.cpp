@@ -43,6 +43,7 @@
 #include <lcf/data.h>
 #include "output.h"
 #include "transition.h"
+#include "event_profiler.h"
 
 namespace {
 struct IndexSet {
@@ -114,6 +115,8 @@ Window_VarList::Mode Scene_Debug::GetWindowMode() const {
 			return Window_VarList::eCommonEvent;
 		case eCallMapEvent:
 			return Window_VarList::eMapEvent;
+		case eProfiler:
+			return Window_VarList::eProfile;
 		default:
 			return Window_VarList::eNone;
 	}
@@ -289,6 +292,7 @@ void Scene_Debug::Update() {
 				if (
 						(is_battle && (next_mode == eSave || next_mode == eBattle || next_mode == eMap || next_mode == eCallMapEvent))
 						|| (!is_battle && (next_mode == eCallBattleEvent))
+						|| (next_mode == eProfilerDump && EventProfiler::GetEntryCount() == 0)
 				   )
 				{
 					Main_Data::game_system->SePlay(Main_Data::game_system->GetSystemSE(Main_Data::game_system->SFX_Buzzer));
@@ -440,6 +444,28 @@ void Scene_Debug::Update() {
 					}
 				}
 				break;
+			case eProfilerRecord:
+				if (EventProfiler::IsEnabled()) {
+					EventProfiler::SetEnabled(false);
+				} else {
+					// Every recording starts from scratch
+					EventProfiler::Reset();
+					EventProfiler::SetEnabled(true);
+				}
+				mode = eMain;
+				UpdateRangeListWindow();
+				break;
+			case eProfiler:
+				if (sz == 1) {
+					PushUiRangeList();
+				} else if (sz == 2) {
+					PushUiVarList();
+				}
+				break;
+			case eProfilerDump:
+				EventProfiler::Dump();
+				mode = eMain;
+				break;
 		}
 		Game_Map::SetNeedRefresh(true);
 	} else if (range_window->GetActive() && Input::IsRepeated(Input::RIGHT)) {
@@ -514,6 +540,9 @@ void Scene_Debug::UpdateRangeListWindow() {
 				addItem("Call ComEvent");
 				addItem("Call MapEvent", !is_battle);
 				addItem("Call BtlEvent", is_battle);
+				addItem(EventProfiler::IsEnabled() ? "Profiler: ON" : "Profiler: OFF");
+				addItem("Profile View");
+				addItem("Profile CSV", EventProfiler::GetEntryCount() > 0);
 			}
 			break;
 		case eSwitch:
@@ -545,6 +574,9 @@ void Scene_Debug::UpdateRangeListWindow() {
 		case eCallCommonEvent:
 			fillRange("Ce");
 			break;
+		case eProfiler:
+			fillRange("Pr");
+			break;
 		case eCallMapEvent:
 			if (GetStackSize() > 3) {
 				auto* event = Game_Map::GetEvent(GetFrame(1).value);
@@ -651,6 +683,9 @@ int Scene_Debug::GetLastPage() {
 		case eCallMapEvent:
 			num_elements = Game_Map::GetHighestEventId();
 			break;
+		case eProfiler:
+			num_elements = EventProfiler::GetEntryCount();
+			break;
 		default:
 			break;
 	}
@@ -67,6 +67,9 @@ public:
 		eCallCommonEvent,
 		eCallMapEvent,
 		eCallBattleEvent,
+		eProfilerRecord,
+		eProfiler,
+		eProfilerDump,
 		eLastMainMenuOption,
 	};
 
@@ -27,6 +27,8 @@
 #include "input.h"
 #include <lcf/lsd/reader.h>
 #include "player.h"
+#include "save_header.h"
+#include "save_writer.h"
 #include "scene_file.h"
 #include "bitmap.h"
 #include <lcf/reader_util.h>
@@ -71,14 +73,14 @@ void Scene_File::CreateHelpWindow() {
 	help_window->SetZ(Priority_Window + 1);
 }
 
-void Scene_File::PopulatePartyFaces(Window_SaveFile& win, int /* id */, lcf::rpg::Save& savegame) {
-	win.SetParty(savegame.title);
+void Scene_File::PopulatePartyFaces(Window_SaveFile& win, int /* id */, const lcf::rpg::SaveTitle& title) {
+	win.SetParty(title);
 	win.SetHasSave(true);
 }
 
-void Scene_File::UpdateLatestTimestamp(int id, lcf::rpg::Save& savegame) {
-	if (savegame.title.timestamp > latest_time) {
-		latest_time = savegame.title.timestamp;
+void Scene_File::UpdateLatestTimestamp(int id, const lcf::rpg::SaveTitle& title) {
+	if (title.timestamp > latest_time) {
+		latest_time = title.timestamp;
 		latest_slot = id;
 	}
 }
@@ -99,11 +101,21 @@ void Scene_File::PopulateSaveWindow(Window_SaveFile& win, int id) {
 			return;
 		}
 
+		// Reading only the title is much faster than parsing the whole savegame
+		lcf::rpg::SaveTitle title;
+		if (SaveHeader::Read(save_stream, Player::encoding, title)) {
+			PopulatePartyFaces(win, id, title);
+			UpdateLatestTimestamp(id, title);
+			return;
+		}
+
+		// Unusual or damaged savegame, the full parse decides whether it is usable
+		save_stream = FileFinder::Save().OpenInputStream(file);
 		std::unique_ptr<lcf::rpg::Save> savegame = lcf::LSD_Reader::Load(save_stream, Player::encoding);
 
 		if (savegame) {
-			PopulatePartyFaces(win, id, *savegame);
-			UpdateLatestTimestamp(id, *savegame);
+			PopulatePartyFaces(win, id, savegame->title);
+			UpdateLatestTimestamp(id, savegame->title);
 		} else {
 			Output::Debug("Save {} corrupted", file);
 			win.SetCorrupted(true);
@@ -116,6 +128,8 @@ void Scene_File::Start() {
 	border_top = Scene_File::MakeBorderSprite(32);
 
 	// Refresh File Finder Save Folder
+	// Show the state after pending saves finished
+	SaveWriter::Flush();
 	fs = FileFinder::Save();
 
 	for (int i = 0; i < Utils::Clamp<int32_t>(lcf::Data::system.easyrpg_max_savefiles, 3, 99); i++) {
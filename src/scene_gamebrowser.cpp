@@ -19,10 +19,12 @@
 #include "scene_gamebrowser.h"
 
 #include <memory>
+#include "async_handler.h"
 #include "audio_secache.h"
 #include "cache.h"
 #include "game_system.h"
 #include "input.h"
+#include "map_cache.h"
 #include "player.h"
 #include "scene_title.h"
 #include "bitmap.h"
@@ -45,8 +47,11 @@ void Scene_GameBrowser::Start() {
 void Scene_GameBrowser::Continue(SceneType /* prev_scene */) {
 	Main_Data::game_system->BgmStop();
 
+	// Cancels the decoding jobs of the previous game
+	AsyncHandler::ClearRequests();
 	Cache::ClearAll();
 	AudioSeCache::Clear();
+	MapCache::Clear();
 	lcf::Data::Clear();
 	Main_Data::Cleanup();
 
@@ -40,8 +40,8 @@ void Scene_Import::PopulateSaveWindow(Window_SaveFile& win, int id) {
 			lcf::LSD_Reader::Load(files[id].full_path, Player::encoding);
 
 		if (savegame.get()) {
-			PopulatePartyFaces(win, id, *savegame);
-			UpdateLatestTimestamp(id, *savegame);
+			PopulatePartyFaces(win, id, savegame->title);
+			UpdateLatestTimestamp(id, savegame->title);
 		} else {
 			win.SetCorrupted(true);
 		}
@@ -41,6 +41,7 @@ public:
 	void Start() override;
 	void Update() override;
 	void DrawBackground(Bitmap& dst) override;
+	bool GetBackgroundHash(uint64_t& hash) const override { hash = 0; return true; }
 
 private:
 	std::unique_ptr<Sprite> logo;
@@ -16,6 +16,7 @@
  */
 
 // Headers
+#include <memory>
 #include <sstream>
 
 #ifdef EMSCRIPTEN
@@ -39,6 +40,7 @@
 #include <lcf/lsd/reader.h>
 #include "output.h"
 #include "player.h"
+#include "save_writer.h"
 #include "scene_save.h"
 #include "version.h"
 
@@ -57,7 +59,7 @@ void Scene_Save::Start() {
 }
 
 void Scene_Save::Action(int index) {
-	Save(fs, index + 1);
+	SaveAsync(fs, index + 1, nullptr);
 
 	Scene::Pop();
 }
@@ -73,21 +75,8 @@ std::string Scene_Save::GetSaveFilename(const FilesystemView& fs, int slot_id) {
 	return filename;
 }
 
-bool Scene_Save::Save(const FilesystemView& fs, int slot_id, bool prepare_save) {
-	const auto filename = GetSaveFilename(fs, slot_id);
-	Output::Debug("Saving to {}", filename);
-	
-	auto save_stream = FileFinder::Save().OpenOutputStream(filename);
-
-	if (!save_stream) {
-		Output::Warning("Failed saving to {}", filename);
-		return false;
-	}
-
-	return Save(save_stream, slot_id, prepare_save);
-}
-
-bool Scene_Save::Save(std::ostream& os, int slot_id, bool prepare_save) {
+namespace {
+lcf::rpg::Save CreateSaveData(int slot_id, bool prepare_save) {
 	lcf::rpg::Save save;
 	auto& title = save.title;
 	// TODO: Maybe find a better place to setup the save file?
@@ -146,11 +135,15 @@ bool Scene_Save::Save(std::ostream& os, int slot_id, bool prepare_save) {
 			sme.map_id = 0;
 		}
 	}
-	auto lcf_engine = Player::IsRPG2k3() ? lcf::EngineVersion::e2k3 : lcf::EngineVersion::e2k;
-	bool res = lcf::LSD_Reader::Save(os, save, lcf_engine, Player::encoding);
 
-	DynRpg::Save(slot_id);
+	return save;
+}
+
+lcf::EngineVersion GetEngineVersion() {
+	return Player::IsRPG2k3() ? lcf::EngineVersion::e2k3 : lcf::EngineVersion::e2k;
+}
 
+void SyncFilesystem() {
 #ifdef EMSCRIPTEN
 	// Save changed file system
 	EM_ASM({
@@ -158,6 +151,72 @@ bool Scene_Save::Save(std::ostream& os, int slot_id, bool prepare_save) {
 		});
 	});
 #endif
+}
+
+/** Runs on the SaveWriter thread */
+bool WriteSave(const FilesystemView& fs, const std::string& filename, bool use_temp_file,
+		const lcf::rpg::Save& save, lcf::EngineVersion engine, const std::string& encoding) {
+	const auto out_name = use_temp_file ? filename + ".tmp" : filename;
+
+	// OpenOutputStream would clear the directory cache from this thread
+	std::unique_ptr<std::streambuf> buf(fs.CreateOutputStreambuffer(out_name,
+		std::ios_base::out | std::ios_base::binary | std::ios_base::trunc));
+	if (!buf) {
+		return false;
+	}
+
+	std::ostream os(buf.get());
+	bool res = lcf::LSD_Reader::Save(os, save, engine, encoding);
+	res = os.flush().good() && res;
+	// Closes the file
+	buf.reset();
+
+	if (res && use_temp_file) {
+		res = fs.Rename(out_name, filename);
+	}
+	return res;
+}
+}
+
+void Scene_Save::SaveAsync(const FilesystemView& fs, int slot_id, std::function<void(bool)> on_done, bool prepare_save) {
+	const auto filename = GetSaveFilename(fs, slot_id);
+	Output::Debug("Saving to {}", filename);
+
+	auto save = std::make_shared<lcf::rpg::Save>(CreateSaveData(slot_id, prepare_save));
+	DynRpg::Save(slot_id);
+
+	const bool use_temp_file = fs.IsFeatureSupported(Filesystem::Feature::Rename);
+	const auto engine = GetEngineVersion();
+	const auto encoding = Player::encoding;
+	auto result = std::make_shared<bool>(false);
+
+	SaveWriter::Submit([=]() {
+		*result = WriteSave(fs, filename, use_temp_file, *save, engine, encoding);
+	}, [=]() {
+		fs.ClearCache();
+		if (!*result) {
+			Output::Warning("Failed saving to {}", filename);
+		}
+		SyncFilesystem();
+		if (on_done) {
+			on_done(*result);
+		}
+	});
+}
+
+bool Scene_Save::Save(const FilesystemView& fs, int slot_id, bool prepare_save) {
+	bool result = false;
+	SaveAsync(fs, slot_id, [&result](bool success) { result = success; }, prepare_save);
+	SaveWriter::Flush();
+	return result;
+}
+
+bool Scene_Save::Save(std::ostream& os, int slot_id, bool prepare_save) {
+	auto save = CreateSaveData(slot_id, prepare_save);
+	bool res = lcf::LSD_Reader::Save(os, save, GetEngineVersion(), Player::encoding);
+
+	DynRpg::Save(slot_id);
+	SyncFilesystem();
 
 	return res;
 }
@@ -19,6 +19,7 @@
 #define EP_SCENE_SAVE_H
 
 // Headers
+#include <functional>
 #include <vector>
 #include "scene.h"
 #include "scene_file.h"
@@ -40,6 +41,21 @@ public:
 	bool IsSlotValid(int index) override;
 
 	static std::string GetSaveFilename(const FilesystemView& tree, int slot_id);
+
+	/**
+	 * Saves the game into a slot.
+	 * The game state is captured immediately, encoding and writing happens
+	 * on the SaveWriter thread. The data is written to a temporary file that
+	 * replaces the savegame when it was written completely.
+	 *
+	 * @param tree save filesystem
+	 * @param slot_id save slot
+	 * @param on_done invoked on the main thread with the result, can be empty
+	 * @param prepare_save whether to update the save count and version info
+	 */
+	static void SaveAsync(const FilesystemView& tree, int slot_id, std::function<void(bool)> on_done, bool prepare_save = true);
+
+	/** Like SaveAsync but waits until the savegame was written */
 	static bool Save(const FilesystemView& tree, int slot_id, bool prepare_save = true);
 	static bool Save(std::ostream& os, int slot_id, bool prepare_save = true);
 };
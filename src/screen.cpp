@@ -23,20 +23,40 @@
 #include "main_data.h"
 #include "screen.h"
 #include "drawable_mgr.h"
+#include "damage_tracker.h"
 
 Screen::Screen() : Drawable(Priority_Screen)
 {
 	DrawableMgr::Register(this);
 }
 
+bool Screen::GetDrawState(const Bitmap& dst, DrawState& state) const {
+	auto flash_color = Main_Data::game_screen->GetFlashColor();
+	state.bounds = flash_color.alpha > 0 ? dst.GetRect() : Rect();
+	state.hash = DrawHash().Add(flash_color).Get();
+	return true;
+}
+
 void Screen::Draw(Bitmap& dst) {
+	Screen::PrepareDraw(dst);
+	Screen::DrawClipped(dst, dst.GetRect());
+}
+
+bool Screen::PrepareDraw(const Bitmap&) {
 	auto flash_color = Main_Data::game_screen->GetFlashColor();
-	if (flash_color.alpha > 0) {
+	flash_visible = flash_color.alpha > 0;
+	if (flash_visible) {
 		if (!flash) {
 			flash = Bitmap::Create(SCREEN_TARGET_WIDTH, SCREEN_TARGET_HEIGHT, flash_color);
 		} else {
 			flash->Fill(flash_color);
 		}
+	}
+	return true;
+}
+
+void Screen::DrawClipped(Bitmap& dst, const Rect&) const {
+	if (flash_visible) {
 		dst.Blit(0, 0, *flash, flash->GetRect(), 255);
 	}
 }
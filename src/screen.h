@@ -37,9 +37,14 @@ public:
 	Screen();
 
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "Screen"; }
+	bool GetDrawState(const Bitmap& dst, DrawState& state) const override;
+	bool PrepareDraw(const Bitmap& dst) override;
+	void DrawClipped(Bitmap& dst, const Rect& clip) const override;
 
 private:
 	BitmapRef flash;
+	bool flash_visible = false;
 };
 
 #endif
@@ -16,6 +16,7 @@
  */
 
 // Headers
+#include <cmath>
 #include <string>
 #include "sprite.h"
 #include "player.h"
@@ -23,6 +24,7 @@
 #include "bitmap.h"
 #include "cache.h"
 #include "drawable_mgr.h"
+#include "damage_tracker.h"
 
 #include "output.h"
 #include "sliding_puzzle.h"
@@ -35,6 +37,58 @@ Sprite::Sprite(Drawable::Flags flags) : Drawable(0, flags)
 
 // Draw
 void Sprite::Draw(Bitmap& dst) {
+	PrepareBlit();
+	Sprite::DrawClipped(dst, dst.GetRect());
+}
+
+bool Sprite::PrepareDraw(const Bitmap&) {
+	PrepareBlit();
+	return true;
+}
+
+void Sprite::DrawClipped(Bitmap& dst, const Rect&) const {
+	if (prepared_bitmap) {
+		BlitScreenIntern(dst, *prepared_bitmap, prepared_rect);
+	}
+}
+
+bool Sprite::GetDrawState(const Bitmap& dst, DrawState& state) const {
+	const Rect rect = myRect.IsEmpty() ? src_rect : myRect;
+	if (rect.width <= 0 || rect.height <= 0 || !bitmap || (opacity_top_effect <= 0 && opacity_bottom_effect <= 0)) {
+		state = {};
+		return true;
+	}
+
+	if (angle_effect != 0.0 || waver_effect_depth != 0) {
+		state.bounds = dst.GetRect();
+	} else {
+		const double x1 = x - ox * zoom_x_effect;
+		const double y1 = y - oy * zoom_y_effect;
+		const double x2 = x1 + rect.width * zoom_x_effect;
+		const double y2 = y1 + rect.height * zoom_y_effect;
+		// Extended by one pixel to cover rounding when zoomed
+		const int left = static_cast<int>(std::floor(std::min(x1, x2))) - 1;
+		const int top = static_cast<int>(std::floor(std::min(y1, y2))) - 1;
+		const int right = static_cast<int>(std::ceil(std::max(x1, x2))) + 1;
+		const int bottom = static_cast<int>(std::ceil(std::max(y1, y2))) + 1;
+		state.bounds = Rect(left, top, right - left, bottom - top);
+	}
+
+	state.hash = DrawHash()
+		.Add(bitmap).Add(rect).Add(src_rect_effect)
+		.Add(x).Add(y).Add(ox).Add(oy)
+		.Add(zoom_x_effect).Add(zoom_y_effect).Add(angle_effect)
+		.Add(opacity_top_effect).Add(opacity_bottom_effect).Add(bush_effect)
+		.Add(tone_effect).Add(flash_effect).Add(blend_color_effect).Add(blend_type_effect)
+		.Add(waver_effect_depth).Add(waver_effect_phase)
+		.Add(flipx_effect).Add(flipy_effect)
+		.Get();
+	return true;
+}
+
+void Sprite::PrepareBlit() {
+	prepared_bitmap.reset();
+
 	if (GetWidth() <= 0 || GetHeight() <= 0) return;
 
 	auto r = myRect;
@@ -43,10 +97,6 @@ void Sprite::Draw(Bitmap& dst) {
 		SetSrcRect(r);
 	}
 
-	BlitScreen(dst);
-}
-
-void Sprite::BlitScreen(Bitmap& dst) {
 	if (!bitmap || (opacity_top_effect <= 0 && opacity_bottom_effect <= 0))
 		return;
 
@@ -65,7 +115,8 @@ void Sprite::BlitScreen(Bitmap& dst) {
 		rect.y %= bitmap_effects->GetHeight();
 	}
 
-	BlitScreenIntern(dst, *draw_bitmap, rect);
+	prepared_bitmap = std::move(draw_bitmap);
+	prepared_rect = rect;
 }
 
 void Sprite::BlitScreenIntern(Bitmap& dst, Bitmap const& draw_bitmap, Rect const& src_rect) const
@@ -106,8 +157,11 @@ BitmapRef Sprite::Refresh(Rect& rect) {
 	}
 
 	if (no_effects) {
+		effects_buffer.reset();
+		effects_refreshed = false;
 		return bitmap;
 	} else if (bitmap_effects) {
+		effects_refreshed = false;
 		return bitmap_effects;
 	} else {
 		current_tone = tone_effect;
@@ -115,8 +169,21 @@ BitmapRef Sprite::Refresh(Rect& rect) {
 		current_flip_x = flipx_effect;
 		current_flip_y = flipy_effect;
 
-		bitmap_effects = Cache::SpriteEffect(bitmap, rect, flipx_effect, flipy_effect, current_tone, current_flash);
+		// A flash fades every frame and tone transitions change the tone on
+		// consecutive frames. Such bitmaps are used once, render them into a
+		// buffer owned by the sprite instead of filling the cache.
+		if (!no_flash || effects_refreshed) {
+			if (!effects_buffer || effects_buffer->GetWidth() != rect.width || effects_buffer->GetHeight() != rect.height) {
+				effects_buffer = Bitmap::Create(rect.width, rect.height, true);
+			}
+			effects_buffer->SpriteEffectBlit(*bitmap, rect, flipx_effect, flipy_effect, current_tone, current_flash);
+			bitmap_effects = effects_buffer;
+		} else {
+			effects_buffer.reset();
+			bitmap_effects = Cache::SpriteEffect(bitmap, rect, flipx_effect, flipy_effect, current_tone, current_flash);
+		}
 		bitmap_effects_src_rect = rect;
+		effects_refreshed = true;
 
 		return bitmap_effects;
 	}
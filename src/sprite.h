@@ -33,6 +33,10 @@ public:
 	explicit Sprite(Drawable::Flags flags = Drawable::Flags::Default);
 
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "Sprite"; }
+	bool GetDrawState(const Bitmap& dst, DrawState& state) const override;
+	bool PrepareDraw(const Bitmap& dst) override;
+	void DrawClipped(Bitmap& dst, const Rect& clip) const override;
 
 	virtual int GetWidth() const;
 	virtual int GetHeight() const;
@@ -102,6 +106,13 @@ public:
 	 */
 	void SetFlashEffect(const Color &color);
 
+	/**
+	 * Used by tests to check which bitmap the effects are rendered into.
+	 *
+	 * @return bitmap of the last draw with tone, flash and flip applied
+	 */
+	BitmapRef const& GetDrawBitmap() const;
+
 	Rect myRect = {0,0,0,0};
 private:
 	BitmapRef bitmap;
@@ -127,6 +138,8 @@ private:
 	Color flash_effect;
 
 	BitmapRef bitmap_effects;
+	/** Reused for effects that change every frame, see Refresh */
+	BitmapRef effects_buffer;
 
 	Rect bitmap_effects_src_rect;
 
@@ -137,8 +150,14 @@ private:
 	bool current_flip_x = false;
 	bool current_flip_y = false;
 	bool bitmap_changed = true;
+	/** Whether the last Refresh rendered the effects */
+	bool effects_refreshed = false;
 
-	void BlitScreen(Bitmap& dst);
+	/** Bitmap and source rect of the next blit, set by PrepareBlit */
+	BitmapRef prepared_bitmap;
+	Rect prepared_rect;
+
+	void PrepareBlit();
 	void BlitScreenIntern(Bitmap& dst, Bitmap const& draw_bitmap,
 							Rect const& src_rect) const;
 	BitmapRef Refresh(Rect& rect);
@@ -156,6 +175,10 @@ inline BitmapRef const& Sprite::GetBitmap() const {
 	return bitmap;
 }
 
+inline BitmapRef const& Sprite::GetDrawBitmap() const {
+	return prepared_bitmap;
+}
+
 inline Rect const& Sprite::GetSrcRect() const {
 	return src_rect;
 }
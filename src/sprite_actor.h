@@ -89,6 +89,7 @@ public:
 	int GetHeight() const override;
 
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "Sprite_Actor"; }
 
 	Game_Actor* GetBattler() const;
 
@@ -40,6 +40,10 @@ public:
 
 	~Sprite_Battler() override;
 
+	/** Drawn by the subclasses, not tracked by the damage tracker and not drawn in bands */
+	bool GetDrawState(const Bitmap&, DrawState&) const override { return false; }
+	bool PrepareDraw(const Bitmap&) override { return false; }
+
 	Game_Battler* GetBattler() const;
 
 	void SetBattler(Game_Battler* new_battler);
@@ -46,6 +46,8 @@ public:
 	 */
 	Sprite_Character(Game_Character* character, CloneType type = CloneType::Original);
 
+	const char* GetTypeName() const override { return "Sprite_Character"; }
+
 	/**
 	 * Updates sprite state.
 	 */
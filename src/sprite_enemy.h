@@ -41,6 +41,7 @@ public:
 	~Sprite_Enemy() override;
 
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "Sprite_Enemy"; }
 
 	Game_Enemy* GetBattler() const;
 
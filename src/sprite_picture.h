@@ -35,6 +35,9 @@ public:
 	Sprite_Picture(int pic_id, Drawable::Flags flags = Drawable::Flags::Default);
 
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "Sprite_Picture"; }
+	bool GetDrawState(const Bitmap&, DrawState&) const override { return false; }
+	bool PrepareDraw(const Bitmap&) override { return false; }
 
 	void OnPictureShow();
 
@@ -37,6 +37,9 @@ public:
 
 protected:
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "Sprite_Timer"; }
+	bool GetDrawState(const Bitmap&, DrawState&) const override { return false; }
+	bool PrepareDraw(const Bitmap&) override { return false; }
 
 	int which = 0;
 
@@ -52,6 +52,9 @@ public:
 	void StopAttack();
 
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "Sprite_Weapon"; }
+	bool GetDrawState(const Bitmap&, DrawState&) const override { return false; }
+	bool PrepareDraw(const Bitmap&) override { return false; }
 
 protected:
 	void CreateSprite();
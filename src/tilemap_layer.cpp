@@ -16,6 +16,7 @@
  */
 
 // Headers
+#include <algorithm>
 #include <cstring>
 #include <cmath>
 #include "tilemap_layer.h"
@@ -28,7 +29,6 @@
 #include "game_map.h"
 #include "game_system.h"
 #include "drawable_mgr.h"
-#include "baseui.h"
 
 // Blocks subtiles IDs
 // Mess with this code and you will die in 3 days...
@@ -140,6 +140,9 @@ static constexpr uint8_t BlockD_Subtiles_IDS[50][2][2][2] = {
     {{{0, 0}, {0, 0}}, {{0, 0}, {0, 0}}}
 };
 
+constexpr int TilemapLayer::CHUNK_SIZE;
+constexpr int TilemapLayer::CHUNK_LIFETIME;
+
 TilemapLayer::TilemapLayer(int ilayer) :
 	substitutions(Game_Map::GetTilesLayer(ilayer)),
 	layer(ilayer),
@@ -156,59 +159,31 @@ TilemapLayer::TilemapLayer(int ilayer) :
 // was created intentionally. Inlining the transparency check was measured and shown
 // to provide a performance improvement
 EP_ALWAYS_INLINE
-void TilemapLayer::DrawTile(Bitmap& dst, Bitmap& tileset, Bitmap& tone_tileset, int x, int y, int row, int col, uint32_t tone_hash, bool allow_fast_blit) {
+ImageOpacity TilemapLayer::DrawTile(Bitmap& dst, Bitmap& tileset, int x, int y, int row, int col, bool allow_fast_blit) {
 	auto op = tileset.GetTileOpacity(col, row);
 	if (op != ImageOpacity::Transparent) {
-		DrawTileImpl(dst, tileset, tone_tileset, x, y, row, col, tone_hash, op, allow_fast_blit);
+		DrawTileImpl(dst, tileset, x, y, row, col, op, allow_fast_blit);
 	}
+	return op;
 }
 
-void TilemapLayer::DrawTileImpl(Bitmap& dst, Bitmap& tileset, Bitmap& tone_tileset, int x, int y, int row, int col, uint32_t tone_hash, ImageOpacity op, bool allow_fast_blit) {
+void TilemapLayer::DrawTileImpl(Bitmap& dst, Bitmap& tileset, int x, int y, int row, int col, ImageOpacity op, bool allow_fast_blit) {
 
 	auto rect = Rect{ col * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE };
 
-	auto* src = &tileset;
-
-	// Create tone changed tile
-	if (tone != Tone()) {
-		if (chipset_tone_tiles.insert(tone_hash).second) {
-			tone_tileset.ToneBlit(col * TILE_SIZE, row * TILE_SIZE, tileset, rect, tone, Opacity::Opaque());
-		}
-		src = &tone_tileset;
-	}
-
 	bool use_fast_blit = fast_blit && allow_fast_blit;
 	if (op == ImageOpacity::Opaque || use_fast_blit) {
-		dst.BlitFast(x, y, *src, rect, 255);
+		dst.BlitFast(x, y, tileset, rect, 255);
 	} else {
-		dst.Blit(x, y, *src, rect, 255);
+		dst.Blit(x, y, tileset, rect, 255);
 	}
 }
 
-static uint32_t MakeFTileHash(int id) {
-	return static_cast<uint32_t>(id);
-}
-
-static uint32_t MakeETileHash(int id) {
-	return static_cast<uint32_t>(id | (1 << 24));
-}
-
-static uint32_t MakeDTileHash(int id) {
-	return static_cast<uint32_t>(id | (2 << 24));
-}
-
-static uint32_t MakeCTileHash(int id, int anim_step) {
-	return static_cast<uint32_t>((id + (anim_step << 12)) | (3 << 24));
-}
-
-static uint32_t MakeAbTileHash(int id, int anim_step) {
-	return static_cast<uint32_t>((id + (anim_step << 12)) | (4 << 24));
-}
-
-void TilemapLayer::Draw(Bitmap& dst, uint8_t z_order) {
+template <typename F>
+void TilemapLayer::ForEachVisibleRun(F&& f) const {
 	// Get the number of tiles that can be displayed on window
-	int tiles_x = (int)ceil(DisplayUi->GetWidth() / (float)TILE_SIZE);
-	int tiles_y = (int)ceil(DisplayUi->GetHeight() / (float)TILE_SIZE);
+	int tiles_x = (int)ceil(view_width / (float)TILE_SIZE);
+	int tiles_y = (int)ceil(view_height / (float)TILE_SIZE);
 
 	// If ox or oy are not equal to the tile size draw the next tile too
 	// to prevent black (empty) tiles at the borders
@@ -231,10 +206,71 @@ void TilemapLayer::Draw(Bitmap& dst, uint8_t z_order) {
 		return rem >= 0 ? rem : m + rem;
 	};
 
+	const int div_ox = div_rounding_down(ox, TILE_SIZE);
+	const int div_oy = div_rounding_down(oy, TILE_SIZE);
+
+	const int mod_ox = mod(ox, TILE_SIZE);
+	const int mod_oy = mod(oy, TILE_SIZE);
+
+	// The visible area is split into runs of tiles sharing the same chunk
+	// and every run is blitted with a single call
+	int run_h;
+	for (int y = 0; y < tiles_y; y += run_h) {
+		int map_y = div_oy + y;
+		if (loop_v) map_y = mod(map_y, height);
+
+		if (map_y < 0) {
+			run_h = -map_y;
+			continue;
+		}
+		if (map_y >= height) {
+			break;
+		}
+
+		const int chunk_y = map_y / CHUNK_SIZE;
+		const int cell_y = map_y % CHUNK_SIZE;
+		run_h = std::min({ CHUNK_SIZE - cell_y, height - map_y, tiles_y - y });
+
+		int run_w;
+		for (int x = 0; x < tiles_x; x += run_w) {
+			int map_x = div_ox + x;
+			if (loop_h) map_x = mod(map_x, width);
+
+			if (map_x < 0) {
+				run_w = -map_x;
+				continue;
+			}
+			if (map_x >= width) {
+				break;
+			}
+
+			const int chunk_x = map_x / CHUNK_SIZE;
+			const int cell_x = map_x % CHUNK_SIZE;
+			run_w = std::min({ CHUNK_SIZE - cell_x, width - map_x, tiles_x - x });
+
+			auto rect = Rect{ cell_x * TILE_SIZE, cell_y * TILE_SIZE, run_w * TILE_SIZE, run_h * TILE_SIZE };
+			f(chunk_x, chunk_y, rect, x * TILE_SIZE - mod_ox, y * TILE_SIZE - mod_oy);
+		}
+	}
+}
+
+void TilemapLayer::Draw(Bitmap& dst, uint8_t z_order) {
+	PrepareDraw(dst, z_order);
+	DrawClipped(dst, z_order, dst.GetRect());
+}
+
+void TilemapLayer::PrepareDraw(const Bitmap& dst, uint8_t z_order) {
+	if (width <= 0 || height <= 0 || chunks.empty()) {
+		return;
+	}
+
+	view_width = dst.GetWidth();
+	view_height = dst.GetHeight();
+
 	// FIXME: When Game_Map singleton is made an object we can remove this null check
 	const auto frames = Main_Data::game_system ? Main_Data::game_system->GetFrameCounter() : 0;
-	auto animation_step_c = (frames / 6) % 4;
-	auto animation_step_ab = frames / animation_speed;
+	int animation_step_c = (frames / 6) % 4;
+	int animation_step_ab = frames / animation_speed;
 	if (animation_type) {
 		animation_step_ab %= 3;
 	} else {
@@ -244,117 +280,315 @@ void TilemapLayer::Draw(Bitmap& dst, uint8_t z_order) {
 		}
 	}
 
-	const int div_ox = div_rounding_down(ox, TILE_SIZE);
-	const int div_oy = div_rounding_down(oy, TILE_SIZE);
+	const int sublayer = z_order >= TileAbove ? 1 : 0;
 
-	const int mod_ox = mod(ox, TILE_SIZE);
-	const int mod_oy = mod(oy, TILE_SIZE);
+	++chunk_clock;
 
-	for (int y = 0; y < tiles_y; y++) {
-		for (int x = 0; x < tiles_x; x++) {
+	ForEachVisibleRun([&](int chunk_x, int chunk_y, const Rect& rect, int, int) {
+		TileChunk& chunk = GetChunk(sublayer, chunk_x, chunk_y);
+		chunk.last_used = chunk_clock;
 
-			// Get the real maps tile coordinates
-			int map_x = div_ox + x;
-			int map_y = div_oy + y;
-			if (loop_h) map_x = mod(map_x, width);
-			if (loop_v) map_y = mod(map_y, height);
+		if (chunk.dirty) {
+			RenderChunk(chunk, z_order, chunk_x, chunk_y, animation_step_ab, animation_step_c);
+		} else if (chunk.animation_step_ab != animation_step_ab || chunk.animation_step_c != animation_step_c) {
+			RenderChunkAnimation(chunk, chunk_x, chunk_y, animation_step_ab, animation_step_c);
+		}
+
+		if (!chunk.empty) {
+			ToneChunk(chunk, rect);
+		}
+	});
+
+	if (chunk_clock % CHUNK_LIFETIME == 0) {
+		EvictChunks();
+	}
+}
+
+void TilemapLayer::DrawClipped(Bitmap& dst, uint8_t z_order, const Rect& clip) const {
+	if (width <= 0 || height <= 0 || chunks.empty()) {
+		return;
+	}
+
+	const int sublayer = z_order >= TileAbove ? 1 : 0;
+	// Same rule as for single tiles: Only the lowest sublayer may ignore alpha
+	const bool use_fast_blit = fast_blit && (layer != 0 || z_order == TileBelow);
+
+	ForEachVisibleRun([&](int chunk_x, int chunk_y, const Rect& rect, int map_draw_x, int map_draw_y) {
+		if (map_draw_y + rect.height <= clip.y || map_draw_y >= clip.y + clip.height) {
+			return;
+		}
+
+		const TileChunk& chunk = GetChunk(sublayer, chunk_x, chunk_y);
+		if (chunk.empty) {
+			return;
+		}
+
+		// The tone keeps the alpha channel, chunk.opaque applies to both bitmaps
+		const Bitmap& src = chunk.tone_bitmap ? *chunk.tone_bitmap : *chunk.bitmap;
+
+		if (chunk.opaque || use_fast_blit) {
+			dst.BlitFast(map_draw_x, map_draw_y, src, rect, 255);
+		} else {
+			dst.Blit(map_draw_x, map_draw_y, src, rect, 255);
+		}
+	});
+}
+
+ImageOpacity TilemapLayer::DrawTileData(Bitmap& dst, int x, int y, const TileData& tile, int animation_step_ab, int animation_step_c) {
+	// The chunks take care of the alpha channel, tiles are always drawn
+	// with alpha into them unless the tile itself is opaque
+	constexpr bool allow_fast_blit = false;
+
+	if (layer == 0) {
+		// If lower layer
+
+		if (tile.ID >= BLOCK_E && tile.ID < BLOCK_E + BLOCK_E_TILES) {
+			int id = substitutions[tile.ID - BLOCK_E];
+			// If Block E
+
+			int row, col;
+
+			// Get the tile coordinates from chipset
+			if (id < 96) {
+				// If from first column of the block
+				col = 12 + id % 6;
+				row = id / 6;
+			} else {
+				// If from second column of the block
+				col = 18 + (id - 96) % 6;
+				row = (id - 96) / 6;
+			}
+
+			return DrawTile(dst, *chipset, x, y, row, col, allow_fast_blit);
+		} else if (tile.ID >= BLOCK_C && tile.ID < BLOCK_D) {
+			// If Block C
+
+			// Get the tile coordinates from chipset
+			int col = 3 + (tile.ID - BLOCK_C) / 50;
+			int row = 4 + animation_step_c;
+
+			return DrawTile(dst, *chipset, x, y, row, col, allow_fast_blit);
+		} else if (tile.ID < BLOCK_C) {
+			// If Blocks A1, A2, B
+
+			// Draw the tile from autotile cache
+			TileXY pos = GetCachedAutotileAB(tile.ID, animation_step_ab);
+
+			int col = pos.x;
+			int row = pos.y;
+
+			return DrawTile(dst, *autotiles_ab_screen, x, y, row, col, allow_fast_blit);
+		} else {
+			// If blocks D1-D12
+
+			// Draw the tile from autotile cache
+			TileXY pos = GetCachedAutotileD(tile.ID);
+
+			int col = pos.x;
+			int row = pos.y;
+
+			return DrawTile(dst, *autotiles_d_screen, x, y, row, col, allow_fast_blit);
+		}
+	} else {
+		// If upper layer
+
+		// Check that block F is being drawn
+		if (tile.ID >= BLOCK_F && tile.ID < BLOCK_F + BLOCK_F_TILES) {
+			int id = substitutions[tile.ID - BLOCK_F];
+			int row, col;
+
+			// Get the tile coordinates from chipset
+			if (id < 48) {
+				// If from first column of the block
+				col = 18 + id % 6;
+				row = 8 + id / 6;
+			} else {
+				// If from second column of the block
+				col = 24 + (id - 48) % 6;
+				row = (id - 48) / 6;
+			}
+
+			return DrawTile(dst, *chipset, x, y, row, col, allow_fast_blit);
+		}
+	}
+
+	return ImageOpacity::Transparent;
+}
+
+void TilemapLayer::RenderChunk(TileChunk& chunk, uint8_t z_order, int chunk_x, int chunk_y, int animation_step_ab, int animation_step_c) {
+	const int base_x = chunk_x * CHUNK_SIZE;
+	const int base_y = chunk_y * CHUNK_SIZE;
+	const int cells_w = std::min(CHUNK_SIZE, width - base_x);
+	const int cells_h = std::min(CHUNK_SIZE, height - base_y);
+
+	if (chunk.bitmap) {
+		chunk.bitmap->Clear();
+	} else {
+		chunk.bitmap = Bitmap::Create(CHUNK_SIZE * TILE_SIZE, CHUNK_SIZE * TILE_SIZE, true);
+	}
 
-			int map_draw_x = x * TILE_SIZE - mod_ox;
-			int map_draw_y = y * TILE_SIZE - mod_oy;
+	chunk.animated_ab.clear();
+	chunk.animated_c.clear();
+	chunk.static_opaque = true;
+	chunk.toned.reset();
+	++chunk_stats.renders;
 
-			bool out_of_bounds =
-				map_x < 0 || map_x >= width ||
-				map_y < 0 || map_y >= height;
+	bool empty = true;
 
-			if (out_of_bounds) {
+	for (int y = 0; y < cells_h; ++y) {
+		for (int x = 0; x < cells_w; ++x) {
+			const TileData& tile = GetDataCache(base_x + x, base_y + y);
+
+			if (tile.z != z_order) {
+				chunk.static_opaque = false;
 				continue;
 			}
 
-			// Get the tile data
-			TileData &tile = GetDataCache(map_x, map_y);
-
-			// Draw the sublayer if its z is being draw now
-			if (z_order == tile.z) {
-				if (layer == 0) {
-					// If lower layer
-					bool allow_fast_blit = (tile.z == TileBelow);
-
-					if (tile.ID >= BLOCK_E && tile.ID < BLOCK_E + BLOCK_E_TILES) {
-						int id = substitutions[tile.ID - BLOCK_E];
-						// If Block E
-
-						int row, col;
-
-						// Get the tile coordinates from chipset
-						if (id < 96) {
-							// If from first column of the block
-							col = 12 + id % 6;
-							row = id / 6;
-						} else {
-							// If from second column of the block
-							col = 18 + (id - 96) % 6;
-							row = (id - 96) / 6;
-						}
-
-						auto tone_hash = MakeETileHash(id);
-						DrawTile(dst, *chipset, *chipset_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
-					} else if (tile.ID >= BLOCK_C && tile.ID < BLOCK_D) {
-						// If Block C
-
-						// Get the tile coordinates from chipset
-						int col = 3 + (tile.ID - BLOCK_C) / 50;
-						int row = 4 + animation_step_c;
-
-						auto tone_hash = MakeCTileHash(tile.ID, animation_step_c);
-						DrawTile(dst, *chipset, *chipset_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
-					} else if (tile.ID < BLOCK_C) {
-						// If Blocks A1, A2, B
-
-						// Draw the tile from autotile cache
-						TileXY pos = GetCachedAutotileAB(tile.ID, animation_step_ab);
-
-						int col = pos.x;
-						int row = pos.y;
-
-						// Create tone changed tile
-						auto tone_hash = MakeAbTileHash(tile.ID,  animation_step_ab);
-						DrawTile(dst, *autotiles_ab_screen, *autotiles_ab_screen_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
-					} else {
-						// If blocks D1-D12
-
-						// Draw the tile from autotile cache
-						TileXY pos = GetCachedAutotileD(tile.ID);
-
-						int col = pos.x;
-						int row = pos.y;
-
-						auto tone_hash = MakeDTileHash(tile.ID);
-						DrawTile(dst, *autotiles_d_screen, *autotiles_d_screen_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
-					}
-				} else {
-					// If upper layer
-
-					// Check that block F is being drawn
-					if (tile.ID >= BLOCK_F && tile.ID < BLOCK_F + BLOCK_F_TILES) {
-						int id = substitutions[tile.ID - BLOCK_F];
-						int row, col;
-
-						// Get the tile coordinates from chipset
-						if (id < 48) {
-							// If from first column of the block
-							col = 18 + id % 6;
-							row = 8 + id / 6;
-						} else {
-							// If from second column of the block
-							col = 24 + (id - 48) % 6;
-							row = (id - 48) / 6;
-						}
-
-						auto tone_hash = MakeFTileHash(id);
-						DrawTile(dst, *chipset, *chipset_effect, map_draw_x, map_draw_y, row, col, tone_hash);
-					}
-				}
+			if (layer == 0 && tile.ID < BLOCK_C) {
+				chunk.animated_ab.push_back(static_cast<uint16_t>(y * CHUNK_SIZE + x));
+				continue;
+			}
+			if (layer == 0 && tile.ID >= BLOCK_C && tile.ID < BLOCK_D) {
+				chunk.animated_c.push_back(static_cast<uint16_t>(y * CHUNK_SIZE + x));
+				continue;
+			}
+
+			auto op = DrawTileData(*chunk.bitmap, x * TILE_SIZE, y * TILE_SIZE, tile, animation_step_ab, animation_step_c);
+			if (op != ImageOpacity::Transparent) {
+				empty = false;
+			}
+			if (op != ImageOpacity::Opaque) {
+				chunk.static_opaque = false;
+			}
+		}
+	}
+
+	chunk.dirty = false;
+	chunk.empty = empty && chunk.animated_ab.empty() && chunk.animated_c.empty();
+
+	if (chunk.empty) {
+		// Nothing of this sublayer in the chunk, e.g. most of the upper layer
+		chunk.bitmap.reset();
+		chunk.tone_bitmap.reset();
+		chunk.opaque = false;
+		return;
+	}
+
+	chunk.animation_step_ab = -1;
+	chunk.animation_step_c = -1;
+	RenderChunkAnimation(chunk, chunk_x, chunk_y, animation_step_ab, animation_step_c);
+}
+
+void TilemapLayer::RenderChunkAnimation(TileChunk& chunk, int chunk_x, int chunk_y, int animation_step_ab, int animation_step_c) {
+	const int base_x = chunk_x * CHUNK_SIZE;
+	const int base_y = chunk_y * CHUNK_SIZE;
+
+	// Returns whether all redrawn cells are opaque
+	auto redraw = [&](const std::vector<uint16_t>& cells) {
+		bool opaque = true;
+		for (auto cell: cells) {
+			const int x = cell % CHUNK_SIZE;
+			const int y = cell / CHUNK_SIZE;
+			const TileData& tile = GetDataCache(base_x + x, base_y + y);
+
+			chunk.bitmap->ClearRect(Rect{ x * TILE_SIZE, y * TILE_SIZE, TILE_SIZE, TILE_SIZE });
+			auto op = DrawTileData(*chunk.bitmap, x * TILE_SIZE, y * TILE_SIZE, tile, animation_step_ab, animation_step_c);
+			chunk.toned.reset(cell);
+			++chunk_stats.animated_cells;
+			if (op != ImageOpacity::Opaque) {
+				opaque = false;
+			}
+		}
+		return opaque;
+	};
+
+	if (chunk.animation_step_ab != animation_step_ab) {
+		chunk.animated_ab_opaque = redraw(chunk.animated_ab);
+		chunk.animation_step_ab = animation_step_ab;
+	}
+
+	if (chunk.animation_step_c != animation_step_c) {
+		chunk.animated_c_opaque = redraw(chunk.animated_c);
+		chunk.animation_step_c = animation_step_c;
+	}
+
+	chunk.opaque = chunk.static_opaque && chunk.animated_ab_opaque && chunk.animated_c_opaque;
+}
+
+void TilemapLayer::ToneChunk(TileChunk& chunk, const Rect& rect) {
+	if (tone == Tone()) {
+		chunk.tone_bitmap.reset();
+		return;
+	}
+
+	if (!chunk.tone_bitmap) {
+		chunk.tone_bitmap = Bitmap::Create(CHUNK_SIZE * TILE_SIZE, CHUNK_SIZE * TILE_SIZE, true);
+		chunk.toned.reset();
+	}
+	if (chunk.tone != tone) {
+		chunk.tone = tone;
+		chunk.toned.reset();
+	}
+
+	// The tone is applied to the rendered chunk instead of the tiles, a tone
+	// fade only redoes the visible cells and never renders the chunk again.
+	// Consecutive cells of a row that need the tone are done in one call.
+	const int cell_x = rect.x / TILE_SIZE;
+	const int cell_y = rect.y / TILE_SIZE;
+	const int cells_w = rect.width / TILE_SIZE;
+	const int cells_h = rect.height / TILE_SIZE;
+
+	for (int y = cell_y; y < cell_y + cells_h; ++y) {
+		int x = cell_x;
+		while (x < cell_x + cells_w) {
+			if (chunk.toned.test(y * CHUNK_SIZE + x)) {
+				++x;
+				continue;
+			}
+
+			const int start = x;
+			while (x < cell_x + cells_w && !chunk.toned.test(y * CHUNK_SIZE + x)) {
+				chunk.toned.set(y * CHUNK_SIZE + x);
+				++x;
 			}
+
+			auto span = Rect{ start * TILE_SIZE, y * TILE_SIZE, (x - start) * TILE_SIZE, TILE_SIZE };
+			chunk.tone_bitmap->ClearRect(span);
+			chunk.tone_bitmap->ToneBlit(span.x, span.y, *chunk.bitmap, span, tone, Opacity::Opaque());
+			chunk_stats.toned_cells += x - start;
+		}
+	}
+}
+
+void TilemapLayer::ResetChunks() {
+	chunks_w = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	chunks_h = (height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+	chunks.clear();
+	chunks.resize(2 * chunks_w * chunks_h);
+}
+
+void TilemapLayer::InvalidateChunkAt(int x, int y) {
+	const int chunk_x = x / CHUNK_SIZE;
+	const int chunk_y = y / CHUNK_SIZE;
+	GetChunk(0, chunk_x, chunk_y).dirty = true;
+	GetChunk(1, chunk_x, chunk_y).dirty = true;
+}
+
+void TilemapLayer::InvalidateAllChunks() {
+	for (auto& chunk: chunks) {
+		chunk.dirty = true;
+	}
+}
+
+void TilemapLayer::EvictChunks() {
+	// Chunks that were not visible for a while are released, they are
+	// rendered again when scrolled back into view
+	for (auto& chunk: chunks) {
+		if (chunk.bitmap && chunk_clock - chunk.last_used >= static_cast<uint32_t>(CHUNK_LIFETIME)) {
+			chunk.bitmap.reset();
+			chunk.tone_bitmap.reset();
+			chunk.dirty = true;
 		}
 	}
 }
@@ -373,7 +607,23 @@ TilemapLayer::TileXY TilemapLayer::GetCachedAutotileD(short ID) {
 }
 
 void TilemapLayer::CreateTileCache(const std::vector<short>& nmap_data) {
-	data_cache_vec.resize(width * height);
+	const int new_chunks_w = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	const int new_chunks_h = (height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	const bool resized = data_cache_vec.size() != static_cast<size_t>(width * height)
+		|| new_chunks_w != chunks_w || new_chunks_h != chunks_h;
+
+	if (resized) {
+		data_cache_vec.clear();
+		data_cache_vec.resize(width * height);
+		ResetChunks();
+	}
+
+	// Tiles whose substitution changed since the chunks were rendered
+	auto substituted = [&](int index) {
+		return index < static_cast<int>(chunk_substitutions.size())
+			&& chunk_substitutions[index] != substitutions[index];
+	};
+
 	for (int x = 0; x < width; x++) {
 		for (int y = 0; y < height; y++) {
 			TileData tile;
@@ -404,9 +654,24 @@ void TilemapLayer::CreateTileCache(const std::vector<short>& nmap_data) {
 
 				}
 			}
-			GetDataCache(x, y) = tile;
+
+			TileData& old_tile = GetDataCache(x, y);
+			if (!resized) {
+				bool changed = old_tile.ID != tile.ID || old_tile.z != tile.z;
+				if (!changed && tile.ID >= BLOCK_F && tile.ID < BLOCK_F + BLOCK_F_TILES) {
+					changed = substituted(tile.ID - BLOCK_F);
+				} else if (!changed && tile.ID >= BLOCK_E && tile.ID < BLOCK_E + BLOCK_E_TILES) {
+					changed = substituted(tile.ID - BLOCK_E);
+				}
+				if (changed) {
+					InvalidateChunkAt(x, y);
+				}
+			}
+			old_tile = tile;
 		}
 	}
+
+	chunk_substitutions.assign(substitutions.begin(), substitutions.end());
 }
 
 void TilemapLayer::GenerateAutotileAB(short ID, short animID) {
@@ -606,15 +871,11 @@ BitmapRef TilemapLayer::GenerateAutotiles(int count, const std::unordered_map<ui
 
 void TilemapLayer::SetChipset(BitmapRef const& nchipset) {
 	chipset = nchipset;
-	chipset_effect = Bitmap::Create(chipset->width(), chipset->height());
-	chipset_tone_tiles.clear();
+	InvalidateAllChunks();
 
 	if (autotiles_ab_next != 0 && autotiles_d_screen != nullptr && layer == 0) {
 		autotiles_ab_screen = GenerateAutotiles(autotiles_ab_next, autotiles_ab_map);
 		autotiles_d_screen = GenerateAutotiles(autotiles_d_next, autotiles_d_map);
-
-		autotiles_ab_screen_effect = Bitmap::Create(autotiles_ab_screen->width(), autotiles_ab_screen->height());
-		autotiles_d_screen_effect = Bitmap::Create(autotiles_d_screen->width(), autotiles_d_screen->height());
 	}
 }
 
@@ -648,10 +909,8 @@ void TilemapLayer::SetMapData(std::vector<short> nmap_data) {
 		autotiles_ab_screen = GenerateAutotiles(autotiles_ab_next, autotiles_ab_map);
 		autotiles_d_screen = GenerateAutotiles(autotiles_d_next, autotiles_d_map);
 
-		autotiles_ab_screen_effect = Bitmap::Create(autotiles_ab_screen->width(), autotiles_ab_screen->height());
-		autotiles_d_screen_effect = Bitmap::Create(autotiles_d_screen->width(), autotiles_d_screen->height());
-
-		chipset_tone_tiles.clear();
+		// The autotile positions changed
+		InvalidateAllChunks();
 	}
 
 	map_data = std::move(nmap_data);
@@ -685,21 +944,22 @@ void TilemapSubLayer::Draw(Bitmap& dst) {
 	tilemap->Draw(dst, GetZ());
 }
 
-void TilemapLayer::SetTone(Tone tone) {
-	if (tone == this->tone) {
+bool TilemapSubLayer::PrepareDraw(const Bitmap& dst) {
+	if (tilemap->GetChipset()) {
+		tilemap->PrepareDraw(dst, GetZ());
+	}
+	return true;
+}
+
+void TilemapSubLayer::DrawClipped(Bitmap& dst, const Rect& clip) const {
+	if (!tilemap->GetChipset()) {
 		return;
 	}
 
-	this->tone = tone;
+	tilemap->DrawClipped(dst, GetZ(), clip);
+}
 
-	if (autotiles_d_screen_effect) {
-		autotiles_d_screen_effect->Clear();
-	}
-	if (autotiles_ab_screen_effect) {
-		autotiles_ab_screen_effect->Clear();
-	}
-	if (chipset_effect) {
-		chipset_effect->Clear();
-	}
-	chipset_tone_tiles.clear();
+void TilemapLayer::SetTone(Tone tone) {
+	// The chunks notice the new tone in PrepareDraw
+	this->tone = tone;
 }
@@ -19,9 +19,9 @@
 #define EP_TILEMAP_LAYER_H
 
 // Headers
+#include <bitset>
 #include <vector>
 #include <map>
-#include <unordered_set>
 #include <unordered_map>
 #include "system.h"
 #include "drawable.h"
@@ -39,6 +39,9 @@ public:
 	TilemapSubLayer(TilemapLayer* tilemap, Drawable::Z_t z);
 
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "TilemapLayer"; }
+	bool PrepareDraw(const Bitmap& dst) override;
+	void DrawClipped(Bitmap& dst, const Rect& clip) const override;
 
 private:
 	TilemapLayer* tilemap = nullptr;
@@ -61,6 +64,23 @@ public:
 
 	void Draw(Bitmap& dst, uint8_t z_order);
 
+	/**
+	 * Renders the chunks visible in the next DrawClipped call.
+	 *
+	 * @param dst bitmap that is drawn to, its size determines the visible area
+	 * @param z_order sublayer to prepare
+	 */
+	void PrepareDraw(const Bitmap& dst, uint8_t z_order);
+
+	/**
+	 * Blits the chunks rendered by PrepareDraw, safe to call concurrently.
+	 *
+	 * @param dst bitmap to draw to
+	 * @param z_order sublayer to draw
+	 * @param clip area of dst drawn to, runs outside of it are skipped
+	 */
+	void DrawClipped(Bitmap& dst, uint8_t z_order, const Rect& clip) const;
+
 	BitmapRef const& GetChipset() const;
 	void SetChipset(BitmapRef const& nchipset);
 	const std::vector<short>& GetMapData() const;
@@ -93,10 +113,20 @@ public:
 
 	void SetTone(Tone tone);
 
+	/** Work done by PrepareDraw since the layer was created */
+	struct ChunkStats {
+		/** Chunks rendered tile by tile */
+		int renders = 0;
+		/** Animated tiles redrawn in rendered chunks */
+		int animated_cells = 0;
+		/** Tiles the tone was applied to */
+		int toned_cells = 0;
+	};
+
+	const ChunkStats& GetChunkStats() const;
+
 private:
 	BitmapRef chipset;
-	BitmapRef chipset_effect;
-	std::unordered_set<uint32_t> chipset_tone_tiles;
 	std::vector<short> map_data;
 	std::vector<uint8_t> passable;
 	Span<const uint8_t> substitutions;
@@ -112,8 +142,8 @@ private:
 	void CreateTileCache(const std::vector<short>& nmap_data);
 	void GenerateAutotileAB(short ID, short animID);
 	void GenerateAutotileD(short ID);
-	void DrawTile(Bitmap& dst, Bitmap& tile, Bitmap& tone_tile, int x, int y, int row, int col, uint32_t tone_hash, bool allow_fast_blit = true);
-	void DrawTileImpl(Bitmap& dst, Bitmap& tile, Bitmap& tone_tile, int x, int y, int row, int col, uint32_t tone_hash, ImageOpacity op, bool allow_fast_blit);
+	ImageOpacity DrawTile(Bitmap& dst, Bitmap& tile, int x, int y, int row, int col, bool allow_fast_blit = true);
+	void DrawTileImpl(Bitmap& dst, Bitmap& tile, int x, int y, int row, int col, ImageOpacity op, bool allow_fast_blit);
 
 	static const int TILES_PER_ROW = 64;
 
@@ -130,9 +160,7 @@ private:
 	TileXY GetCachedAutotileAB(short ID, short animID);
 	TileXY GetCachedAutotileD(short ID);
 	BitmapRef autotiles_ab_screen;
-	BitmapRef autotiles_ab_screen_effect;
 	BitmapRef autotiles_d_screen;
-	BitmapRef autotiles_d_screen_effect;
 
 	int autotiles_ab_next = -1;
 	int autotiles_d_next = -1;
@@ -152,6 +180,69 @@ private:
 
 	std::vector<TileData> data_cache_vec;
 
+	ImageOpacity DrawTileData(Bitmap& dst, int x, int y, const TileData& tile, int animation_step_ab, int animation_step_c);
+
+	// Size of a pre-rendered chunk in tiles
+	static constexpr int CHUNK_SIZE = 16;
+	// Amount of Draw calls a chunk survives without being visible
+	static constexpr int CHUNK_LIFETIME = 240;
+
+	/**
+	 * A CHUNK_SIZE x CHUNK_SIZE area of one sublayer pre-rendered into a bitmap.
+	 * Animated tiles (Block A, B and C) are redrawn in place when the
+	 * animation step changes, everything else only when the chunk is dirty.
+	 * The tone is applied to a copy of the chunk, see ToneChunk.
+	 */
+	struct TileChunk {
+		BitmapRef bitmap;
+		// bitmap with the tone applied, only while a tone is set
+		BitmapRef tone_bitmap;
+		Tone tone;
+		// Cells of tone_bitmap that are up to date
+		std::bitset<CHUNK_SIZE * CHUNK_SIZE> toned;
+		// Cells (y * CHUNK_SIZE + x) containing animated tiles
+		std::vector<uint16_t> animated_ab;
+		std::vector<uint16_t> animated_c;
+		int animation_step_ab = -1;
+		int animation_step_c = -1;
+		uint32_t last_used = 0;
+		bool dirty = true;
+		bool empty = true;
+		// All non-animated cells are opaque
+		bool static_opaque = false;
+		bool animated_ab_opaque = false;
+		bool animated_c_opaque = false;
+		// All cells are opaque, the chunk can be blitted without alpha
+		bool opaque = false;
+	};
+
+	TileChunk& GetChunk(int sublayer, int chunk_x, int chunk_y);
+	const TileChunk& GetChunk(int sublayer, int chunk_x, int chunk_y) const;
+
+	/** Invokes f(chunk_x, chunk_y, src_rect, dst_x, dst_y) for every run of visible tiles sharing a chunk */
+	template <typename F>
+	void ForEachVisibleRun(F&& f) const;
+	void ResetChunks();
+	void InvalidateChunkAt(int x, int y);
+	void InvalidateAllChunks();
+	void RenderChunk(TileChunk& chunk, uint8_t z_order, int chunk_x, int chunk_y, int animation_step_ab, int animation_step_c);
+	void RenderChunkAnimation(TileChunk& chunk, int chunk_x, int chunk_y, int animation_step_ab, int animation_step_c);
+	/** Applies the tone to the cells of rect (in pixels) that are not toned yet */
+	void ToneChunk(TileChunk& chunk, const Rect& rect);
+	void EvictChunks();
+
+	// [sublayer][chunk_y][chunk_x]
+	std::vector<TileChunk> chunks;
+	int chunks_w = 0;
+	int chunks_h = 0;
+	uint32_t chunk_clock = 0;
+	// Substitution table the chunks were rendered with
+	std::vector<uint8_t> chunk_substitutions;
+	ChunkStats chunk_stats;
+	// Size of the bitmap passed to PrepareDraw
+	int view_width = 0;
+	int view_height = 0;
+
 	TilemapSubLayer lower_layer;
 	TilemapSubLayer upper_layer;
 
@@ -232,9 +323,21 @@ inline void TilemapLayer::SetFastBlit(bool fast) {
 	fast_blit = fast;
 }
 
+inline const TilemapLayer::ChunkStats& TilemapLayer::GetChunkStats() const {
+	return chunk_stats;
+}
+
 inline TilemapLayer::TileData& TilemapLayer::GetDataCache(int x, int y) {
 	return data_cache_vec[x + y * width];
 }
 
+inline TilemapLayer::TileChunk& TilemapLayer::GetChunk(int sublayer, int chunk_x, int chunk_y) {
+	return chunks[(sublayer * chunks_h + chunk_y) * chunks_w + chunk_x];
+}
+
+inline const TilemapLayer::TileChunk& TilemapLayer::GetChunk(int sublayer, int chunk_x, int chunk_y) const {
+	return chunks[(sublayer * chunks_h + chunk_y) * chunks_w + chunk_x];
+}
+
 
 #endif
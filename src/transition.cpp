@@ -170,6 +170,12 @@ void Transition::SetAttributesTransitions() {
 	}
 }
 
+bool Transition::GetDrawState(const Bitmap&, DrawState& state) const {
+	// Active transitions redraw the whole screen
+	state = {};
+	return !IsActive();
+}
+
 void Transition::Draw(Bitmap& dst) {
 	if (!IsActive())
 		return;
@@ -107,6 +107,8 @@ public:
 	void PrependFlashes(int r, int g, int b, int power, int duration, int iterations);
 
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "Transition"; }
+	bool GetDrawState(const Bitmap& dst, DrawState& state) const override;
 	void Update();
 
 	bool IsActive() const;
@@ -499,6 +499,18 @@ void Utils::SwapByteOrder(uint32_t& ui) {
 			(ui << 24);
 }
 
+void Utils::SwapByteOrder(uint64_t& ui) {
+	if (!IsBigEndian()) {
+		return;
+	}
+
+	uint32_t hi = static_cast<uint32_t>(ui >> 32);
+	uint32_t lo = static_cast<uint32_t>(ui);
+	SwapByteOrder(hi);
+	SwapByteOrder(lo);
+	ui = (static_cast<uint64_t>(lo) << 32) | hi;
+}
+
 void Utils::SwapByteOrder(double& d) {
 	if (!IsBigEndian()) {
 		return;
@@ -570,6 +582,19 @@ std::vector<uint8_t> Utils::ReadStream(std::istream& stream) {
 	constexpr int buffer_incr = 8192;
 	std::vector<uint8_t> outbuf;
 
+	// Avoid reallocations when the size is known
+	auto pos = stream.tellg();
+	if (pos != std::istream::pos_type(-1)) {
+		if (stream.seekg(0, std::ios_base::end)) {
+			auto end = stream.tellg();
+			if (end > pos) {
+				outbuf.reserve(static_cast<size_t>(end - pos) + buffer_incr);
+			}
+		}
+		stream.clear();
+		stream.seekg(pos);
+	}
+
 	do {
 		outbuf.resize(outbuf.size() + buffer_incr);
 		stream.read(reinterpret_cast<char*>(outbuf.data() + outbuf.size() - buffer_incr), buffer_incr);
@@ -229,6 +229,14 @@ namespace Utils {
 	 */
 	void SwapByteOrder(uint32_t& ui);
 
+	/**
+	 * Swaps the byte order of the passed number when on big endian systems.
+	 * Does nothing otherwise.
+	 *
+	 * @param ui Number to swap
+	 */
+	void SwapByteOrder(uint64_t& ui);
+
 	/**
 	 * Swaps the byte order of the passed number when on big endian systems.
 	 * Does nothing otherwise.
@@ -33,6 +33,7 @@ public:
 	Weather();
 
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "Weather"; }
 	void Update();
 
 	Tone GetTone() const;
@@ -23,10 +23,14 @@
 #include "util_macro.h"
 #include "window.h"
 #include "bitmap.h"
+#include "cache.h"
 #include "drawable_mgr.h"
+#include "damage_tracker.h"
 
 constexpr int pause_animation_frames = 20;
 
+bool Window::compose_enabled = true;
+
 Window::Window(Drawable::Flags flags): Drawable(Priority_Window, flags)
 {
 	DrawableMgr::Register(this);
@@ -58,14 +62,49 @@ void Window::SetCloseAnimation(int frames) {
 }
 
 void Window::Draw(Bitmap& dst) {
-	if (!IsVisible()) return;
-	if (width <= 0 || height <= 0) return;
-	if (x < -width || x > dst.GetWidth() || y < -height || y > dst.GetHeight()) return;
+	Window::PrepareDraw(dst);
+	Window::DrawClipped(dst, dst.GetRect());
+}
+
+bool Window::PrepareDraw(const Bitmap& dst) {
+	if (!IsVisible()) return true;
+	if (width <= 0 || height <= 0) return true;
+	if (x < -width || x > dst.GetWidth() || y < -height || y > dst.GetHeight()) return true;
 
 	if (windowskin) {
 		if (width > 4 && height > 4 && (back_opacity * opacity / 255 > 0)) {
 			if (background_needs_refresh) RefreshBackground();
+		}
+
+		if (width > 0 && height > 0 && opacity > 0) {
+			if (frame_needs_refresh) RefreshFrame();
+		}
+
+		if (IsComposed()) {
+			if (composed_needs_refresh) RefreshComposed();
+		}
+
+		if (width >= 16 && height > 16 && cursor_rect.width > 4 && cursor_rect.height > 4 && animation_frames == 0) {
+			if (cursor_needs_refresh) RefreshCursor();
+		}
+
+		if (left_arrow || right_arrow) {
+			if (arrows_needs_refresh) RefreshArrows();
+		}
+	}
+
+	return true;
+}
+
+void Window::DrawClipped(Bitmap& dst, const Rect&) const {
+	if (!IsVisible()) return;
+	if (width <= 0 || height <= 0) return;
+	if (x < -width || x > dst.GetWidth() || y < -height || y > dst.GetHeight()) return;
 
+	if (windowskin && IsComposed()) {
+		dst.BlitFast(x, y, *composed, composed->GetRect(), 255);
+	} else if (windowskin) {
+		if (width > 4 && height > 4 && (back_opacity * opacity / 255 > 0)) {
 			if (animation_frames > 0) {
 				int ianimation_count = (int)animation_count;
 
@@ -78,8 +117,6 @@ void Window::Draw(Bitmap& dst) {
 		}
 
 		if (width > 0 && height > 0 && opacity > 0) {
-			if (frame_needs_refresh) RefreshFrame();
-
 			if (animation_frames > 0) {
 				int ianimation_count = (int)animation_count;
 
@@ -102,10 +139,10 @@ void Window::Draw(Bitmap& dst) {
 				dst.Blit(x + width - 8, y + 8, *frame_right, frame_right->GetRect(), opacity);
 			}
 		}
+	}
 
+	if (windowskin) {
 		if (width >= 16 && height > 16 && cursor_rect.width > 4 && cursor_rect.height > 4 && animation_frames == 0) {
-			if (cursor_needs_refresh) RefreshCursor();
-
 			Rect src_rect(
 				-min(cursor_rect.x + border_x, 0),
 				-min(cursor_rect.y + border_y, 0),
@@ -145,16 +182,34 @@ void Window::Draw(Bitmap& dst) {
 	}
 
 	if (right_arrow) {
-		Rect src_rect(40, 16, 16, 8);
-		dst.RotateZoomOpacityBlit(x + width - 8, y + height / 2 - 8, 16, 0, *windowskin, src_rect, -M_PI / 2, 1.0, 1.0, 255);
+		dst.Blit(x + width - 8, y + height / 2 - 8, *arrow_right, arrow_right->GetRect(), 255);
 	}
 
 	if (left_arrow) {
-		Rect src_rect(40, 8, 16, 8);
-		dst.RotateZoomOpacityBlit(x, y + height / 2 - 8, 16, 0, *windowskin, src_rect, -M_PI / 2, 1.0, 1.0, 255);
+		dst.Blit(x, y + height / 2 - 8, *arrow_left, arrow_left->GetRect(), 255);
 	}
 }
 
+bool Window::GetDrawState(const Bitmap&, DrawState& state) const {
+	if (width <= 0 || height <= 0) {
+		state = {};
+		return true;
+	}
+
+	// The arrows are drawn partially outside of the window
+	state.bounds = Rect(x - 16, y - 16, width + 32, height + 32);
+	state.hash = DrawHash()
+		.Add(windowskin).Add(contents).Add(stretch)
+		.Add(x).Add(y).Add(width).Add(height).Add(ox).Add(oy).Add(border_x).Add(border_y)
+		.Add(opacity).Add(back_opacity).Add(contents_opacity)
+		.Add(cursor_rect).Add(cursor_frame <= 10)
+		.Add(pause && pause_frame < pause_animation_frames)
+		.Add(up_arrow).Add(down_arrow).Add(left_arrow).Add(right_arrow)
+		.Add(animation_frames).Add(static_cast<int>(animation_count))
+		.Get();
+	return true;
+}
+
 void Window::RefreshBackground() {
 	background_needs_refresh = false;
 
@@ -230,6 +285,23 @@ void Window::RefreshFrame() {
 	}
 }
 
+void Window::RefreshComposed() {
+	composed_needs_refresh = false;
+
+	// Same result as blitting the parts one after another with full opacity
+	BitmapRef bitmap = Bitmap::Create(width, height);
+
+	bitmap->BlitFast(0, 0, *background, background->GetRect(), 255);
+	bitmap->Blit(0, 0, *frame_up, frame_up->GetRect(), 255);
+	bitmap->Blit(0, height - 8, *frame_down, frame_down->GetRect(), 255);
+	if (frame_left) {
+		bitmap->Blit(0, 8, *frame_left, frame_left->GetRect(), 255);
+		bitmap->Blit(width - 8, 8, *frame_right, frame_right->GetRect(), 255);
+	}
+
+	composed = bitmap;
+}
+
 void Window::RefreshCursor() {
 	cursor_needs_refresh = false;
 
@@ -289,6 +361,13 @@ void Window::RefreshCursor() {
 	cursor2 = cursor2_bitmap;
 }
 
+void Window::RefreshArrows() {
+	arrows_needs_refresh = false;
+
+	arrow_left = Cache::WindowArrow(windowskin, false);
+	arrow_right = Cache::WindowArrow(windowskin, true);
+}
+
 void Window::Update() {
 	if (active) {
 		cursor_frame += 1;
@@ -315,12 +394,17 @@ void Window::SetWindowskin(BitmapRef const& nwindowskin) {
 	}
 	background_needs_refresh = true;
 	frame_needs_refresh = true;
+	composed_needs_refresh = true;
 	cursor_needs_refresh = true;
+	arrows_needs_refresh = true;
 	windowskin = nwindowskin;
 }
 
 void Window::SetStretch(bool nstretch) {
-	if (stretch != nstretch) background_needs_refresh = true;
+	if (stretch != nstretch) {
+		background_needs_refresh = true;
+		composed_needs_refresh = true;
+	}
 	stretch = nstretch;
 }
 
@@ -333,6 +417,7 @@ void Window::SetWidth(int nwidth) {
 	if (width != nwidth) {
 		background_needs_refresh = true;
 		frame_needs_refresh = true;
+		composed_needs_refresh = true;
 	}
 	width = nwidth;
 }
@@ -341,6 +426,7 @@ void Window::SetHeight(int nheight) {
 	if (height != nheight) {
 		background_needs_refresh = true;
 		frame_needs_refresh = true;
+		composed_needs_refresh = true;
 	}
 	height = nheight;
 }
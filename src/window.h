@@ -31,6 +31,10 @@ public:
 	Window(Drawable::Flags flags = Drawable::Flags::Default);
 
 	void Draw(Bitmap& dst) override;
+	const char* GetTypeName() const override { return "Window"; }
+	bool GetDrawState(const Bitmap& dst, DrawState& state) const override;
+	bool PrepareDraw(const Bitmap& dst) override;
+	void DrawClipped(Bitmap& dst, const Rect& clip) const override;
 
 	void Update();
 	BitmapRef const& GetWindowskin() const;
@@ -82,6 +86,17 @@ public:
 	bool IsClosing() const;
 	bool IsOpeningOrClosing() const;
 
+	/** @return whether static windows are drawn from a composed bitmap */
+	static bool IsComposeEnabled();
+
+	/**
+	 * Enables drawing static windows from a composed bitmap. Used by tests
+	 * to compare with drawing every part separately.
+	 *
+	 * @param enabled whether to compose static windows
+	 */
+	static void SetComposeEnabled(bool enabled);
+
 protected:
 	virtual bool IsSystemGraphicUpdateAllowed() const;
 
@@ -112,13 +127,32 @@ private:
 		background, frame_down,
 		frame_up, frame_left, frame_right, cursor1, cursor2;
 
+	/** Background with the frame blitted on top, drawn in one blit when IsComposed() */
+	BitmapRef composed;
+
+	/** Left and right arrow of the windowskin, shared by all windows with the same windowskin */
+	BitmapRef arrow_left, arrow_right;
+
+	static bool compose_enabled;
+
+	/**
+	 * @return whether background and frame are drawn from the composed bitmap.
+	 * Only fully opaque, static windows qualify, otherwise the parts are
+	 * blended with different opacities.
+	 */
+	bool IsComposed() const;
+
 	void RefreshBackground();
 	void RefreshFrame();
+	void RefreshComposed();
 	void RefreshCursor();
+	void RefreshArrows();
 
 	bool background_needs_refresh;
 	bool frame_needs_refresh;
+	bool composed_needs_refresh = true;
 	bool cursor_needs_refresh;
+	bool arrows_needs_refresh = true;
 	bool pause = false;
 
 	int cursor_frame = 0;
@@ -289,6 +323,18 @@ inline void Window::SetContentsOpacity(int ncontents_opacity) {
 	contents_opacity = ncontents_opacity;
 }
 
+inline bool Window::IsComposeEnabled() {
+	return compose_enabled;
+}
+
+inline void Window::SetComposeEnabled(bool enabled) {
+	compose_enabled = enabled;
+}
+
+inline bool Window::IsComposed() const {
+	return compose_enabled && opacity == 255 && back_opacity == 255 && animation_frames == 0 && width > 4 && height > 4;
+}
+
 inline bool Window::IsSystemGraphicUpdateAllowed() const {
 	return !IsClosing();
 }
@@ -86,6 +86,15 @@ void Window_VarList::DrawItemValue(int index){
 				contents->TextDraw(GetWidth() - 16, 16 * index + 2, Font::ColorDefault, "", Text::AlignRight);
 			}
 			break;
+		case eProfile:
+			{
+				const auto& entry = profile[first_var + index - 1];
+				auto font = (entry.loop_limit_hits > 0) ? Font::ColorCritical : Font::ColorDefault;
+				auto ms = std::chrono::duration<double, std::milli>(entry.time).count();
+				DrawItem(index, Font::ColorDefault);
+				contents->TextDraw(GetWidth() - 16, 16 * index + 2, font, fmt::format("{:.1f}ms", ms), Text::AlignRight);
+			}
+			break;
 		case eLevel:
 			{
 				auto value = Main_Data::game_party->GetActors()[first_var + index - 1]->GetLevel();
@@ -107,6 +116,9 @@ void Window_VarList::UpdateList(int first_value){
 				[](const lcf::rpg::MapInfo& l, int r) { return l.ID < r; });
 		map_idx = iter - lcf::Data::treemap.maps.begin();
 	}
+	if (mode == eProfile) {
+		profile = EventProfiler::GetEntries();
+	}
 	for (int i = 0; i < 10; i++){
 		if (!DataIsValid(first_var+i)) {
 			continue;
@@ -155,6 +167,9 @@ void Window_VarList::UpdateList(int first_value){
 			case eMapEvent:
 				ss << Game_Map::GetEvent(first_value+i)->GetName();
 				break;
+			case eProfile:
+				ss << EventProfiler::GetLabel(profile[first_value + i - 1]);
+				break;
 			default:
 				break;
 		}
@@ -188,6 +203,8 @@ bool Window_VarList::DataIsValid(int range_index) {
 			return range_index > 0 && range_index <= static_cast<int>(lcf::Data::commonevents.size());
 		case eMapEvent:
 			return Game_Map::GetEvent(range_index) != nullptr;
+		case eProfile:
+			return range_index > 0 && range_index <= static_cast<int>(profile.size());
 		default:
 			break;
 	}
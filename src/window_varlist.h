@@ -19,6 +19,8 @@
 #define EP_WINDOW_VARLIST_H
 
 // Headers
+#include <vector>
+#include "event_profiler.h"
 #include "window_command.h"
 
 class Window_VarList : public Window_Command
@@ -35,6 +37,7 @@ public:
 		eLevel,
 		eCommonEvent,
 		eMapEvent,
+		eProfile,
 	};
 
 	/**
@@ -80,6 +83,8 @@ private:
 
 	Mode mode = eNone;
 	int first_var = 0;
+	/** Snapshot of the EventProfiler entries taken by UpdateList */
+	std::vector<EventProfiler::Entry> profile;
 
 	bool DataIsValid(int range_index);
 
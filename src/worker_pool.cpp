@@ -0,0 +1,258 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "worker_pool.h"
+#include "output.h"
+#include "system.h"
+
+#ifdef SUPPORT_THREADS
+#  include <algorithm>
+#  include <atomic>
+#  include <condition_variable>
+#  include <deque>
+#  include <memory>
+#  include <mutex>
+#  include <thread>
+#  include <vector>
+
+namespace {
+	constexpr unsigned max_workers = 4;
+
+	struct Job {
+		std::function<void()> work;
+		std::function<void()> done;
+		bool finished = false;
+	};
+
+	struct Pool {
+		std::vector<std::thread> threads;
+		std::mutex mutex;
+		/** Signaled when a job is queued or the pool shuts down */
+		std::condition_variable work_cv;
+		/** Signaled when the last running job finished */
+		std::condition_variable idle_cv;
+		/** Jobs not picked up by a worker yet */
+		std::deque<std::shared_ptr<Job>> queue;
+		/** All jobs whose done callback wasn't invoked yet, in submission order */
+		std::deque<std::shared_ptr<Job>> jobs;
+		int running = 0;
+		bool quit = false;
+	};
+
+	// Heap allocated: Output::Error calls exit() and joinable threads must not be destructed
+	Pool* pool = nullptr;
+
+	void WorkerMain() {
+		Output::DeferThreadMessages();
+
+		std::unique_lock<std::mutex> lock(pool->mutex);
+		for (;;) {
+			pool->work_cv.wait(lock, [] { return pool->quit || !pool->queue.empty(); });
+			if (pool->quit) {
+				return;
+			}
+
+			auto job = std::move(pool->queue.front());
+			pool->queue.pop_front();
+			++pool->running;
+
+			lock.unlock();
+			job->work();
+			// Release resources captured by the job on the worker
+			job->work = nullptr;
+			lock.lock();
+
+			job->finished = true;
+			if (--pool->running == 0) {
+				pool->idle_cv.notify_all();
+			}
+		}
+	}
+}
+
+void WorkerPool::Init() {
+	if (pool) {
+		return;
+	}
+
+	unsigned num_workers = std::thread::hardware_concurrency();
+	// Leave one core for the main thread
+	num_workers = std::max(1u, std::min(max_workers, num_workers > 1 ? num_workers - 1 : 1u));
+
+	pool = new Pool();
+	for (unsigned i = 0; i < num_workers; ++i) {
+		pool->threads.emplace_back(WorkerMain);
+	}
+
+	Output::Debug("WorkerPool: Started {} worker threads", num_workers);
+}
+
+void WorkerPool::Quit() {
+	if (!pool) {
+		return;
+	}
+
+	Cancel();
+
+	{
+		std::lock_guard<std::mutex> lock(pool->mutex);
+		pool->quit = true;
+	}
+	pool->work_cv.notify_all();
+
+	for (auto& thread: pool->threads) {
+		thread.join();
+	}
+
+	delete pool;
+	pool = nullptr;
+}
+
+bool WorkerPool::IsEnabled() {
+	return pool != nullptr;
+}
+
+void WorkerPool::Submit(std::function<void()> work, std::function<void()> done) {
+	if (!pool) {
+		work();
+		done();
+		return;
+	}
+
+	auto job = std::make_shared<Job>();
+	job->work = std::move(work);
+	job->done = std::move(done);
+
+	{
+		std::lock_guard<std::mutex> lock(pool->mutex);
+		pool->queue.push_back(job);
+		pool->jobs.push_back(std::move(job));
+	}
+	pool->work_cv.notify_one();
+}
+
+void WorkerPool::Parallel(int count, const std::function<void(int)>& fn) {
+	if (!pool || count <= 1) {
+		for (int i = 0; i < count; ++i) {
+			fn(i);
+		}
+		return;
+	}
+
+	struct State {
+		std::atomic<int> next{0};
+		int finished = 0;
+		std::mutex mutex;
+		std::condition_variable cv;
+	};
+	auto state = std::make_shared<State>();
+
+	// Helpers that start after all indices were taken do not touch fn anymore
+	auto run = [state, count, &fn]() {
+		int done = 0;
+		for (int i = state->next++; i < count; i = state->next++) {
+			fn(i);
+			++done;
+		}
+		if (done > 0) {
+			std::lock_guard<std::mutex> lock(state->mutex);
+			state->finished += done;
+			if (state->finished == count) {
+				state->cv.notify_all();
+			}
+		}
+	};
+
+	{
+		std::lock_guard<std::mutex> lock(pool->mutex);
+		const int helpers = std::min(count - 1, static_cast<int>(pool->threads.size()));
+		for (int i = 0; i < helpers; ++i) {
+			// Not added to jobs, there is no done callback
+			auto job = std::make_shared<Job>();
+			job->work = run;
+			pool->queue.push_front(std::move(job));
+		}
+	}
+	pool->work_cv.notify_all();
+
+	run();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->cv.wait(lock, [&] { return state->finished == count; });
+}
+
+void WorkerPool::Update() {
+	if (!pool) {
+		return;
+	}
+
+	std::vector<std::function<void()>> finished;
+	{
+		std::lock_guard<std::mutex> lock(pool->mutex);
+		while (!pool->jobs.empty() && pool->jobs.front()->finished) {
+			finished.push_back(std::move(pool->jobs.front()->done));
+			pool->jobs.pop_front();
+		}
+	}
+
+	// Invoked without the lock, callbacks are allowed to submit new jobs
+	for (auto& done: finished) {
+		done();
+	}
+}
+
+void WorkerPool::Cancel() {
+	if (!pool) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(pool->mutex);
+	pool->queue.clear();
+	pool->idle_cv.wait(lock, [] { return pool->running == 0; });
+	pool->jobs.clear();
+}
+
+#else
+
+void WorkerPool::Init() {
+}
+
+void WorkerPool::Quit() {
+}
+
+bool WorkerPool::IsEnabled() {
+	return false;
+}
+
+void WorkerPool::Submit(std::function<void()> work, std::function<void()> done) {
+	work();
+	done();
+}
+
+void WorkerPool::Parallel(int count, const std::function<void(int)>& fn) {
+	for (int i = 0; i < count; ++i) {
+		fn(i);
+	}
+}
+
+void WorkerPool::Update() {
+}
+
+void WorkerPool::Cancel() {
+}
+
+#endif
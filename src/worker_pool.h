@@ -0,0 +1,71 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_WORKER_POOL_H
+#define EP_WORKER_POOL_H
+
+#include <functional>
+
+/**
+ * WorkerPool runs expensive jobs (e.g. image decoding) on background threads.
+ * The completion callbacks are invoked on the main thread by Update() in the
+ * order the jobs were submitted.
+ */
+namespace WorkerPool {
+	/** Starts the worker threads. Does nothing on platforms without thread support. */
+	void Init();
+
+	/** Cancels all jobs and stops the worker threads. */
+	void Quit();
+
+	/** @return whether jobs are executed by worker threads */
+	bool IsEnabled();
+
+	/**
+	 * Queues a job.
+	 * When the pool is not enabled both functions are invoked immediately.
+	 *
+	 * @param work executed on a worker thread, must not touch main thread state
+	 * @param done executed on the main thread after work finished
+	 */
+	void Submit(std::function<void()> work, std::function<void()> done);
+
+	/**
+	 * Invokes fn(0) ... fn(count - 1) in parallel on the worker threads and the
+	 * calling thread and returns when all invocations finished.
+	 * Runs ahead of queued jobs. When the pool is not enabled fn is invoked serially.
+	 *
+	 * @param count number of invocations
+	 * @param fn invoked with the index, must be safe to run concurrently
+	 */
+	void Parallel(int count, const std::function<void(int)>& fn);
+
+	/**
+	 * Invokes the done callbacks of all finished jobs.
+	 * A finished job waits for all jobs submitted before it to finish.
+	 * Must be called from the main thread.
+	 */
+	void Update();
+
+	/**
+	 * Discards all queued jobs and waits for running ones.
+	 * The done callbacks of discarded jobs are not invoked.
+	 */
+	void Cancel();
+}
+
+#endif
@@ -0,0 +1,142 @@
+#include "asset_prefetch.h"
+#include "doctest.h"
+#include <lcf/rpg/commonevent.h>
+#include <lcf/rpg/eventcommand.h>
+#include <lcf/rpg/map.h>
+
+TEST_SUITE_BEGIN("AssetPrefetch");
+
+namespace {
+using Cmd = lcf::rpg::EventCommand::Code;
+
+lcf::rpg::EventCommand MakeCommand(Cmd code, const char* str, std::vector<int32_t> params = {}) {
+	lcf::rpg::EventCommand com;
+	com.code = static_cast<int>(code);
+	com.string = lcf::DBString(std::string(str));
+	com.parameters = lcf::DBArray<int32_t>(params.begin(), params.end());
+	return com;
+}
+
+lcf::rpg::EventPage MakePage(int id, int trigger, std::vector<lcf::rpg::EventCommand> commands) {
+	lcf::rpg::EventPage page;
+	page.ID = id;
+	page.trigger = trigger;
+	page.event_commands = std::move(commands);
+	return page;
+}
+
+std::vector<std::string> Names(const std::vector<AssetPrefetch::Asset>& assets) {
+	std::vector<std::string> names;
+	for (auto& asset: assets) {
+		names.push_back(asset.directory + "/" + asset.name);
+	}
+	return names;
+}
+}
+
+TEST_CASE("Order") {
+	lcf::rpg::Map map;
+
+	map.events.resize(2);
+	map.events[0].ID = 1;
+	map.events[0].pages.push_back(MakePage(1, lcf::rpg::EventPage::Trigger_action, {
+		MakeCommand(Cmd::ShowPicture, "action"),
+		MakeCommand(Cmd::PlaySound, "se"),
+	}));
+	map.events[0].pages.back().character_name = lcf::DBString(std::string("hero"));
+
+	map.events[1].ID = 2;
+	map.events[1].pages.push_back(MakePage(1, lcf::rpg::EventPage::Trigger_auto_start, {
+		MakeCommand(Cmd::ShowPicture, "auto"),
+		MakeCommand(Cmd::CallEvent, "", {0, 1, 0}),
+		MakeCommand(Cmd::ShowPicture, "action"),
+	}));
+
+	std::vector<lcf::rpg::CommonEvent> common_events(1);
+	common_events[0].ID = 1;
+	common_events[0].trigger = lcf::rpg::CommonEvent::Trigger_call;
+	common_events[0].event_commands.push_back(MakeCommand(Cmd::PlayBGM, "called"));
+
+	auto names = Names(AssetPrefetch::Plan(map, common_events));
+	std::vector<std::string> expected = {
+		"CharSet/hero",
+		"Picture/auto",
+		"Music/called",
+		"Picture/action",
+		"Sound/se",
+	};
+	CHECK_EQ(names, expected);
+}
+
+TEST_CASE("UnreachablePages") {
+	lcf::rpg::Map map;
+
+	map.events.resize(1);
+	map.events[0].ID = 1;
+	map.events[0].pages.push_back(MakePage(1, lcf::rpg::EventPage::Trigger_action, {
+		MakeCommand(Cmd::ShowPicture, "page1"),
+	}));
+	map.events[0].pages.push_back(MakePage(2, lcf::rpg::EventPage::Trigger_action, {
+		MakeCommand(Cmd::ShowPicture, "page2"),
+	}));
+	map.events[0].pages.push_back(MakePage(3, lcf::rpg::EventPage::Trigger_action, {
+		MakeCommand(Cmd::ShowPicture, "page3"),
+		// Calls page 1 of the same event
+		MakeCommand(Cmd::CallEvent, "", {1, 10005, 1}),
+	}));
+	map.events[0].pages.back().condition.flags.switch_a = true;
+
+	// Page 2 has no conditions: Page 1 is only reachable through CallEvent
+	auto names = Names(AssetPrefetch::Plan(map, {}));
+	std::vector<std::string> expected = {
+		"Picture/page3",
+		"Picture/page1",
+		"Picture/page2",
+	};
+	CHECK_EQ(names, expected);
+}
+
+TEST_CASE("Duplicates") {
+	lcf::rpg::Map map;
+
+	map.events.resize(1);
+	map.events[0].ID = 1;
+	map.events[0].pages.push_back(MakePage(1, lcf::rpg::EventPage::Trigger_parallel, {
+		MakeCommand(Cmd::ShowPicture, "pic"),
+		MakeCommand(Cmd::ShowPicture, "pic"),
+		MakeCommand(Cmd::PlaySound, "(OFF)"),
+		MakeCommand(Cmd::PlaySound, ""),
+		MakeCommand(Cmd::ChangeSpriteAssociation, "pic", {1, 0, 0}),
+		// Recursion
+		MakeCommand(Cmd::CallEvent, "", {1, 1, 1}),
+	}));
+
+	auto names = Names(AssetPrefetch::Plan(map, {}));
+	std::vector<std::string> expected = {
+		"Picture/pic",
+		"CharSet/pic",
+	};
+	CHECK_EQ(names, expected);
+}
+
+TEST_CASE("PictureTransparency") {
+	lcf::rpg::Map map;
+
+	map.events.resize(1);
+	map.events[0].ID = 1;
+	map.events[0].pages.push_back(MakePage(1, lcf::rpg::EventPage::Trigger_parallel, {
+		MakeCommand(Cmd::ShowPicture, "pic", {1, 0, 0, 0, 0, 100, 0, 0}),
+		MakeCommand(Cmd::ShowPicture, "pic", {1, 0, 0, 0, 0, 100, 0, 1}),
+		MakeCommand(Cmd::ShowPicture, "pic", {2, 0, 0, 0, 0, 100, 0, 0}),
+	}));
+
+	// Prefetched with the transparency requested by Game_Pictures
+	auto assets = AssetPrefetch::Plan(map, {});
+	REQUIRE_EQ(assets.size(), 2);
+	CHECK_EQ(assets[0].name, "pic");
+	CHECK(!assets[0].transparent);
+	CHECK_EQ(assets[1].name, "pic");
+	CHECK(assets[1].transparent);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,115 @@
+#include <thread>
+#include "async_handler.h"
+#include "bitmap.h"
+#include "cache.h"
+#include "filefinder.h"
+#include "pixel_format.h"
+#include "worker_pool.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("AsyncHandler");
+
+namespace {
+struct TestGame {
+	TestGame() {
+		Bitmap::SetFormat(format_R8G8B8A8_a().format());
+		FileFinder::SetGameFilesystem(FileFinder::Root().Create(EP_TEST_PATH "/game"));
+		Cache::ClearAll();
+		WorkerPool::Init();
+	}
+
+	~TestGame() {
+		AsyncHandler::ClearRequests();
+		WorkerPool::Quit();
+		Cache::ClearAll();
+		FileFinder::SetGameFilesystem({});
+	}
+};
+}
+
+TEST_CASE("ImportantGraphicIsSynchronous") {
+	TestGame game;
+
+	bool done = false;
+	auto* request = AsyncHandler::RequestFile("CharSet", "chara1");
+	request->SetGraphicFile(true);
+	request->SetImportantFile(true);
+	auto binding = request->Bind([&done](FileRequestResult*) { done = true; });
+	request->Start();
+
+	// Finishes in the same frame independent of the decoding time
+	CHECK(done);
+	CHECK(!AsyncHandler::IsImportantFilePending());
+}
+
+TEST_CASE("GraphicIsDecodedInBackground") {
+	TestGame game;
+	if (!WorkerPool::IsEnabled()) {
+		return;
+	}
+
+	bool done = false;
+	auto* request = AsyncHandler::RequestFile("CharSet", "chara1");
+	request->SetGraphicFile(true);
+	auto binding = request->Bind([&done](FileRequestResult*) { done = true; });
+	request->Start();
+
+	CHECK(!done);
+	CHECK(AsyncHandler::IsGraphicFilePending());
+
+	while (!done) {
+		WorkerPool::Update();
+		std::this_thread::yield();
+	}
+	CHECK(!AsyncHandler::IsGraphicFilePending());
+}
+
+TEST_CASE("MadeImportantWhileDecoding") {
+	TestGame game;
+	if (!WorkerPool::IsEnabled()) {
+		return;
+	}
+
+	int done = 0;
+	auto* request = AsyncHandler::RequestFile("CharSet", "chara1");
+	request->SetGraphicFile(true);
+	auto binding = request->Bind([&done](FileRequestResult*) { ++done; });
+	request->Start();
+	REQUIRE(!request->IsReady());
+
+	// e.g. ShowPicture with a pending Picture request: Finishes in the same frame
+	request->SetImportantFile(true);
+	CHECK(request->IsReady());
+	CHECK_EQ(done, 1);
+	CHECK(!AsyncHandler::IsImportantFilePending());
+
+	// The decoding job finishes later and does not invoke the listener again
+	while (Cache::GetStats().entries == 0) {
+		WorkerPool::Update();
+		std::this_thread::yield();
+	}
+	CHECK_EQ(done, 1);
+}
+
+TEST_CASE("ClearRequestsWhileDecoding") {
+	TestGame game;
+	if (!WorkerPool::IsEnabled()) {
+		return;
+	}
+
+	bool done = false;
+	auto* request = AsyncHandler::RequestFile("CharSet", "chara1");
+	request->SetGraphicFile(true);
+	auto binding = request->Bind([&done](FileRequestResult*) { done = true; });
+	request->Start();
+
+	// Switching the game: The request is gone and the decoded image is not cached
+	AsyncHandler::ClearRequests();
+	Cache::ClearAll();
+	WorkerPool::Update();
+
+	CHECK(!done);
+	CHECK_EQ(Cache::GetStats().entries, 0);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,124 @@
+#include <cstdint>
+#include <vector>
+#include "audio_mixer.h"
+#include "doctest.h"
+
+using Format = AudioDecoderBase::Format;
+
+TEST_SUITE_BEGIN("AudioMixer");
+
+TEST_CASE("ToFloat") {
+	// Odd sizes cover the vectorized and the remaining samples
+	constexpr int n = 37;
+	std::vector<float> out(n);
+
+	std::vector<int8_t> s8(n);
+	std::vector<uint8_t> u8(n);
+	std::vector<int16_t> s16(n);
+	std::vector<uint16_t> u16(n);
+	std::vector<int32_t> s32(n);
+	std::vector<uint32_t> u32(n);
+	std::vector<float> f32(n);
+	for (int i = 0; i < n; ++i) {
+		s8[i] = static_cast<int8_t>(i * 7 - 128);
+		u8[i] = static_cast<uint8_t>(i * 7);
+		s16[i] = static_cast<int16_t>(i * 1771 - 32768);
+		u16[i] = static_cast<uint16_t>(i * 1771);
+		s32[i] = static_cast<int32_t>(i * 116000000LL - 2147483648LL);
+		u32[i] = static_cast<uint32_t>(i * 116000000u);
+		f32[i] = i / 37.0f - 0.5f;
+	}
+
+	AudioMixer::ToFloat(s8.data(), Format::S8, n, out.data());
+	for (int i = 0; i < n; ++i) {
+		REQUIRE_EQ(out[i], doctest::Approx(s8[i] / 128.0));
+	}
+
+	AudioMixer::ToFloat(u8.data(), Format::U8, n, out.data());
+	for (int i = 0; i < n; ++i) {
+		REQUIRE_EQ(out[i], doctest::Approx(u8[i] / 128.0 - 1.0));
+	}
+
+	AudioMixer::ToFloat(s16.data(), Format::S16, n, out.data());
+	for (int i = 0; i < n; ++i) {
+		REQUIRE_EQ(out[i], doctest::Approx(s16[i] / 32768.0));
+	}
+
+	AudioMixer::ToFloat(u16.data(), Format::U16, n, out.data());
+	for (int i = 0; i < n; ++i) {
+		REQUIRE_EQ(out[i], doctest::Approx(u16[i] / 32768.0 - 1.0));
+	}
+
+	AudioMixer::ToFloat(s32.data(), Format::S32, n, out.data());
+	for (int i = 0; i < n; ++i) {
+		REQUIRE_EQ(out[i], doctest::Approx(s32[i] / 2147483648.0));
+	}
+
+	AudioMixer::ToFloat(u32.data(), Format::U32, n, out.data());
+	for (int i = 0; i < n; ++i) {
+		REQUIRE_EQ(out[i], doctest::Approx(u32[i] / 2147483648.0 - 1.0));
+	}
+
+	AudioMixer::ToFloat(f32.data(), Format::F32, n, out.data());
+	CHECK_EQ(out, f32);
+}
+
+TEST_CASE("AccumulateStereo") {
+	constexpr int frames = 11;
+	std::vector<float> src(frames * 2);
+	for (int i = 0; i < frames; ++i) {
+		src[i * 2] = 0.5f;
+		src[i * 2 + 1] = -0.25f;
+	}
+
+	std::vector<float> mix(frames * 2, 0.125f);
+	AudioMixer::Accumulate(mix.data(), src.data(), 2, frames, 1.0f, 1.0f);
+	for (int i = 0; i < frames; ++i) {
+		REQUIRE_EQ(mix[i * 2], doctest::Approx(0.625f));
+		REQUIRE_EQ(mix[i * 2 + 1], doctest::Approx(-0.125f));
+	}
+}
+
+TEST_CASE("AccumulateMono") {
+	constexpr int frames = 13;
+	std::vector<float> src(frames);
+	for (int i = 0; i < frames; ++i) {
+		src[i] = i / 16.0f;
+	}
+
+	// Added to both sides
+	std::vector<float> mix(frames * 2, 0.0f);
+	AudioMixer::Accumulate(mix.data(), src.data(), 1, frames, 0.5f, 0.5f);
+	for (int i = 0; i < frames; ++i) {
+		REQUIRE_EQ(mix[i * 2], doctest::Approx(src[i] * 0.5f));
+		REQUIRE_EQ(mix[i * 2 + 1], doctest::Approx(src[i] * 0.5f));
+	}
+}
+
+TEST_CASE("AccumulateRamp") {
+	constexpr int frames = 10;
+	std::vector<float> src(frames * 2, 1.0f);
+	std::vector<float> mix(frames * 2, 0.0f);
+
+	AudioMixer::Accumulate(mix.data(), src.data(), 2, frames, 0.0f, 1.0f);
+	for (int i = 0; i < frames; ++i) {
+		REQUIRE_EQ(mix[i * 2], doctest::Approx(i / 10.0));
+		REQUIRE_EQ(mix[i * 2 + 1], doctest::Approx(i / 10.0));
+	}
+}
+
+TEST_CASE("ToS16") {
+	std::vector<float> mix = { 0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 2.0f, -2.0f, 0.25f, -0.25f };
+	std::vector<int16_t> out(mix.size());
+
+	AudioMixer::ToS16(mix.data(), static_cast<int>(mix.size()), 1.0f, out.data());
+	std::vector<int16_t> expected = { 0, 16384, -16384, 32767, -32768, 32767, -32768, 8192, -8192 };
+	CHECK_EQ(out, expected);
+
+	// Samples above 0.8 are compressed, total volume maps to 1
+	AudioMixer::ToS16(mix.data(), static_cast<int>(mix.size()), 2.0f, out.data());
+	expected = { 0, 16384, -16384, 27306, -27306, 32767, -32768, 8192, -8192 };
+	CHECK_EQ(out, expected);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,48 @@
+#include <vector>
+#include "benchmark_mode.h"
+#include "doctest.h"
+
+namespace {
+std::vector<Game_Clock::duration> MakeSamples(int n) {
+	std::vector<Game_Clock::duration> samples;
+	// n, n-1, ..., 1 milliseconds
+	for (int i = n; i > 0; --i) {
+		samples.push_back(std::chrono::milliseconds(i));
+	}
+	return samples;
+}
+}
+
+TEST_SUITE_BEGIN("BenchmarkMode");
+
+TEST_CASE("Empty") {
+	std::vector<Game_Clock::duration> samples;
+	auto stats = BenchmarkMode::CalculateStats(samples);
+	CHECK_EQ(stats.min.count(), 0);
+	CHECK_EQ(stats.max.count(), 0);
+}
+
+TEST_CASE("Single") {
+	auto samples = MakeSamples(1);
+	auto stats = BenchmarkMode::CalculateStats(samples);
+	CHECK(stats.min == std::chrono::milliseconds(1));
+	CHECK(stats.median == std::chrono::milliseconds(1));
+	CHECK(stats.p99 == std::chrono::milliseconds(1));
+	CHECK(stats.max == std::chrono::milliseconds(1));
+}
+
+TEST_CASE("Percentiles") {
+	auto samples = MakeSamples(1000);
+	auto stats = BenchmarkMode::CalculateStats(samples);
+	CHECK(stats.min == std::chrono::milliseconds(1));
+	CHECK(stats.median == std::chrono::milliseconds(500));
+	CHECK(stats.p99 == std::chrono::milliseconds(990));
+	CHECK(stats.max == std::chrono::milliseconds(1000));
+
+	samples = MakeSamples(10);
+	stats = BenchmarkMode::CalculateStats(samples);
+	CHECK(stats.median == std::chrono::milliseconds(5));
+	CHECK(stats.p99 == std::chrono::milliseconds(10));
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,294 @@
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "bitmap.h"
+#include "bitmap_kernels.h"
+#include "pixel_format.h"
+#include "doctest.h"
+
+using BitmapKernels::Level;
+
+namespace {
+constexpr Level vector_levels[] = { Level::SSE2, Level::AVX2 };
+
+// Runs the kernel with the scalar implementation and with level on a copy of pixels
+template <typename F>
+void CheckSameAsScalar(Level level, std::vector<uint32_t> pixels, F&& kernel) {
+	auto expected = pixels;
+	REQUIRE(BitmapKernels::SetLevel(Level::Scalar));
+	kernel(expected);
+
+	REQUIRE(BitmapKernels::SetLevel(level));
+	kernel(pixels);
+
+	auto mismatch = std::mismatch(pixels.begin(), pixels.end(), expected.begin());
+	if (mismatch.first != pixels.end()) {
+		INFO("pixel ", mismatch.first - pixels.begin());
+		REQUIRE_EQ(*mismatch.first, *mismatch.second);
+	}
+}
+
+struct RestoreLevel {
+	Level level = BitmapKernels::GetLevel();
+	~RestoreLevel() { BitmapKernels::SetLevel(level); }
+};
+
+struct RestoreBlit {
+	bool enabled = BitmapKernels::IsBlitEnabled();
+	~RestoreBlit() { BitmapKernels::SetBlitEnabled(enabled); }
+};
+
+// Per channel reference of the pixman operators
+uint32_t Div255(uint32_t x) {
+	x += 0x80;
+	return (x + (x >> 8)) >> 8;
+}
+
+uint32_t ReferenceBlit(BitmapKernels::BlitOp op, uint32_t s, uint32_t d, int alpha_shift, int opacity) {
+	using BlitOp = BitmapKernels::BlitOp;
+	if (op == BlitOp::Copy) {
+		return s;
+	}
+	if (op == BlitOp::OverOpacity) {
+		uint32_t m = 0;
+		for (int shift = 0; shift < 32; shift += 8) {
+			m |= Div255(((s >> shift) & 0xFF) * opacity) << shift;
+		}
+		s = m;
+	}
+	const uint32_t ia = 255 - ((s >> alpha_shift) & 0xFF);
+	uint32_t res = 0;
+	for (int shift = 0; shift < 32; shift += 8) {
+		res |= std::min<uint32_t>(255, Div255(((d >> shift) & 0xFF) * ia) + ((s >> shift) & 0xFF)) << shift;
+	}
+	return res;
+}
+
+void FillRandom(Bitmap& bitmap, std::mt19937& rng) {
+	auto* pixels = reinterpret_cast<uint8_t*>(bitmap.pixels());
+	for (int y = 0; y < bitmap.height(); ++y) {
+		auto* row = reinterpret_cast<uint32_t*>(pixels + y * bitmap.pitch());
+		for (int x = 0; x < bitmap.width(); ++x) {
+			row[x] = rng();
+		}
+	}
+}
+}
+
+TEST_SUITE_BEGIN("BitmapKernels");
+
+TEST_CASE("ToneRow") {
+	RestoreLevel restore;
+	std::mt19937 rng(1234);
+	const int shifts[][4] = { {24, 16, 8, 0}, {0, 8, 16, 24}, {16, 8, 0, 24}, {8, 16, 24, 0} };
+
+	for (auto level: vector_levels) {
+		if (!BitmapKernels::IsSupported(level)) {
+			continue;
+		}
+		INFO(BitmapKernels::GetName(level));
+
+		for (int i = 0; i < 2000; ++i) {
+			BitmapKernels::ToneParams p;
+			const auto& s = shifts[rng() % 4];
+			p.rs = s[0];
+			p.gs = s[1];
+			p.bs = s[2];
+			p.as = s[3];
+			int gray = rng() % 256;
+			p.saturation = gray > 128 ? 1024 + (gray - 128) * 16 : gray * 8;
+			p.apply_saturation = rng() % 2;
+			p.apply_tone = rng() % 2;
+			p.red = rng() % 256;
+			p.green = rng() % 256;
+			// 128 maps 255 to 256 before clamping
+			p.blue = rng() % 4 == 0 ? 128 : rng() % 256;
+			p.skip_transparent = rng() % 2;
+			p.premultiplied = rng() % 2;
+
+			// Odd sizes cover the scalar tail
+			std::vector<uint32_t> pixels(rng() % 200);
+			for (auto& px: pixels) {
+				px = rng();
+				if (rng() % 4 == 0) {
+					px &= ~(0xFFu << p.as);
+				} else if (rng() % 4 == 0) {
+					px |= 0xFFu << p.bs;
+				}
+			}
+
+			CheckSameAsScalar(level, std::move(pixels), [&](std::vector<uint32_t>& px) {
+				BitmapKernels::ToneRow(px.data(), static_cast<int>(px.size()), p);
+			});
+		}
+	}
+}
+
+TEST_CASE("ToneRowAllTones") {
+	RestoreLevel restore;
+
+	// Every tone applied to every channel value
+	std::vector<uint32_t> pixels(256 * 256);
+	for (uint32_t i = 0; i < pixels.size(); ++i) {
+		uint32_t c = i & 0xFF;
+		pixels[i] = (c << 24) | (c << 16) | (c << 8) | (i >> 8);
+	}
+
+	for (auto level: vector_levels) {
+		if (!BitmapKernels::IsSupported(level)) {
+			continue;
+		}
+		INFO(BitmapKernels::GetName(level));
+
+		for (int tone = 0; tone < 256; ++tone) {
+			BitmapKernels::ToneParams p;
+			p.rs = 24;
+			p.gs = 16;
+			p.bs = 8;
+			p.as = 0;
+			p.apply_saturation = true;
+			p.saturation = tone > 128 ? 1024 + (tone - 128) * 16 : tone * 8;
+			p.apply_tone = true;
+			p.red = tone;
+			p.green = 255 - tone;
+			p.blue = tone;
+			p.premultiplied = tone % 2;
+
+			CheckSameAsScalar(level, pixels, [&](std::vector<uint32_t>& px) {
+				BitmapKernels::ToneRow(px.data(), static_cast<int>(px.size()), p);
+			});
+		}
+	}
+}
+
+TEST_CASE("HueRow") {
+	RestoreLevel restore;
+	std::mt19937 rng(4321);
+
+	// All colors with a coarse step, all orderings of equal channels are included
+	std::vector<uint32_t> pixels;
+	for (int r = 0; r < 256; r += 5) {
+		for (int g = 0; g < 256; g += 3) {
+			for (int b = 0; b < 256; b += 1) {
+				uint32_t a = rng() % 8 == 0 ? 0 : rng() % 256;
+				pixels.push_back((r << 24) | (g << 16) | (b << 8) | a);
+			}
+		}
+	}
+	// Odd size covers the scalar tail
+	pixels.push_back(0x102030FF);
+
+	for (auto level: vector_levels) {
+		if (!BitmapKernels::IsSupported(level)) {
+			continue;
+		}
+		INFO(BitmapKernels::GetName(level));
+
+		for (int hue: { 0, 1, 0x80, 0x100, 0x2AB, 0x5FF, 0x600 }) {
+			CheckSameAsScalar(level, pixels, [&](std::vector<uint32_t>& px) {
+				BitmapKernels::HueRow(px.data(), static_cast<int>(px.size()), hue);
+			});
+		}
+	}
+}
+
+TEST_CASE("BlitRect") {
+	using BlitOp = BitmapKernels::BlitOp;
+	std::mt19937 rng(5678);
+
+	constexpr int w = 37;
+	constexpr int h = 5;
+	std::vector<uint32_t> src(w * h);
+	std::vector<uint32_t> dst(w * h);
+
+	for (auto op: { BlitOp::Copy, BlitOp::Over1Bit, BlitOp::Over, BlitOp::OverOpacity }) {
+		for (int alpha_shift: { 0, 24 }) {
+			for (int i = 0; i < 200; ++i) {
+				for (auto& px: src) {
+					px = rng();
+					// Mostly alpha 0 and 255 like the images Over1Bit is used for
+					switch (rng() % 4) {
+						case 0:
+							px &= ~(0xFFu << alpha_shift);
+							break;
+						case 1:
+							px |= 0xFFu << alpha_shift;
+							break;
+						case 2:
+							px = 0;
+							break;
+					}
+				}
+				for (auto& px: dst) {
+					px = rng();
+				}
+				const int opacity = rng() % 256;
+
+				auto expected = dst;
+				// Blits 30x3 pixels at (4, 1) from (2, 2)
+				for (int y = 0; y < 3; ++y) {
+					for (int x = 0; x < 30; ++x) {
+						auto& d = expected[(y + 1) * w + x + 4];
+						d = ReferenceBlit(op, src[(y + 2) * w + x + 2], d, alpha_shift, opacity);
+					}
+				}
+
+				BitmapKernels::BlitRect(op, &dst[w + 4], w * 4, &src[2 * w + 2], w * 4, 30, 3, alpha_shift, opacity);
+
+				auto mismatch = std::mismatch(dst.begin(), dst.end(), expected.begin());
+				if (mismatch.first != dst.end()) {
+					INFO("op ", static_cast<int>(op), " shift ", alpha_shift, " pixel ", mismatch.first - dst.begin());
+					REQUIRE_EQ(*mismatch.first, *mismatch.second);
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("BlitSameAsPixman") {
+	RestoreBlit restore;
+	std::mt19937 rng(8765);
+
+	for (auto format: { format_R8G8B8A8_a().format(), format_A8R8G8B8_a().format() }) {
+		Bitmap::SetFormat(format);
+		auto src = Bitmap::Create(24, 32, true);
+		auto dst = Bitmap::Create(64, 48, true);
+		auto dst_pixman = Bitmap::Create(64, 48, true);
+
+		for (int i = 0; i < 100; ++i) {
+			FillRandom(*src, rng);
+			FillRandom(*dst, rng);
+			dst_pixman->BlitFast(0, 0, *dst, dst->GetRect(), Opacity::Opaque());
+
+			const int x = static_cast<int>(rng() % 96) - 32;
+			const int y = static_cast<int>(rng() % 80) - 32;
+			const Rect src_rect(rng() % 8, rng() % 8, 1 + rng() % 16, 1 + rng() % 24);
+			const Opacity opacity(rng() % 2 ? 255 : 1 + rng() % 254);
+			const bool fast = rng() % 2;
+			const bool clip = rng() % 2;
+
+			std::vector<Rect> clip_rects;
+			if (clip) {
+				clip_rects = { Rect(0, 0, 20, 20), Rect(30, 10, 20, 30) };
+			}
+
+			for (auto& bitmap: { dst, dst_pixman }) {
+				BitmapKernels::SetBlitEnabled(bitmap == dst);
+				bitmap->SetClipRects(clip_rects);
+				if (fast) {
+					bitmap->BlitFast(x, y, *src, src_rect, opacity);
+				} else {
+					bitmap->Blit(x, y, *src, src_rect, opacity);
+				}
+				bitmap->SetClipRects({});
+			}
+
+			INFO("format ", format.a.shift, " x ", x, " y ", y, " fast ", fast, " clip ", clip, " opacity ", opacity.Value());
+			const auto size = static_cast<size_t>(dst->pitch()) * dst->height();
+			REQUIRE(std::memcmp(dst->pixels(), dst_pixman->pixels(), size) == 0);
+		}
+	}
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,89 @@
+#include <thread>
+#include "cache.h"
+#include "bitmap.h"
+#include "filefinder.h"
+#include "pixel_format.h"
+#include "worker_pool.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("Cache");
+
+namespace {
+struct TestGame {
+	TestGame() {
+		Bitmap::SetFormat(format_R8G8B8A8_a().format());
+		FileFinder::SetGameFilesystem(FileFinder::Root().Create(EP_TEST_PATH "/game"));
+		Cache::ClearAll();
+		WorkerPool::Init();
+	}
+
+	~TestGame() {
+		WorkerPool::Quit();
+		Cache::ClearAll();
+		FileFinder::SetGameFilesystem({});
+	}
+};
+
+void WaitFor(const bool& done) {
+	while (!done) {
+		WorkerPool::Update();
+		std::this_thread::yield();
+	}
+}
+}
+
+TEST_CASE("LoadBitmapAsync") {
+	TestGame game;
+	if (!WorkerPool::IsEnabled()) {
+		return;
+	}
+
+	bool done = false;
+	BitmapRef loaded;
+	REQUIRE(Cache::LoadBitmapAsync("CharSet", "chara1", [&](BitmapRef bmp) {
+		loaded = bmp;
+		done = true;
+	}));
+	WaitFor(done);
+
+	REQUIRE(loaded);
+	CHECK_EQ(Cache::GetStats().entries, 1);
+
+	// Cached now, nothing to decode
+	CHECK(!Cache::LoadBitmapAsync("CharSet", "chara1", [](BitmapRef) {}));
+	CHECK_EQ(Cache::Charset("chara1"), loaded);
+}
+
+TEST_CASE("ClearWhileDecoding") {
+	TestGame game;
+	if (!WorkerPool::IsEnabled()) {
+		return;
+	}
+
+	bool done = false;
+	BitmapRef loaded;
+	REQUIRE(Cache::LoadBitmapAsync("CharSet", "chara1", [&](BitmapRef bmp) {
+		loaded = bmp;
+		done = true;
+	}));
+
+	// E.g. switching to another game, the image belongs to the old one
+	Cache::Clear();
+	WaitFor(done);
+
+	CHECK(!loaded);
+	CHECK_EQ(Cache::GetStats().entries, 0);
+
+	// A new request decodes the image again
+	done = false;
+	REQUIRE(Cache::LoadBitmapAsync("CharSet", "chara1", [&](BitmapRef bmp) {
+		loaded = bmp;
+		done = true;
+	}));
+	WaitFor(done);
+
+	CHECK(loaded);
+	CHECK_EQ(Cache::GetStats().entries, 1);
+}
+
+TEST_SUITE_END();
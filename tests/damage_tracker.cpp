@@ -0,0 +1,186 @@
+#include "damage_tracker.h"
+#include "bitmap.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("DamageTracker");
+
+namespace {
+const Rect screen(0, 0, 320, 240);
+
+int a, b, c;
+
+std::vector<Rect> Update(DamageTracker& tracker, const std::vector<DamageTracker::Entry>& entries, uint64_t key = 0) {
+	return tracker.Update(key, screen, entries);
+}
+}
+
+TEST_CASE("FirstFrameIsFull") {
+	DamageTracker tracker;
+
+	auto damage = Update(tracker, {{ &a, Rect(10, 10, 20, 20), 1 }});
+	REQUIRE_EQ(damage.size(), 1u);
+	REQUIRE_EQ(damage[0], screen);
+}
+
+TEST_CASE("Unchanged") {
+	DamageTracker tracker;
+	std::vector<DamageTracker::Entry> entries = {{ &a, Rect(10, 10, 20, 20), 1 }, { &b, Rect(50, 50, 20, 20), 2 }};
+
+	Update(tracker, entries);
+	REQUIRE(Update(tracker, entries).empty());
+	REQUIRE(tracker.GetDamageBounds().IsEmpty());
+}
+
+TEST_CASE("Changed") {
+	DamageTracker tracker;
+
+	Update(tracker, {{ &a, Rect(10, 10, 20, 20), 1 }, { &b, Rect(100, 100, 20, 20), 2 }});
+
+	auto damage = Update(tracker, {{ &a, Rect(10, 10, 20, 20), 3 }, { &b, Rect(100, 100, 20, 20), 2 }});
+	REQUIRE_EQ(damage.size(), 1u);
+	REQUIRE_EQ(damage[0], Rect(10, 10, 20, 20));
+}
+
+TEST_CASE("Moved") {
+	DamageTracker tracker;
+
+	Update(tracker, {{ &a, Rect(10, 10, 20, 20), 1 }});
+
+	auto damage = Update(tracker, {{ &a, Rect(200, 100, 20, 20), 1 }});
+	REQUIRE_EQ(damage.size(), 2u);
+	REQUIRE_EQ(DamageTracker::GetArea(damage), 800);
+	REQUIRE_EQ(tracker.GetDamageBounds(), Rect(10, 10, 210, 110));
+
+	// Overlapping movement results in one rect
+	damage = Update(tracker, {{ &a, Rect(202, 100, 20, 20), 1 }});
+	REQUIRE_EQ(damage.size(), 1u);
+	REQUIRE_EQ(damage[0], Rect(200, 100, 22, 20));
+}
+
+TEST_CASE("AddedAndRemoved") {
+	DamageTracker tracker;
+
+	Update(tracker, {{ &a, Rect(10, 10, 20, 20), 1 }});
+
+	auto damage = Update(tracker, {{ &a, Rect(10, 10, 20, 20), 1 }, { &b, Rect(100, 100, 10, 10), 1 }});
+	REQUIRE_EQ(damage.size(), 1u);
+	REQUIRE_EQ(damage[0], Rect(100, 100, 10, 10));
+
+	damage = Update(tracker, {{ &b, Rect(100, 100, 10, 10), 1 }});
+	REQUIRE_EQ(damage.size(), 1u);
+	REQUIRE_EQ(damage[0], Rect(10, 10, 20, 20));
+}
+
+TEST_CASE("ClippedToScreen") {
+	DamageTracker tracker;
+
+	Update(tracker, {});
+
+	auto damage = Update(tracker, {{ &a, Rect(300, -10, 40, 20), 1 }, { &b, Rect(400, 10, 10, 10), 1 }});
+	REQUIRE_EQ(damage.size(), 1u);
+	REQUIRE_EQ(damage[0], Rect(300, 0, 20, 10));
+}
+
+TEST_CASE("KeyChangeIsFull") {
+	DamageTracker tracker;
+	std::vector<DamageTracker::Entry> entries = {{ &a, Rect(10, 10, 20, 20), 1 }};
+
+	Update(tracker, entries, 1);
+	auto damage = Update(tracker, entries, 2);
+	REQUIRE_EQ(damage.size(), 1u);
+	REQUIRE_EQ(damage[0], screen);
+
+	REQUIRE(Update(tracker, entries, 2).empty());
+
+	tracker.Invalidate();
+	damage = Update(tracker, entries, 2);
+	REQUIRE_EQ(damage.size(), 1u);
+	REQUIRE_EQ(damage[0], screen);
+}
+
+TEST_CASE("RectLimit") {
+	DamageTracker tracker;
+	std::vector<int> ids(20);
+	std::vector<DamageTracker::Entry> entries;
+
+	Update(tracker, {});
+
+	for (int i = 0; i < 20; ++i) {
+		entries.push_back({ &ids[i], Rect(i * 16, (i % 2) * 100, 8, 8), 1 });
+	}
+	auto damage = Update(tracker, entries);
+	REQUIRE_LE(damage.size(), DamageTracker::max_rects);
+	REQUIRE_EQ(tracker.GetDamageBounds(), Rect(0, 0, 19 * 16 + 8, 108));
+
+	// Every entry is still covered
+	for (auto& entry : entries) {
+		bool covered = false;
+		for (auto& rect : damage) {
+			Rect r = entry.bounds;
+			r.Adjust(rect);
+			covered |= r == entry.bounds;
+		}
+		REQUIRE(covered);
+	}
+}
+
+TEST_CASE("Area") {
+	REQUIRE_EQ(DamageTracker::GetArea({}), 0);
+	REQUIRE_EQ(DamageTracker::GetArea({ Rect(0, 0, 10, 10) }), 100);
+	REQUIRE_EQ(DamageTracker::GetArea({ Rect(0, 0, 10, 10), Rect(5, 5, 10, 10) }), 175);
+	REQUIRE_EQ(DamageTracker::GetArea({ Rect(0, 0, 10, 10), Rect(2, 2, 2, 2) }), 100);
+	REQUIRE_EQ(DamageTracker::GetArea({ Rect(0, 0, 10, 10), Rect(20, 20, 0, 5) }), 100);
+}
+
+TEST_CASE("RedrawRatio") {
+	DamageTracker tracker;
+	std::vector<DamageTracker::Entry> entries = {{ &c, Rect(0, 0, 10, 10), 1 }};
+
+	Update(tracker, entries);
+	REQUIRE_EQ(tracker.GetRedrawRatio(), doctest::Approx(1.0));
+
+	for (int i = 0; i < 600; ++i) {
+		Update(tracker, entries);
+	}
+	REQUIRE_LT(tracker.GetRedrawRatio(), 0.01);
+}
+
+TEST_CASE("HashBitmapRevision") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	auto bitmap = Bitmap::Create(4, 4, true);
+
+	const auto hash = DrawHash().Add(bitmap).Get();
+	REQUIRE_EQ(DrawHash().Add(bitmap).Get(), hash);
+
+	bitmap->Fill(Color(255, 0, 0, 255));
+	REQUIRE_NE(DrawHash().Add(bitmap).Get(), hash);
+
+	REQUIRE_NE(DrawHash().Add(1).Add(2).Get(), DrawHash().Add(2).Add(1).Get());
+}
+
+TEST_CASE("ClipRects") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	Bitmap bitmap(8, 8, true);
+	bitmap.Fill(Color(255, 255, 255, 255));
+
+	auto pixel = [&](int x, int y) {
+		auto* pixels = static_cast<const uint32_t*>(static_cast<const Bitmap&>(bitmap).pixels());
+		return pixels[y * bitmap.pitch() / 4 + x];
+	};
+	const uint32_t white = pixel(0, 0);
+
+	bitmap.SetClipRects({ Rect(0, 0, 2, 2), Rect(1, 1, 2, 2) });
+	bitmap.Clear();
+	bitmap.ToneBlit(0, 0, bitmap, bitmap.GetRect(), Tone(0, 0, 0, 128), Opacity::Opaque());
+	bitmap.SetClipRects({});
+
+	REQUIRE_EQ(pixel(0, 0), 0);
+	REQUIRE_EQ(pixel(2, 2), 0);
+	REQUIRE_EQ(pixel(3, 3), white);
+	REQUIRE_EQ(pixel(7, 0), white);
+
+	bitmap.Clear();
+	REQUIRE_EQ(pixel(7, 7), 0);
+}
+
+TEST_SUITE_END();
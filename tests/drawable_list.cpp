@@ -1,9 +1,26 @@
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
 #include "utils.h"
+#include "background.h"
+#include "cache.h"
 #include "drawable_list.h"
 #include "drawable_mgr.h"
 #include "bitmap.h"
+#include "game_screen.h"
+#include "graphics.h"
+#include "main_data.h"
+#include "map_data.h"
+#include "mock_game.h"
+#include "pixel_format.h"
+#include "screen.h"
+#include "sprite.h"
+#include "tilemap_layer.h"
+#include "window.h"
+#include "worker_pool.h"
 #include "doctest.h"
 
 TEST_SUITE_BEGIN("DrawableList");
@@ -22,6 +39,21 @@ class TestFrame : public Drawable {
 		void Draw(Bitmap&) override {}
 };
 
+class TestLogSprite : public Drawable {
+	public:
+		TestLogSprite(Drawable::Z_t z, std::string name, bool banded, std::vector<std::string>& log)
+			: Drawable(z, Drawable::Flags::Global), name(std::move(name)), banded(banded), log(log) {}
+		void Draw(Bitmap&) override { log.push_back(name); }
+		bool PrepareDraw(const Bitmap&) override { return banded; }
+		void DrawClipped(Bitmap&, const Rect& clip) const override {
+			log.push_back(name + std::to_string(clip.y));
+		}
+	private:
+		std::string name;
+		bool banded = false;
+		std::vector<std::string>& log;
+};
+
 }
 
 TEST_CASE("Default") {
@@ -350,4 +382,168 @@ TEST_CASE("TakeFromPred") {
 	REQUIRE(list2.IsDirty());
 }
 
+TEST_CASE("DrawBands") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	Bitmap bitmap(16, 16, false);
+
+	std::vector<DrawableList::Band> bands = {
+		{ Bitmap::Create(16, 16, false), Rect(0, 0, 16, 8) },
+		{ Bitmap::Create(16, 16, false), Rect(0, 8, 16, 8) }
+	};
+
+	std::vector<std::string> log;
+	TestLogSprite s1(1, "a", true, log);
+	TestLogSprite s2(2, "b", true, log);
+	TestLogSprite s3(3, "c", false, log);
+	TestLogSprite s4(4, "d", true, log);
+
+	DrawableList list;
+	list.Append(&s4);
+	list.Append(&s3);
+	list.Append(&s2);
+	list.Append(&s1);
+
+	// Without worker threads the bands are drawn in order
+	list.Draw(bitmap, 0, 3, bands);
+	REQUIRE_EQ(log, std::vector<std::string>{ "a0", "b0", "a8", "b8", "c" });
+
+	log.clear();
+	list.Draw(bitmap, 2, 4, bands);
+	REQUIRE_EQ(log, std::vector<std::string>{ "b0", "b8", "c", "d0", "d8" });
+}
+
+namespace {
+// A map scene with one drawable of every type that supports bands
+struct TestScene {
+	MockGame game { MockMap::ePass40x30 };
+	DrawableList list;
+	std::unique_ptr<Background> background;
+	std::unique_ptr<TilemapLayer> tilemap;
+	std::vector<std::unique_ptr<Sprite>> sprites;
+	std::unique_ptr<Window> window;
+	std::unique_ptr<Screen> screen;
+
+	TestScene() {
+		Bitmap::SetFormat(format_R8G8B8A8_a().format());
+		DrawableMgr::SetLocalList(&list);
+		Cache::ClearAll();
+
+		background = std::make_unique<Background>(CACHE_DEFAULT_BITMAP);
+
+		auto chipset = Bitmap::Create(480, 256);
+		chipset->Fill(Color(100, 150, 200, 255));
+		chipset->FillRect(Rect(18 * TILE_SIZE + 4, 8 * TILE_SIZE + 4, 8, 8), Color(20, 40, 60, 128));
+		chipset->CheckPixels(Bitmap::Flag_Chipset);
+
+		std::vector<short> map_data(40 * 30, BLOCK_F);
+		for (int i = 0; i < 40 * 30; i += 7) {
+			map_data[i] = BLOCK_F + 1;
+		}
+		tilemap = std::make_unique<TilemapLayer>(1);
+		tilemap->SetChipset(chipset);
+		tilemap->SetWidth(40);
+		tilemap->SetHeight(30);
+		tilemap->SetPassable(std::vector<unsigned char>(162, 0));
+		tilemap->SetMapData(map_data);
+		tilemap->SetOx(5 * TILE_SIZE + 3);
+		tilemap->SetOy(2 * TILE_SIZE + 7);
+
+		auto sprite_bitmap = Bitmap::Create(64, 48, true);
+		for (int y = 0; y < 48; y += 4) {
+			sprite_bitmap->FillRect(Rect(y, y, 64 - y, 4), Color(y * 5, 255 - y * 5, 80, 255 - y * 2));
+		}
+
+		// Each sprite crosses a band border and takes another blit path
+		auto add_sprite = [&](int x, int y) {
+			sprites.push_back(std::make_unique<Sprite>());
+			auto& sprite = *sprites.back();
+			sprite.SetBitmap(sprite_bitmap);
+			sprite.SetX(x);
+			sprite.SetY(y);
+			sprite.SetZ(Priority_Player);
+			return &sprite;
+		};
+		add_sprite(10, 100);
+		add_sprite(90, 50)->SetOpacity(160, 80);
+		auto* s = add_sprite(170, 60);
+		s->SetZoomX(1.5);
+		s->SetZoomY(2.0);
+		s->SetAngle(0.7);
+		s = add_sprite(250, 120);
+		s->SetTone(Tone(200, 100, 50, 80));
+		s->SetBushDepth(12);
+		s = add_sprite(40, 160);
+		s->SetWaverDepth(3);
+		s->SetWaverPhase(1.0);
+		s->SetFlipY(true);
+
+		auto contents = Bitmap::Create(200, 80, true);
+		contents->FillRect(Rect(10, 10, 150, 40), Color(255, 255, 0, 200));
+		window = std::make_unique<Window>();
+		window->SetWindowskin(Cache::System(CACHE_DEFAULT_BITMAP));
+		window->SetContents(contents);
+		window->SetX(40);
+		window->SetY(130);
+		window->SetWidth(232);
+		window->SetHeight(104);
+		window->SetCursorRect(Rect(0, 16, 100, 16));
+		window->SetBackOpacity(160);
+		window->SetDownArrow(true);
+		window->SetZ(Priority_Window);
+
+		screen = std::make_unique<Screen>();
+		Main_Data::game_screen->FlashOnce(31, 10, 0, 12, 60);
+	}
+
+	~TestScene() {
+		screen.reset();
+		window.reset();
+		sprites.clear();
+		tilemap.reset();
+		background.reset();
+		Cache::ClearAll();
+		DrawableMgr::SetLocalList(nullptr);
+	}
+
+	BitmapRef Draw(int num_bands) {
+		auto dst = Bitmap::Create(SCREEN_TARGET_WIDTH, SCREEN_TARGET_HEIGHT, Color(0, 0, 0, 255));
+		if (num_bands == 1) {
+			list.Draw(*dst);
+		} else {
+			list.Draw(*dst, std::numeric_limits<Drawable::Z_t>::min(), std::numeric_limits<Drawable::Z_t>::max(),
+				Graphics::CreateBands(*dst, num_bands));
+		}
+		return dst;
+	}
+};
+
+bool SamePixels(const Bitmap& a, const Bitmap& b) {
+	return std::memcmp(a.pixels(), b.pixels(), a.height() * a.pitch()) == 0;
+}
+}
+
+TEST_CASE("DrawBandsSameAsUnbanded") {
+	TestScene scene;
+	auto expected = scene.Draw(1);
+
+	// The scene is not empty
+	REQUIRE_FALSE(SamePixels(*expected, *Bitmap::Create(SCREEN_TARGET_WIDTH, SCREEN_TARGET_HEIGHT, Color(0, 0, 0, 255))));
+
+	SUBCASE("sequential") {
+		for (int num_bands: { 2, 3, 7, 16 }) {
+			INFO("bands: ", num_bands);
+			REQUIRE(SamePixels(*scene.Draw(num_bands), *expected));
+		}
+	}
+
+	SUBCASE("parallel") {
+		WorkerPool::Init();
+		for (int num_bands: { 2, 3, 7, 16 }) {
+			INFO("bands: ", num_bands);
+			REQUIRE(SamePixels(*scene.Draw(num_bands), *expected));
+		}
+		WorkerPool::Quit();
+	}
+}
+
 TEST_SUITE_END();
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "event_command_list.h"
+#include "doctest.h"
+
+using Cmd = lcf::rpg::EventCommand::Code;
+
+namespace {
+lcf::rpg::EventCommand MakeCommand(Cmd code, int indent, int param = 0) {
+	lcf::rpg::EventCommand com;
+	com.code = static_cast<int32_t>(code);
+	com.indent = indent;
+	com.parameters = lcf::DBArray<int32_t>({ param });
+	return com;
+}
+
+// The linear searches of Game_Interpreter before the jump table
+
+int ScanNext(const std::vector<lcf::rpg::EventCommand>& list, int index, std::initializer_list<Cmd> codes, int indent) {
+	for (++index; index < static_cast<int>(list.size()); ++index) {
+		const auto& com = list[index];
+		if (com.indent > indent) {
+			continue;
+		}
+		if (std::find(codes.begin(), codes.end(), static_cast<Cmd>(com.code)) != codes.end()) {
+			break;
+		}
+	}
+	return index;
+}
+
+int ScanLoopStart(const std::vector<lcf::rpg::EventCommand>& list, int index) {
+	const int indent = list[index].indent;
+	for (int idx = index; idx >= 0; idx--) {
+		if (list[idx].indent > indent)
+			continue;
+		if (list[idx].indent < indent)
+			return -1;
+		if (static_cast<Cmd>(list[idx].code) != Cmd::Loop)
+			continue;
+		return idx;
+	}
+	return index;
+}
+
+int ScanNextEndLoop(const std::vector<lcf::rpg::EventCommand>& list, int index) {
+	for (++index; index < static_cast<int>(list.size()); ++index) {
+		if (static_cast<Cmd>(list[index].code) == Cmd::EndLoop) {
+			break;
+		}
+	}
+	return index;
+}
+
+int ScanLabel(const std::vector<lcf::rpg::EventCommand>& list, int label_id) {
+	for (int idx = 0; idx < static_cast<int>(list.size()); ++idx) {
+		if (static_cast<Cmd>(list[idx].code) == Cmd::Label && list[idx].parameters[0] == label_id) {
+			return idx;
+		}
+	}
+	return -1;
+}
+}
+
+TEST_SUITE_BEGIN("EventCommandList");
+
+TEST_CASE("Empty") {
+	EventCommandList list;
+	CHECK(list.empty());
+	CHECK_EQ(list.FindLabel(1), -1);
+}
+
+TEST_CASE("NestedBranches") {
+	std::vector<lcf::rpg::EventCommand> commands = {
+		MakeCommand(Cmd::ConditionalBranch, 0),
+		MakeCommand(Cmd::ConditionalBranch, 1),
+		MakeCommand(Cmd::Comment, 2),
+		MakeCommand(Cmd::ElseBranch, 1),
+		MakeCommand(Cmd::Comment, 2),
+		MakeCommand(Cmd::EndBranch, 1),
+		MakeCommand(Cmd::Comment, 1),
+		MakeCommand(Cmd::ElseBranch, 0),
+		MakeCommand(Cmd::Comment, 1),
+		MakeCommand(Cmd::EndBranch, 0),
+		MakeCommand(Cmd::Comment, 0)
+	};
+	EventCommandList list(commands);
+
+	CHECK_EQ(list.FindNext(0, { Cmd::ElseBranch, Cmd::EndBranch }, 0), 7);
+	CHECK_EQ(list.FindNext(1, { Cmd::ElseBranch, Cmd::EndBranch }, 1), 3);
+	CHECK_EQ(list.FindNext(3, { Cmd::EndBranch }, 1), 5);
+	CHECK_EQ(list.FindNext(7, { Cmd::EndBranch }, 0), 9);
+	CHECK_EQ(list.FindNext(0, { Cmd::EndLoop }, 0), 11);
+}
+
+TEST_CASE("Loops") {
+	std::vector<lcf::rpg::EventCommand> commands = {
+		MakeCommand(Cmd::EndLoop, 0),
+		MakeCommand(Cmd::Loop, 0),
+		MakeCommand(Cmd::Loop, 1),
+		MakeCommand(Cmd::BreakLoop, 2),
+		MakeCommand(Cmd::EndLoop, 1),
+		MakeCommand(Cmd::EndLoop, 0),
+		MakeCommand(Cmd::ConditionalBranch, 0),
+		MakeCommand(Cmd::EndLoop, 1),
+		MakeCommand(Cmd::EndBranch, 0)
+	};
+	EventCommandList list(commands);
+
+	CHECK_EQ(list.FindLoopStart(0), 0);
+	CHECK_EQ(list.FindLoopStart(4), 2);
+	CHECK_EQ(list.FindLoopStart(5), 1);
+	CHECK_EQ(list.FindLoopStart(7), -1);
+	CHECK_EQ(list.FindNextEndLoop(3), 4);
+	CHECK_EQ(list.FindNextEndLoop(7), 9);
+}
+
+TEST_CASE("Labels") {
+	std::vector<lcf::rpg::EventCommand> commands = {
+		MakeCommand(Cmd::Label, 0, 3),
+		MakeCommand(Cmd::Label, 0, 1),
+		MakeCommand(Cmd::JumpToLabel, 0, 1),
+		MakeCommand(Cmd::Label, 1, 3),
+	};
+	EventCommandList list(commands);
+
+	CHECK_EQ(list.FindLabel(1), 1);
+	CHECK_EQ(list.FindLabel(3), 0);
+	CHECK_EQ(list.FindLabel(2), -1);
+}
+
+TEST_CASE("SameAsScan") {
+	std::mt19937 rng(42);
+	const Cmd codes[] = { Cmd::Comment, Cmd::ConditionalBranch, Cmd::ElseBranch, Cmd::EndBranch,
+		Cmd::Loop, Cmd::EndLoop, Cmd::BreakLoop, Cmd::Label, Cmd::ShowChoiceOption, Cmd::ShowChoiceEnd };
+
+	for (int iter = 0; iter < 200; ++iter) {
+		// Random indentation walk, includes malformed scripts
+		std::vector<lcf::rpg::EventCommand> commands;
+		int indent = 0;
+		const int n = rng() % 100;
+		for (int i = 0; i < n; ++i) {
+			indent = std::max(0, indent + static_cast<int>(rng() % 5) - 2);
+			commands.push_back(MakeCommand(codes[rng() % 10], indent, rng() % 8));
+		}
+		EventCommandList list(commands);
+
+		for (int i = 0; i < n; ++i) {
+			INFO("iteration ", iter, " index ", i);
+			const int indent = commands[i].indent;
+			REQUIRE_EQ(list.FindNext(i, { Cmd::ElseBranch, Cmd::EndBranch }, indent), ScanNext(commands, i, { Cmd::ElseBranch, Cmd::EndBranch }, indent));
+			REQUIRE_EQ(list.FindNext(i, { Cmd::ShowChoiceOption, Cmd::ShowChoiceEnd }, indent), ScanNext(commands, i, { Cmd::ShowChoiceOption, Cmd::ShowChoiceEnd }, indent));
+			REQUIRE_EQ(list.FindNext(i, { Cmd::EndLoop }, indent - 1), ScanNext(commands, i, { Cmd::EndLoop }, indent - 1));
+			REQUIRE_EQ(list.FindNextEndLoop(i), ScanNextEndLoop(commands, i));
+			if (static_cast<Cmd>(commands[i].code) == Cmd::EndLoop) {
+				REQUIRE_EQ(list.FindLoopStart(i), ScanLoopStart(commands, i));
+			}
+		}
+		for (int label = 0; label < 8; ++label) {
+			REQUIRE_EQ(list.FindLabel(label), ScanLabel(commands, label));
+		}
+	}
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,74 @@
+#include <sstream>
+#include "event_profiler.h"
+#include "doctest.h"
+
+using namespace std::chrono_literals;
+
+TEST_SUITE_BEGIN("EventProfiler");
+
+TEST_CASE("Accumulate") {
+	EventProfiler::Reset();
+
+	const EventProfiler::Source ev = { 3, 5, 2 };
+	const EventProfiler::Source ce = { 0, 7, 0 };
+
+	EventProfiler::AddCommand(ev, 10110, 1ms);
+	EventProfiler::AddCommand(ev, 10110, 2ms);
+	EventProfiler::AddCommand(ce, 12010, 5ms);
+	EventProfiler::AddUpdate(ev, 4ms);
+	EventProfiler::AddLoopLimit(ev, 10110);
+
+	REQUIRE_EQ(EventProfiler::GetEntryCount(), 3);
+	auto entries = EventProfiler::GetEntries();
+
+	// Most expensive first
+	CHECK_EQ(entries[0].source.event_id, 7);
+	CHECK_EQ(entries[0].code, 12010);
+	CHECK(entries[0].time == 5ms);
+
+	CHECK_EQ(entries[1].code, EventProfiler::update_code);
+	CHECK_EQ(entries[1].count, 1);
+
+	CHECK_EQ(entries[2].source.map_id, 3);
+	CHECK_EQ(entries[2].source.page_id, 2);
+	CHECK_EQ(entries[2].count, 2);
+	CHECK(entries[2].time == 3ms);
+	CHECK_EQ(entries[2].loop_limit_hits, 1);
+
+	EventProfiler::Reset();
+	CHECK_EQ(EventProfiler::GetEntryCount(), 0);
+}
+
+TEST_CASE("Label") {
+	EventProfiler::Entry entry;
+	entry.source = { 3, 5, 2 };
+	entry.code = 10110;
+	CHECK_EQ(EventProfiler::GetLabel(entry), "M3:E5/2 #10110");
+
+	entry.code = EventProfiler::update_code;
+	CHECK_EQ(EventProfiler::GetLabel(entry), "M3:E5/2 Update");
+
+	entry.source = { 0, 7, 0 };
+	CHECK_EQ(EventProfiler::GetLabel(entry), "CE7 Update");
+
+	entry.source = {};
+	CHECK_EQ(EventProfiler::GetLabel(entry), "Other Update");
+}
+
+TEST_CASE("Csv") {
+	EventProfiler::Reset();
+	EventProfiler::AddCommand({ 1, 2, 1 }, 10110, 1500us);
+	EventProfiler::AddCommand({ 0, 4, 0 }, 11410, 250us);
+	EventProfiler::AddLoopLimit({ 0, 4, 0 }, 11410);
+
+	std::stringstream ss;
+	EventProfiler::WriteCsv(ss);
+	CHECK_EQ(ss.str(),
+		"map,event,page,command,count,time_us,loop_limit_hits\n"
+		"1,2,1,10110,1,1500.000,0\n"
+		"0,4,0,11410,1,250.000,1\n");
+
+	EventProfiler::Reset();
+}
+
+TEST_SUITE_END();
@@ -6,6 +6,21 @@
 
 #define ZIP_PATH EP_TEST_PATH "/filesystem/test.zip"
 #define ZIP_FOLDER_PATH EP_TEST_PATH "/filesystem/folder.zip"
+// "large" has 3 MiB + 1000 bytes, every 4 KiB block repeats the line "%07d\n" of the block number.
+// It is deflated with a block boundary every 64 KiB that is not byte aligned.
+#define ZIP_LARGE_PATH EP_TEST_PATH "/filesystem/large.zip"
+// Contains "text" and "folder/1kb", all sizes and offsets are stored in Zip64 records
+#define ZIP64_PATH EP_TEST_PATH "/filesystem/zip64.zip"
+
+namespace {
+constexpr int64_t large_size = 3 * 1024 * 1024 + 1000;
+
+char LargeByte(int64_t pos) {
+	std::string line = std::to_string(pos / 4096);
+	line = std::string(7 - line.size(), '0') + line + '\n';
+	return line[pos % line.size()];
+}
+}
 
 TEST_SUITE_BEGIN("Filesystem ZIP");
 
@@ -60,6 +75,124 @@ TEST_CASE("File reading") {
 	CHECK(line_out == "lo");
 }
 
+TEST_CASE("File seeking") {
+	auto fs = FileFinder::Root().Create(ZIP_PATH);
+	auto is = fs.OpenInputStream("1kb");
+	REQUIRE(is);
+
+	std::vector<char> data(1024);
+	CHECK(is.read(data.data(), data.size()).gcount() == 1024);
+	CHECK(is.get() == EOF);
+
+	is.clear();
+	is.seekg(-512, std::ios_base::end);
+	CHECK(is.tellg() == 512);
+
+	std::vector<char> second_half(512);
+	CHECK(is.read(second_half.data(), second_half.size()).gcount() == 512);
+	CHECK(std::equal(second_half.begin(), second_half.end(), data.begin() + 512));
+
+	is.seekg(100, std::ios_base::beg);
+	CHECK(is.get() == data[100]);
+}
+
+TEST_CASE("Large file reading") {
+	auto fs = FileFinder::Root().Create(ZIP_LARGE_PATH);
+	REQUIRE(fs.GetFilesize("large") == large_size);
+
+	auto is = fs.OpenInputStream("large");
+	REQUIRE(is);
+
+	std::vector<char> data(large_size);
+	CHECK(is.read(data.data(), data.size()).gcount() == large_size);
+	CHECK(is.get() == EOF);
+
+	bool same = true;
+	for (int64_t i = 0; i < large_size; ++i) {
+		same &= data[i] == LargeByte(i);
+	}
+	CHECK(same);
+}
+
+TEST_CASE("Large file seeking") {
+	auto fs = FileFinder::Root().Create(ZIP_LARGE_PATH);
+	auto is = fs.OpenInputStream("large");
+	REQUIRE(is);
+
+	// Forward, inflates up to there and records restart points every MiB
+	is.seekg(2500000, std::ios_base::beg);
+	CHECK(is.tellg() == 2500000);
+	CHECK(is.get() == LargeByte(2500000));
+
+	// Backwards across one and two restart points
+	is.seekg(1100000, std::ios_base::beg);
+	CHECK(is.get() == LargeByte(1100000));
+	is.seekg(10, std::ios_base::beg);
+	CHECK(is.get() == LargeByte(10));
+
+	// Forward again, resumes from a restart point
+	is.seekg(3000000, std::ios_base::beg);
+	CHECK(is.get() == LargeByte(3000000));
+
+	// Exactly on and right before a restart point
+	is.seekg(1024 * 1024, std::ios_base::beg);
+	CHECK(is.get() == LargeByte(1024 * 1024));
+	is.seekg(2 * 1024 * 1024 - 1, std::ios_base::beg);
+	CHECK(is.get() == LargeByte(2 * 1024 * 1024 - 1));
+
+	// Reads across a restart point
+	is.seekg(1024 * 1024 - 100, std::ios_base::beg);
+	std::vector<char> data(200);
+	CHECK(is.read(data.data(), data.size()).gcount() == 200);
+	bool same = true;
+	for (int i = 0; i < 200; ++i) {
+		same &= data[i] == LargeByte(1024 * 1024 - 100 + i);
+	}
+	CHECK(same);
+
+	// Past the end is clamped to the end
+	is.seekg(large_size + 500, std::ios_base::beg);
+	CHECK(is.tellg() == large_size);
+	CHECK(is.get() == EOF);
+
+	is.clear();
+	is.seekg(-1, std::ios_base::end);
+	CHECK(is.tellg() == large_size - 1);
+	CHECK(is.get() == LargeByte(large_size - 1));
+	CHECK(is.get() == EOF);
+
+	// Back to the start after reaching the end
+	is.clear();
+	is.seekg(0, std::ios_base::beg);
+	CHECK(is.get() == LargeByte(0));
+}
+
+TEST_CASE("Zip64") {
+	auto fs = FileFinder::Root().Create(ZIP64_PATH);
+	REQUIRE(fs);
+	CHECK(fs.IsDirectory("folder", false));
+	CHECK(fs.GetFilesize("text") == 12);
+	CHECK(fs.GetFilesize("folder/1kb") == 1024);
+
+	auto is = fs.OpenInputStream("text");
+	REQUIRE(is);
+	std::string line_out;
+	CHECK(Utils::ReadLine(is, line_out));
+	CHECK(line_out == "hello");
+	CHECK(Utils::ReadLine(is, line_out));
+	CHECK(line_out == "world");
+
+	auto is_deflate = fs.OpenInputStream("folder/1kb");
+	REQUIRE(is_deflate);
+	std::vector<char> data(1024);
+	CHECK(is_deflate.read(data.data(), data.size()).gcount() == 1024);
+	bool same = true;
+	for (int i = 0; i < 1024; ++i) {
+		same &= static_cast<uint8_t>(data[i]) == i % 256;
+	}
+	CHECK(same);
+}
+
 TEST_CASE("File IO error") {
 	auto fs = FileFinder::Root().Create(ZIP_PATH);
 	CHECK(!fs.OpenInputStream("game"));
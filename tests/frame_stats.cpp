@@ -0,0 +1,70 @@
+#include "frame_stats.h"
+#include "doctest.h"
+
+using namespace std::chrono_literals;
+
+TEST_SUITE_BEGIN("FrameStats");
+
+TEST_CASE("Phases") {
+	FrameStats::Reset();
+	CHECK_EQ(FrameStats::GetFrameCount(), 0);
+
+	FrameStats::AddTime(FrameStats::eInput, 1ms);
+	FrameStats::AddTime(FrameStats::eLogic, 2ms);
+	FrameStats::AddLogicStep();
+	FrameStats::AddTime(FrameStats::eLogic, 3ms);
+	FrameStats::AddLogicStep();
+	FrameStats::AddTime(FrameStats::eSleep, 4ms);
+	FrameStats::EndFrame();
+
+	FrameStats::AddTime(FrameStats::eDraw, 6ms);
+	FrameStats::EndFrame();
+
+	REQUIRE_EQ(FrameStats::GetFrameCount(), 2);
+
+	const auto& last = FrameStats::GetFrame(0);
+	CHECK(last.GetTotal() == 6ms);
+	CHECK_EQ(last.logic_steps, 0);
+
+	const auto& first = FrameStats::GetFrame(1);
+	CHECK(first.phases[FrameStats::eLogic] == 5ms);
+	CHECK_EQ(first.logic_steps, 2);
+	CHECK(first.GetTotal() == 10ms);
+}
+
+TEST_CASE("History") {
+	FrameStats::Reset();
+
+	for (int i = 1; i <= FrameStats::history_size + 10; ++i) {
+		FrameStats::AddTime(FrameStats::eLogic, std::chrono::milliseconds(i));
+		FrameStats::EndFrame();
+	}
+
+	REQUIRE_EQ(FrameStats::GetFrameCount(), FrameStats::history_size);
+	CHECK(FrameStats::GetFrame(0).GetTotal() == std::chrono::milliseconds(FrameStats::history_size + 10));
+	CHECK(FrameStats::GetFrame(FrameStats::history_size - 1).GetTotal() == 11ms);
+}
+
+TEST_CASE("Summary") {
+	FrameStats::Reset();
+	CHECK(FrameStats::GetSummary().max == 0ms);
+
+	// 1ms to 100ms
+	for (int i = 100; i >= 1; --i) {
+		FrameStats::AddTime(FrameStats::eDraw, std::chrono::milliseconds(i));
+		FrameStats::AddLogicStep();
+		FrameStats::EndFrame();
+	}
+
+	auto summary = FrameStats::GetSummary();
+	CHECK(summary.p50 == 50ms);
+	CHECK(summary.p95 == 95ms);
+	CHECK(summary.p99 == 99ms);
+	CHECK(summary.max == 100ms);
+	CHECK(summary.average.phases[FrameStats::eDraw] == 50500us);
+	CHECK_EQ(summary.average.logic_steps, 1);
+
+	FrameStats::Reset();
+}
+
+TEST_SUITE_END();
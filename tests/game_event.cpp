@@ -5,6 +5,8 @@
 #include "main_data.h"
 #include <climits>
 
+#include "mock_game.h"
+
 TEST_SUITE_BEGIN("Game_Event");
 
 TEST_CASE("IdName") {
@@ -28,4 +30,31 @@ TEST_CASE("IdName") {
 	}
 }
 
+TEST_CASE("EventsXYFollowPosition") {
+	const MockGame mg(MockMap::ePass40x30);
+
+	auto& ev = *MockGame::GetEvent(1);
+	ev.SetX(5);
+	ev.SetY(7);
+
+	std::vector<Game_Event*> events;
+	Game_Map::GetEventsXY(events, 5, 7);
+	REQUIRE_EQ(events.size(), 1);
+	REQUIRE_EQ(events[0], &ev);
+	REQUIRE_EQ(Game_Map::GetEventAt(5, 7, false), &ev);
+
+	ev.SetX(6);
+
+	events.clear();
+	Game_Map::GetEventsXY(events, 5, 7);
+	REQUIRE(events.empty());
+	REQUIRE_EQ(Game_Map::GetEventAt(5, 7, false), nullptr);
+	REQUIRE_EQ(Game_Map::GetEventAt(6, 7, false), &ev);
+
+	// Out of map positions are still found
+	ev.SetX(-3);
+	REQUIRE_EQ(Game_Map::GetEventAt(-3, 7, false), &ev);
+	REQUIRE_EQ(Game_Map::GetEventAt(6, 7, false), nullptr);
+}
+
 TEST_SUITE_END();
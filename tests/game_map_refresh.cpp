@@ -0,0 +1,141 @@
+#include "game_map.h"
+#include "game_event.h"
+#include "game_switches.h"
+#include "game_variables.h"
+#include "main_data.h"
+#include "doctest.h"
+
+#include "mock_game.h"
+
+TEST_SUITE_BEGIN("Game_Map_Refresh");
+
+namespace {
+lcf::rpg::EventPage MakePage(int id) {
+	lcf::rpg::EventPage page;
+	page.ID = id;
+	page.move_type = lcf::rpg::EventPage::MoveType_stationary;
+	return page;
+}
+
+// 1: Page 2 when switch 1 is on
+// 2: Page 2 when variable 1 >= 5
+// 3: Only page 1 when switch 2 is on
+void SetupMap() {
+	auto map = MakeMockMap(MockMap::ePass40x30);
+	map->events.clear();
+
+	for (int i = 1; i <= 3; ++i) {
+		map->events.push_back({});
+		map->events.back().ID = i;
+	}
+
+	auto& ev1 = map->events[0];
+	ev1.pages.push_back(MakePage(1));
+	ev1.pages.push_back(MakePage(2));
+	ev1.pages.back().condition.flags.switch_a = true;
+	ev1.pages.back().condition.switch_a_id = 1;
+
+	auto& ev2 = map->events[1];
+	ev2.pages.push_back(MakePage(1));
+	ev2.pages.push_back(MakePage(2));
+	ev2.pages.back().condition.flags.variable = true;
+	ev2.pages.back().condition.variable_id = 1;
+	ev2.pages.back().condition.variable_value = 5;
+	ev2.pages.back().condition.compare_operator = 1;
+
+	auto& ev3 = map->events[2];
+	ev3.pages.push_back(MakePage(1));
+	ev3.pages.back().condition.flags.switch_a = true;
+	ev3.pages.back().condition.switch_a_id = 2;
+
+	Game_Map::Setup(std::move(map));
+}
+
+int PageId(int event_id) {
+	auto* page = Game_Map::GetEvent(event_id)->GetActivePage();
+	return page ? page->ID : 0;
+}
+}
+
+TEST_CASE("FirstRefreshIsFull") {
+	const MockGame mg(MockMap::ePass40x30);
+	SetupMap();
+
+	Game_Map::Refresh();
+	REQUIRE_EQ(Game_Map::GetRefreshedEventCount(), 3);
+	REQUIRE_EQ(PageId(1), 1);
+	REQUIRE_EQ(PageId(2), 1);
+	REQUIRE_EQ(PageId(3), 0);
+}
+
+TEST_CASE("SwitchRefreshesDependentEvents") {
+	const MockGame mg(MockMap::ePass40x30);
+	SetupMap();
+	Game_Map::Refresh();
+
+	// Event 3 has no active page and is always refreshed
+	Game_Map::Refresh();
+	REQUIRE_EQ(Game_Map::GetRefreshedEventCount(), 1);
+
+	Main_Data::game_switches->Set(1, true);
+	Game_Map::Refresh();
+	REQUIRE_EQ(Game_Map::GetRefreshedEventCount(), 2);
+	REQUIRE_EQ(PageId(1), 2);
+	REQUIRE_EQ(PageId(2), 1);
+
+	// Not read by any page condition
+	Main_Data::game_switches->Set(5, true);
+	Game_Map::Refresh();
+	REQUIRE_EQ(Game_Map::GetRefreshedEventCount(), 1);
+
+	Main_Data::game_switches->Set(1, false);
+	Game_Map::Refresh();
+	REQUIRE_EQ(Game_Map::GetRefreshedEventCount(), 2);
+	REQUIRE_EQ(PageId(1), 1);
+}
+
+TEST_CASE("VariableRefreshesDependentEvents") {
+	const MockGame mg(MockMap::ePass40x30);
+	SetupMap();
+	Game_Map::Refresh();
+
+	Main_Data::game_variables->Set(1, 3);
+	Game_Map::Refresh();
+	REQUIRE_EQ(Game_Map::GetRefreshedEventCount(), 2);
+	REQUIRE_EQ(PageId(2), 1);
+
+	Main_Data::game_variables->Set(1, 5);
+	Game_Map::Refresh();
+	REQUIRE_EQ(Game_Map::GetRefreshedEventCount(), 2);
+	REQUIRE_EQ(PageId(1), 1);
+	REQUIRE_EQ(PageId(2), 2);
+
+	// Same value again
+	Main_Data::game_variables->Set(1, 5);
+	Game_Map::Refresh();
+	REQUIRE_EQ(Game_Map::GetRefreshedEventCount(), 1);
+}
+
+TEST_CASE("EventsWithoutPageAlwaysRefresh") {
+	const MockGame mg(MockMap::ePass40x30);
+	SetupMap();
+	Game_Map::Refresh();
+
+	// Refreshing an event without page resets its state, this must
+	// happen even when no value read by its conditions changed
+	auto* ev3 = Game_Map::GetEvent(3);
+	ev3->SetThrough(false);
+	Game_Map::Refresh();
+	REQUIRE(ev3->GetThrough());
+
+	Main_Data::game_switches->Set(2, true);
+	Game_Map::Refresh();
+	REQUIRE_EQ(Game_Map::GetRefreshedEventCount(), 1);
+	REQUIRE_EQ(PageId(3), 1);
+
+	// All events have a page now
+	Game_Map::Refresh();
+	REQUIRE_EQ(Game_Map::GetRefreshedEventCount(), 0);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,84 @@
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "instrumentation.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("Instrumentation");
+
+TEST_CASE("ScopeNotTracing") {
+	CHECK(!Instrumentation::IsTracing());
+	{
+		EP_INSTRUMENT_SCOPE("Ignored");
+	}
+
+	Instrumentation::StartTrace();
+	CHECK(Instrumentation::IsTracing());
+	std::stringstream ss;
+	Instrumentation::StopTrace(ss);
+	CHECK(!Instrumentation::IsTracing());
+	CHECK(ss.str().find("Ignored") == std::string::npos);
+}
+
+TEST_CASE("ChromeTrace") {
+	Instrumentation::StartTrace();
+	{
+		EP_INSTRUMENT_SCOPE("Outer");
+		EP_INSTRUMENT_SCOPE("Inner \"quoted\"", 42);
+	}
+	std::stringstream ss;
+	Instrumentation::StopTrace(ss);
+
+	const auto json = ss.str();
+	CHECK(json.find("{\"traceEvents\":[") == 0);
+	CHECK(json.find("\"name\":\"Outer\",\"ph\":\"X\"") != std::string::npos);
+	CHECK(json.find("\"name\":\"Inner \\\"quoted\\\"\",\"ph\":\"X\"") != std::string::npos);
+	CHECK(json.find("\"args\":{\"value\":42}") != std::string::npos);
+
+	// Records of the previous trace are discarded
+	Instrumentation::StartTrace();
+	std::stringstream ss2;
+	Instrumentation::StopTrace(ss2);
+	CHECK(ss2.str().find("Outer") == std::string::npos);
+}
+
+TEST_CASE("StopWhileRecording") {
+	std::atomic<bool> running = { true };
+	std::atomic<int> count = { 0 };
+
+	Instrumentation::StartTrace();
+	std::thread worker([&]() {
+		while (running) {
+			EP_INSTRUMENT_SCOPE("Worker", count.load());
+			++count;
+		}
+	});
+
+	// Wrap the ring buffer of the worker at least once
+	while (count < (1 << 17)) {
+		std::this_thread::yield();
+	}
+
+	std::stringstream ss;
+	Instrumentation::StopTrace(ss);
+
+	// Keeps recording after the trace stopped
+	const int stopped_at = count;
+	while (count < stopped_at + 1000) {
+		std::this_thread::yield();
+	}
+	running = false;
+	worker.join();
+
+	const auto json = ss.str();
+	CHECK(json.find("\"name\":\"Worker\"") != std::string::npos);
+	CHECK(json.rfind("\n],\"displayTimeUnit\":\"ms\"}\n") != std::string::npos);
+
+	std::stringstream ss2;
+	Instrumentation::StartTrace();
+	Instrumentation::StopTrace(ss2);
+	CHECK(ss2.str().find("Worker") == std::string::npos);
+}
+
+TEST_SUITE_END();
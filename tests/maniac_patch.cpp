@@ -0,0 +1,714 @@
+#include <limits>
+#include <random>
+#include <vector>
+#include "maniac_patch.h"
+#include "game_interpreter.h"
+#include "game_interpreter_control_variables.h"
+#include "game_switches.h"
+#include "game_variables.h"
+#include "main_data.h"
+#include "output.h"
+#include "rand.h"
+#include "utils.h"
+#include "test_mock_actor.h"
+#include "doctest.h"
+
+/*
+The tree walking evaluator that was used before the bytecode compiler,
+copied from the baseline ManiacPatch::ParseExpression. Only the lines
+marked with "Changed" differ, they trap on x86 otherwise.
+*/
+namespace Baseline {
+	enum class Op {
+		Null = 0,
+		U8,
+		U16,
+		S32,
+		UX8,
+		UX16,
+		SX32,
+		Var = 8,
+		Switch,
+		VarIndirect = 13,
+		SwitchIndirect,
+		Array = 19,
+		Negate = 24,
+		Not,
+		Flip,
+		AssignInplace = 34,
+		AddInplace,
+		SubInplace,
+		MulInplace,
+		DivInplace,
+		ModInplace,
+		BitOrInplace,
+		BitAndInplace,
+		BitXorInplace,
+		BitShiftLeftInplace,
+		BitShiftRightInplace,
+		Add = 48,
+		Sub,
+		Mul,
+		Div,
+		Mod,
+		BitOr,
+		BitAnd,
+		BitXor,
+		BitShiftLeft,
+		BitShiftRight,
+		Equal,
+		GreaterEqual,
+		LessEqual,
+		Greater,
+		Less,
+		NotEqual,
+		Or,
+		And,
+		Range,
+		Subscript,
+		Ternary = 72,
+		Function = 78
+	};
+
+	enum class Fn {
+		Rand = 0,
+		Item,
+		Event,
+		Actor,
+		Party,
+		Enemy,
+		Misc,
+		Pow,
+		Sqrt,
+		Sin,
+		Cos,
+		Atan2,
+		Min,
+		Max,
+		Abs,
+		Clamp,
+		Muldiv,
+		Divmul,
+		Between
+	};
+
+int process(std::vector<int32_t>::iterator& it, std::vector<int32_t>::iterator end, const Game_Interpreter& ip) {
+	int value = 0;
+	int imm = 0;
+	int imm2 = 0;
+	int imm3 = 0;
+
+	if (it == end) {
+		return 0;
+	}
+
+	auto op = static_cast<Op>(*it);
+	++it;
+
+	// When entering the switch it is on the first argument
+	switch (op) {
+		case Op::Null:
+			*it++;
+			return 0;
+		case Op::U8:
+		case Op::UX8:
+			value = *it++;
+			return value;
+		case Op::U16:
+		case Op::UX16:
+			imm = *it++;
+			if (it == end) {
+				return 0;
+			}
+			imm2 = *it++;
+			value = (imm2 << 8) + imm;
+			return value;
+		case Op::S32:
+		case Op::SX32:
+			imm = *it++;
+			if (it == end) {
+				return 0;
+			}
+			imm2 = *it++;
+			if (it == end) {
+				return 0;
+			}
+			imm3 = *it++;
+			if (it == end) {
+				return 0;
+			}
+			value = *it++;
+			value = (value << 24) + (imm3 << 16) + (imm2 << 8) + imm;
+			return value;
+		case Op::Var:
+			imm = process(it, end, ip);
+			return Main_Data::game_variables->Get(imm);
+		case Op::Switch:
+			imm = process(it, end, ip);
+			return Main_Data::game_switches->GetInt(imm);
+		case Op::VarIndirect:
+			imm = process(it, end, ip);
+			return Main_Data::game_variables->GetIndirect(imm);
+		case Op::SwitchIndirect:
+			imm = process(it, end, ip);
+			return Main_Data::game_switches->GetInt(Main_Data::game_variables->Get(imm));
+		case Op::Negate:
+			imm = process(it, end, ip);
+			return -imm;
+		case Op::Not:
+			imm = process(it, end, ip);
+			return !imm ? 0 : 1;
+		case Op::Flip:
+			imm = process(it, end, ip);
+			return ~imm;
+		case Op::Add:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			return static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(imm) + imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
+		case Op::Sub:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			return static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(imm) - imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
+		case Op::Mul:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			return static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(imm) * imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
+		case Op::Div:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			if (imm2 == 0) {
+				return imm;
+			}
+			// Changed: INT_MIN / -1 traps, the bytecode saturates
+			if (imm2 == -1) {
+				return static_cast<int32_t>(Utils::Clamp<int64_t>(-static_cast<int64_t>(imm), std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
+			}
+			return imm / imm2;
+		case Op::Mod:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			if (imm2 == 0) {
+				return imm;
+			}
+			// Changed: INT_MIN % -1 traps
+			if (imm2 == -1) {
+				return 0;
+			}
+			return imm % imm2;
+		case Op::BitOr:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			return imm | imm2;
+		case Op::BitAnd:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			return imm & imm2;
+		case Op::BitXor:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			return imm ^ imm2;
+		case Op::BitShiftLeft:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			return imm << imm2;
+		case Op::BitShiftRight:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			return imm >> imm2;
+		case Op::Equal:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			return imm == imm2 ? 1 : 0;
+		case Op::GreaterEqual:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			return imm >= imm2 ? 1 : 0;
+		case Op::LessEqual:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			return imm <= imm2 ? 1 : 0;
+		case Op::Greater:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			return imm > imm2 ? 1 : 0;
+		case Op::Less:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			return imm < imm2 ? 1 : 0;
+		case Op::NotEqual:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			return imm != imm2 ? 1 : 0;
+		case Op::Or:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			return !!imm || !!imm2 ? 1 : 0;
+		case Op::And:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			return !!imm && !!imm2 ? 1 : 0;
+		case Op::Ternary:
+			imm = process(it, end, ip);
+			imm2 = process(it, end, ip);
+			imm3 = process(it, end, ip);
+			return imm != 0 ? imm2 : imm3;
+		case Op::Function:
+			imm = *it++; // function
+			imm2 = *it++; // arguments
+
+			if ((imm2 & 0x80) != 0) {
+				// Argument count is 4 bytes, that mode is not supported
+				Output::Warning("Maniac: Expression func long args unsupported");
+				return 0;
+			}
+
+			switch (static_cast<Fn>(imm)) {
+				case Fn::Rand:
+					if (imm2 != 2) {
+						Output::Warning("Maniac: Expression rnd args {} != 2", imm2);
+						return 0;
+					}
+					imm3 = process(it, end, ip);
+					return ControlVariables::Random(process(it, end, ip), imm3);
+				case Fn::Item:
+					if (imm2 != 2) {
+						Output::Warning("Maniac: Expression item args {} != 2", imm2);
+						return 0;
+					}
+					imm3 = process(it, end, ip);
+					return ControlVariables::Item(process(it, end, ip), imm3);
+				case Fn::Event:
+					if (imm2 != 2) {
+						Output::Warning("Maniac: Expression event args {} != 2", imm2);
+						return 0;
+					}
+					imm3 = process(it, end, ip);
+					return ControlVariables::Event(process(it, end, ip), imm3, ip);
+				case Fn::Actor:
+					if (imm2 != 2) {
+						Output::Warning("Maniac: Expression actor args {} != 2", imm2);
+						return 0;
+					}
+					return ControlVariables::Actor(process(it, end, ip), imm3);
+				case Fn::Party:
+					if (imm2 != 2) {
+						Output::Warning("Maniac: Expression member args {} != 2", imm2);
+						return 0;
+					}
+					imm3 = process(it, end, ip);
+					return ControlVariables::Party(process(it, end, ip), imm3);
+				case Fn::Enemy:
+					if (imm2 != 2) {
+						Output::Warning("Maniac: Expression enemy args {} != 2", imm2);
+						return 0;
+					}
+					imm3 = process(it, end, ip);
+					return ControlVariables::Enemy(process(it, end, ip), imm3);
+					break;
+				case Fn::Misc:
+					if (imm2 != 1) {
+						Output::Warning("Maniac: Expression misc args {} != 1", imm2);
+						return 0;
+					}
+					return ControlVariables::Other(process(it, end, ip));
+				case Fn::Pow:
+					if (imm2 != 2) {
+						Output::Warning("Maniac: Expression pow args {} != 2", imm2);
+						return 0;
+					}
+					return ControlVariables::Pow(process(it, end, ip), process(it, end, ip));
+				case Fn::Sqrt:
+					if (imm2 != 2) {
+						Output::Warning("Maniac: Expression sqrt args {} != 2", imm2);
+						return 0;
+					}
+					return ControlVariables::Sqrt(process(it, end, ip), process(it, end, ip));
+				case Fn::Sin:
+					if (imm2 != 3) {
+						Output::Warning("Maniac: Expression sin args {} != 3", imm2);
+						return 0;
+					}
+					return ControlVariables::Sin(process(it, end, ip), process(it, end, ip), process(it, end, ip));
+				case Fn::Cos:
+					if (imm2 != 3) {
+						Output::Warning("Maniac: Expression cos args {} != 3", imm2);
+						return 0;
+					}
+					return ControlVariables::Cos(process(it, end, ip), process(it, end, ip), process(it, end, ip));
+				case Fn::Atan2:
+					if (imm2 != 3) {
+						Output::Warning("Maniac: Expression atan2 args {} != 3", imm2);
+						return 0;
+					}
+					return ControlVariables::Atan2(process(it, end, ip), process(it, end, ip), process(it, end, ip));
+				case Fn::Min:
+					if (imm2 != 2) {
+						Output::Warning("Maniac: Expression min args {} != 2", imm2);
+						return 0;
+					}
+					return ControlVariables::Min(process(it, end, ip), process(it, end, ip));
+				case Fn::Max:
+					if (imm2 != 2) {
+						Output::Warning("Maniac: Expression max args {} != 2", imm2);
+						return 0;
+					}
+					return ControlVariables::Max(process(it, end, ip), process(it, end, ip));
+				case Fn::Abs:
+					if (imm2 != 1) {
+						Output::Warning("Maniac: Expression abs args {} != 1", imm2);
+						return 0;
+					}
+					return ControlVariables::Abs(process(it, end, ip));
+				case Fn::Clamp:
+					if (imm2 != 3) {
+						Output::Warning("Maniac: Expression clamp args {} != 3", imm2);
+						return 0;
+					}
+					return ControlVariables::Clamp(process(it, end, ip), process(it, end, ip), process(it, end, ip));
+				case Fn::Muldiv:
+					if (imm2 != 3) {
+						Output::Warning("Maniac: Expression muldiv args {} != 3", imm2);
+						return 0;
+					}
+					return ControlVariables::Muldiv(process(it, end, ip), process(it, end, ip), process(it, end, ip));
+				case Fn::Divmul:
+					if (imm2 != 3) {
+						Output::Warning("Maniac: Expression divmul args {} != 3", imm2);
+						return 0;
+					}
+					return ControlVariables::Divmul(process(it, end, ip), process(it, end, ip), process(it, end, ip));
+				case Fn::Between:
+					if (imm2 != 3) {
+						Output::Warning("Maniac: Expression between args {} != 3", imm2);
+						return 0;
+					}
+					return ControlVariables::Between(process(it, end, ip), process(it, end, ip), process(it, end, ip));
+				default:
+					Output::Warning("Maniac: Expression Unknown Func {}", imm);
+					for (int i = 0; i < imm2; ++i) {
+						process(it, end, ip);
+					}
+					return 0;
+			}
+		default:
+			Output::Warning("Maniac: Expression contains unsupported operation {}", static_cast<int>(op));
+			return 0;
+	}
+}
+
+int32_t ParseExpression(Span<const int32_t> op_codes, const Game_Interpreter& interpreter) {
+	std::vector<int32_t> ops;
+	for (auto &o: op_codes) {
+		auto uo = static_cast<uint32_t>(o);
+		ops.push_back(static_cast<int32_t>(uo & 0x000000FF));
+		ops.push_back(static_cast<int32_t>((uo & 0x0000FF00) >> 8));
+		ops.push_back(static_cast<int32_t>((uo & 0x00FF0000) >> 16));
+		ops.push_back(static_cast<int32_t>((uo & 0xFF000000) >> 24));
+	}
+	// Changed: process reads past the end of truncated expressions.
+	// The padding makes these reads yield 0 instead of being undefined.
+	const auto size = ops.size();
+	ops.resize(size * 4 + 64, 0);
+	auto beg = ops.begin();
+	return process(beg, ops.begin() + size, interpreter);
+}
+}
+
+namespace {
+std::vector<int32_t> Pack(const std::vector<uint32_t>& bytes) {
+	std::vector<int32_t> op_codes((bytes.size() + 3) / 4);
+	for (size_t i = 0; i < bytes.size(); ++i) {
+		op_codes[i / 4] |= static_cast<int32_t>(bytes[i] << ((i % 4) * 8));
+	}
+	return op_codes;
+}
+
+int32_t Evaluate(const std::vector<int32_t>& op_codes, const Game_Interpreter& interpreter) {
+	auto expr = ManiacPatch::CompileExpression(Span<const int32_t>(op_codes.data(), op_codes.size()));
+	return ManiacPatch::EvaluateExpression(expr, interpreter);
+}
+
+int FirstOfThree(int a, int, int) {
+	return a;
+}
+
+// The baseline passes several process() calls as the arguments of one function.
+// GCC evaluates them right to left and the bytecode stores the arguments in that order.
+bool ArgumentsRightToLeft() {
+	int i = 0;
+	auto next = [&i]() { return i++; };
+	return FirstOfThree(next(), next(), next()) == 2;
+}
+
+// Generates the byte stream of a random expression
+class Generator {
+public:
+	Generator(uint32_t seed, bool multi_arg_functions) : rng(seed), multi_arg_functions(multi_arg_functions) {}
+
+	std::vector<int32_t> Make() {
+		bytes.clear();
+		if (rng() % 8 == 0) {
+			// Garbage
+			const int size = 1 + rng() % 32;
+			for (int i = 0; i < size; ++i) {
+				RandomByte();
+			}
+		} else {
+			Expr(0);
+		}
+
+		// Truncated expressions
+		if (rng() % 8 == 0 && !bytes.empty()) {
+			bytes.resize(rng() % bytes.size());
+		}
+
+		return Pack(bytes);
+	}
+
+private:
+	void Byte(uint32_t b) {
+		bytes.push_back(b & 0xFF);
+	}
+
+	// Operand bytes are parsed as operations when the stream gets out of
+	// sync, they must not start a function call that needs a map
+	void RandomByte() {
+		uint32_t b = rng() & 0xFF;
+		Byte(b == 78 ? 0 : b);
+	}
+
+	void Expr(int depth) {
+		const int leaf = depth > 6 ? 1 : 0;
+		switch (leaf ? rng() % 4 : rng() % 12) {
+			case 0:
+				// Small numbers are often used as ids
+				Byte(1);
+				Byte(rng() % 8);
+				break;
+			case 1:
+				Byte(2);
+				RandomByte();
+				RandomByte();
+				break;
+			case 2:
+				Byte(3);
+				for (int i = 0; i < 4; ++i) {
+					RandomByte();
+				}
+				break;
+			case 3:
+				Byte(0);
+				RandomByte();
+				break;
+			case 4: {
+				const uint32_t unary[] = { 8, 9, 13, 14, 24, 25, 26 };
+				Byte(unary[rng() % 7]);
+				Expr(depth + 1);
+				break;
+			}
+			case 5:
+			case 6:
+			case 7:
+				Byte(48 + rng() % 18);
+				Expr(depth + 1);
+				Expr(depth + 1);
+				break;
+			case 8:
+				Byte(72);
+				Expr(depth + 1);
+				Expr(depth + 1);
+				Expr(depth + 1);
+				break;
+			case 9: {
+				// Event (2) and Misc (6) need a map and are not generated
+				const int fns[] = { 0, 1, 3, 4, 5, 14, 25, 7, 8, 9, 10, 11, 12, 13, 15, 16, 17, 18 };
+				const int expected_args[] = { 2, 2, 2, 2, 2, 2, 1, 2, 2, 3, 3, 3, 2, 2, 1, 3, 3, 3, 3 };
+				// The first 7 functions pass at most one process() call to a function
+				int fn = fns[rng() % (multi_arg_functions ? 18 : 7)];
+				int args = fn < 19 ? expected_args[fn] : rng() % 3;
+				if (rng() % 16 == 0) {
+					args = rng() % 4;
+				} else if (rng() % 32 == 0) {
+					args |= 0x80;
+				}
+				Byte(78);
+				Byte(fn);
+				Byte(args);
+				for (int i = 0; i < (args & 0x7F); ++i) {
+					Expr(depth + 1);
+				}
+				break;
+			}
+			case 10: {
+				// Array, Range, Subscript, Inplace and unknown operations
+				const uint32_t unsupported[] = { 7, 19, 34, 40, 66, 67, 70, 99 };
+				Byte(unsupported[rng() % 8]);
+				Expr(depth + 1);
+				break;
+			}
+			case 11:
+				// Indirection through the variables
+				Byte(rng() % 2 ? 13 : 14);
+				Byte(8);
+				Byte(1);
+				Byte(rng() % 12);
+				break;
+		}
+	}
+
+	std::mt19937 rng;
+	bool multi_arg_functions;
+	std::vector<uint32_t> bytes;
+};
+
+struct GoldenExpression {
+	const char* name;
+	std::vector<uint32_t> bytes;
+	int32_t result;
+};
+
+// Results of the evaluator in Baseline built with GCC, checked on every compiler
+// V[1..11] = 5, -3, 100, 1, 0, 7, INT_MIN, INT_MAX, -1, 2, 3 and S[2] = ON
+const std::vector<GoldenExpression> golden_expressions = {
+	{ "u8", { 1, 200 }, 200 },
+	{ "u16", { 2, 52, 18 }, 4660 },
+	{ "s32", { 3, 254, 255, 255, 255 }, -2 },
+	{ "ux8", { 4, 7 }, 7 },
+	{ "ux16", { 5, 0, 1 }, 256 },
+	{ "sx32", { 6, 1, 0, 0, 128 }, -2147483647 },
+	{ "null", { 0, 5 }, 0 },
+	{ "var", { 8, 1, 3 }, 100 },
+	{ "var out of range", { 8, 1, 99 }, 0 },
+	{ "var indirect", { 13, 1, 4 }, 5 },
+	{ "switch", { 9, 1, 2 }, 1 },
+	{ "switch off", { 9, 1, 1 }, 0 },
+	{ "switch indirect", { 14, 1, 10 }, 1 },
+	{ "negate", { 24, 8, 1, 2 }, 3 },
+	{ "not zero", { 25, 1, 0 }, 0 },
+	{ "not", { 25, 1, 7 }, 1 },
+	{ "flip", { 26, 1, 5 }, -6 },
+	{ "add", { 48, 1, 5, 8, 1, 2 }, 2 },
+	{ "add saturated", { 48, 8, 1, 8, 1, 1 }, 2147483647 },
+	{ "sub", { 49, 1, 10, 1, 3 }, 7 },
+	{ "sub saturated", { 49, 8, 1, 7, 1, 1 }, -2147483648 },
+	{ "mul", { 50, 8, 1, 2, 1, 3 }, -9 },
+	{ "mul saturated", { 50, 8, 1, 8, 1, 2 }, 2147483647 },
+	{ "div", { 51, 1, 100, 1, 7 }, 14 },
+	{ "div zero", { 51, 1, 9, 1, 0 }, 9 },
+	{ "div negative", { 51, 8, 1, 2, 1, 2 }, -1 },
+	{ "mod", { 52, 1, 100, 1, 7 }, 2 },
+	{ "mod zero", { 52, 1, 9, 1, 0 }, 9 },
+	{ "mod negative", { 52, 8, 1, 2, 1, 2 }, -1 },
+	{ "bit or", { 53, 1, 12, 1, 10 }, 14 },
+	{ "bit and", { 54, 1, 12, 1, 10 }, 8 },
+	{ "bit xor", { 55, 1, 12, 1, 10 }, 6 },
+	{ "shift left", { 56, 1, 3, 1, 4 }, 48 },
+	{ "shift right", { 57, 8, 1, 2, 1, 1 }, -2 },
+	{ "equal", { 58, 1, 3, 8, 1, 4 }, 0 },
+	{ "greater equal", { 59, 1, 3, 1, 5 }, 0 },
+	{ "less equal", { 60, 1, 3, 1, 5 }, 1 },
+	{ "greater", { 61, 1, 5, 1, 3 }, 1 },
+	{ "less", { 62, 1, 5, 1, 3 }, 0 },
+	{ "not equal", { 63, 1, 5, 1, 3 }, 1 },
+	{ "or", { 64, 1, 0, 1, 9 }, 1 },
+	{ "or zero", { 64, 1, 0, 1, 0 }, 0 },
+	{ "and", { 65, 1, 3, 1, 9 }, 1 },
+	{ "and zero", { 65, 1, 3, 1, 0 }, 0 },
+	{ "ternary true", { 72, 8, 1, 1, 1, 4, 1, 9 }, 4 },
+	{ "ternary false", { 72, 1, 0, 1, 4, 1, 9 }, 9 },
+	{ "nested", { 48, 1, 5, 50, 8, 1, 1, 1, 3 }, 20 },
+	{ "pow", { 78, 7, 2, 1, 2, 1, 10 }, 100 },
+	{ "sqrt", { 78, 8, 2, 1, 100, 1, 3 }, 173 },
+	{ "sin", { 78, 9, 3, 1, 90, 1, 1, 1, 100 }, 88 },
+	{ "cos", { 78, 10, 3, 1, 60, 1, 2, 1, 100 }, 38 },
+	{ "atan2", { 78, 11, 3, 1, 1, 1, 100, 1, 10 }, 5 },
+	{ "min", { 78, 12, 2, 1, 4, 8, 1, 2 }, -3 },
+	{ "max", { 78, 13, 2, 1, 4, 8, 1, 2 }, 4 },
+	{ "abs", { 78, 14, 1, 8, 1, 2 }, 3 },
+	{ "clamp", { 78, 15, 3, 1, 3, 1, 5, 1, 10 }, 3 },
+	{ "muldiv", { 78, 16, 3, 1, 10, 1, 6, 1, 4 }, 2 },
+	{ "divmul", { 78, 17, 3, 1, 7, 1, 2, 1, 100 }, 350 },
+	{ "between", { 78, 18, 3, 1, 20, 1, 1, 1, 10 }, 0 },
+	{ "function in add", { 48, 78, 7, 2, 1, 2, 1, 3, 8, 1, 6 }, 16 },
+	{ "function of functions", { 78, 12, 2, 78, 16, 3, 1, 10, 1, 6, 1, 4, 78, 7, 2, 1, 2, 1, 3 }, 2 },
+	{ "unknown function", { 48, 78, 25, 2, 1, 1, 1, 2, 1, 5 }, 5 },
+	{ "wrong argument count", { 78, 7, 3, 1, 2, 1, 10, 1, 1 }, 0 },
+	{ "long argument count", { 78, 7, 130, 1, 2, 1, 10 }, 0 },
+	{ "array", { 19, 1, 5 }, 0 },
+	{ "range", { 66, 1, 1, 1, 5 }, 0 },
+	{ "subscript", { 67, 1, 1, 1, 5 }, 0 },
+	{ "inplace", { 34, 1, 1, 1, 5 }, 0 },
+	{ "unsupported operand", { 48, 1, 5, 19, 1, 5 }, 5 },
+};
+
+void SetupGame() {
+	std::vector<int32_t> vars = { 5, -3, 100, 1, 0, 7, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max(), -1, 2, 3 };
+	Main_Data::game_variables->SetData(vars);
+	Main_Data::game_variables->SetWarning(0);
+	Main_Data::game_switches->Set(2, true);
+	Main_Data::game_switches->SetWarning(0);
+}
+}
+
+TEST_SUITE_BEGIN("ManiacPatch");
+
+TEST_CASE("Expression") {
+	const MockBattle mb;
+	Game_Interpreter interpreter;
+
+	std::vector<int32_t> vars = { 5, -3, 100, 1, 0, 7 };
+	Main_Data::game_variables->SetData(vars);
+	Main_Data::game_variables->SetWarning(0);
+
+	// 5 + V[1] * 3: Add, U8 5, Mul, Var U8 1, U8 3
+	auto op_codes = Pack({ 48, 1, 5, 50, 8, 1, 1, 1, 3 });
+
+	auto expr = ManiacPatch::CompileExpression(Span<const int32_t>(op_codes.data(), op_codes.size()));
+	CHECK_EQ(ManiacPatch::EvaluateExpression(expr, interpreter), 20);
+
+	// The compiled expression reads the variables when it is evaluated
+	Main_Data::game_variables->Set(1, 10);
+	CHECK_EQ(ManiacPatch::EvaluateExpression(expr, interpreter), 35);
+
+	// Empty expressions are 0
+	CHECK_EQ(ManiacPatch::ParseExpression({}, interpreter), 0);
+}
+
+TEST_CASE("SameAsBaseline") {
+	const MockBattle mb;
+	Game_Interpreter interpreter;
+	SetupGame();
+
+	// Unsupported operations warn on every evaluation of the baseline
+	const auto log_level = Output::GetLogLevel();
+	Output::SetLogLevel(LogLevel::Error);
+
+	Generator gen(1234, ArgumentsRightToLeft());
+	for (int i = 0; i < 20000; ++i) {
+		auto op_codes = gen.Make();
+
+		Rand::SeedRandomNumberGenerator(i);
+		auto expected = Baseline::ParseExpression(Span<const int32_t>(op_codes.data(), op_codes.size()), interpreter);
+
+		Rand::SeedRandomNumberGenerator(i);
+		auto result = Evaluate(op_codes, interpreter);
+
+		INFO("expression ", i);
+		REQUIRE_EQ(result, expected);
+	}
+
+	Output::SetLogLevel(log_level);
+}
+
+TEST_CASE("GoldenResults") {
+	const MockBattle mb;
+	Game_Interpreter interpreter;
+	SetupGame();
+
+	for (const auto& golden: golden_expressions) {
+		INFO(golden.name);
+		CHECK_EQ(Evaluate(Pack(golden.bytes), interpreter), golden.result);
+	}
+}
+
+TEST_SUITE_END();
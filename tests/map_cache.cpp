@@ -0,0 +1,106 @@
+#include <lcf/rpg/map.h>
+#include <lcf/rpg/savetarget.h>
+#include "map_cache.h"
+#include "player.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("MapCache");
+
+static MapCache::MapFile MakeMapFile(size_t tiles) {
+	auto map = std::make_shared<lcf::rpg::Map>();
+	map->lower_layer.resize(tiles);
+	map->upper_layer.resize(tiles);
+
+	MapCache::MapFile file;
+	file.bytes = MapCache::EstimateSize(*map);
+	file.map = std::move(map);
+	return file;
+}
+
+static lcf::rpg::EventCommand MakeTeleport(int map_id) {
+	lcf::rpg::EventCommand cmd;
+	cmd.code = static_cast<int>(lcf::rpg::EventCommand::Code::Teleport);
+	cmd.parameters = lcf::DBArray<int32_t>({ map_id, 5, 5, 0 });
+	return cmd;
+}
+
+TEST_CASE("EstimateSize") {
+	lcf::rpg::Map map;
+	const auto empty = MapCache::EstimateSize(map);
+
+	map.lower_layer.resize(100);
+	map.upper_layer.resize(100);
+	REQUIRE_EQ(MapCache::EstimateSize(map), empty + 400);
+
+	map.events.resize(1);
+	map.events[0].pages.resize(1);
+	map.events[0].pages[0].event_commands.push_back(MakeTeleport(1));
+	REQUIRE_GT(MapCache::EstimateSize(map), empty + 400);
+}
+
+TEST_CASE("GetAndAdd") {
+	MapCache::Clear();
+
+	REQUIRE(!MapCache::Get(1).map);
+
+	auto file = MakeMapFile(100);
+	MapCache::Add(1, file);
+	REQUIRE_EQ(MapCache::Get(1).map, file.map);
+
+	auto stats = MapCache::GetStats();
+	REQUIRE_EQ(stats.entries, 1);
+	REQUIRE_EQ(stats.bytes, file.bytes);
+	REQUIRE_EQ(stats.hits, 1);
+	REQUIRE_EQ(stats.misses, 1);
+
+	// Replacing does not count twice
+	MapCache::Add(1, MakeMapFile(100));
+	REQUIRE_EQ(MapCache::GetStats().bytes, file.bytes);
+
+	MapCache::Clear();
+	REQUIRE(!MapCache::Get(1).map);
+}
+
+TEST_CASE("EvictLeastRecentlyUsed") {
+	MapCache::Clear();
+
+	// A third of the budget each
+	const size_t budget = static_cast<size_t>(Player::player_config.map_cache_budget.Get()) * 1024 * 1024;
+	const size_t tiles = budget / 3 / (2 * sizeof(int16_t));
+
+	MapCache::Add(1, MakeMapFile(tiles));
+	MapCache::Add(2, MakeMapFile(tiles));
+	REQUIRE(MapCache::Get(1).map);
+
+	MapCache::Add(3, MakeMapFile(tiles));
+	REQUIRE(MapCache::Get(1).map);
+	REQUIRE(!MapCache::Get(2).map);
+	REQUIRE(MapCache::Get(3).map);
+
+	// Maps larger than the budget are not cached
+	MapCache::Add(4, MakeMapFile(budget));
+	REQUIRE(!MapCache::Get(4).map);
+	REQUIRE_EQ(MapCache::GetStats().entries, 2);
+
+	MapCache::Clear();
+}
+
+TEST_CASE("PlanPrefetch") {
+	lcf::rpg::Map map;
+	map.events.resize(2);
+	map.events[0].pages.resize(2);
+	map.events[0].pages[0].event_commands.push_back(MakeTeleport(5));
+	map.events[0].pages[1].event_commands.push_back(MakeTeleport(3));
+	map.events[1].pages.resize(1);
+	map.events[1].pages[0].event_commands.push_back(MakeTeleport(1));
+	map.events[1].pages[0].event_commands.push_back(MakeTeleport(5));
+
+	std::vector<lcf::rpg::SaveTarget> targets(2);
+	targets[0].map_id = 3;
+	targets[1].map_id = 7;
+
+	auto plan = MapCache::PlanPrefetch(map, 1, targets);
+	REQUIRE_EQ(plan, std::vector<int>{ 5, 3, 7 });
+}
+
+TEST_SUITE_END();
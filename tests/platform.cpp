@@ -42,6 +42,20 @@ TEST_CASE("GetSize") {
 	CHECK(Platform::File(bad).GetSize() == -1);
 }
 
+TEST_CASE("MappedFile") {
+	Platform::MappedFile file(onekb);
+	if (!file) {
+		// Platform without memory mapping support
+		CHECK(file.GetData().empty());
+		return;
+	}
+	CHECK(file.GetData().size() == 1024);
+
+	CHECK(!Platform::MappedFile(empty));
+	CHECK(!Platform::MappedFile(folder));
+	CHECK(!Platform::MappedFile(bad));
+}
+
 TEST_CASE("ReadDirectory") {
 	Platform::Directory dir(EP_TEST_PATH "/platform");
 
@@ -0,0 +1,95 @@
+#include <sstream>
+#include <lcf/lsd/reader.h>
+#include <lcf/reader_lcf.h>
+#include <lcf/rpg/save.h>
+#include "save_header.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("SaveHeader");
+
+static std::string MakeSave(const lcf::rpg::SaveTitle& title) {
+	lcf::rpg::Save save;
+	save.title = title;
+	save.system.switches.resize(100, true);
+
+	std::stringstream ss;
+	REQUIRE(lcf::LSD_Reader::Save(ss, save, lcf::EngineVersion::e2k3, ""));
+	return ss.str();
+}
+
+TEST_CASE("ReadTitle") {
+	lcf::rpg::SaveTitle title;
+	title.timestamp = 44195.5;
+	title.hero_name = "Alex";
+	title.hero_level = 12;
+	title.hero_hp = 345;
+	title.face1_name = "Actor1";
+	title.face1_id = 3;
+	title.face4_name = "Actor2";
+	title.face4_id = 7;
+
+	std::stringstream ss(MakeSave(title));
+	lcf::rpg::SaveTitle read;
+	REQUIRE(SaveHeader::Read(ss, "", read));
+
+	REQUIRE_EQ(read.timestamp, title.timestamp);
+	REQUIRE_EQ(read.hero_name, title.hero_name);
+	REQUIRE_EQ(read.hero_level, title.hero_level);
+	REQUIRE_EQ(read.hero_hp, title.hero_hp);
+	REQUIRE_EQ(read.face1_name, title.face1_name);
+	REQUIRE_EQ(read.face1_id, title.face1_id);
+	REQUIRE(read.face2_name.empty());
+	REQUIRE_EQ(read.face4_name, title.face4_name);
+	REQUIRE_EQ(read.face4_id, title.face4_id);
+}
+
+TEST_CASE("RejectInvalid") {
+	lcf::rpg::SaveTitle read;
+
+	std::stringstream empty;
+	REQUIRE(!SaveHeader::Read(empty, "", read));
+
+	std::stringstream other("\x0b" "LcfDataBase");
+	REQUIRE(!SaveHeader::Read(other, "", read));
+
+	lcf::rpg::SaveTitle title;
+	title.hero_name = "Alex";
+	auto data = MakeSave(title);
+	std::stringstream truncated(data.substr(0, 20));
+	REQUIRE(!SaveHeader::Read(truncated, "", read));
+}
+
+TEST_CASE("RejectTruncated") {
+	lcf::rpg::SaveTitle title;
+	title.hero_name = "Alex";
+	const auto data = MakeSave(title);
+
+	// Find the end of the title chunk
+	std::stringstream ss(data);
+	lcf::LcfReader reader(ss, "");
+	std::string header;
+	reader.ReadString(header, reader.ReadInt());
+	REQUIRE_EQ(reader.ReadInt(), 0x64);
+	const auto title_end = reader.Tell() + reader.ReadInt();
+	REQUIRE(title_end < data.size());
+
+	lcf::rpg::SaveTitle read;
+
+	std::stringstream after_title(data.substr(0, title_end));
+	REQUIRE(!SaveHeader::Read(after_title, "", read));
+
+	std::stringstream inside_chunk(data.substr(0, title_end + 3));
+	REQUIRE(!SaveHeader::Read(inside_chunk, "", read));
+
+	std::stringstream no_end_marker(data.substr(0, data.size() - 1));
+	REQUIRE(!SaveHeader::Read(no_end_marker, "", read));
+
+	std::stringstream trailing_data(data + "x");
+	REQUIRE(!SaveHeader::Read(trailing_data, "", read));
+
+	std::stringstream complete(data);
+	REQUIRE(SaveHeader::Read(complete, "", read));
+	REQUIRE_EQ(read.hero_name, title.hero_name);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,49 @@
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "save_writer.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("SaveWriter");
+
+TEST_CASE("RunInSubmissionOrder") {
+	std::vector<int> work_order;
+	std::vector<int> done_order;
+	constexpr int num_jobs = 32;
+	for (int i = 0; i < num_jobs; ++i) {
+		SaveWriter::Submit([&work_order, i]() {
+			// Early jobs take longer
+			std::this_thread::sleep_for(std::chrono::microseconds((num_jobs - i) * 10));
+			work_order.push_back(i);
+		}, [&done_order, i]() {
+			done_order.push_back(i);
+		});
+	}
+
+	SaveWriter::Flush();
+	REQUIRE(!SaveWriter::IsPending());
+
+	REQUIRE_EQ(work_order.size(), num_jobs);
+	REQUIRE_EQ(done_order.size(), num_jobs);
+	for (int i = 0; i < num_jobs; ++i) {
+		REQUIRE_EQ(work_order[i], i);
+		REQUIRE_EQ(done_order[i], i);
+	}
+
+	SaveWriter::Quit();
+}
+
+TEST_CASE("FlushRunsChainedJobs") {
+	int result = 0;
+	SaveWriter::Submit([&result]() { result = 1; }, [&result]() {
+		SaveWriter::Submit([&result]() { result *= 10; }, [&result]() { result += 2; });
+	});
+
+	SaveWriter::Flush();
+	REQUIRE(!SaveWriter::IsPending());
+	REQUIRE_EQ(result, 12);
+
+	SaveWriter::Quit();
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,148 @@
+#include <cstring>
+#include "sprite.h"
+#include "bitmap.h"
+#include "cache.h"
+#include "drawable_list.h"
+#include "drawable_mgr.h"
+#include "pixel_format.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("Sprite");
+
+namespace {
+struct TestSprite {
+	DrawableList list;
+	BitmapRef bitmap;
+	BitmapRef dst;
+	std::unique_ptr<Sprite> sprite;
+
+	TestSprite() {
+		Bitmap::SetFormat(format_R8G8B8A8_a().format());
+		DrawableMgr::SetLocalList(&list);
+		Cache::ClearAll();
+
+		bitmap = Bitmap::Create(32, 32, true);
+		bitmap->Clear();
+		for (int y = 0; y < 32; y += 2) {
+			bitmap->FillRect(Rect(0, y, 32 - y, 2), Color(y * 7, 200 - y * 5, 40 + y * 3, 255 - y * 4));
+		}
+		dst = Bitmap::Create(320, 240, true);
+
+		sprite = std::make_unique<Sprite>();
+		sprite->SetBitmap(bitmap);
+	}
+
+	~TestSprite() {
+		sprite.reset();
+		Cache::ClearAll();
+		DrawableMgr::SetLocalList(nullptr);
+	}
+
+	/** Draws a frame and checks the effects against the cache for the same parameters */
+	BitmapRef Draw(const Rect& rect) {
+		sprite->Draw(*dst);
+		const auto& draw_bitmap = sprite->GetDrawBitmap();
+		REQUIRE(draw_bitmap);
+
+		auto expected = Cache::SpriteEffect(bitmap, rect, sprite->GetFlipX(), sprite->GetFlipY(), sprite->GetTone(), flash);
+		REQUIRE_EQ(draw_bitmap->GetWidth(), expected->GetWidth());
+		REQUIRE_EQ(draw_bitmap->GetHeight(), expected->GetHeight());
+		CHECK(std::memcmp(draw_bitmap->pixels(), expected->pixels(), expected->height() * expected->pitch()) == 0);
+		return draw_bitmap;
+	}
+
+	void SetFlash(Color color) {
+		flash = color;
+		sprite->SetFlashEffect(color);
+	}
+
+	Color flash;
+};
+}
+
+TEST_CASE("FlashFade") {
+	TestSprite test;
+	const Rect rect = test.bitmap->GetRect();
+
+	test.SetFlash(Color(255, 100, 50, 255));
+	auto buffer = test.Draw(rect);
+
+	// Every frame is rendered into the same buffer instead of the cache
+	for (int alpha = 240; alpha > 0; alpha -= 16) {
+		test.SetFlash(Color(255, 100, 50, alpha));
+		CHECK_EQ(test.Draw(rect), buffer);
+	}
+	CHECK_NE(Cache::SpriteEffect(test.bitmap, rect, false, false, Tone(), test.flash), buffer);
+
+	// Flash ended: Drawn from the source bitmap
+	test.SetFlash(Color());
+	test.sprite->Draw(*test.dst);
+	CHECK_EQ(test.sprite->GetDrawBitmap(), test.bitmap);
+}
+
+TEST_CASE("ToneTransition") {
+	TestSprite test;
+	const Rect rect = test.bitmap->GetRect();
+
+	test.sprite->Draw(*test.dst);
+	CHECK_EQ(test.sprite->GetDrawBitmap(), test.bitmap);
+
+	// A single tone change uses the shared cache
+	test.sprite->SetTone(Tone(128, 128, 128, 0));
+	auto cached = test.Draw(rect);
+	CHECK_EQ(cached, Cache::SpriteEffect(test.bitmap, rect, false, false, Tone(128, 128, 128, 0), Color()));
+	CHECK_EQ(test.Draw(rect), cached);
+
+	// A transition changes the tone on consecutive frames: The first step still uses
+	// the cache, the following steps are rendered into the buffer
+	test.sprite->SetFlipX(true);
+	test.sprite->SetTone(Tone(135, 121, 128, 15));
+	auto first_step = test.Draw(rect);
+	CHECK_EQ(first_step, Cache::SpriteEffect(test.bitmap, rect, true, false, Tone(135, 121, 128, 15), Color()));
+
+	test.sprite->SetTone(Tone(142, 114, 128, 30));
+	auto buffer = test.Draw(rect);
+	CHECK_NE(buffer, first_step);
+	for (int step = 3; step <= 16; ++step) {
+		test.sprite->SetTone(Tone(128 + step * 7, 128 - step * 7, 128, step * 15));
+		CHECK_EQ(test.Draw(rect), buffer);
+	}
+
+	// Transition finished: The buffer is kept while nothing changes
+	CHECK_EQ(test.Draw(rect), buffer);
+
+	// Effects ended: Drawn from the source bitmap, the next change uses the cache again
+	test.sprite->SetFlipX(false);
+	test.sprite->SetTone(Tone());
+	test.sprite->Draw(*test.dst);
+	CHECK_EQ(test.sprite->GetDrawBitmap(), test.bitmap);
+
+	test.sprite->SetTone(Tone(128, 128, 128, 0));
+	CHECK_EQ(test.Draw(rect), Cache::SpriteEffect(test.bitmap, rect, false, false, Tone(128, 128, 128, 0), Color()));
+}
+
+TEST_CASE("BufferSize") {
+	TestSprite test;
+
+	test.sprite->SetSpriteRect(Rect(0, 0, 16, 16));
+	test.SetFlash(Color(255, 255, 255, 200));
+	auto buffer = test.Draw(Rect(0, 0, 16, 16));
+
+	// Same size at another position: Reused
+	test.sprite->SetSpriteRect(Rect(16, 16, 16, 16));
+	test.SetFlash(Color(255, 255, 255, 180));
+	CHECK_EQ(test.Draw(Rect(16, 16, 16, 16)), buffer);
+
+	// Different size: Reallocated
+	test.sprite->SetSpriteRect(Rect(0, 8, 32, 16));
+	test.SetFlash(Color(255, 255, 255, 160));
+	auto resized = test.Draw(Rect(0, 8, 32, 16));
+	CHECK_NE(resized, buffer);
+	CHECK_EQ(resized->GetWidth(), 32);
+	CHECK_EQ(resized->GetHeight(), 16);
+
+	test.SetFlash(Color(255, 255, 255, 140));
+	CHECK_EQ(test.Draw(Rect(0, 8, 32, 16)), resized);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,141 @@
+#include <cstring>
+#include "tilemap_layer.h"
+#include "bitmap.h"
+#include "drawable_list.h"
+#include "drawable_mgr.h"
+#include "map_data.h"
+#include "pixel_format.h"
+#include "mock_game.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("TilemapLayer");
+
+namespace {
+// Sublayer of the upper layer tiles that are not above the hero
+constexpr uint8_t z_order = TilemapLayer::TileBelow + 1;
+
+// The map is 40x30 tiles, 3x2 chunks. At 320x240 only the chunks (0, 0) and (1, 0) are visible.
+struct TestMap {
+	MockGame game { MockMap::ePass40x30 };
+	DrawableList list;
+	std::unique_ptr<TilemapLayer> layer;
+	std::vector<short> map_data = std::vector<short>(40 * 30, BLOCK_F);
+	BitmapRef screen;
+
+	TestMap() {
+		Bitmap::SetFormat(format_R8G8B8A8_a().format());
+		DrawableMgr::SetLocalList(&list);
+
+		auto chipset = Bitmap::Create(480, 256);
+		chipset->Fill(Color(100, 150, 200, 255));
+		chipset->FillRect(Rect(18 * TILE_SIZE + 4, 8 * TILE_SIZE + 4, 8, 8), Color(20, 40, 60, 255));
+		chipset->CheckPixels(Bitmap::Flag_Chipset);
+
+		layer = std::make_unique<TilemapLayer>(1);
+		layer->SetChipset(chipset);
+		layer->SetWidth(40);
+		layer->SetHeight(30);
+		layer->SetPassable(std::vector<unsigned char>(162, 0));
+		layer->SetMapData(map_data);
+
+		screen = Bitmap::Create(320, 240);
+	}
+
+	~TestMap() {
+		layer.reset();
+		DrawableMgr::SetLocalList(nullptr);
+	}
+
+	void Draw() {
+		screen->Clear();
+		layer->Draw(*screen, z_order);
+	}
+
+	void SetTile(int x, int y, short id) {
+		map_data[y * 40 + x] = id;
+		layer->SetMapData(map_data);
+	}
+};
+
+bool SamePixels(const Bitmap& a, const Bitmap& b) {
+	return std::memcmp(a.pixels(), b.pixels(), a.height() * a.pitch()) == 0;
+}
+}
+
+TEST_CASE("ChunksRenderedOnce") {
+	TestMap map;
+
+	map.Draw();
+	REQUIRE_EQ(map.layer->GetChunkStats().renders, 2);
+
+	map.Draw();
+	REQUIRE_EQ(map.layer->GetChunkStats().renders, 2);
+}
+
+TEST_CASE("TileChangeInvalidatesChunk") {
+	TestMap map;
+	map.Draw();
+
+	// Only the chunk with the tile is rendered again
+	map.SetTile(2, 2, BLOCK_F + 1);
+	map.Draw();
+	REQUIRE_EQ(map.layer->GetChunkStats().renders, 3);
+
+	// Same tile again, nothing changed
+	map.SetTile(2, 2, BLOCK_F + 1);
+	map.Draw();
+	REQUIRE_EQ(map.layer->GetChunkStats().renders, 3);
+
+	// Chunk (2, 1) is not visible
+	map.SetTile(35, 25, BLOCK_F + 1);
+	map.Draw();
+	REQUIRE_EQ(map.layer->GetChunkStats().renders, 3);
+}
+
+TEST_CASE("ToneKeepsChunks") {
+	TestMap map;
+	map.Draw();
+	auto plain = Bitmap::Create(*map.screen, map.screen->GetRect());
+
+	const Tone tone(255, 100, 128, 60);
+	map.layer->SetTone(tone);
+	map.Draw();
+
+	// 20x15 visible tiles are toned, the chunks are not rendered again
+	REQUIRE_EQ(map.layer->GetChunkStats().renders, 2);
+	REQUIRE_EQ(map.layer->GetChunkStats().toned_cells, 20 * 15);
+
+	auto expected = Bitmap::Create(320, 240);
+	expected->Clear();
+	expected->ToneBlit(0, 0, *plain, plain->GetRect(), tone, Opacity::Opaque());
+	REQUIRE(SamePixels(*map.screen, *expected));
+
+	// Same tone, nothing to do
+	map.Draw();
+	REQUIRE_EQ(map.layer->GetChunkStats().toned_cells, 20 * 15);
+
+	// Next step of a tone fade
+	map.layer->SetTone(Tone(200, 110, 128, 80));
+	map.Draw();
+	REQUIRE_EQ(map.layer->GetChunkStats().renders, 2);
+	REQUIRE_EQ(map.layer->GetChunkStats().toned_cells, 2 * 20 * 15);
+
+	map.layer->SetTone(Tone());
+	map.Draw();
+	REQUIRE(SamePixels(*map.screen, *plain));
+}
+
+TEST_CASE("ToneAfterTileChange") {
+	TestMap map;
+	const Tone tone(255, 100, 128, 60);
+	map.layer->SetTone(tone);
+	map.Draw();
+
+	// The changed chunk is rendered and toned again
+	map.SetTile(18, 3, BLOCK_F + 1);
+	map.Draw();
+	REQUIRE_EQ(map.layer->GetChunkStats().renders, 3);
+	REQUIRE_EQ(map.layer->GetChunkStats().toned_cells, 20 * 15 + 4 * 15);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,148 @@
+#include <cstring>
+#include "window.h"
+#include "bitmap.h"
+#include "cache.h"
+#include "drawable_list.h"
+#include "drawable_mgr.h"
+#include "pixel_format.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("Window");
+
+namespace {
+struct TestWindows {
+	DrawableList list;
+	BitmapRef skin1;
+	BitmapRef skin2;
+
+	TestWindows() {
+		Bitmap::SetFormat(format_R8G8B8A8_a().format());
+		DrawableMgr::SetLocalList(&list);
+		Cache::ClearAll();
+
+		skin1 = Cache::System(CACHE_DEFAULT_BITMAP);
+
+		skin2 = Bitmap::Create(160, 80, true);
+		skin2->Clear();
+		for (int y = 0; y < 80; y += 2) {
+			skin2->FillRect(Rect(0, y, 160 - y, 2), Color(y * 3, 200 - y * 2, 100 + y, 255 - y));
+		}
+	}
+
+	~TestWindows() {
+		Window::SetComposeEnabled(true);
+		Cache::ClearAll();
+		DrawableMgr::SetLocalList(nullptr);
+	}
+
+	std::unique_ptr<Window> MakeWindow(BitmapRef skin, int width, int height) {
+		auto window = std::make_unique<Window>();
+		window->SetWindowskin(skin);
+		window->SetX(20);
+		window->SetY(30);
+		window->SetWidth(width);
+		window->SetHeight(height);
+		window->SetLeftArrow(true);
+		window->SetRightArrow(true);
+		window->SetDownArrow(true);
+		return window;
+	}
+
+	static BitmapRef Draw(Window& window, bool composed) {
+		Window::SetComposeEnabled(composed);
+		auto dst = Bitmap::Create(320, 240, Color(40, 80, 120, 255));
+		window.Draw(*dst);
+		Window::SetComposeEnabled(true);
+		return dst;
+	}
+};
+
+bool SamePixels(const Bitmap& a, const Bitmap& b) {
+	return std::memcmp(a.pixels(), b.pixels(), a.height() * a.pitch()) == 0;
+}
+}
+
+TEST_CASE("ComposedSameAsParts") {
+	TestWindows test;
+
+	for (auto& skin: { test.skin1, test.skin2 }) {
+		for (bool stretch: { true, false }) {
+			for (auto size: { Rect(0, 0, 160, 80), Rect(0, 0, 33, 17), Rect(0, 0, 64, 12) }) {
+				auto window = test.MakeWindow(skin, size.width, size.height);
+				window->SetStretch(stretch);
+				REQUIRE(SamePixels(*test.Draw(*window, true), *test.Draw(*window, false)));
+			}
+		}
+	}
+}
+
+TEST_CASE("ComposedInvalidation") {
+	TestWindows test;
+	auto window = test.MakeWindow(test.skin1, 120, 64);
+	test.Draw(*window, true);
+
+	SUBCASE("windowskin") {
+		window->SetWindowskin(test.skin2);
+		auto expected = test.MakeWindow(test.skin2, 120, 64);
+		REQUIRE(SamePixels(*test.Draw(*window, true), *test.Draw(*expected, false)));
+	}
+
+	SUBCASE("size") {
+		window->SetWidth(80);
+		window->SetHeight(96);
+		auto expected = test.MakeWindow(test.skin1, 80, 96);
+		REQUIRE(SamePixels(*test.Draw(*window, true), *test.Draw(*expected, false)));
+	}
+
+	SUBCASE("stretch") {
+		window->SetStretch(false);
+		auto expected = test.MakeWindow(test.skin1, 120, 64);
+		expected->SetStretch(false);
+		REQUIRE(SamePixels(*test.Draw(*window, true), *test.Draw(*expected, false)));
+	}
+
+	SUBCASE("opacity") {
+		auto expected = test.MakeWindow(test.skin1, 120, 64);
+
+		window->SetOpacity(128);
+		expected->SetOpacity(128);
+		REQUIRE(SamePixels(*test.Draw(*window, true), *test.Draw(*expected, false)));
+
+		// Resized while drawn from the parts
+		window->SetWidth(100);
+		test.Draw(*window, true);
+		window->SetOpacity(255);
+		expected = test.MakeWindow(test.skin1, 100, 64);
+		REQUIRE(SamePixels(*test.Draw(*window, true), *test.Draw(*expected, false)));
+
+		window->SetBackOpacity(160);
+		expected->SetBackOpacity(160);
+		REQUIRE(SamePixels(*test.Draw(*window, true), *test.Draw(*expected, false)));
+	}
+}
+
+TEST_CASE("ArrowsPerWindowskin") {
+	TestWindows test;
+
+	auto window1 = test.MakeWindow(test.skin1, 120, 64);
+	auto window2 = test.MakeWindow(test.skin1, 64, 120);
+	test.Draw(*window1, true);
+	test.Draw(*window2, true);
+
+	auto left = Cache::WindowArrow(test.skin1, false);
+	auto right = Cache::WindowArrow(test.skin1, true);
+	REQUIRE_NE(left, right);
+	REQUIRE_EQ(left.use_count(), 3);
+	REQUIRE_EQ(right.use_count(), 3);
+
+	// Another windowskin has its own arrows
+	window2->SetWindowskin(test.skin2);
+	test.Draw(*window2, true);
+	REQUIRE_EQ(left.use_count(), 2);
+	REQUIRE_NE(Cache::WindowArrow(test.skin2, false), left);
+
+	auto expected = test.MakeWindow(test.skin2, 64, 120);
+	REQUIRE(SamePixels(*test.Draw(*window2, true), *test.Draw(*expected, false)));
+}
+
+TEST_SUITE_END();
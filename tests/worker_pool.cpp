@@ -0,0 +1,76 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "worker_pool.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("WorkerPool");
+
+TEST_CASE("DoneInSubmissionOrder") {
+	WorkerPool::Init();
+
+	std::vector<int> order;
+	constexpr int num_jobs = 64;
+	for (int i = 0; i < num_jobs; ++i) {
+		WorkerPool::Submit([i]() {
+			// Early jobs take longer
+			std::this_thread::sleep_for(std::chrono::microseconds((num_jobs - i) * 10));
+		}, [&order, i]() {
+			order.push_back(i);
+		});
+	}
+
+	while (static_cast<int>(order.size()) < num_jobs) {
+		WorkerPool::Update();
+		std::this_thread::yield();
+	}
+
+	for (int i = 0; i < num_jobs; ++i) {
+		REQUIRE_EQ(order[i], i);
+	}
+
+	WorkerPool::Quit();
+}
+
+TEST_CASE("Cancel") {
+	WorkerPool::Init();
+
+	std::atomic<int> done{0};
+	for (int i = 0; i < 16; ++i) {
+		WorkerPool::Submit([]() {}, [&done]() { ++done; });
+	}
+	WorkerPool::Cancel();
+	WorkerPool::Update();
+
+	CHECK_EQ(done.load(), 0);
+
+	WorkerPool::Quit();
+}
+
+TEST_CASE("Parallel") {
+	WorkerPool::Init();
+
+	constexpr int count = 100;
+	std::vector<std::atomic<int>> calls(count);
+	WorkerPool::Parallel(count, [&calls](int i) {
+		++calls[i];
+	});
+
+	for (int i = 0; i < count; ++i) {
+		REQUIRE_EQ(calls[i].load(), 1);
+	}
+
+	WorkerPool::Quit();
+}
+
+TEST_CASE("ParallelDisabled") {
+	std::vector<int> order;
+	WorkerPool::Parallel(4, [&order](int i) {
+		order.push_back(i);
+	});
+
+	CHECK_EQ(order, std::vector<int>{0, 1, 2, 3});
+}
+
+TEST_SUITE_END();